@@ -48,12 +48,16 @@ int64_t rfread(void* buffer, size_t elem_size, size_t elem_count, RFILE* stream)
 #include "tom.h"
 #include "blitter.h"
 #include "gpu.h"
+#include "op.h"
 #include "eeprom.h"
 #include "memtrack.h"
 #include "jaggd.h"
 #include "nvmbios.h"
 #include "vjag_memory.h"
 #include "state.h"
+#include "state_delta.h"
+#include "perf_timing.h"
+#include "rewind.h"
 #include "titledb.h"
 #include "titlehook.h"
 #include "log.h"
@@ -357,6 +361,29 @@ static bool         inputdev_live[2]        = { false, false };
  * than function-local so retro_deinit can put it back. */
 static bool         headroom_logged         = false;
 
+/* In-core rewind (src/core/rewind.h): the RetroPad button on port 1 that
+ * steps back (-1 = off), frames between captures, and the byte budget the
+ * ring was last configured with.  Reset in retro_deinit. */
+static int          rewind_button           = -1;
+static unsigned     rewind_interval         = 2;
+static size_t       rewind_budget           = 0;
+static unsigned     rewind_countdown        = 0;
+/* Run-ahead loads a state, runs the real frame, saves
+ * (RETRO_SAVESTATE_CONTEXT_RUNAHEAD_SAME_INSTANCE) and runs the look-ahead
+ * frames it will roll back with the next load.  rewind_speculating marks
+ * those frames, so rewind neither captures nor steps on them; a second
+ * run-ahead instance only ever runs such frames.  Frontend rewind saves in
+ * the same context before every frame without loading in between, and the
+ * second save in a row shows the frames are real after all. */
+static bool         rewind_speculating      = false;
+static bool         rewind_saved_since_load = false;
+
+/* Output path (virtualjaguar_audio_resampler) and the sample rate the
+ * frontend was last told about, so retro_run renegotiates only when the
+ * two disagree.  Reset in retro_deinit. */
+static int          audio_resampler         = DAC_RESAMPLER_LINEAR;
+static double       audio_rate_advertised   = 0.0;
+
 static const char *inputdev_type_name(InputDevType t)
 {
    switch (t)
@@ -670,6 +697,7 @@ static bool update_option_visibility(void)
          "virtualjaguar_cd_bios_type",
          "virtualjaguar_cd_boot_mode",
          "virtualjaguar_cd_read_speed",
+         "virtualjaguar_cd_read_ahead",
          "virtualjaguar_cd_trace",
          "virtualjaguar_memory_track",
       };
@@ -1944,6 +1972,187 @@ static void check_variables(void)
          GPUPipeTimingReset();
    }
 
+   /* Pre-decoded RISC instruction stream: host-side only, so it needs
+    * no savestate field and can be flipped at any time. */
+   var.key = "virtualjaguar_risc_decode_cache";
+   var.value = NULL;
+   {
+      int decodeCache = 1;
+      if (get_variable_pertitle(&var) && var.value)
+         decodeCache = (strcmp(var.value, "disabled") != 0);
+      GPUSetDecodeCache(decodeCache);
+      DSPSetDecodeCache(decodeCache);
+   }
+
+   var.key = "virtualjaguar_risc_superblocks";
+   var.value = NULL;
+   {
+      int superblocks = 1;
+      if (get_variable_pertitle(&var) && var.value)
+         superblocks = (strcmp(var.value, "disabled") != 0);
+      GPUSetSuperblocks(superblocks);
+      DSPSetSuperblocks(superblocks);
+   }
+
+   /* Per-title rows in titledb.c can turn this off for a title whose
+    * loop the watch misjudges; the skip itself needs no savestate
+    * field. */
+   var.key = "virtualjaguar_risc_idle_skip";
+   var.value = NULL;
+   {
+      int idleSkip = 1;
+      if (get_variable_pertitle(&var) && var.value)
+         idleSkip = (strcmp(var.value, "disabled") != 0);
+      GPUSetIdleSkip(idleSkip);
+      DSPSetIdleSkip(idleSkip);
+   }
+
+   /* Exact by construction (see op.c); the option is an A/B switch. */
+   var.key = "virtualjaguar_op_list_index";
+   var.value = NULL;
+   {
+      bool listIndex = true;
+      if (get_variable_pertitle(&var) && var.value)
+         listIndex = (strcmp(var.value, "disabled") != 0);
+      OPSetListIndex(listIndex);
+   }
+
+   /* Off by default: the interpreter is the reference. */
+   var.key = "virtualjaguar_risc_dynarec";
+   var.value = NULL;
+   {
+      static int dynarec_warned = 0;
+      int dynarec = 0, gpu_ok, dsp_ok;
+      if (get_variable_pertitle(&var) && var.value)
+         dynarec = (strcmp(var.value, "enabled") == 0);
+      gpu_ok = GPUSetJit(dynarec);
+      dsp_ok = DSPSetJit(dynarec);
+      if (dynarec && !(gpu_ok && dsp_ok) && !dynarec_warned)
+      {
+         LOG_WRN("[RISC] dynarec unavailable on this host; using the interpreter\n");
+         dynarec_warned = 1;
+      }
+   }
+
+   /* On by default: the DAC keeps its per-output-sample event, which
+    * cuts processor slices as the reference schedule does. */
+   var.key = "virtualjaguar_dac_slice_cuts";
+   var.value = NULL;
+   vjs.dacSliceCuts = true;
+   if (get_variable_pertitle(&var) && var.value)
+      vjs.dacSliceCuts = (strcmp(var.value, "disabled") != 0);
+
+   /* Off by default: frontend RAM pokes bypass the dirty-page tracking. */
+   var.key = "virtualjaguar_state_delta";
+   var.value = NULL;
+   {
+      bool state_delta = false;
+      if (get_variable_pertitle(&var) && var.value)
+         state_delta = (strcmp(var.value, "enabled") == 0);
+      StateDeltaSetEnabled(state_delta);
+   }
+
+   /* Off by default.  Resizing the ring drops history, so only when the
+    * budget actually changes. */
+   var.key = "virtualjaguar_rewind";
+   var.value = NULL;
+   {
+      size_t budget = 0;
+
+      rewind_button = -1;
+      if (get_variable_pertitle(&var) && var.value)
+      {
+         if (!strcmp(var.value, "l3"))          rewind_button = RETRO_DEVICE_ID_JOYPAD_L3;
+         else if (!strcmp(var.value, "r3"))     rewind_button = RETRO_DEVICE_ID_JOYPAD_R3;
+         else if (!strcmp(var.value, "l2"))     rewind_button = RETRO_DEVICE_ID_JOYPAD_L2;
+         else if (!strcmp(var.value, "r2"))     rewind_button = RETRO_DEVICE_ID_JOYPAD_R2;
+         else if (!strcmp(var.value, "select")) rewind_button = RETRO_DEVICE_ID_JOYPAD_SELECT;
+      }
+
+      var.key = "virtualjaguar_rewind_interval";
+      var.value = NULL;
+      rewind_interval = 2;
+      if (get_variable_pertitle(&var) && var.value && atoi(var.value) > 0)
+         rewind_interval = (unsigned)atoi(var.value);
+
+      if (rewind_button >= 0)
+      {
+         var.key = "virtualjaguar_rewind_budget";
+         var.value = NULL;
+         budget = (size_t)64 << 20;
+         if (get_variable_pertitle(&var) && var.value && atoi(var.value) > 0)
+            budget = (size_t)atoi(var.value) << 20;
+      }
+
+      if (budget != rewind_budget)
+      {
+         if (!RewindConfigure(STATE_SIZE, budget))
+         {
+            LOG_WRN("[rewind] cannot allocate %lu MB of history; rewind off\n",
+                    (unsigned long)(budget >> 20));
+            budget = 0;
+            rewind_button = -1;
+         }
+         rewind_budget = budget;
+      }
+   }
+
+   /* Off by default: the worker only pays for itself with a spare core. */
+   var.key = "virtualjaguar_threaded_render";
+   var.value = NULL;
+   {
+      static int threaded_warned = 0;
+      bool threaded = false;
+      if (get_variable_pertitle(&var) && var.value)
+         threaded = (strcmp(var.value, "enabled") == 0);
+      if (threaded != TOMSetThreadedRender(threaded) && !threaded_warned)
+      {
+         LOG_WRN("[TOM] no render thread in this build; converting lines inline\n");
+         threaded_warned = 1;
+      }
+   }
+
+   /* Off by default for the same reason: a spare core or it only costs. */
+   /* Linear by default: the output every other setting was tuned
+    * against.  Native changes the advertised sample rate, which retro_run
+    * renegotiates (audio_rate_advertised). */
+   var.key = "virtualjaguar_audio_resampler";
+   var.value = NULL;
+   audio_resampler = DAC_RESAMPLER_LINEAR;
+   if (get_variable_pertitle(&var) && var.value)
+   {
+      if (!strcmp(var.value, "sinc"))
+         audio_resampler = DAC_RESAMPLER_SINC;
+      else if (!strcmp(var.value, "native"))
+         audio_resampler = DAC_RESAMPLER_NATIVE;
+   }
+   DACSetResampler(audio_resampler);
+
+   var.key = "virtualjaguar_threaded_dsp";
+   var.value = NULL;
+   {
+      static int dsp_thread_warned = 0;
+      bool threaded = false;
+      if (get_variable_pertitle(&var) && var.value)
+         threaded = (strcmp(var.value, "enabled") == 0);
+      if (threaded != DSPSetThreaded(threaded) && !dsp_thread_warned)
+      {
+         LOG_WRN("[DSP] no DSP thread in this build; running it inline\n");
+         dsp_thread_warned = 1;
+      }
+   }
+
+   /* On by default: the worker mostly sleeps on I/O, so it costs little
+    * even without a spare core, and reads return the same bytes. */
+   var.key = "virtualjaguar_cd_read_ahead";
+   var.value = NULL;
+   {
+      bool readAhead = true;
+      if (get_variable_pertitle(&var) && var.value)
+         readAhead = (strcmp(var.value, "disabled") != 0);
+      CDIntfSetReadAhead(readAhead);
+   }
+
    /* DRAM timing: enabled/disabled only, covering BOTH halves of the
     * symmetric self-cost model (GPU stalls in gpu.c, 68K wait-states
     * in jaguar.c).  The calibration scale is deliberately NOT a core
@@ -2771,6 +2980,11 @@ void retro_get_system_av_info(struct retro_system_av_info *info)
    info->timing.sample_rate    = (double)(vjs.hardwareTypeNTSC
                                           ? (BUFNTSC / 2) : (BUFPAL / 2))
                                  * info->timing.fps;
+   /* Native-rate audio hands over the word strobe's pairs as captured,
+    * so the rate is whatever SCLK/SMODE currently make it. */
+   if (audio_resampler == DAC_RESAMPLER_NATIVE)
+      info->timing.sample_rate = DACGetI2SRate();
+   audio_rate_advertised = info->timing.sample_rate;
    info->geometry.base_width   = game_width;
    info->geometry.base_height  = game_height;
    /* Hi-res: the maxima scale by the (load-time-fixed) internal
@@ -2849,11 +3063,26 @@ size_t retro_serialize_size(void)
    return STATE_SIZE;
 }
 
-bool retro_serialize(void *data, size_t size)
+/* Incremental saves are only safe into a buffer the frontend keeps in
+ * this process; a frontend that cannot say is assumed to (run-ahead and
+ * rewind predate the context query). */
+static bool serialize_delta_allowed(void)
+{
+   int ctx = RETRO_SAVESTATE_CONTEXT_NORMAL;
+
+   if (!environ_cb || !environ_cb(RETRO_ENVIRONMENT_GET_SAVESTATE_CONTEXT, &ctx))
+      return true;
+   return ctx == RETRO_SAVESTATE_CONTEXT_RUNAHEAD_SAME_INSTANCE;
+}
+
+/* deltaAllowed: the buffer may be rewritten incrementally next time
+ * (src/core/state_delta.h).  The rewind capture buffer never may -- the
+ * ring turns it into a delta right after. */
+static bool serialize_state(void *data, size_t size, bool deltaAllowed)
 {
    uint8_t *buf, *start;
    size_t written;
-   uint32_t magic, version, flags, reserved;
+   uint32_t magic, version, flags, reserved, oldReserved;
    extern uint8_t jerry_ram_8[];
    extern bool lowerField;
 
@@ -2863,18 +3092,24 @@ bool retro_serialize(void *data, size_t size)
    start = (uint8_t *)data;
    buf   = start;
 
-   /* Header */
+   /* Header.  `reserved` is ignored on load; it carries the incremental-
+    * save nonce (src/core/state_delta.h), read back before it is
+    * overwritten to decide whether this buffer still holds our last
+    * image. */
+   memcpy(&oldReserved, start + 12, sizeof(oldReserved));
    magic    = STATE_MAGIC;
    version  = STATE_VERSION;
    flags    = 0;
-   reserved = 0;
+   reserved = StateDeltaSaveBegin(start, STATE_SIZE, oldReserved,
+         deltaAllowed);
    STATE_SAVE_VAR(buf, magic);
    STATE_SAVE_VAR(buf, version);
    STATE_SAVE_VAR(buf, flags);
    STATE_SAVE_VAR(buf, reserved);
 
    /* Large memory blocks */
-   STATE_SAVE_BUF(buf, jaguarMainRAM, 0x200000);  /* 2 MB main RAM */
+   StateDeltaSaveRAM(buf, jaguarMainRAM);          /* 2 MB main RAM */
+   buf += 0x200000;
    STATE_SAVE_BUF(buf, tomRam8, 0x4000);           /* 16 KB TOM registers */
 
    STATE_SAVE_BUF(buf, jerry_ram_8, 0x10000);      /* 64 KB JERRY registers */
@@ -2927,9 +3162,18 @@ bool retro_serialize(void *data, size_t size)
     * different motion. */
    buf += InputDevStateSave(buf);
 
+   /* v12, extended in place: absolute event-scheduler clocks.  The event
+    * chunk above stores delays from "now"; the sub-cycle phase of now
+    * decides where the next slice boundary lands in whole cycles, so a
+    * rollback that dropped it would run different slice lengths. */
+   buf += EventClockStateSave(buf);
+
    written = (size_t)(buf - start);
    if (written > STATE_SIZE)
+   {
+      StateDeltaSaveEnd(start, false, written);
       return false;
+   }
 
    /* One-shot headroom report.  The trailing chunks in this function grow
     * every release and the only backstop is the hard fail above, so make
@@ -2946,13 +3190,32 @@ bool retro_serialize(void *data, size_t size)
    }
 
    /* Zero-fill remaining bytes for deterministic save states */
-   if (written < STATE_SIZE)
+   if (written < STATE_SIZE && StateDeltaNeedZeroFill(written))
       memset(buf, 0, STATE_SIZE - written);
 
+   StateDeltaSaveEnd(start, true, written);
    return true;
 }
 
-bool retro_unserialize(const void *data, size_t size)
+bool retro_serialize(void *data, size_t size)
+{
+   int ctx = RETRO_SAVESTATE_CONTEXT_NORMAL;
+   bool ok;
+
+   PERF_TIME_ENTER(PERF_T_STATE);
+   ok = serialize_state(data, size, serialize_delta_allowed());
+   PERF_TIME_LEAVE();
+   if (ok && environ_cb
+       && environ_cb(RETRO_ENVIRONMENT_GET_SAVESTATE_CONTEXT, &ctx)
+       && ctx == RETRO_SAVESTATE_CONTEXT_RUNAHEAD_SAME_INSTANCE)
+   {
+      rewind_speculating = !rewind_saved_since_load;
+      rewind_saved_since_load = true;
+   }
+   return ok;
+}
+
+static bool unserialize_state(const void *data, size_t size)
 {
    const uint8_t *buf;
    uint32_t magic, version, flags, reserved;
@@ -2987,6 +3250,7 @@ bool retro_unserialize(const void *data, size_t size)
 
    /* Large memory blocks */
    STATE_LOAD_BUF(buf, jaguarMainRAM, 0x200000);
+   StateDeltaLoaded((const uint8_t *)data, reserved);
    STATE_LOAD_BUF(buf, tomRam8, 0x4000);
 
    STATE_LOAD_BUF(buf, jerry_ram_8, 0x10000);
@@ -3070,6 +3334,13 @@ bool retro_unserialize(const void *data, size_t size)
    else
       InputDevReset();
 
+   /* v12, extended in place: event-scheduler clocks.  A state written
+    * before the extension (or any older version) reads zeros from the
+    * tail / keeps the zero clocks EventStateLoad left, i.e. restarts the
+    * clocks on a cycle boundary with every pending delay intact. */
+   if (version >= STATE_VERSION_INPUT_DEVICES)
+      buf += EventClockStateLoad(buf);
+
    /* tomRam8 was restored raw above; recompute the DRAM/refresh timing
     * that bus_arbiter derives from MEMCON1/MEMCON2 so it matches the
     * loaded state (dram_row_miss/rom_clocks/dram_refresh_clks from
@@ -3100,6 +3371,29 @@ bool retro_unserialize(const void *data, size_t size)
    return true;
 }
 
+/* A state the player loads moves them off the timeline the rewind history
+ * leads back along, so that history goes.  Run-ahead and netplay rollback
+ * stay on it and leave it alone (a frontend that cannot say which is which
+ * is treated as a player load). */
+bool retro_unserialize(const void *data, size_t size)
+{
+   int ctx = RETRO_SAVESTATE_CONTEXT_NORMAL;
+   bool ok;
+
+   PERF_TIME_ENTER(PERF_T_STATE);
+   ok = unserialize_state(data, size);
+   PERF_TIME_LEAVE();
+   if (!ok)
+      return false;
+   if (environ_cb)
+      environ_cb(RETRO_ENVIRONMENT_GET_SAVESTATE_CONTEXT, &ctx);
+   if (ctx == RETRO_SAVESTATE_CONTEXT_NORMAL)
+      RewindClear();
+   rewind_speculating = (ctx == RETRO_SAVESTATE_CONTEXT_RUNAHEAD_SAME_BINARY);
+   rewind_saved_since_load = false;
+   return true;
+}
+
 /* Cheat codes — the parser and list management live in src/core/cheat.c so
  * they can be unit-tested without the rest of the emulator. Here we just
  * bind them to the Jaguar memory bus and re-apply every frame so games
@@ -3983,6 +4277,13 @@ bool retro_load_game(const struct retro_game_info *info)
    if (jaguarMemTrackInserted)
       NVMBiosInstall();
 
+   /* Boot paths write RAM directly; no earlier buffer is current. */
+   StateDeltaForget();
+   RewindClear();
+   rewind_countdown = 0;
+   rewind_speculating = false;
+   rewind_saved_since_load = false;
+
    return true;
 }
 
@@ -4005,6 +4306,8 @@ void retro_unload_game(void)
    content_loaded    = false;
    update_option_visibility();
    JaguarDone();
+   StateDeltaForget();
+   RewindClear();
 
 #ifdef VJ_TRACE
    /* Next title's frame 1 must be ring/field-CSV frame 1, not a
@@ -4331,6 +4634,16 @@ void retro_deinit(void)
    analog_exponent_q8[1]   = 256;
    show_analog_options     = true;
    headroom_logged         = false;
+   RewindFree();
+   rewind_button           = -1;
+   rewind_interval         = 2;
+   rewind_budget           = 0;
+   rewind_countdown        = 0;
+   rewind_speculating      = false;
+   rewind_saved_since_load = false;
+   audio_resampler         = DAC_RESAMPLER_LINEAR;
+   audio_rate_advertised   = 0.0;
+   DACSetResampler(DAC_RESAMPLER_LINEAR);
    video_buffer_alloc_pixels = VIDEO_BUFFER_PIXELS;
    hires_restart_notice_logged = 0;
 
@@ -4391,6 +4704,8 @@ void retro_reset(void)
    NVMBiosReset();
    if (jaguarMemTrackInserted)
       NVMBiosInstall();
+   StateDeltaMarkAll();
+   RewindClear();
 
    /* Re-blank the framebuffer, or the reset presents the PREVIOUS session's
     * pixels.  TOMReset puts tomWidth back to 0, and the border-fill path in
@@ -4435,6 +4750,8 @@ static void dbg_dump_frame(void)
 void retro_run(void)
 {
    bool updated = false;
+   bool rewinding;
+   bool present_video, present_audio;
 
 #ifdef VJ_TRACE
    /* Stamp the frame number BEFORE the machine runs, so every event
@@ -4471,6 +4788,23 @@ void retro_run(void)
    if (environ_cb(RETRO_ENVIRONMENT_GET_VARIABLE_UPDATE, &updated) && updated)
       check_variables();
 
+   /* The advertised sample rate moved: the resampler option changed, or
+    * native-rate output follows a title that reprogrammed SCLK or SMODE
+    * last frame.  Only then -- SET_SYSTEM_AV_INFO makes frontends
+    * reinitialise their audio (and sometimes video) drivers. */
+   {
+      double rate = audio_resampler == DAC_RESAMPLER_NATIVE
+         ? DACGetI2SRate()
+         : (double)(vjs.hardwareTypeNTSC ? (BUFNTSC / 2) : (BUFPAL / 2))
+           * JaguarGetFieldRateHz();
+
+      if (audio_rate_advertised != 0.0 && rate != audio_rate_advertised)
+      {
+         retro_get_system_av_info(&g_av_info);
+         environ_cb(RETRO_ENVIRONMENT_SET_SYSTEM_AV_INFO, &g_av_info);
+      }
+   }
+
    /* Apply pending geometry change BEFORE rendering this frame.  TOM's
     * scanline renderer reads tomWidth (pixels per row) and screenPitch
     * (line stride) live; if tomWidth grew but screenPitch is stale, later
@@ -4573,12 +4907,54 @@ void retro_run(void)
 
    update_input();
 
+   /* Run-ahead and similar frontends run frames whose picture or sound
+    * they throw away.  Those still execute bit-identically -- OP, line
+    * buffer, DAC cursors and all -- but skip converting lines into the
+    * framebuffer, interpolating output samples and the per-frame
+    * presentation upkeep below.  A frontend that cannot say wants both. */
+   {
+      int av = 3;
+
+      if (!environ_cb(RETRO_ENVIRONMENT_GET_AUDIO_VIDEO_ENABLE, &av))
+         av = 3;
+      present_video = (av & 1) != 0;
+      present_audio = (av & 2) && !(av & 8);
+      TOMSetPresent(present_video);
+      DACSetAudioOutput(present_audio);
+   }
+
+   /* In-core rewind: while the button is held, put the machine back to the
+    * capture before the newest and run this frame from there only to have
+    * a picture to show.  Each held frame steps one capture further back;
+    * on release play resumes from where the last step landed.  The button
+    * is a Jaguar key too, so the pads read as idle while it is held.
+    * Run-ahead's look-ahead frames run on from where the real frame
+    * stepped to instead of stepping again. */
+   rewinding = false;
+   if (rewind_button >= 0
+       && input_state_cb(0, RETRO_DEVICE_JOYPAD, 0, (unsigned)rewind_button))
+   {
+      const uint8_t *prev = rewind_speculating ? NULL : RewindStepBack();
+
+      rewinding = true;
+      if (prev)
+      {
+         PERF_TIME_ENTER(PERF_T_STATE);
+         unserialize_state(prev, STATE_SIZE);
+         PERF_TIME_LEAVE();
+      }
+      memset(joypad0Buttons, 0, BUTTON_LAST + 1);
+      memset(joypad1Buttons, 0, BUTTON_LAST + 1);
+   }
+
    /* Hi-res: advance the shadow surface's frame epoch (no-op when off;
     * see shadowfb.h, design section 3.4). */
    ShadowHiresFrameTick();
 
    DACPrepareFrame(vjs.hardwareTypeNTSC == 1 ? BUFNTSC : BUFPAL);
    JaguarExecuteNew();
+   /* Threaded scanline conversion: everything below may read videoBuffer. */
+   TOMFlushScanlines();
    cheat_apply_all();
    SoundCallback(NULL, sampleBuffer, vjs.hardwareTypeNTSC == 1 ? BUFNTSC : BUFPAL);
 
@@ -4637,7 +5013,8 @@ void retro_run(void)
        * written == 0 (TOM addressed no rows at all) is the degenerate form
        * of the same thing; the coverage test already rejects it, but keep it
        * explicit so the intent survives a future tweak of the bounds. */
-      if (written > 0 && written < stock_height
+      if (present_video
+          && written > 0 && written < stock_height
           && stock_height - written <= MAX_BLANK_TAIL_ROWS
           && written * MIN_BLANK_COVERAGE_DEN
              >= stock_height * MIN_BLANK_COVERAGE_NUM)
@@ -4657,11 +5034,27 @@ void retro_run(void)
     * and video stall. Fires LOG_WRN/LOG_ERR via vj_log_cb so the
     * signature shows up in the RetroArch log without extra wiring.
     * Off-mode short-circuits in CrashDetectFrameTick, so the cost
-    * when disabled is one indirect function call per frame. */
-   CrashDetectFrameTick(videoBuffer, (unsigned)game_width, (unsigned)game_height);
+    * when disabled is one indirect function call per frame.  Hidden
+    * frames are skipped: their framebuffer was never drawn, so it would
+    * read as a video stall. */
+   if (present_video)
+      CrashDetectFrameTick(videoBuffer, (unsigned)game_width, (unsigned)game_height);
 
    video_cb(videoBuffer, game_width, game_height, game_width << 2);
 
+   /* Capture after the frame so the head is always the state play would
+    * resume from.  Not while rewinding, nor on run-ahead's look-ahead
+    * frames: those are thrown away. */
+   if (rewind_button >= 0 && !rewinding && !rewind_speculating
+       && ++rewind_countdown >= rewind_interval)
+   {
+      rewind_countdown = 0;
+      PERF_TIME_ENTER(PERF_T_STATE);
+      if (serialize_state(RewindCaptureBuffer(), STATE_SIZE, false))
+         RewindCommit();
+      PERF_TIME_LEAVE();
+   }
+
 #ifdef DEBUG_PRESENTATION
    if (dbg_frame_counter < 5
        || dbg_frame_counter == 60
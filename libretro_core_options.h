@@ -122,6 +122,11 @@ struct retro_core_option_v2_category option_cats_us[] = {
       "Timing",
       "Clock speed multipliers, then the experimental hardware-timing models."
    },
+   {
+      "performance",
+      "Performance",
+      "Host-side speedups. None of these change what the emulated console does; turn one off only to rule it out when reporting a bug."
+   },
    { NULL, NULL, NULL },
 };
 
@@ -303,6 +308,212 @@ struct retro_core_option_v2_definition option_defs_us[] = {
       },
       "disabled"
    },
+   {
+      "virtualjaguar_risc_decode_cache",
+      "RISC Decode Cache",
+      NULL,
+      "Keep a pre-decoded copy of the GPU and DSP local-RAM programs so each instruction is dispatched with one table lookup instead of a fetch-and-split. The copy is rewritten on every store, so self-modifying code and overlays behave exactly as without it.",
+      NULL,
+      "performance",
+      {
+         { "enabled",  NULL },
+         { "disabled", NULL },
+         { NULL, NULL },
+      },
+      "enabled"
+   },
+   {
+      "virtualjaguar_risc_superblocks",
+      "RISC Superblocks",
+      NULL,
+      "Run straight stretches of GPU and DSP register-only instructions as one unit, charging their cycles once instead of instruction by instruction. Timing and results are unchanged. Needs 'RISC Decode Cache'; has no effect while 'GPU Pipeline Timing' is on for the GPU.",
+      NULL,
+      "performance",
+      {
+         { "enabled",  NULL },
+         { "disabled", NULL },
+         { NULL, NULL },
+      },
+      "enabled"
+   },
+   {
+      "virtualjaguar_risc_idle_skip",
+      "RISC Idle-Loop Skip",
+      NULL,
+      "Recognise a GPU or DSP parked in a short polling loop whose state no longer changes and charge its remaining iterations in one step instead of running them. Results and timing are unchanged; the loop still sees every write and interrupt where it would have.",
+      NULL,
+      "performance",
+      {
+         { "enabled",  NULL },
+         { "disabled", NULL },
+         { NULL, NULL },
+      },
+      "enabled"
+   },
+   {
+      "virtualjaguar_op_list_index",
+      "Object List Index",
+      NULL,
+      "Remember each object's header phrase for the rest of the field so the Object Processor decides rejected objects and branches without re-reading them from RAM on every line. Any write into the list's memory drops the index; output and timing are unchanged.",
+      NULL,
+      "performance",
+      {
+         { "enabled",  NULL },
+         { "disabled", NULL },
+         { NULL, NULL },
+      },
+      "enabled"
+   },
+   {
+      "virtualjaguar_risc_dynarec",
+      "RISC Dynarec (x86-64)",
+      NULL,
+      "Translate hot GPU and DSP superblocks into native x86-64 code. Results and timing match the interpreter, which stays the default and the reference. Needs 'RISC Superblocks'; ignored on other host CPUs.",
+      NULL,
+      "performance",
+      {
+         { "disabled", NULL },
+         { "enabled",  NULL },
+         { NULL, NULL },
+      },
+      "disabled"
+   },
+   {
+      "virtualjaguar_dac_slice_cuts",
+      "Audio Output Slice Cuts",
+      NULL,
+      "Keep the DAC's timer event at every 48 kHz output step, which stops the 68000, GPU and DSP there as older versions of the core did. Audio is rendered once per frame either way. Disabling drops about 800 events per frame, but changes how the processors interleave, so timing-sensitive games may behave differently.",
+      NULL,
+      "performance",
+      {
+         { "disabled", NULL },
+         { "enabled",  NULL },
+         { NULL, NULL },
+      },
+      "enabled"
+   },
+   {
+      "virtualjaguar_state_delta",
+      "Incremental Savestates",
+      NULL,
+      "Speed up run-ahead and rewind by rewriting only the parts of the 2 MB work RAM that changed since the last savestate, when the frontend hands the core the same buffer again. Saved files are unchanged. Cheats applied by the frontend directly to RAM are not seen; leave off when using them.",
+      NULL,
+      "performance",
+      {
+         { "disabled", NULL },
+         { "enabled",  NULL },
+         { NULL, NULL },
+      },
+      "disabled"
+   },
+   {
+      "virtualjaguar_rewind",
+      "In-Core Rewind",
+      NULL,
+      "Keep a compressed rewind history inside the core and step back through it while the chosen controller 1 button is held; the button's keypad mapping is ignored while rewinding. Uses far less memory than the frontend's own rewind. Do not combine with run-ahead, the frontend's rewind or netplay.",
+      NULL,
+      "performance",
+      {
+         { "disabled", NULL },
+         { "l3",       "L3" },
+         { "r3",       "R3" },
+         { "l2",       "L2" },
+         { "r2",       "R2" },
+         { "select",   "Select" },
+         { NULL, NULL },
+      },
+      "disabled"
+   },
+   {
+      "virtualjaguar_rewind_interval",
+      "In-Core Rewind Granularity",
+      NULL,
+      "Frames between rewind captures. Larger steps rewind faster, hold more time in the same memory and cost less per frame.",
+      NULL,
+      "performance",
+      {
+         { "1", "1 frame" },
+         { "2", "2 frames" },
+         { "4", "4 frames" },
+         { "8", "8 frames" },
+         { NULL, NULL },
+      },
+      "2"
+   },
+   {
+      "virtualjaguar_rewind_budget",
+      "In-Core Rewind Memory",
+      NULL,
+      "Memory set aside for the rewind history. When it is full the oldest moments are forgotten first.",
+      NULL,
+      "performance",
+      {
+         { "32",  "32 MB" },
+         { "64",  "64 MB" },
+         { "128", "128 MB" },
+         { "256", "256 MB" },
+         { "512", "512 MB" },
+         { NULL, NULL },
+      },
+      "64"
+   },
+   {
+      "virtualjaguar_threaded_render",
+      "Threaded Scanline Conversion",
+      NULL,
+      "Convert each finished video line to the output picture on a second CPU core while emulation continues. The picture is identical; only worth it on devices with a spare core, mainly at higher internal resolutions. Ignored where the core is built without threads.",
+      NULL,
+      "performance",
+      {
+         { "disabled", NULL },
+         { "enabled",  NULL },
+         { NULL, NULL },
+      },
+      "disabled"
+   },
+   {
+      "virtualjaguar_threaded_dsp",
+      "Threaded DSP",
+      NULL,
+      "Run the DSP on a second CPU core alongside the 68000 and GPU. The DSP runs ahead until it needs main memory or the other processors touch it, then falls back to the usual order, so the result is identical. Helps sound-heavy titles on devices with a spare core; costs speed on a single core. Ignored where the core is built without threads.",
+      NULL,
+      "performance",
+      {
+         { "disabled", NULL },
+         { "enabled",  NULL },
+         { NULL, NULL },
+      },
+      "disabled"
+   },
+   {
+      "virtualjaguar_cd_read_ahead",
+      "CD Read-Ahead",
+      NULL,
+      "Read the disc image a few dozen sectors ahead of the drive on a background thread, so FMV and level loads do not wait on slow storage such as SD cards or network shares. The data read is identical. Ignored where the core is built without threads.",
+      NULL,
+      "performance",
+      {
+         { "enabled",  NULL },
+         { "disabled", NULL },
+         { NULL, NULL },
+      },
+      "enabled"
+   },
+   {
+      "virtualjaguar_audio_resampler",
+      "Audio Resampler",
+      NULL,
+      "How the Jaguar's sound output (whatever rate the game programs, typically 20-48 kHz) reaches the 48 kHz the core delivers. 'Linear' is the cheapest. 'Windowed Sinc' band-limits the output, removing the aliasing linear interpolation leaves in high-pitched sounds, for a little more CPU and ~0.3 ms more latency. 'Native Rate' skips resampling and hands the frontend the raw samples at the hardware rate; the frontend renegotiates its audio each time a game changes that rate.",
+      NULL,
+      "performance",
+      {
+         { "linear", "Linear" },
+         { "sinc",   "Windowed Sinc" },
+         { "native", "Native Rate" },
+         { NULL, NULL },
+      },
+      "linear"
+   },
    {
       "virtualjaguar_netlink",
       "Network Link",
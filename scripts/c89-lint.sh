@@ -28,6 +28,7 @@ skip_file() {
         # scalar ops and the arch header would redefine every one). They are
         # checked, with the right define and target, by check_simd_arch below.
         src/tom/blitter_simd_neon.c|src/tom/blitter_simd_sse2.c) return 0 ;;
+        src/core/simd_ops_neon.c|src/core/simd_ops_sse2.c) return 0 ;;
         # Depends on rcheevos headers fetched at runtime by the e2e shell wrapper.
         test/tools/test_rcheevos_e2e.c) return 0 ;;
         # Diagnostic tools — not part of the libretro core build.
@@ -59,7 +60,7 @@ CHECK_SIMD=0
 for f in $FILES; do
     [ -f "$f" ] || continue
     case "$f" in *.c) ;; *) continue ;; esac
-    case "$f" in src/tom/blitter.c|src/tom/blitter_simd_*.c) CHECK_SIMD=1 ;; esac
+    case "$f" in src/tom/blitter.c|src/tom/blitter_simd_*.c|src/core/simd_ops_*.c) CHECK_SIMD=1 ;; esac
     if skip_file "$f"; then continue; fi
 
     if ! $CC $CFLAGS $INCLUDES $DEFINES "$f" 2>&1; then
@@ -77,7 +78,8 @@ done
 # and x86 target, and the neon one on every ARM target.  A C99-ism in
 # either arch header would sail past the lint and break there instead.
 #
-# Re-check blitter.c (and the arch's own .c) once per arch, cross-
+# Re-check blitter.c (and the arch's own .c files, which also pull in
+# the line_simd, op_simd and dac_fir headers) once per arch, cross-
 # targeting when the host can't do it natively.  A host that can't
 # cross-target says so out loud rather than passing silently.
 check_simd_arch() {
@@ -103,7 +105,7 @@ check_simd_arch() {
     rm -f "$probe_c"
 
     arch_failed=0
-    for f in src/tom/blitter.c "src/tom/blitter_simd_$arch.c"; do
+    for f in src/tom/blitter.c "src/tom/blitter_simd_$arch.c" "src/core/simd_ops_$arch.c"; do
         [ -f "$f" ] || continue
         if ! $cc $CFLAGS $target $INCLUDES $DEFINES "-D$define" "$f" 2>&1; then
             echo "C89 lint: $arch pass failed on $f"
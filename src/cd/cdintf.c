@@ -22,6 +22,9 @@
 #include "cdintf.h"
 #include "jaguar.h"
 #include "log.h"
+#include "perf_counters.h"
+#include "perf_timing.h"
+#include "vjthread.h"
 
 #include <libchdr/chd.h>
 #include <libchdr/cdrom.h>
@@ -99,6 +102,8 @@ static void MSFFromLBA(uint32_t lba, uint8_t *m, uint8_t *s, uint8_t *f);
 static uint32_t LBAFromMSF(uint8_t m, uint8_t s, uint8_t f);
 static char *TrimWhitespace(char *str);
 static bool GetDirectoryFromPath(const char *path, char *dir, size_t dirSize);
+static void CDIntfReadAheadStart(void);
+static void CDIntfReadAheadStop(void);
 
 // The global disc state
 static struct CDIntfDisc disc;
@@ -127,6 +132,95 @@ uint32_t CDIntfLastVirtualPregapLBA(void)
    return lastVirtualPregapLBA;
 }
 
+/* Track lookup.  A sector belongs to the last track (in disc.tracks
+ * order) whose [startLBA, startLBA + lengthLBA) holds it; the readers
+ * used to find it with a scan from the last track down on every sector.
+ * CDIntfIndexTracks() resolves that rule once per image into runs of
+ * LBAs with a single owner, sorted by start, so a lookup is a binary
+ * search.  Each run's owner comes from the scan itself, run on the run's
+ * first LBA, so overlapping tracks resolve exactly as before. */
+#define CDINTF_MAX_RUNS (2 * CDINTF_MAX_TRACKS + 1)
+
+struct CDIntfTrackRun {
+   uint32_t start;               // First LBA of the run
+   int track;                    // Index into disc.tracks, -1 for none
+};
+
+static struct CDIntfTrackRun trackRuns[CDINTF_MAX_RUNS];
+static uint32_t numTrackRuns = 0;
+
+static int CDIntfScanTrack(uint32_t sector)
+{
+   int i;
+
+   for (i = (int)disc.numTracks - 1; i >= 0; i--)
+   {
+      uint32_t tStart = disc.tracks[i].startLBA;
+      uint32_t tEnd = tStart + disc.tracks[i].lengthLBA;
+      if (sector >= tStart && sector < tEnd)
+         return i;
+   }
+   return -1;
+}
+
+// Called once the image is parsed; the runs are read-only until it closes
+static void CDIntfIndexTracks(void)
+{
+   uint32_t bounds[CDINTF_MAX_RUNS];
+   uint32_t n = 0, i, j;
+
+   // Ownership can only change where a track starts or ends
+   bounds[n++] = 0;
+   for (i = 0; i < disc.numTracks; i++)
+   {
+      bounds[n++] = disc.tracks[i].startLBA;
+      bounds[n++] = disc.tracks[i].startLBA + disc.tracks[i].lengthLBA;
+   }
+
+   for (i = 1; i < n; i++)
+   {
+      uint32_t b = bounds[i];
+      for (j = i; j > 0 && bounds[j - 1] > b; j--)
+         bounds[j] = bounds[j - 1];
+      bounds[j] = b;
+   }
+
+   numTrackRuns = 0;
+   for (i = 0; i < n; i++)
+   {
+      int track;
+
+      if (i > 0 && bounds[i] == bounds[i - 1])
+         continue;
+      track = CDIntfScanTrack(bounds[i]);
+      if (numTrackRuns > 0 && trackRuns[numTrackRuns - 1].track == track)
+         continue;
+      trackRuns[numTrackRuns].start = bounds[i];
+      trackRuns[numTrackRuns].track = track;
+      numTrackRuns++;
+   }
+}
+
+// Index of the track holding sector, or -1 (gap, or no image)
+static int CDIntfFindTrack(uint32_t sector)
+{
+   uint32_t lo = 0, hi = numTrackRuns;
+
+   if (numTrackRuns == 0)
+      return -1;
+
+   // Last run starting at or before sector; run 0 starts at LBA 0
+   while (hi - lo > 1)
+   {
+      uint32_t mid = lo + (hi - lo) / 2;
+      if (trackRuns[mid].start <= sector)
+         lo = mid;
+      else
+         hi = mid;
+   }
+   return trackRuns[lo].track;
+}
+
 // Helper: convert LBA to MSF
 static void MSFFromLBA(uint32_t lba, uint8_t *m, uint8_t *s, uint8_t *f)
 {
@@ -606,7 +700,7 @@ static bool ParseCHD(const char *chdPath)
    return true;
 }
 
-static bool CDIntfReadBlockCHD(uint32_t sector, uint8_t *buffer)
+static bool CDIntfReadBlockCHD(uint32_t sector, uint8_t *buffer, int *pregap)
 {
    int i;
    struct CDIntfTrack *track;
@@ -619,33 +713,21 @@ static bool CDIntfReadBlockCHD(uint32_t sector, uint8_t *buffer)
    uint32_t b;
    uint8_t tmp;
 
-   track = NULL;
-   for (i = (int)disc.numTracks - 1; i >= 0; i--)
-   {
-      uint32_t tStart = disc.tracks[i].startLBA;
-      uint32_t tEnd = tStart + disc.tracks[i].lengthLBA;
-      if (sector >= tStart && sector < tEnd)
-      {
-         track = &disc.tracks[i];
-         break;
-      }
-   }
-
-   if (!track)
+   i = CDIntfFindTrack(sector);
+   if (i < 0)
    {
       memset(buffer, 0, 2352);
-      lastReadVirtualPregap = true;
-      lastVirtualPregapLBA = sector;
+      *pregap = 1;
       return true;
    }
 
-   lastReadVirtualPregap = false;
+   track = &disc.tracks[i];
+   *pregap = 0;
 
    if (chd_virtual_pregap[track->number - 1] && sector < track->dataLBA)
    {
       memset(buffer, 0, 2352);
-      lastReadVirtualPregap = true;
-      lastVirtualPregapLBA = sector;
+      *pregap = 1;
       return true;
    }
 
@@ -1668,9 +1750,9 @@ fail:
 }
 
 // Read a sector from a CDI file
-static bool CDIntfReadBlockCDI(uint32_t sector, uint8_t *buffer)
+static bool CDIntfReadBlockCDI(uint32_t sector, uint8_t *buffer, int *pregap)
 {
-   int i, trackIdx = -1;
+   int trackIdx;
    int64_t filePos;
    int64_t bytesRead;
    uint32_t sectorSize;
@@ -1678,26 +1760,15 @@ static bool CDIntfReadBlockCDI(uint32_t sector, uint8_t *buffer)
    if (!cdi_file)
       return false;
 
-   for (i = (int)disc.numTracks - 1; i >= 0; i--)
-   {
-      uint32_t tStart = disc.tracks[i].startLBA;
-      uint32_t tEnd = tStart + disc.tracks[i].lengthLBA;
-      if (sector >= tStart && sector < tEnd)
-      {
-         trackIdx = i;
-         break;
-      }
-   }
-
+   trackIdx = CDIntfFindTrack(sector);
    if (trackIdx < 0)
    {
       memset(buffer, 0, 2352);
-      lastReadVirtualPregap = true;
-      lastVirtualPregapLBA = sector;
+      *pregap = 1;
       return true;
    }
 
-   lastReadVirtualPregap = false;
+   *pregap = 0;
    sectorSize = disc.tracks[trackIdx].sectorSize;
    if (sectorSize == 0) sectorSize = 2352;
 
@@ -1732,7 +1803,7 @@ static bool CDIntfReadBlockCDI(uint32_t sector, uint8_t *buffer)
    return true;
 }
 
-bool CDIntfOpenImage(const char *path)
+static bool CDIntfParseImage(const char *path)
 {
    const char *ext;
    CDIntfCloseImage();
@@ -1782,8 +1853,22 @@ bool CDIntfOpenImage(const char *path)
    return true;
 }
 
+bool CDIntfOpenImage(const char *path)
+{
+   if (!CDIntfParseImage(path))
+      return false;
+
+   CDIntfIndexTracks();
+   CDIntfReadAheadStart();
+   return true;
+}
+
 void CDIntfCloseImage(void)
 {
+   // The worker reads through the handles closed below
+   CDIntfReadAheadStop();
+   numTrackRuns = 0;
+
    CDIntfCloseCHD();
    bootStubEndLBA = 0;
 
@@ -1833,8 +1918,10 @@ void CDIntfDone(void)
 }
 
 // Read a raw 2352-byte sector from the disc image
-// sector is an absolute LBA (from the start of the disc)
-bool CDIntfReadBlock(uint32_t sector, uint8_t *buffer)
+// sector is an absolute LBA (from the start of the disc).  *pregap is set
+// to 1 for synthesized silence and 0 for a sector some track owns; it is
+// left alone when the read fails before the track is known.
+static bool CDIntfReadBlockImage(uint32_t sector, uint8_t *buffer, int *pregap)
 {
    int i;
    int64_t filePos;
@@ -1846,35 +1933,25 @@ bool CDIntfReadBlock(uint32_t sector, uint8_t *buffer)
       return false;
 
    if (cdi_file)
-      return CDIntfReadBlockCDI(sector, buffer);
+      return CDIntfReadBlockCDI(sector, buffer, pregap);
 
    if (chd)
-      return CDIntfReadBlockCHD(sector, buffer);
+      return CDIntfReadBlockCHD(sector, buffer, pregap);
 
    // Find which track contains this sector. A sector belongs to a track only
    // if it falls within [startLBA, startLBA + lengthLBA). Sectors in the
    // inter-session gap belong to no track and are returned as silence.
-   for (i = (int)disc.numTracks - 1; i >= 0; i--)
-   {
-      uint32_t tStart = disc.tracks[i].startLBA;
-      uint32_t tEnd = tStart + disc.tracks[i].lengthLBA;
-      if (sector >= tStart && sector < tEnd)
-      {
-         track = &disc.tracks[i];
-         break;
-      }
-   }
-
-   if (!track)
+   i = CDIntfFindTrack(sector);
+   if (i < 0)
    {
       // True inter-session gap. Return silence; tracks lookup will fall through.
       memset(buffer, 0, 2352);
-      lastReadVirtualPregap = true;
-      lastVirtualPregapLBA = sector;
+      *pregap = 1;
       return true;
    }
 
-   lastReadVirtualPregap = false;
+   track = &disc.tracks[i];
+   *pregap = 0;
 
    sectorSize = track->sectorSize;
    if (sectorSize == 0)
@@ -1947,6 +2024,327 @@ bool CDIntfReadBlock(uint32_t sector, uint8_t *buffer)
    return true;
 }
 
+/* Sector read-ahead (virtualjaguar_cd_read_ahead).  Every sector the
+ * drive, the SSI audio head or an HLE CD_read streams used to be an
+ * rfseek + rfread on the emulation thread at the moment it was needed;
+ * on SD cards and network mounts one of those can take longer than a
+ * frame.  With read-ahead on, a worker thread keeps the sectors just
+ * ahead of each read cursor in a direct-mapped cache, and a read the
+ * worker got to first is a memcpy.
+ *
+ * cdrom.c reads through two independent heads (block for the BUTCH
+ * FIFO, ssiBlock for the I2S feed) and an HLE CD_read adds a third, so
+ * the cache follows up to READ_AHEAD_STREAMS cursors.  A read at or up
+ * to READ_AHEAD_SECTORS past a stream's next sector moves that stream
+ * on; any other read is a seek and takes over the stream read least
+ * recently.  CDIntfPrefetch() opens a stream ahead of its first read.
+ * Neither thread evicts a sector another stream still wants, so two
+ * windows that share slots cannot keep the worker re-reading them.
+ *
+ * A slot holds exactly what CDIntfReadBlockImage() returned: the bytes
+ * and the pregap flag.  Failed reads are kept only so the worker stops
+ * retrying them; the emulation thread reads those itself, so failures
+ * behave as before.  All image I/O, from either thread, runs under
+ * readAheadIO: the file handles, the CHD hunk buffer and the multi-file
+ * handle cache are shared.  The worker starts once an image is open and
+ * CDIntfCloseImage() joins it before closing anything.  Where threads
+ * are unavailable (vjthread.h) it never starts and every read goes to
+ * the image as before. */
+#define READ_AHEAD_SLOTS   256           // Direct-mapped by LBA, ~600 KB
+#define READ_AHEAD_SECTORS 32            // Kept ahead of each stream
+#define READ_AHEAD_STREAMS 4
+
+struct CDIntfReadAheadSlot {
+   uint32_t lba;
+   bool valid;
+   bool failed;                  // Read failed; not served from here
+   bool pregap;                  // Synthesized silence (see CDIntfReadBlock)
+   uint8_t data[2352];
+};
+
+struct CDIntfReadAheadStream {
+   uint32_t next;                // First sector not read yet
+   uint32_t used;                // readAheadClock at the last read
+   bool active;
+};
+
+static bool readAheadEnabled = true;
+static struct CDIntfReadAheadSlot *readAheadSlots = NULL;
+static struct CDIntfReadAheadStream readAheadStreams[READ_AHEAD_STREAMS];
+static uint32_t readAheadClock = 0;
+static vj_thread *readAheadWorker = NULL;
+static vj_lock *readAheadLock = NULL;    // Slots, streams, readAheadQuit
+static vj_lock *readAheadIO = NULL;      // Image I/O; taken before readAheadLock
+static bool readAheadQuit = false;
+static uint64_t readAheadHits = 0;
+static uint64_t readAheadMisses = 0;
+
+PERF_COUNTER(cd_read_ahead_hits);
+PERF_COUNTER(cd_read_ahead_misses);
+
+// True if some stream's window still wants lba.  Lock held.
+static bool CDIntfReadAheadWanted(uint32_t lba)
+{
+   int s;
+
+   for (s = 0; s < READ_AHEAD_STREAMS; s++)
+   {
+      const struct CDIntfReadAheadStream *st = &readAheadStreams[s];
+      if (st->active && lba - st->next < READ_AHEAD_SECTORS)
+         return true;
+   }
+   return false;
+}
+
+// Point the stream that next continues at next.  Lock held.
+static void CDIntfReadAheadFollow(uint32_t next)
+{
+   int s, i;
+
+   readAheadClock++;
+   for (s = 0; s < READ_AHEAD_STREAMS; s++)
+      if (readAheadStreams[s].active
+            && next - readAheadStreams[s].next <= READ_AHEAD_SECTORS)
+         break;
+
+   if (s == READ_AHEAD_STREAMS)
+   {
+      // A seek: reuse an idle stream, else the one read least recently
+      s = 0;
+      for (i = 1; i < READ_AHEAD_STREAMS; i++)
+         if (!readAheadStreams[i].active
+               || (readAheadStreams[s].active
+                  && readAheadClock - readAheadStreams[i].used
+                     > readAheadClock - readAheadStreams[s].used))
+            s = i;
+   }
+
+   readAheadStreams[s].next = next;
+   readAheadStreams[s].used = readAheadClock;
+   readAheadStreams[s].active = true;
+}
+
+// Copy sector out of the cache if a good read of it is there.  Lock held.
+static bool CDIntfReadAheadTake(uint32_t sector, uint8_t *buffer, int *pregap)
+{
+   const struct CDIntfReadAheadSlot *slot =
+      &readAheadSlots[sector % READ_AHEAD_SLOTS];
+
+   if (!slot->valid || slot->lba != sector || slot->failed)
+      return false;
+   memcpy(buffer, slot->data, 2352);
+   *pregap = slot->pregap ? 1 : 0;
+   return true;
+}
+
+// Keep a read, unless its slot holds a sector a stream wants.  Lock held.
+static void CDIntfReadAheadStore(uint32_t lba, const uint8_t *buffer,
+                                 bool ok, int pregap)
+{
+   struct CDIntfReadAheadSlot *slot = &readAheadSlots[lba % READ_AHEAD_SLOTS];
+
+   if (slot->valid && slot->lba != lba && CDIntfReadAheadWanted(slot->lba))
+      return;
+   slot->lba = lba;
+   slot->valid = true;
+   slot->failed = !ok;
+   slot->pregap = (pregap == 1);
+   if (ok)
+      memcpy(slot->data, buffer, 2352);
+}
+
+// The nearest sector a stream wants that is not cached yet.  Lock held.
+static bool CDIntfReadAheadPick(uint32_t *lba)
+{
+   uint32_t k;
+   int s;
+
+   for (k = 0; k < READ_AHEAD_SECTORS; k++)
+      for (s = 0; s < READ_AHEAD_STREAMS; s++)
+      {
+         const struct CDIntfReadAheadSlot *slot;
+         uint32_t want = readAheadStreams[s].next + k;
+
+         if (!readAheadStreams[s].active)
+            continue;
+         slot = &readAheadSlots[want % READ_AHEAD_SLOTS];
+         if (slot->valid && (slot->lba == want || CDIntfReadAheadWanted(slot->lba)))
+            continue;
+         *lba = want;
+         return true;
+      }
+   return false;
+}
+
+static void CDIntfReadAheadRun(void *arg)
+{
+   uint8_t buffer[2352];
+
+   (void)arg;
+
+   VJLock(readAheadLock);
+   for (;;)
+   {
+      uint32_t lba;
+      int pregap = 0;
+      bool ok;
+
+      while (!readAheadQuit && !CDIntfReadAheadPick(&lba))
+         VJLockWait(readAheadLock);
+      if (readAheadQuit)
+         break;
+      VJUnlock(readAheadLock);
+
+      VJLock(readAheadIO);
+      ok = CDIntfReadBlockImage(lba, buffer, &pregap);
+      VJLock(readAheadLock);
+      VJUnlock(readAheadIO);
+      CDIntfReadAheadStore(lba, buffer, ok, pregap);
+   }
+   VJUnlock(readAheadLock);
+}
+
+static bool CDIntfReadAheadRead(uint32_t sector, uint8_t *buffer, int *pregap)
+{
+   bool hit;
+   bool ok = false;
+
+   VJLock(readAheadLock);
+   CDIntfReadAheadFollow(sector + 1);
+   hit = CDIntfReadAheadTake(sector, buffer, pregap);
+   VJLockSignal(readAheadLock);
+   VJUnlock(readAheadLock);
+
+   if (!hit)
+   {
+      /* The worker may be reading this very sector: once the I/O lock
+       * is free, look again before going to the image. */
+      VJLock(readAheadIO);
+      VJLock(readAheadLock);
+      hit = CDIntfReadAheadTake(sector, buffer, pregap);
+      VJUnlock(readAheadLock);
+      if (!hit)
+      {
+         ok = CDIntfReadBlockImage(sector, buffer, pregap);
+         if (ok)
+         {
+            VJLock(readAheadLock);
+            CDIntfReadAheadStore(sector, buffer, ok, *pregap);
+            VJUnlock(readAheadLock);
+         }
+      }
+      VJUnlock(readAheadIO);
+   }
+
+   if (hit)
+   {
+      readAheadHits++;
+      PERF_INC(cd_read_ahead_hits);
+      return true;
+   }
+   readAheadMisses++;
+   PERF_INC(cd_read_ahead_misses);
+   return ok;
+}
+
+static void CDIntfReadAheadStart(void)
+{
+   static bool warned = false;
+
+   if (readAheadWorker || !readAheadEnabled || !disc.loaded)
+      return;
+
+   readAheadSlots = (struct CDIntfReadAheadSlot *)calloc(READ_AHEAD_SLOTS,
+         sizeof(*readAheadSlots));
+   readAheadLock = VJLockNew();
+   readAheadIO = VJLockNew();
+   memset(readAheadStreams, 0, sizeof(readAheadStreams));
+   readAheadQuit = false;
+   if (readAheadSlots && readAheadLock && readAheadIO)
+      readAheadWorker = VJThreadStart(CDIntfReadAheadRun, NULL);
+   if (!readAheadWorker)
+   {
+      if (!warned)
+      {
+         LOG_WRN("[CD] no read-ahead thread in this build; reading sectors inline\n");
+         warned = true;
+      }
+      free(readAheadSlots);
+      VJLockFree(readAheadLock);
+      VJLockFree(readAheadIO);
+      readAheadSlots = NULL;
+      readAheadLock = NULL;
+      readAheadIO = NULL;
+   }
+}
+
+static void CDIntfReadAheadStop(void)
+{
+   if (!readAheadWorker)
+      return;
+
+   VJLock(readAheadLock);
+   readAheadQuit = true;
+   VJLockSignal(readAheadLock);
+   VJUnlock(readAheadLock);
+   VJThreadJoin(readAheadWorker);
+   VJLockFree(readAheadLock);
+   VJLockFree(readAheadIO);
+   free(readAheadSlots);
+   readAheadWorker = NULL;
+   readAheadLock = NULL;
+   readAheadIO = NULL;
+   readAheadSlots = NULL;
+}
+
+void CDIntfSetReadAhead(bool enabled)
+{
+   readAheadEnabled = enabled;
+   if (enabled)
+      CDIntfReadAheadStart();
+   else
+      CDIntfReadAheadStop();
+}
+
+void CDIntfPrefetch(uint32_t sector)
+{
+   if (!readAheadWorker)
+      return;
+
+   VJLock(readAheadLock);
+   CDIntfReadAheadFollow(sector);
+   VJLockSignal(readAheadLock);
+   VJUnlock(readAheadLock);
+}
+
+void CDIntfReadAheadStats(uint64_t *hits, uint64_t *misses)
+{
+   if (hits)
+      *hits = readAheadHits;
+   if (misses)
+      *misses = readAheadMisses;
+}
+
+bool CDIntfReadBlock(uint32_t sector, uint8_t *buffer)
+{
+   bool ok;
+   int pregap = -1;
+
+   PERF_TIME_ENTER(PERF_T_CD);
+   if (readAheadWorker && buffer)
+      ok = CDIntfReadAheadRead(sector, buffer, &pregap);
+   else
+      ok = CDIntfReadBlockImage(sector, buffer, &pregap);
+   if (pregap >= 0)
+   {
+      lastReadVirtualPregap = (pregap != 0);
+      if (pregap)
+         lastVirtualPregapLBA = sector;
+   }
+   PERF_TIME_LEAVE();
+   return ok;
+}
+
 uint32_t CDIntfGetNumSessions(void)
 {
    if (!disc.loaded)
@@ -2009,23 +2407,15 @@ bool CDIntfGetQPosition(uint32_t lba, uint32_t *trackNum, uint32_t *idx,
                         uint32_t *relLBA, bool *isData)
 {
    int i;
-   struct CDIntfTrack *track = NULL;
+   struct CDIntfTrack *track;
 
    if (!disc.loaded)
       return false;
 
-   for (i = (int)disc.numTracks - 1; i >= 0; i--)
-   {
-      uint32_t tStart = disc.tracks[i].startLBA;
-      uint32_t tEnd = tStart + disc.tracks[i].lengthLBA;
-      if (lba >= tStart && lba < tEnd)
-      {
-         track = &disc.tracks[i];
-         break;
-      }
-   }
-   if (!track)
+   i = CDIntfFindTrack(lba);
+   if (i < 0)
       return false;
+   track = &disc.tracks[i];
 
    if (trackNum)
       *trackNum = track->number;
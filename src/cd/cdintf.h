@@ -121,6 +121,16 @@ bool CDIntfOpenImage(const char *cuePath);
 void CDIntfCloseImage(void);
 bool CDIntfIsImageLoaded(void);
 
+/* Sector read-ahead: while an image is open, a worker thread reads the
+ * sectors just ahead of each read cursor into a cache (on by default;
+ * no-op where the core is built without threads).  Reads return the same
+ * bytes either way.  CDIntfPrefetch() tells it where a read is about to
+ * start.  Stats count reads served from the cache (hits) and from the
+ * image (misses) while it runs. */
+void CDIntfSetReadAhead(bool enabled);
+void CDIntfPrefetch(uint32_t sector);
+void CDIntfReadAheadStats(uint64_t *hits, uint64_t *misses);
+
 /* Extract the game boot stub from the start of session 2.
  * Reads the first ~12 sectors of the first session-2 track, undoes the
  * I2S word-swap, validates the universal-header magic, and returns the
@@ -15,6 +15,7 @@
 #include "jaguar.h"
 #include "log.h"
 #include "settings.h"
+#include "state_delta.h"
 #include "vjag_memory.h"
 #include "m68000/m68kinterface.h"
 
@@ -34,6 +35,12 @@ static void bios_reset(void)
     cdBootStubInjected = false;
 }
 
+static void bios_register_hooks(void)
+{
+    M68KHookRegister(0x005E40);
+    M68KHookRegister(0x050176);
+}
+
 static bool bios_instruction_hook(uint32_t m68kPC)
 {
     /* GPU auth magic — boot ROM checks this to verify GPU ran auth code.
@@ -65,6 +72,8 @@ static bool bios_instruction_hook(uint32_t m68kPC)
             if (CDIntfExtractBootStub(stub, sizeof(stub), &loadAddr, &length))
             {
                 uint32_t i;
+                /* Stub, trampoline and TOC below all bypass the bus. */
+                StateDeltaMarkAll();
                 for (i = 0; i < length && (loadAddr + i) < 0x200000; i++)
                     jaguarMainRAM[loadAddr + i] = stub[i];
                 LOG_INF("[CD-BOOTSTUB] Injected $%X bytes at $%06X\n",
@@ -232,5 +241,6 @@ const CDBootStrategy cd_boot_strategy_bios = {
     "bios",
     bios_boot,
     bios_instruction_hook,
+    bios_register_hooks,
     bios_reset
 };
@@ -14,6 +14,9 @@ typedef struct CDBootStrategy {
     const char *name;
     bool (*boot)(const struct retro_game_info *info);
     bool (*instruction_hook)(uint32_t pc);
+    /* Declare every PC instruction_hook may trap (M68KHookRegister);
+     * called from M68KHookRebuild() at each reset. */
+    void (*register_hooks)(void);
     void (*reset)(void);
 } CDBootStrategy;
 
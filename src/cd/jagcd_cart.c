@@ -87,6 +87,10 @@ static bool cart_instruction_hook(uint32_t pc)
     return false;
 }
 
+static void cart_register_hooks(void)
+{
+}
+
 static void cart_reset(void)
 {
 }
@@ -95,5 +99,6 @@ const CDBootStrategy cd_boot_strategy_cart = {
     "cart",
     cart_boot,
     cart_instruction_hook,
+    cart_register_hooks,
     cart_reset
 };
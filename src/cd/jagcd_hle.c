@@ -21,6 +21,7 @@
 #include "cdrom.h"
 #include "log.h"
 #include "settings.h"
+#include "state_delta.h"
 #include "vjag_memory.h"
 #include "gpu.h"
 #include "dsp.h"
@@ -232,6 +233,7 @@ static void HLEPopulateTOC(uint32_t addr)
    base = addr;
 
    memset(&jaguarMainRAM[base], 0, 0x400);
+   StateDeltaMarkRange(base, 0x400);
 
    /* Track-INDEXED layout, matching the real CD BIOS's 68K-side TOC
     * builder ($808BE8, a 68K routine in the BIOS ROM that reads BUTCH DSA
@@ -290,6 +292,7 @@ static void HLEPopulateTOC(uint32_t addr)
 static void HLEInstallJumpTable(void)
 {
    uint32_t i;
+   StateDeltaMarkRange(BIOS_JUMPTABLE_BASE, BIOS_JUMPTABLE_SIZE);
    for (i = 0; i < BIOS_JUMPTABLE_SIZE; i += 2)
    {
       jaguarMainRAM[BIOS_JUMPTABLE_BASE + i + 0] = 0x4E;
@@ -944,6 +947,7 @@ static void HLEHandleCDRead(void)
          for (i = 0; i < ((byteCount + 3u) & ~3u) &&
                      (destAddr + i) < 0x200000; i++)
             jaguarMainRAM[destAddr + i] = 0;
+         StateDeltaMarkRange(destAddr, i);
          scanLBA = lba;
          scanOff = 0;
          /* Skip the sector copy loop — dest is already zeroed */
@@ -1000,6 +1004,9 @@ hle_cd_read_post_scan:
    hleStream.lba      = scanLBA;
    hleStream.bufOff   = scanOff;
    hleStream.bufValid = false;
+   /* The first sector is read on a later tick, after the modelled seek;
+    * have the read-ahead start on it now. */
+   CDIntfPrefetch(scanLBA);
    hleStream.dest     = destAddr;
    /* Deliver whole longwords, exactly like the real GPU CD ISR: it
     * writes 4 bytes per store and stops only when the write pointer
@@ -1122,6 +1129,7 @@ static void HLEStreamFinish(void)
       if (padEnd <= 0x200000)
       {
          uint32_t p;
+         StateDeltaMarkRange(destAddr + byteCount, 8);
          for (p = destAddr + byteCount; p < padEnd; p++)
             jaguarMainRAM[p] = 0xFF;
       }
@@ -1153,6 +1161,7 @@ static void HLEStreamFinish(void)
        * ($200000-$7FFFFF) between RAM and cart space. */
       if (syncAddr + 64 <= 0x200000)
       {
+         StateDeltaMarkRange(syncAddr, 64);
          for (p = 0; p < 16; p++)
             SET32(jaguarMainRAM, syncAddr + p * 4, atri);
       }
@@ -1324,6 +1333,7 @@ void JaguarCDHLEStreamTick(void)
       dst = hleStream.dest + hleStream.written;
       for (i = 0; i < chunk && (dst + i) < 0x200000; i++)
          jaguarMainRAM[dst + i] = hleStream.buf[hleStream.bufOff + i];
+      StateDeltaMarkRange(dst, i);
 
       hleStream.written += chunk;
       hleStream.bufOff  += chunk;
@@ -1443,6 +1453,7 @@ static void HLEHandleCDPoll(void)
       hle_gpu_data_base = 0xF03B00;
       GPUWriteLong(hle_gpu_data_base + 0, hle_read_end_addr + 28, 0);
       GPUWriteLong(hle_gpu_data_base + 4, hle_read_end_addr, 0);
+      StateDeltaMark(0x3074, 4);
       SET32(jaguarMainRAM, 0x3074, hle_gpu_data_base);
       a0_val = hle_read_end_addr + 28;
       a1_val = 0;
@@ -1490,6 +1501,7 @@ static void HLESetDsaStatus(uint8_t respClass)
    uint32_t d0 = m68k_get_reg(NULL, M68K_REG_D0);
    if ((d0 & 0xFFFF) == 0)
       return;   /* no-wait call: BIOS leaves $3E00 untouched */
+   StateDeltaMark(CD_BIOS_DSA_STATUS_ADDR, 2);
    SET16(jaguarMainRAM, CD_BIOS_DSA_STATUS_ADDR,
          (respClass == 0x04) ? 0 : 1);
 }
@@ -1528,6 +1540,8 @@ static void HLEHandleISRSetup(uint8_t mode)
 
    hle_gpu_data_base = a0;
 
+   StateDeltaMarkRange(0x3072, 6);
+
    /* $3072: ISR mode flag */
    jaguarMainRAM[0x3072] = mode;
    jaguarMainRAM[0x3073] = 0x00;
@@ -1615,6 +1629,7 @@ static void HLEParkOnHalt(void)
    SET32(jaguarMainRAM, 4, 0x00000400);
    jaguarMainRAM[0x400] = 0x60;
    jaguarMainRAM[0x401] = 0xFE;
+   StateDeltaMarkAll();
    m68k_set_reg(M68K_REG_SP, 0x00200000);
    m68k_set_reg(M68K_REG_PC, 0x00000400);
    LOG_WRN("[CD-HLE] Parked 68K on halt loop at $00000400\n");
@@ -1729,6 +1744,7 @@ bool JaguarCDHLEBoot(void)
    SET32(jaguarMainRAM, 4, loadAddr);
    m68k_set_reg(M68K_REG_SP, 0x00200000);
    m68k_set_reg(M68K_REG_PC, loadAddr);
+   StateDeltaMarkAll();
 
    hle_active = true;
 
@@ -1885,6 +1901,12 @@ static bool hle_strategy_instruction_hook(uint32_t pc)
    return false;
 }
 
+static void hle_strategy_register_hooks(void)
+{
+   M68KHookRegisterRange(BIOS_JUMPTABLE_BASE, 0x00306C);
+   M68KHookRegisterRange(0x800000, 0xE00000);
+}
+
 static void hle_strategy_reset(void)
 {
    hle_active        = false;
@@ -1901,5 +1923,6 @@ const CDBootStrategy cd_boot_strategy_hle = {
    "hle",
    hle_strategy_boot,
    hle_strategy_instruction_hook,
+   hle_strategy_register_hooks,
    hle_strategy_reset
 };
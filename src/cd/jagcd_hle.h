@@ -14,9 +14,9 @@ extern "C" {
  * Returns true if HLE boot was set up successfully. */
 bool JaguarCDHLEBoot(void);
 
-/* Called from M68KInstructionHook for every instruction.
- * Intercepts BIOS jump table calls (CD_read, etc.) and handles
- * them entirely in C.
+/* Called from the HLE strategy's instruction hook for the jump-table PCs
+ * it registers with M68KHookRegister.  Intercepts BIOS jump table calls
+ * (CD_read, etc.) and handles them entirely in C.
  * Returns true if the PC was handled (caller should skip other hooks). */
 bool JaguarCDHLEHook(uint32_t pc);
 
@@ -26,232 +26,324 @@
 
 // NOTE ABOUT TIMING SYSTEM DATA STRUCTURES:
 
-// A queue won't work for this system because we can't guarantee that an event will go
-// in with a time that is later than the ones already queued up. So we just use a simple
-// list.
-
-// Although if we used an insertion sort we could, but it wouldn't work for adjusting
-// times... (For that, you would have to remove the event then reinsert it.)
+// Each domain (EVENT_MAIN, EVENT_JERRY) keeps its own absolute clock and a
+// binary min-heap of pending events keyed on absolute due time, both counted
+// in event ticks (1 << EVENT_TICK_SHIFT per RISC cycle, see event.h).  Time
+// passing is then a single add to the domain clock instead of a subtraction
+// from every slot, the next event is always the heap root, and the slice
+// length between two events comes out of the clock as an exact cycle count.
+//
+// Callers still talk microseconds; those are converted to ticks once, on the
+// way in (SetCallbackTime/AdjustCallbackTime/SubtractEventTimes) and out
+// (GetTimeToNextEvent).
+//
+// The original implementation was an unordered 32-slot list scanned with a
+// strict <, so of two events due at the same time the one in the lower slot
+// fired first, and a new event took the lowest free slot.  Every event still
+// carries that slot number: it breaks ties in the heap so dispatch order is
+// unchanged, and it is where the event goes in the savestate, whose layout is
+// the old list's.
 
 struct Event
 {
-	bool valid;
-	int eventType;
-	double eventTime;
-	void (* timerCallback)(void);
+   uint64_t eventTime;                 // Absolute due time, in ticks
+   int eventType;
+   uint8_t slot;                       // Position in the legacy list
+   void (* timerCallback)(void);
 };
 
-static struct Event eventList[EVENT_LIST_SIZE];
-static struct Event eventListJERRY[EVENT_LIST_SIZE];
-static uint32_t nextEvent;
-static uint32_t nextEventJERRY;
-static uint32_t numberOfEvents;
+struct EventQueue
+{
+   struct Event heap[EVENT_LIST_SIZE];
+   uint32_t count;
+   uint32_t slotsUsed;                 // Bit n set = legacy slot n taken
+   uint64_t now;                       // Domain clock, in ticks
+};
+
+static struct EventQueue eventQueue[2];   // Indexed by EVENT_MAIN/EVENT_JERRY
+
+static double eventTicksPerUsec = (double)EVENT_TICKS_PER_RISC_CYCLE / RISC_CYCLE_IN_USEC;
+static double eventUsecPerTick  = RISC_CYCLE_IN_USEC / (double)EVENT_TICKS_PER_RISC_CYCLE;
 
 
-static double ClampDueEventTime(double time)
+static struct EventQueue * QueueFor(int type)
 {
-   return (time < 0.0 ? 0.0 : time);
+   return &eventQueue[type == EVENT_MAIN ? EVENT_MAIN : EVENT_JERRY];
 }
 
 
-void InitializeEventList(void)
+// Negative delays mean "due now", as they always have.
+static uint64_t UsecToTicks(double time)
 {
-   unsigned i;
-   for(i = 0; i < EVENT_LIST_SIZE; i++)
+   return (time <= 0.0 ? 0 : (uint64_t)(time * eventTicksPerUsec + 0.5));
+}
+
+
+static bool EventBefore(const struct Event * a, const struct Event * b)
+{
+   return (a->eventTime < b->eventTime
+      || (a->eventTime == b->eventTime && a->slot < b->slot));
+}
+
+
+static void SiftUp(struct EventQueue * q, uint32_t i)
+{
+   struct Event e = q->heap[i];
+
+   while (i > 0)
    {
-      eventList[i].valid = false;
-      eventList[i].eventTime = 0.0;
-      eventListJERRY[i].valid = false;
-      eventListJERRY[i].eventTime = 0.0;
+      uint32_t parent = (i - 1) >> 1;
+
+      if (!EventBefore(&e, &q->heap[parent]))
+         break;
+
+      q->heap[i] = q->heap[parent];
+      i = parent;
    }
 
-   numberOfEvents = 0;
+   q->heap[i] = e;
 }
 
 
-// Set callback time in µs. This is fairly arbitrary, but works well enough for our purposes.
-//We just slap the next event into the list in the first available slot, no checking, no nada...
-void SetCallbackTime(void (* callback)(void), double time, int type/*= EVENT_MAIN*/)
+static void SiftDown(struct EventQueue * q, uint32_t i)
 {
-   unsigned i;
-   time = ClampDueEventTime(time);
+   struct Event e = q->heap[i];
 
-   if (type == EVENT_MAIN)
+   for(;;)
    {
-      for(i = 0; i < EVENT_LIST_SIZE; i++)
-      {
-         if (!eventList[i].valid)
-         {
-            eventList[i].timerCallback = callback;
-            eventList[i].eventTime = time;
-            eventList[i].eventType = type;
-            eventList[i].valid = true;
-            numberOfEvents++;
+      uint32_t child = (i << 1) + 1;
 
-            return;
-         }
-      }
+      if (child >= q->count)
+         break;
+
+      if (child + 1 < q->count && EventBefore(&q->heap[child + 1], &q->heap[child]))
+         child++;
+
+      if (!EventBefore(&q->heap[child], &e))
+         break;
+
+      q->heap[i] = q->heap[child];
+      i = child;
    }
-   else
+
+   q->heap[i] = e;
+}
+
+
+static void RemoveAt(struct EventQueue * q, uint32_t i)
+{
+   q->slotsUsed &= ~(1u << q->heap[i].slot);
+   q->count--;
+
+   if (i == q->count)
+      return;
+
+   q->heap[i] = q->heap[q->count];
+   SiftUp(q, i);
+   SiftDown(q, i);
+}
+
+
+static void Insert(struct EventQueue * q, void (* callback)(void), uint64_t when, int type, uint8_t slot)
+{
+   struct Event * e = &q->heap[q->count];
+
+   e->eventTime = when;
+   e->eventType = type;
+   e->slot = slot;
+   e->timerCallback = callback;
+   q->slotsUsed |= 1u << slot;
+   SiftUp(q, q->count++);
+}
+
+
+// The pending event for callback in the lowest legacy slot, MAIN before JERRY
+// on a tie -- the entry the old slot-by-slot search found first.
+static bool FindCallback(void (* callback)(void), struct EventQueue ** queue, uint32_t * index)
+{
+   unsigned best = EVENT_LIST_SIZE;
+   unsigned d;
+   uint32_t i;
+
+   for(d = 0; d < 2; d++)
    {
-      for(i = 0; i < EVENT_LIST_SIZE; i++)
+      struct EventQueue * q = &eventQueue[d];
+
+      for(i = 0; i < q->count; i++)
       {
-         if (!eventListJERRY[i].valid)
+         if (q->heap[i].timerCallback == callback && q->heap[i].slot < best)
          {
-            /* Found callback slot */
-            eventListJERRY[i].timerCallback = callback;
-            eventListJERRY[i].eventTime = time;
-            eventListJERRY[i].eventType = type;
-            eventListJERRY[i].valid = true;
-            numberOfEvents++;
-
-            return;
+            best = q->heap[i].slot;
+            *queue = q;
+            *index = i;
          }
       }
    }
+
+   return (best < EVENT_LIST_SIZE);
 }
 
 
-void RemoveCallback(void (* callback)(void))
+void InitializeEventList(void)
 {
-   unsigned i;
+   unsigned d;
 
-   for (i = 0; i < EVENT_LIST_SIZE; i++)
+   for(d = 0; d < 2; d++)
    {
-      if (eventList[i].valid && eventList[i].timerCallback == callback)
-      {
-         eventList[i].valid = false;
-         numberOfEvents--;
+      eventQueue[d].count = 0;
+      eventQueue[d].slotsUsed = 0;
+      eventQueue[d].now = 0;
+   }
+}
 
-         return;
-      }
-      else if (eventListJERRY[i].valid && eventListJERRY[i].timerCallback == callback)
-      {
-         eventListJERRY[i].valid = false;
-         numberOfEvents--;
 
+void SetEventClockRate(double riscCycleUsec)
+{
+   eventTicksPerUsec = (double)EVENT_TICKS_PER_RISC_CYCLE / riscCycleUsec;
+   eventUsecPerTick  = riscCycleUsec / (double)EVENT_TICKS_PER_RISC_CYCLE;
+}
+
+
+// Set callback time in µs. This is fairly arbitrary, but works well enough for our purposes.
+//We just slap the next event into the lowest free slot, no checking, no nada...
+void SetCallbackTime(void (* callback)(void), double time, int type/*= EVENT_MAIN*/)
+{
+   struct EventQueue * q = QueueFor(type);
+   uint8_t slot;
+
+   for(slot = 0; slot < EVENT_LIST_SIZE; slot++)
+   {
+      if (!(q->slotsUsed & (1u << slot)))
+      {
+         Insert(q, callback, q->now + UsecToTicks(time), type, slot);
          return;
       }
    }
 }
 
 
+void RemoveCallback(void (* callback)(void))
+{
+   struct EventQueue * q;
+   uint32_t i;
+
+   if (FindCallback(callback, &q, &i))
+      RemoveAt(q, i);
+}
+
+
 void AdjustCallbackTime(void (* callback)(void), double time)
 {
-   unsigned i;
-   time = ClampDueEventTime(time);
+   struct EventQueue * q;
+   uint32_t i;
 
-   for(i = 0; i < EVENT_LIST_SIZE; i++)
+   if (FindCallback(callback, &q, &i))
    {
-      if (eventList[i].valid && eventList[i].timerCallback == callback)
-      {
-         eventList[i].eventTime = time;
-         return;
-      }
-      else if (eventListJERRY[i].valid && eventListJERRY[i].timerCallback == callback)
-      {
-         eventListJERRY[i].eventTime = time;
-         return;
-      }
+      q->heap[i].eventTime = q->now + UsecToTicks(time);
+      SiftUp(q, i);
+      SiftDown(q, i);
    }
 }
 
 
+uint64_t GetEventClock(int type)
+{
+   return QueueFor(type)->now;
+}
+
+
+// The delay SetCallbackTime() would schedule `time` µs out at, in ticks.
+uint64_t EventUsecToTicks(double time)
+{
+   return UsecToTicks(time);
+}
+
+
+// Ticks until the next event, 0 if it is already due; EVENT_TICKS_NEVER when
+// the domain has nothing pending.
+uint64_t GetTicksToNextEvent(int type)
+{
+   struct EventQueue * q = QueueFor(type);
+
+   if (q->count == 0)
+      return EVENT_TICKS_NEVER;
+
+   return (q->heap[0].eventTime > q->now ? q->heap[0].eventTime - q->now : 0);
+}
+
+
 //
-// Since our list is unordered WRT time, we have to search it to find the next event
-// Returns time to next event & sets nextEvent to that event
+// Returns time to next event in µs (1e30 when nothing is pending)
 //
 double GetTimeToNextEvent(int type/*= EVENT_MAIN*/)
 {
-   double time = 1e30;
-   unsigned i;
-   if (type == EVENT_MAIN)
-   {
-      nextEvent = 0;
+   uint64_t ticks = GetTicksToNextEvent(type);
 
-      for(i = 0; i < EVENT_LIST_SIZE; i++)
-      {
-         if (eventList[i].valid && (eventList[i].eventTime < time))
-         {
-            time = eventList[i].eventTime;
-            nextEvent = i;
-         }
-      }
-   }
-   else
-   {
-      nextEventJERRY = 0;
+   if (ticks == EVENT_TICKS_NEVER)
+      return 1e30;
 
-      for(i = 0; i < EVENT_LIST_SIZE; i++)
-      {
-         if (eventListJERRY[i].valid && (eventListJERRY[i].eventTime < time))
-         {
-            time = eventListJERRY[i].eventTime;
-            nextEventJERRY = i;
-         }
-      }
-   }
-
-   return ClampDueEventTime(time);
+   return (double)ticks * eventUsecPerTick;
 }
 
 
+// Fire the earliest pending event, advancing the domain clock to its due time
+// (never backwards: an overdue event fires at the current time).
 void HandleNextEvent(int type/*= EVENT_MAIN*/)
 {
-   unsigned i;
+   struct EventQueue * q = QueueFor(type);
+   void (* event)(void);
 
-   if (type == EVENT_MAIN)
-   {
-      double elapsedTime = ClampDueEventTime(eventList[nextEvent].eventTime);
-      void (* event)(void) = eventList[nextEvent].timerCallback;
+   if (q->count == 0)
+      return;
 
-      for (i = 0; i < EVENT_LIST_SIZE; i++)
-      {
-         //We can skip the check & just subtract from everything, since the check is probably
-         //just as heavy as the code after and we won't use the elapsed time from an invalid event anyway.
-         //		if (eventList[i].valid)
-         eventList[i].eventTime -= elapsedTime;
-      }
+   event = q->heap[0].timerCallback;
 
-      eventList[nextEvent].valid = false;			// Remove event from list...
-      numberOfEvents--;
+   if (q->heap[0].eventTime > q->now)
+      q->now = q->heap[0].eventTime;
 
-      (*event)();
-   }
-   else
-   {
-      double elapsedTime = ClampDueEventTime(eventListJERRY[nextEventJERRY].eventTime);
-      void (* event)(void) = eventListJERRY[nextEventJERRY].timerCallback;
+   RemoveAt(q, 0);
+   (*event)();
+}
+
+
+void AdvanceEventClock(uint64_t ticks, int type)
+{
+   QueueFor(type)->now += ticks;
+}
 
-      for (i = 0; i < EVENT_LIST_SIZE; i++)
-      {
-         //We can skip the check & just subtract from everything, since the check is probably
-         //just as heavy as the code after and we won't use the elapsed time from an invalid event anyway.
-         //		if (eventList[i].valid)
-         eventListJERRY[i].eventTime -= elapsedTime;
-      }
 
-      eventListJERRY[nextEventJERRY].valid = false;	// Remove event from list...
-      numberOfEvents--;
+// End a processor slice at absolute tick `sliceEnd` by firing the event it
+// was cut at, the earlier of the two domains' next events (JERRY only when
+// strictly sooner).  The end is fixed before the processors run, and they
+// can remove or push back that event (a PIT or UART reprogrammed
+// mid-slice): then nothing is due by `sliceEnd`, nothing fires, and both
+// clocks are left at `sliceEnd` for the next slice to start from.
+void HandleSliceEnd(uint64_t sliceEnd)
+{
+   uint64_t toMain = GetTicksToNextEvent(EVENT_MAIN);
+   uint64_t toJerry = GetTicksToNextEvent(EVENT_JERRY);
+   int type = (toJerry < toMain) ? EVENT_JERRY : EVENT_MAIN;
+   uint64_t ticks = (type == EVENT_JERRY) ? toJerry : toMain;
+   int d;
 
-      (*event)();
+   if (ticks == EVENT_TICKS_NEVER || QueueFor(type)->now + ticks > sliceEnd)
+   {
+      for(d = 0; d < 2; d++)
+      {
+         if (eventQueue[d].now < sliceEnd)
+            eventQueue[d].now = sliceEnd;
+      }
+      return;
    }
+
+   AdvanceEventClock(ticks, type == EVENT_JERRY ? EVENT_MAIN : EVENT_JERRY);
+   HandleNextEvent(type);
 }
 
 
 void SubtractEventTimes(double elapsed, int type)
 {
-   unsigned i;
-   if (type == EVENT_MAIN)
-   {
-      for (i = 0; i < EVENT_LIST_SIZE; i++)
-         eventList[i].eventTime -= elapsed;
-   }
-   else
-   {
-      for (i = 0; i < EVENT_LIST_SIZE; i++)
-         eventListJERRY[i].eventTime -= elapsed;
-   }
+   AdvanceEventClock(UsecToTicks(elapsed), type);
 }
 
 
@@ -304,35 +396,32 @@ static event_callback_t id_to_callback(uint8_t id)
 }
 
 
-size_t EventStateSave(uint8_t *buf)
+/* The event chunk keeps the layout of the old slot list: per slot, the
+ * valid flag, callback ID, type and the delay from now in µs.  The domain
+ * clocks themselves travel separately (EventClockStateSave), so states
+ * written before they existed still load. */
+static uint8_t * SaveQueue(uint8_t *buf, const struct EventQueue *q)
 {
-   uint8_t *start = buf;
+   const struct Event *bySlot[EVENT_LIST_SIZE];
    unsigned i;
 
-   STATE_SAVE_VAR(buf, nextEvent);
-   STATE_SAVE_VAR(buf, nextEventJERRY);
-   STATE_SAVE_VAR(buf, numberOfEvents);
-
-   /* Save both event lists — serialize callback as ID */
    for (i = 0; i < EVENT_LIST_SIZE; i++)
-   {
-      uint8_t valid = eventList[i].valid ? 1 : 0;
-      uint8_t cb_id = callback_to_id(eventList[i].timerCallback);
-      int32_t etype = (int32_t)eventList[i].eventType;
-      double etime  = eventList[i].eventTime;
-
-      STATE_SAVE_VAR(buf, valid);
-      STATE_SAVE_VAR(buf, cb_id);
-      STATE_SAVE_VAR(buf, etype);
-      STATE_SAVE_VAR(buf, etime);
-   }
+      bySlot[i] = NULL;
+   for (i = 0; i < q->count; i++)
+      bySlot[q->heap[i].slot] = &q->heap[i];
 
    for (i = 0; i < EVENT_LIST_SIZE; i++)
    {
-      uint8_t valid = eventListJERRY[i].valid ? 1 : 0;
-      uint8_t cb_id = callback_to_id(eventListJERRY[i].timerCallback);
-      int32_t etype = (int32_t)eventListJERRY[i].eventType;
-      double etime  = eventListJERRY[i].eventTime;
+      const struct Event *e = bySlot[i];
+      uint8_t valid = e ? 1 : 0;
+      uint8_t cb_id = e ? callback_to_id(e->timerCallback) : 0;
+      int32_t etype = e ? (int32_t)e->eventType : 0;
+      double etime  = 0.0;
+
+      if (e)
+         etime = (e->eventTime >= q->now
+            ? (double)(e->eventTime - q->now) * eventUsecPerTick
+            : -(double)(q->now - e->eventTime) * eventUsecPerTick);
 
       STATE_SAVE_VAR(buf, valid);
       STATE_SAVE_VAR(buf, cb_id);
@@ -340,53 +429,106 @@ size_t EventStateSave(uint8_t *buf)
       STATE_SAVE_VAR(buf, etime);
    }
 
-   return (size_t)(buf - start);
+   return buf;
 }
 
-
-size_t EventStateLoad(const uint8_t *buf)
+static const uint8_t * LoadQueue(const uint8_t *buf, struct EventQueue *q)
 {
-   const uint8_t *start = buf;
    unsigned i;
 
-   STATE_LOAD_VAR(buf, nextEvent);
-   STATE_LOAD_VAR(buf, nextEventJERRY);
-   STATE_LOAD_VAR(buf, numberOfEvents);
+   q->count = 0;
+   q->slotsUsed = 0;
+   q->now = 0;
 
    for (i = 0; i < EVENT_LIST_SIZE; i++)
    {
       uint8_t valid, cb_id;
       int32_t etype;
       double etime;
+      event_callback_t cb;
 
       STATE_LOAD_VAR(buf, valid);
       STATE_LOAD_VAR(buf, cb_id);
       STATE_LOAD_VAR(buf, etype);
       STATE_LOAD_VAR(buf, etime);
 
-      eventList[i].timerCallback = id_to_callback(cb_id);
-      /* Invalidate event if callback could not be resolved */
-      eventList[i].valid = (valid && eventList[i].timerCallback) ? true : false;
-      eventList[i].eventType = etype;
-      eventList[i].eventTime = etime;
+      cb = id_to_callback(cb_id);
+      /* Drop the event if its callback could not be resolved */
+      if (valid && cb)
+         Insert(q, cb, UsecToTicks(etime), etype, (uint8_t)i);
    }
 
-   for (i = 0; i < EVENT_LIST_SIZE; i++)
+   return buf;
+}
+
+
+size_t EventStateSave(uint8_t *buf)
+{
+   uint8_t *start = buf;
+   uint32_t nextEvent = eventQueue[EVENT_MAIN].count ? eventQueue[EVENT_MAIN].heap[0].slot : 0;
+   uint32_t nextEventJERRY = eventQueue[EVENT_JERRY].count ? eventQueue[EVENT_JERRY].heap[0].slot : 0;
+   uint32_t numberOfEvents = eventQueue[EVENT_MAIN].count + eventQueue[EVENT_JERRY].count;
+
+   STATE_SAVE_VAR(buf, nextEvent);
+   STATE_SAVE_VAR(buf, nextEventJERRY);
+   STATE_SAVE_VAR(buf, numberOfEvents);
+
+   buf = SaveQueue(buf, &eventQueue[EVENT_MAIN]);
+   buf = SaveQueue(buf, &eventQueue[EVENT_JERRY]);
+
+   return (size_t)(buf - start);
+}
+
+
+size_t EventStateLoad(const uint8_t *buf)
+{
+   const uint8_t *start = buf;
+   uint32_t nextEvent, nextEventJERRY, numberOfEvents;
+
+   /* Derived from the lists below; kept for the layout only. */
+   STATE_LOAD_VAR(buf, nextEvent);
+   STATE_LOAD_VAR(buf, nextEventJERRY);
+   STATE_LOAD_VAR(buf, numberOfEvents);
+
+   buf = LoadQueue(buf, &eventQueue[EVENT_MAIN]);
+   buf = LoadQueue(buf, &eventQueue[EVENT_JERRY]);
+
+   return (size_t)(buf - start);
+}
+
+
+/* Absolute domain clocks.  Only the sub-cycle phase changes emulation (it
+ * decides where the next slice boundary falls in whole cycles), but the
+ * full count is cheap and keeps long-session clocks intact across a load.
+ * Must be loaded after EventStateLoad(), which leaves both clocks at 0. */
+size_t EventClockStateSave(uint8_t *buf)
+{
+   uint8_t *start = buf;
+
+   STATE_SAVE_VAR(buf, eventQueue[EVENT_MAIN].now);
+   STATE_SAVE_VAR(buf, eventQueue[EVENT_JERRY].now);
+
+   return (size_t)(buf - start);
+}
+
+
+size_t EventClockStateLoad(const uint8_t *buf)
+{
+   const uint8_t *start = buf;
+   unsigned d;
+
+   for (d = 0; d < 2; d++)
    {
-      uint8_t valid, cb_id;
-      int32_t etype;
-      double etime;
+      struct EventQueue *q = &eventQueue[d];
+      uint64_t now;
+      uint32_t i;
 
-      STATE_LOAD_VAR(buf, valid);
-      STATE_LOAD_VAR(buf, cb_id);
-      STATE_LOAD_VAR(buf, etype);
-      STATE_LOAD_VAR(buf, etime);
+      STATE_LOAD_VAR(buf, now);
 
-      eventListJERRY[i].timerCallback = id_to_callback(cb_id);
-      /* Invalidate event if callback could not be resolved */
-      eventListJERRY[i].valid = (valid && eventListJERRY[i].timerCallback) ? true : false;
-      eventListJERRY[i].eventType = etype;
-      eventListJERRY[i].eventTime = etime;
+      /* Rebase: pending delays are relative to the saved clock. */
+      for (i = 0; i < q->count; i++)
+         q->heap[i].eventTime += now - q->now;
+      q->now = now;
    }
 
    return (size_t)(buf - start);
@@ -7,6 +7,9 @@
 #ifndef __EVENT_H__
 #define __EVENT_H__
 
+#include <stdint.h>
+#include <boolean.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -26,13 +29,29 @@ enum { EVENT_MAIN, EVENT_JERRY };
 #define USEC_TO_RISC_CYCLES(u) (uint32_t)(((u) / (vjs.hardwareTypeNTSC ? RISC_CYCLE_IN_USEC : RISC_CYCLE_PAL_IN_USEC)) + 0.5)
 #define USEC_TO_M68K_CYCLES(u) (uint32_t)(((u) / (vjs.hardwareTypeNTSC ? M68K_CYCLE_IN_USEC : M68K_CYCLE_PAL_IN_USEC)) + 0.5)
 
+// Event clocks count ticks of 1/65536 RISC cycle.  Slices are cut on whole
+// cycles of the RISC (and, one bit up, the 68K) clock between two absolute
+// tick counts, so their lengths are exact integers that sum to the clock.
+#define EVENT_TICK_SHIFT			16
+#define EVENT_TICKS_PER_RISC_CYCLE	(1u << EVENT_TICK_SHIFT)
+#define EVENT_TICKS_NEVER			(~(uint64_t)0)
+
+#define EVENT_TICKS_TO_RISC_CYCLES(from, to) (uint32_t)(((to) >> EVENT_TICK_SHIFT) - ((from) >> EVENT_TICK_SHIFT))
+#define EVENT_TICKS_TO_M68K_CYCLES(from, to) (uint32_t)(((to) >> (EVENT_TICK_SHIFT + 1)) - ((from) >> (EVENT_TICK_SHIFT + 1)))
+
 void InitializeEventList(void);
+void SetEventClockRate(double riscCycleUsec);
 void SetCallbackTime(void (* callback)(void), double time, int type);
 void RemoveCallback(void (* callback)(void));
 void AdjustCallbackTime(void (* callback)(void), double time);
 double GetTimeToNextEvent(int type);
 void HandleNextEvent(int type);
 void SubtractEventTimes(double elapsed, int type);
+uint64_t GetEventClock(int type);
+uint64_t EventUsecToTicks(double time);
+uint64_t GetTicksToNextEvent(int type);
+void AdvanceEventClock(uint64_t ticks, int type);
+void HandleSliceEnd(uint64_t sliceEnd);
 
 #ifdef __cplusplus
 }
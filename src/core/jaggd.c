@@ -29,6 +29,7 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "jaguar.h"   /* JaguarMemoryMapRebuild */
 #include "log.h"
 
 /* ------------------------------------------------------------------ */
@@ -213,6 +214,7 @@ void JGDReset(void)
       jgdPage[i] = (uint8_t)i;
    jgdWriteEnabled = 0;
    JGDSpiReset();
+   JaguarMemoryMapRebuild();
 }
 
 
@@ -225,6 +227,7 @@ void JGDUnload(void)
       free(jgdROM);
       jgdROM = NULL;
    }
+   JaguarMemoryMapRebuild();
 }
 
 
@@ -264,6 +267,7 @@ void JGDLoadROM(const uint8_t *buffer, uint32_t size)
       memset(jgdROM + size, 0, JGD_ROM_SIZE - size);
 
    jgdActive = 1;
+   JaguarMemoryMapRebuild();
    LOG_INF("[JGD] GameDrive emulation active (%s, image %u bytes)\n",
            jgdMode == JGD_MODE_ENABLED ? "forced" : "auto", (unsigned)size);
 }
@@ -453,6 +457,8 @@ static void JGDBackdoorWrite(uint16_t v)
       default:
          break;
    }
+   /* The cart pages of the bus fast path point into the banks. */
+   JaguarMemoryMapRebuild();
 }
 
 /* ------------------------------------------------------------------ */
@@ -623,6 +629,7 @@ size_t JGDStateLoad(const uint8_t *buf)
          spiParamCount = JGD_PARAM_MAX;
       if (spiHdrCount > 3)
          spiHdrCount = 3;
+      JaguarMemoryMapRebuild();
    }
 
    return (size_t)(buf - start);
@@ -24,6 +24,7 @@
 
 #include "cdrom.h"
 #include "perf_counters.h"
+#include "perf_timing.h"
 #include "jagcd_boot.h"
 #include "jagcd_hle.h"
 #include "dac.h"
@@ -40,6 +41,7 @@
 #include "jaggd.h"
 #include "nvmbios.h"
 #include "settings.h"
+#include "state_delta.h"
 #include "tom.h"
 #include "vjtrace.h"
 
@@ -56,6 +58,8 @@ PERF_COUNTER(timing_vblank_irqs);
 PERF_COUNTER(timing_jaguar_execute_calls);
 PERF_COUNTER(timing_m68k_cycles);
 PERF_COUNTER(timing_risc_cycles);
+PERF_COUNTER(timing_slices);
+PERF_COUNTER(m68k_fetch_window_moves);
 
 // Platform-independent xorshift32 PRNG for deterministic RAM initialization.
 // libc rand() produces different sequences on different platforms (glibc vs
@@ -332,46 +336,85 @@ bool bpmActive = false;
 uint32_t bpmAddress1;
 
 
-/* Callback function to detect illegal instructions */
-static bool start = false;
+/* ---- 68000 instruction hooks ----
+ *
+ * The CD HLE, the NVM BIOS and the CD boot strategies each trap a handful
+ * of magic PCs.  Rather than call every one of them before every
+ * instruction, each declares the PCs it may trap and m68k_execute() tests
+ * one bit of m68kHookMap (one bit per word address, 1 MB over the 24-bit
+ * space) before calling M68KInstructionHook().  The hooks still check
+ * their own conditions (HLE active, stub still in place...), so a set bit
+ * only has to be a superset of what is trapped, and the map needs
+ * rebuilding only when the set of providers changes: at reset, which is
+ * where every boot strategy starts.
+ *
+ * pcQueue is the 68000's PC history: m68k_execute() pushes the start PC
+ * of every instruction (vjtrace attributes accesses and backtraces with
+ * it).  The register snapshot beside it costs 16 more stores per
+ * instruction and is opt-in: set m68kRegTraceback (or VJ_M68K_TRACEBACK
+ * in the environment) before loading content; the whole map is then set
+ * so every instruction comes through the hook. */
+uint32_t m68kHookMap[M68K_HOOK_MAP_WORDS];
+bool m68kRegTraceback = false;
+
+void M68KHookRegister(uint32_t pc)
+{
+   pc &= 0xFFFFFF;
+   m68kHookMap[pc >> 6] |= 1u << ((pc >> 1) & 31);
+}
+
+/* [start, end) */
+void M68KHookRegisterRange(uint32_t start, uint32_t end)
+{
+   uint32_t pc;
+
+   for (pc = start & ~1u; pc < end; pc += 2)
+      M68KHookRegister(pc);
+}
+
+void M68KHookRebuild(void)
+{
+   if (m68kRegTraceback)
+   {
+      memset(m68kHookMap, 0xFF, sizeof(m68kHookMap));
+      return;
+   }
+
+   memset(m68kHookMap, 0, sizeof(m68kHookMap));
+   NVMBiosRegisterHooks();
+   if (bootConfig.strategy && bootConfig.strategy->register_hooks)
+      bootConfig.strategy->register_hooks();
+}
 
+/* Called from m68k_execute() for PCs whose m68kHookMap bit is set. */
 void M68KInstructionHook(void)
 {
-   unsigned i;
    uint32_t m68kPC = m68k_get_reg(NULL, M68K_REG_PC);
 
-   // For tracebacks...
-   // Ideally, we'd save all the registers as well...
-   pcQueue[pcQPtr] = m68kPC;
-   a0Queue[pcQPtr] = m68k_get_reg(NULL, M68K_REG_A0);
-   a1Queue[pcQPtr] = m68k_get_reg(NULL, M68K_REG_A1);
-   a2Queue[pcQPtr] = m68k_get_reg(NULL, M68K_REG_A2);
-   a3Queue[pcQPtr] = m68k_get_reg(NULL, M68K_REG_A3);
-   a4Queue[pcQPtr] = m68k_get_reg(NULL, M68K_REG_A4);
-   a5Queue[pcQPtr] = m68k_get_reg(NULL, M68K_REG_A5);
-   a6Queue[pcQPtr] = m68k_get_reg(NULL, M68K_REG_A6);
-   a7Queue[pcQPtr] = m68k_get_reg(NULL, M68K_REG_A7);
-   d0Queue[pcQPtr] = m68k_get_reg(NULL, M68K_REG_D0);
-   d1Queue[pcQPtr] = m68k_get_reg(NULL, M68K_REG_D1);
-   d2Queue[pcQPtr] = m68k_get_reg(NULL, M68K_REG_D2);
-   d3Queue[pcQPtr] = m68k_get_reg(NULL, M68K_REG_D3);
-   d4Queue[pcQPtr] = m68k_get_reg(NULL, M68K_REG_D4);
-   d5Queue[pcQPtr] = m68k_get_reg(NULL, M68K_REG_D5);
-   d6Queue[pcQPtr] = m68k_get_reg(NULL, M68K_REG_D6);
-   d7Queue[pcQPtr] = m68k_get_reg(NULL, M68K_REG_D7);
-   pcQPtr++;
-   pcQPtr &= 0x3FF;
+   if (m68kRegTraceback)
+   {
+      uint32_t slot = (pcQPtr - 1) & 0x3FF;
+      a0Queue[slot] = m68k_get_reg(NULL, M68K_REG_A0);
+      a1Queue[slot] = m68k_get_reg(NULL, M68K_REG_A1);
+      a2Queue[slot] = m68k_get_reg(NULL, M68K_REG_A2);
+      a3Queue[slot] = m68k_get_reg(NULL, M68K_REG_A3);
+      a4Queue[slot] = m68k_get_reg(NULL, M68K_REG_A4);
+      a5Queue[slot] = m68k_get_reg(NULL, M68K_REG_A5);
+      a6Queue[slot] = m68k_get_reg(NULL, M68K_REG_A6);
+      a7Queue[slot] = m68k_get_reg(NULL, M68K_REG_A7);
+      d0Queue[slot] = m68k_get_reg(NULL, M68K_REG_D0);
+      d1Queue[slot] = m68k_get_reg(NULL, M68K_REG_D1);
+      d2Queue[slot] = m68k_get_reg(NULL, M68K_REG_D2);
+      d3Queue[slot] = m68k_get_reg(NULL, M68K_REG_D3);
+      d4Queue[slot] = m68k_get_reg(NULL, M68K_REG_D4);
+      d5Queue[slot] = m68k_get_reg(NULL, M68K_REG_D5);
+      d6Queue[slot] = m68k_get_reg(NULL, M68K_REG_D6);
+      d7Queue[slot] = m68k_get_reg(NULL, M68K_REG_D7);
+   }
 
    if (m68kPC & 0x01)		// Oops! We're fetching an odd address!
       return;
 
-   /* CD HLE jump-table dispatch.  When CD HLE BIOS is active, a small set
-    * of magic PCs in cart ROM space resolve to BIOS routines emulated in
-    * jagcd_hle.c instead of executing the cart bytes.  Returns true if the
-    * hook handled the call (PC/registers updated). */
-   if (JaguarCDHLEHook(m68kPC))
-      return;
-
    /* Memory Track NVM BIOS dispatcher ($2404) — active for CD content in
     * BOTH boot modes; the module is RAM-resident on hardware, independent
     * of which CD BIOS variant booted the disc. */
@@ -380,7 +423,7 @@ void M68KInstructionHook(void)
 
    /* CD boot strategy hook (cart strategy is a no-op for cart games;
     * HLE/BIOS strategies trap specific PCs to inject boot stubs, patch
-    * auth checks, etc.). */
+    * auth checks, dispatch the HLE BIOS jump table, etc.). */
    if (bootConfig.strategy && bootConfig.strategy->instruction_hook
          && bootConfig.strategy->instruction_hook(m68kPC))
       return;
@@ -425,7 +468,11 @@ static int m68kBusNoCharge = 0;
 #define M68K_BUS_CHARGE(addr, naccesses) \
    do { \
       if (busArbiter.enabled && !m68kBusNoCharge) \
+      { \
+         if (m68kFetchPending) \
+            m68k_fetch_flush(); \
          regs.remainingCycles -= (int32_t)bus_arbiter_m68k_access((addr), (naccesses), m68kClockScalePct); \
+      } \
    } while (0)
 
 /* A 68000 READ from GPU local RAM samples the state of a coprocessor that
@@ -475,8 +522,178 @@ static void M68KGPURAMSyncRead(unsigned int address, unsigned int length)
       DSPSyncToM68K();
 }
 
+/* ---- Page-table memory map ----
+ *
+ * The read/write handlers below decode an address by walking a ladder of
+ * range checks (RAM, cart with Memory Track and GameDrive banking, CD,
+ * BIOS, TOM, JERRY).  Almost every access is to plain RAM or ROM, so each
+ * handler first looks the 64 KB page up in a table of host pointers and,
+ * on a hit, is one load or store away from done.  A NULL entry sends the
+ * access down the ladder, which stays the single source of truth for
+ * everything else.
+ *
+ * There are two sets of tables because the two buses decode differently:
+ * the 68000 sees unpopulated space above 2 MB and the Memory Track, the
+ * JaguarRead*() masters (GPU, DSP, blitter, OP) see the 2 MB RAM mirrored
+ * to $7FFFFF.
+ *
+ * Hooks that the ladder runs per access are page attributes here: while a
+ * VJ_TRACE watch is armed every page is NULL, and while the blit memo is
+ * on the RAM pages are (its write hook, and its read log while a blit is
+ * recorded).  The disabled case therefore costs nothing on the fast path.
+ * 68000 bus charging stays inline -- it applies to every page.
+ *
+ * Whatever changes the decode must call JaguarMemoryMapRebuild(): reset
+ * and content load, GameDrive bank switches and image (un)load, blit memo
+ * mode changes and watch changes. */
+uint8_t *m68kReadPage[JAG_PAGES];
+uint8_t *m68kWritePage[JAG_PAGES];
+uint8_t *jaguarReadPage[JAG_PAGES];
+uint8_t *jaguarWritePage[JAG_PAGES];
+
+/* Host pointer for a cart page, or NULL while the GameDrive has no
+ * image.  Banks are 1 MB, so a 64 KB page never straddles two. */
+static uint8_t *jaguar_cart_page(uint32_t page)
+{
+   uint32_t off = (page << JAG_PAGE_SHIFT) - 0x800000;
+
+   if (JGD_BANKING())
+   {
+      if (!jgdROM)
+         return NULL;
+      return jgdROM + (((uint32_t)jgdPage[off >> 20] << 20) | (off & 0xFFFFF));
+   }
+   return jaguarMainROM + off;
+}
+
+void JaguarMemoryMapRebuild(void)
+{
+   uint32_t page;
+   bool memo = (blitMemoMode != BLIT_MEMO_OFF);
+   bool mt   = MEMTRACK_PRESENT();
+
+   /* The fetch window may hold one of the old pages. */
+   if (m68kFetchPending)
+      m68k_fetch_flush();
+   m68kFetchStart = M68K_FETCH_NONE;
+
+   memset(m68kReadPage, 0, sizeof(m68kReadPage));
+   memset(m68kWritePage, 0, sizeof(m68kWritePage));
+   memset(jaguarReadPage, 0, sizeof(jaguarReadPage));
+   memset(jaguarWritePage, 0, sizeof(jaguarWritePage));
+
+#ifdef VJ_TRACE
+   if (vjtrace_nwatch)
+      return;
+#endif
+
+   for (page = 0; page < JAG_PAGES; page++)
+   {
+      uint32_t base = page << JAG_PAGE_SHIFT;
+
+      if (base < 0x200000)
+      {
+         m68kReadPage[page] = jaguarMainRAM + base;
+         if (!memo)
+         {
+            m68kWritePage[page]   = jaguarMainRAM + base;
+            jaguarWritePage[page] = jaguarMainRAM + base;
+         }
+      }
+      if (base < 0x800000 && !memo)
+         jaguarReadPage[page] = jaguarMainRAM + (base & 0x1FFFFF);
+
+      /* $DF0000 holds the CD registers at $DFFF00, so the ladder keeps
+       * that whole page. */
+      if (base >= 0x800000 && base < 0xDF0000)
+      {
+         jaguarReadPage[page] = jaguar_cart_page(page);
+         /* The Memory Track answers at $800000-$80FFFF (ID and unlock
+          * reads) and in its $900000 NVRAM window. */
+         if (!(mt && (page == 0x80 || (base >= (MT_DATA_BASE & ~JAG_PAGE_MASK)
+                                       && base < MT_DATA_END))))
+            m68kReadPage[page] = jaguarReadPage[page];
+      }
+
+      if (base >= 0xE00000 && base < 0xE40000)
+      {
+         m68kReadPage[page]   = jagMemSpace + base;
+         jaguarReadPage[page] = jagMemSpace + base;
+      }
+   }
+}
+
+/* ---- 68000 instruction-fetch window ----
+ *
+ * Opcode and extension-word fetches are most of the 68000's bus traffic,
+ * and nearly all of it runs sequentially through one page of RAM or ROM.
+ * get_iword() & co. (m68000/inlines.h) read straight from the page at
+ * m68kFetchStart; m68k_fetch_16/32 move the window when the PC leaves it,
+ * and hand a page the map leaves NULL (GPU/DSP RAM, I/O, watched pages)
+ * to the full read handlers.
+ *
+ * Window fetches are charged in bulk.  Each adds m68kFetchCharge (1 while
+ * the DRAM timing model is on, else 0) to m68kFetchPending, and
+ * m68k_fetch_flush() charges the total against the window's page.  The
+ * flush runs after every instruction and before any other 68000 bus
+ * charge, so remainingCycles matches per-fetch charging everywhere it is
+ * read (GPUSyncToM68K and friends run from those charged handlers). */
+unsigned int m68kFetchStart = M68K_FETCH_NONE;
+const unsigned char *m68kFetchBase = NULL;
+unsigned int m68kFetchCharge = 0;
+unsigned int m68kFetchPending = 0;
+
+void m68k_fetch_flush(void)
+{
+   uint32_t n = m68kFetchPending;
+
+   m68kFetchPending = 0;
+   if (busArbiter.enabled)
+      regs.remainingCycles -= (int32_t)bus_arbiter_m68k_access(m68kFetchStart, n,
+                                                               m68kClockScalePct);
+}
+
+/* Point the window at the mapped page holding `address`. */
+static void m68k_fetch_move(uint32_t address, const uint8_t *page)
+{
+   PERF_INC(m68k_fetch_window_moves);
+   if (m68kFetchPending)
+      m68k_fetch_flush();
+   m68kFetchStart  = address & ~JAG_PAGE_MASK;
+   m68kFetchBase   = page;
+   m68kFetchCharge = busArbiter.enabled ? 1 : 0;
+}
+
+unsigned int m68k_fetch_16(unsigned int address)
+{
+   const uint8_t *page;
+
+   address &= 0x00FFFFFF;
+   page = m68kReadPage[address >> JAG_PAGE_SHIFT];
+   if (!page || (address & JAG_PAGE_MASK) > JAG_PAGE_MASK - 1)
+      return m68k_read_memory_16(address);
+   m68k_fetch_move(address, page);
+   m68kFetchPending += m68kFetchCharge;
+   return GET16(page, address & JAG_PAGE_MASK);
+}
+
+unsigned int m68k_fetch_32(unsigned int address)
+{
+   const uint8_t *page;
+
+   address &= 0x00FFFFFF;
+   page = m68kReadPage[address >> JAG_PAGE_SHIFT];
+   if (!page || (address & JAG_PAGE_MASK) > JAG_PAGE_MASK - 3)
+      return m68k_read_memory_32(address);
+   m68k_fetch_move(address, page);
+   m68kFetchPending += 2 * m68kFetchCharge;
+   return GET32(page, address & JAG_PAGE_MASK);
+}
+
 unsigned int m68k_read_memory_8(unsigned int address)
 {
+   const uint8_t *page;
+
 #ifdef ALPINE_FUNCTIONS
    // Check if breakpoint on memory is active, and deal with it
    if (bpmActive && address == bpmAddress1)
@@ -485,6 +702,12 @@ unsigned int m68k_read_memory_8(unsigned int address)
 
    // Musashi does this automagically for you, UAE core does not :-P
    address &= 0x00FFFFFF;
+   page = m68kReadPage[address >> JAG_PAGE_SHIFT];
+   if (page)
+   {
+      M68K_BUS_CHARGE(address, 1);
+      return page[address & JAG_PAGE_MASK];
+   }
    /* This bus fast path never routes through JaguarReadByte (see the
     * comment above M68K_BUS_CHARGE), so hook the watch check here.
     * m68kBusNoCharge is also true for disassembler reads (Task 7.5):
@@ -525,6 +748,8 @@ void gpu_dump_registers(void);
 
 unsigned int m68k_read_memory_16(unsigned int address)
 {
+   const uint8_t *page;
+
 #ifdef ALPINE_FUNCTIONS
    // Check if breakpoint on memory is active, and deal with it
    if (bpmActive && address == bpmAddress1)
@@ -533,6 +758,12 @@ unsigned int m68k_read_memory_16(unsigned int address)
 
    // Musashi does this automagically for you, UAE core does not :-P
    address &= 0x00FFFFFF;
+   page = m68kReadPage[address >> JAG_PAGE_SHIFT];
+   if (page && (address & JAG_PAGE_MASK) <= JAG_PAGE_MASK - 1)
+   {
+      M68K_BUS_CHARGE(address, 1);
+      return GET16(page, address & JAG_PAGE_MASK);
+   }
    /* Bus fast path, hooked directly -- see m68k_read_memory_8. */
    if (!m68kBusNoCharge)
       VJT_WATCH_RD(address, 0, M68K);
@@ -572,6 +803,8 @@ unsigned int m68k_read_memory_16(unsigned int address)
 
 unsigned int m68k_read_memory_32(unsigned int address)
 {
+   const uint8_t *page;
+
 #ifdef ALPINE_FUNCTIONS
    // Check if breakpoint on memory is active, and deal with it
    if (bpmActive && address == bpmAddress1)
@@ -580,6 +813,12 @@ unsigned int m68k_read_memory_32(unsigned int address)
 
    // Musashi does this automagically for you, UAE core does not :-P
    address &= 0x00FFFFFF;
+   page = m68kReadPage[address >> JAG_PAGE_SHIFT];
+   if (page && (address & JAG_PAGE_MASK) <= JAG_PAGE_MASK - 3)
+   {
+      M68K_BUS_CHARGE(address, 2);
+      return GET32(page, address & JAG_PAGE_MASK);
+   }
 
    if (address <= 0x1FFFFC)
    {
@@ -740,6 +979,8 @@ static bool M68KRiscWordLatch(unsigned int address, unsigned int value)
 
 void m68k_write_memory_8(unsigned int address, unsigned int value)
 {
+   uint8_t *page;
+
 #ifdef ALPINE_FUNCTIONS
    // Check if breakpoint on memory is active, and deal with it
    if (bpmActive && address == bpmAddress1)
@@ -748,6 +989,14 @@ void m68k_write_memory_8(unsigned int address, unsigned int value)
 
    // Musashi does this automagically for you, UAE core does not :-P
    address &= 0x00FFFFFF;
+   page = m68kWritePage[address >> JAG_PAGE_SHIFT];
+   if (page)
+   {
+      M68K_BUS_CHARGE(address, 1);
+      StateDeltaMark(address, 1);
+      page[address & JAG_PAGE_MASK] = value;
+      return;
+   }
    /* Bus fast path, hooked directly -- never routes through
     * JaguarWriteByte (see the comment above M68K_BUS_CHARGE).  No
     * disassembler variant exists for writes, so unlike the read side
@@ -764,6 +1013,7 @@ void m68k_write_memory_8(unsigned int address, unsigned int value)
    {
       if (blitMemoMode)
          BlitMemoWriteHook(address, 1, value);
+      StateDeltaMark(address, 1);
       jaguarMainRAM[address] = value;
    }
    /* GameDrive: GD_ROMWriteEnable makes the SDRAM-backed "ROM" writable
@@ -794,6 +1044,8 @@ void m68k_write_memory_8(unsigned int address, unsigned int value)
 
 void m68k_write_memory_16(unsigned int address, unsigned int value)
 {
+   uint8_t *page;
+
 #ifdef ALPINE_FUNCTIONS
    // Check if breakpoint on memory is active, and deal with it
    if (bpmActive && address == bpmAddress1)
@@ -802,6 +1054,14 @@ void m68k_write_memory_16(unsigned int address, unsigned int value)
 
    // Musashi does this automagically for you, UAE core does not :-P
    address &= 0x00FFFFFF;
+   page = m68kWritePage[address >> JAG_PAGE_SHIFT];
+   if (page && (address & JAG_PAGE_MASK) <= JAG_PAGE_MASK - 1)
+   {
+      M68K_BUS_CHARGE(address, 1);
+      StateDeltaMark(address, 2);
+      SET16(page, address & JAG_PAGE_MASK, value);
+      return;
+   }
    /* Bus fast path, hooked directly -- terminal (never recurses into
     * another m68k_write_memory_* function), so one call here is exactly
     * one 68K bus write, including the half that only reaches the
@@ -829,6 +1089,7 @@ void m68k_write_memory_16(unsigned int address, unsigned int value)
    {
       if (blitMemoMode)
          BlitMemoWriteHook(address, 2, value);
+      StateDeltaMark(address, 2);
       SET16(jaguarMainRAM, address, value);
    }
    /* GameDrive write-enabled cart space (see the byte handler). */
@@ -864,6 +1125,8 @@ void m68k_write_memory_16(unsigned int address, unsigned int value)
 
 void m68k_write_memory_32(unsigned int address, unsigned int value)
 {
+   uint8_t *page;
+
 #ifdef ALPINE_FUNCTIONS
    // Check if breakpoint on memory is active, and deal with it
    if (bpmActive && address == bpmAddress1)
@@ -872,6 +1135,14 @@ void m68k_write_memory_32(unsigned int address, unsigned int value)
 
    // Musashi does this automagically for you, UAE core does not :-P
    address &= 0x00FFFFFF;
+   page = m68kWritePage[address >> JAG_PAGE_SHIFT];
+   if (page && (address & JAG_PAGE_MASK) <= JAG_PAGE_MASK - 3)
+   {
+      M68K_BUS_CHARGE(address, 2);
+      StateDeltaMark(address, 4);
+      SET32(page, address & JAG_PAGE_MASK, value);
+      return;
+   }
 
    if (address <= 0x1FFFFC)
    {
@@ -887,6 +1158,7 @@ void m68k_write_memory_32(unsigned int address, unsigned int value)
       M68K_BUS_CHARGE(address, 2);
       if (blitMemoMode)
          BlitMemoWriteHook(address, 4, value);
+      StateDeltaMark(address, 4);
       SET32(jaguarMainRAM, address, value);
       return;
    }
@@ -931,11 +1203,16 @@ unsigned int m68k_read_disassembler_32(unsigned int address)
 
 uint8_t JaguarReadByte(uint32_t offset, uint32_t who)
 {
+   const uint8_t *page;
+
    /* Mask BEFORE the watch check -- a caller passing an address with
     * upper bits set must still compare against the real 24-bit bus
     * address a watch range was defined against.  The memo hook sits
     * after the mask for the same reason. */
    offset &= 0xFFFFFF;
+   page = jaguarReadPage[offset >> JAG_PAGE_SHIFT];
+   if (page)
+      return page[offset & JAG_PAGE_MASK];
    VJT_WATCH_RD(offset, 0, who);
    if (blitMemoRecording)
       BlitMemoNoteRead(offset, 1);
@@ -965,8 +1242,13 @@ uint8_t JaguarReadByte(uint32_t offset, uint32_t who)
 
 uint16_t JaguarReadWord(uint32_t offset, uint32_t who)
 {
+   const uint8_t *page;
+
    /* Mask before the watch check -- see JaguarReadByte. */
    offset &= 0xFFFFFF;
+   page = jaguarReadPage[offset >> JAG_PAGE_SHIFT];
+   if (page && (offset & JAG_PAGE_MASK) <= JAG_PAGE_MASK - 1)
+      return GET16(page, offset & JAG_PAGE_MASK);
    VJT_WATCH_RD(offset, 0, who);
    if (blitMemoRecording)
       BlitMemoNoteRead(offset, 2);
@@ -997,8 +1279,17 @@ uint16_t JaguarReadWord(uint32_t offset, uint32_t who)
 
 void JaguarWriteByte(uint32_t offset, uint8_t data, uint32_t who)
 {
+   uint8_t *page;
+
    /* Mask before the watch check -- see JaguarReadByte. */
    offset &= 0xFFFFFF;
+   page = jaguarWritePage[offset >> JAG_PAGE_SHIFT];
+   if (page)
+   {
+      StateDeltaMark(offset, 1);
+      page[offset & JAG_PAGE_MASK] = data;
+      return;
+   }
    VJT_WATCH_WR(offset, data, who);
    if (blitMemoMode)
       BlitMemoWriteHook(offset, 1, data);
@@ -1017,6 +1308,7 @@ void JaguarWriteByte(uint32_t offset, uint8_t data, uint32_t who)
     * depend on reads staying harmless. */
    if (offset < 0x200000)
    {
+      StateDeltaMark(offset, 1);
       jaguarMainRAM[offset] = data;
       return;
    }
@@ -1051,8 +1343,17 @@ void JaguarWriteByte(uint32_t offset, uint8_t data, uint32_t who)
 
 void JaguarWriteWord(uint32_t offset, uint16_t data, uint32_t who)
 {
+   uint8_t *page;
+
    /* Mask before the watch check -- see JaguarReadByte. */
    offset &= 0xFFFFFF;
+   page = jaguarWritePage[offset >> JAG_PAGE_SHIFT];
+   if (page && (offset & JAG_PAGE_MASK) <= JAG_PAGE_MASK - 1)
+   {
+      StateDeltaMark(offset, 2);
+      SET16(page, offset & JAG_PAGE_MASK, data);
+      return;
+   }
    VJT_WATCH_WR(offset, data, who);
    if (blitMemoMode)
       BlitMemoWriteHook(offset, 2, data);
@@ -1060,6 +1361,7 @@ void JaguarWriteWord(uint32_t offset, uint16_t data, uint32_t who)
    /* Unpopulated $200000-$7FFFFF: discard (see JaguarWriteByte). */
    if (offset <= 0x1FFFFE)
    {
+      StateDeltaMark(offset, 2);
       jaguarMainRAM[offset+0] = data >> 8;
       jaguarMainRAM[offset+1] = data & 0xFF;
       return;
@@ -1100,12 +1402,15 @@ void JaguarWriteWord(uint32_t offset, uint16_t data, uint32_t who)
 uint32_t JaguarReadLong(uint32_t offset, uint32_t who)
 {
    uint32_t addr = offset & 0xFFFFFF;
+   const uint8_t *page = jaguarReadPage[addr >> JAG_PAGE_SHIFT];
    /* OP bus occupancy: every 32-bit read the object processor makes is
     * half a phrase; page-mode phrase cost is 2 system clocks (OP
     * streaming is sequential -> page hits), so charge 1 clock per long.
     * Row-change overhead is added per rendered object in op.c. */
    if (busArbiter.enabled && who == OP)
       bus_arbiter_op_charge(1);
+   if (page && (addr & JAG_PAGE_MASK) <= JAG_PAGE_MASK - 3)
+      return GET32(page, addr & JAG_PAGE_MASK);
    if (addr < 0x800000)
    {
       /* Fast path: bypasses JaguarReadWord, so the watch check there
@@ -1125,6 +1430,7 @@ uint32_t JaguarReadLong(uint32_t offset, uint32_t who)
 void JaguarWriteLong(uint32_t offset, uint32_t data, uint32_t who)
 {
    uint32_t addr = offset & 0xFFFFFF;
+   uint8_t *page = jaguarWritePage[addr >> JAG_PAGE_SHIFT];
    /* OP bus occupancy: every 32-bit write-back the object processor
     * makes is half a phrase; page-mode phrase cost is 2 system clocks
     * (OP streaming is sequential -> page hits), so charge 1 clock per
@@ -1140,6 +1446,12 @@ void JaguarWriteLong(uint32_t offset, uint32_t data, uint32_t who)
    if (addr == 0xF1B274 && data != 0)
       LOG_DBG("[CDDA] DSP mailbox $F1B274 = %08X who=%u 68kpc=$%06X\n",
               data, who, m68k_get_reg(NULL, M68K_REG_PC));
+   if (page && (addr & JAG_PAGE_MASK) <= JAG_PAGE_MASK - 3)
+   {
+      StateDeltaMark(addr, 4);
+      SET32(page, addr & JAG_PAGE_MASK, data);
+      return;
+   }
    if (addr < 0x200000)
    {
       /* Fast path: bypasses JaguarWriteWord, so the watch check there
@@ -1148,6 +1460,7 @@ void JaguarWriteLong(uint32_t offset, uint32_t data, uint32_t who)
       VJT_WATCH_WR(addr, data, who);
       if (blitMemoMode)
          BlitMemoWriteHook(addr, 4, data);
+      StateDeltaMark(addr, 4);
       SET32(jaguarMainRAM, addr, data);
       return;
    }
@@ -1186,6 +1499,9 @@ void JaguarInit(void)
    lowerField = false;							// Reset the lower field flag
    memset(jaguarMainRAM + 0x804, 0xFF, 4);
 
+   if (getenv("VJ_M68K_TRACEBACK"))
+      m68kRegTraceback = true;
+
    m68k_pulse_reset();							// Need to do this so UAE disasm doesn't segfault on exit
    GPUInit();
    DSPInit();
@@ -1351,6 +1667,7 @@ void JaguarReset(void)
     * that must be cleared on every reset.  Cart strategy reset is a no-op. */
    if (bootConfig.strategy && bootConfig.strategy->reset)
       bootConfig.strategy->reset();
+   M68KHookRebuild();
 
    /* GameDrive: console reset returns the ASIC to identity pages,
     * write-protected, SPI idle; the game re-runs GD_Install itself. */
@@ -1397,6 +1714,7 @@ void JaguarReset(void)
 
    // New timer base code stuffola...
    InitializeEventList();
+   SetEventClockRate(vjs.hardwareTypeNTSC ? RISC_CYCLE_IN_USEC : RISC_CYCLE_PAL_IN_USEC);
    //Need to change this so it uses the single RAM space and load the BIOS
    //into it somewhere...
    //Also, have to change this here and in JaguarReadXX() currently
@@ -1557,6 +1875,7 @@ void JaguarReset(void)
 
    lowerField = false;								// Reset the lower field flag
    SetCallbackTime(HalflineCallback, JaguarGetHalflinePeriodUs(), EVENT_MAIN);
+   StateDeltaMarkAll();
 }
 
 
@@ -1564,7 +1883,10 @@ void JaguarApplyHLEBIOSState(void)
 {
    if (!vjs.useJaguarBIOS && jaguarCartInserted
          && GET32(jaguarMainRAM, HLE_BIOS_WORK_FLAG_ADDR) == 0)
+   {
+      StateDeltaMark(HLE_BIOS_WORK_FLAG_ADDR, 4);
       SET32(jaguarMainRAM, HLE_BIOS_WORK_FLAG_ADDR, HLE_BIOS_WORK_READY);
+   }
 }
 
 
@@ -1657,18 +1979,27 @@ static void M68KExecuteWithStalls(uint32_t cycles)
 /* New Jaguar execution stack
  * This executes 1 frame's worth of code.
  * Interleaves EVENT_MAIN (video/halfline) and EVENT_JERRY (DSP/I2S/timers)
- * so the DSP runs alongside the 68K and GPU, matching real hardware timing. */
+ * so the DSP runs alongside the 68K and GPU, matching real hardware timing.
+ * Each slice ends at the next event of either domain. */
 void JaguarExecuteNew(void)
 {
    PERF_INC(timing_jaguar_execute_calls);
    frameDone = false;
 
+   /* The PAL/NTSC option can change between frames; the event clock
+    * keeps its tick count and only the µs conversion follows. */
+   SetEventClockRate(vjs.hardwareTypeNTSC ? RISC_CYCLE_IN_USEC : RISC_CYCLE_PAL_IN_USEC);
+
    do
    {
-      double timeToMainEvent = GetTimeToNextEvent(EVENT_MAIN);
-      double timeToJerryEvent = GetTimeToNextEvent(EVENT_JERRY);
-      double timeDelta;
+      uint64_t ticksToMainEvent = GetTicksToNextEvent(EVENT_MAIN);
+      uint64_t ticksToJerryEvent = GetTicksToNextEvent(EVENT_JERRY);
+      int nextType = (ticksToJerryEvent < ticksToMainEvent) ? EVENT_JERRY : EVENT_MAIN;
+      uint64_t ticks = (nextType == EVENT_JERRY) ? ticksToJerryEvent : ticksToMainEvent;
+      uint64_t sliceStart = GetEventClock(nextType);
+      uint64_t sliceEnd = sliceStart + ticks;
       uint32_t riscCycles;
+      uint32_t m68kCycles;
 
       /* GPUBeginSlice/DSPBeginSlice + *SliceRemaining: part of each
        * RISC slice may already have been run from GPUSyncToM68K() /
@@ -1680,35 +2011,40 @@ void JaguarExecuteNew(void)
        * handed out: the RISC scale widens the GPU+DSP compute budget per
        * slice, the M68K scale is applied inside M68KExecuteWithStalls()
        * after the (unscaled, wall-time) bus-occupancy stall.  Event
-       * scheduling (timeDelta, EVENT_MAIN/EVENT_JERRY) stays on the real
-       * sysclock, so video, PIT/UART timers and I2S sample pacing are
+       * scheduling (the tick clocks, EVENT_MAIN/EVENT_JERRY) stays on the
+       * real sysclock, so video, PIT/UART timers and I2S sample pacing are
        * untouched -- more DSP cycles run between I2S interrupts, but the
-       * interrupts (and thus audio pitch) keep their stock rate. */
-      if (timeToJerryEvent < timeToMainEvent)
-      {
-         timeDelta = timeToJerryEvent;
-         riscCycles = SCALE_RISC_CYCLES(USEC_TO_RISC_CYCLES(timeDelta));
-         GPUBeginSlice(riscCycles);
-         DSPBeginSlice(riscCycles);
-         M68KExecuteWithStalls(USEC_TO_M68K_CYCLES(timeDelta));
-         GPUExec(GPUSliceRemaining());
-         DSPExec(DSPSliceRemaining());
-         SubtractEventTimes(timeDelta, EVENT_MAIN);
-         HandleNextEvent(EVENT_JERRY);
-      }
-      else
-      {
-         timeDelta = timeToMainEvent;
-         riscCycles = SCALE_RISC_CYCLES(USEC_TO_RISC_CYCLES(timeDelta));
-         GPUBeginSlice(riscCycles);
-         DSPBeginSlice(riscCycles);
-         M68KExecuteWithStalls(USEC_TO_M68K_CYCLES(timeDelta));
-         GPUExec(GPUSliceRemaining());
-         DSPExec(DSPSliceRemaining());
-         SubtractEventTimes(timeDelta, EVENT_JERRY);
-         HandleNextEvent(EVENT_MAIN);
-      }
-      PERF_ADD(timing_m68k_cycles, (unsigned long long)SCALE_M68K_CYCLES(USEC_TO_M68K_CYCLES(timeDelta)));
-      PERF_ADD(timing_risc_cycles, (unsigned long long)SCALE_RISC_CYCLES(USEC_TO_RISC_CYCLES(timeDelta)));
+       * interrupts (and thus audio pitch) keep their stock rate.
+       *
+       * Slice lengths are the whole cycles the clock crosses between the
+       * two absolute tick counts, so they sum exactly to elapsed time
+       * instead of accumulating per-slice rounding.
+       *
+       * With the threaded DSP on, DSPStartSlice() runs the DSP's share on
+       * a worker alongside the 68K and GPU, and DSPFinishSlice() waits
+       * for it; otherwise it is DSPExec(DSPSliceRemaining()) as before.
+       * The order the processors observe each other in is the same. */
+      riscCycles = SCALE_RISC_CYCLES(EVENT_TICKS_TO_RISC_CYCLES(sliceStart, sliceEnd));
+      m68kCycles = EVENT_TICKS_TO_M68K_CYCLES(sliceStart, sliceEnd);
+      GPUBeginSlice(riscCycles);
+      DSPBeginSlice(riscCycles);
+      DSPStartSlice();
+      PERF_TIME_ENTER(PERF_T_M68K);
+      M68KExecuteWithStalls(m68kCycles);
+      PERF_TIME_LEAVE();
+      PERF_TIME_ENTER(PERF_T_GPU);
+      GPUExec(GPUSliceRemaining());
+      PERF_TIME_LEAVE();
+      PERF_TIME_ENTER(PERF_T_DSP);
+      DSPFinishSlice();
+      PERF_TIME_LEAVE();
+      PERF_INC(timing_slices);
+      PERF_ADD(timing_m68k_cycles, (unsigned long long)SCALE_M68K_CYCLES(m68kCycles));
+      PERF_ADD(timing_risc_cycles, (unsigned long long)riscCycles);
+
+      /* Fire the event the slice was cut at.  The end is the absolute
+       * tick fixed above: the processors may have moved or removed that
+       * event while the slice ran. */
+      HandleSliceEnd(sliceEnd);
    } while(!frameDone);
 }
@@ -29,6 +29,26 @@ void JaguarWriteLong(uint32_t offset, uint32_t data, uint32_t who);
 
 bool JaguarInterruptHandlerIsValid(uint32_t i);
 
+/* 64 KB pages of host pointers the bus handlers try before their decode
+ * ladder; a NULL entry means "take the ladder".  m68k* is the 68000's
+ * view, jaguar* the one JaguarRead/Write*() give the other bus masters.
+ * Rebuild after anything that changes the decode (see jaguar.c). */
+#define JAG_PAGE_SHIFT 16
+#define JAG_PAGE_MASK  0xFFFF
+#define JAG_PAGES      0x100
+extern uint8_t *m68kReadPage[JAG_PAGES];
+extern uint8_t *m68kWritePage[JAG_PAGES];
+extern uint8_t *jaguarReadPage[JAG_PAGES];
+extern uint8_t *jaguarWritePage[JAG_PAGES];
+void JaguarMemoryMapRebuild(void);
+
+/* PCs M68KInstructionHook() is called for (see jaguar.c).  Providers
+ * register from M68KHookRebuild(), which runs at every reset. */
+extern bool m68kRegTraceback;
+void M68KHookRegister(uint32_t pc);
+void M68KHookRegisterRange(uint32_t start, uint32_t end);
+void M68KHookRebuild(void);
+
 void JaguarExecuteNew(void);
 
 // Exports from JAGUAR.CPP
@@ -41,6 +41,7 @@
  * silently write into the data segment at the pointer variable itself. */
 extern uint8_t *jaguarMainRAM;
 extern bool jaguarMemTrackInserted;
+void M68KHookRegister(uint32_t pc);
 
 /* --------------------------------------------------------------------
  * Module state (the original keeps this in its BSS at $2400+; ours
@@ -611,6 +612,11 @@ static void read_ram_string(uint32_t addr, char *dst, unsigned max)
    dst[i] = '\0';
 }
 
+void NVMBiosRegisterHooks(void)
+{
+   M68KHookRegister(NVM_DISPATCH_ADDR);
+}
+
 bool NVMBiosHook(uint32_t pc)
 {
    uint32_t sp;
@@ -56,6 +56,7 @@
 void NVMBiosInstall(void);        /* write cookie + RTS stub into main RAM */
 void NVMBiosReset(void);          /* forget runtime state (power-on/reset) */
 bool NVMBiosHook(uint32_t pc);    /* pre-instruction hook for $2404 */
+void NVMBiosRegisterHooks(void);  /* declare $2404 to M68KHookRebuild */
 size_t NVMBiosStateSave(uint8_t *buf);
 size_t NVMBiosStateLoad(const uint8_t *buf);
 
@@ -76,10 +76,11 @@ unsigned long long *perf_counters_find(const char *name);
 #else /* !BENCH_PROFILE */
 
 #define PERF_COUNTER(name) typedef int perf_##name##_unused
-/* No-op forms remain expressions of integer type (not void) so callers
- * can use them inside comma operators without code changes. */
-#define PERF_INC(name)        (0)
-#define PERF_ADD(name, n)     ((void)(n), 0)
+/* No-op forms are void expressions: still fine as the left operand of
+ * a comma, and a bare `PERF_INC(x);` statement does not trip
+ * -Wunused-value.  PERF_ADD still evaluates `n`. */
+#define PERF_INC(name)        ((void)0)
+#define PERF_ADD(name, n)     ((void)(n))
 
 #endif /* BENCH_PROFILE */
 
@@ -0,0 +1,156 @@
+/*
+ * perf_timing.c - region stack and totals for perf_timing.h.
+ *
+ * Each transition reads the clock once: the time since the previous
+ * transition goes to the region on top of the stack, which is the one
+ * that was running.  Nesting deeper than PERF_TIMING_DEPTH (a blit from
+ * a GPU catch-up inside the 68000 is three) is charged to the deepest
+ * region tracked rather than lost.
+ */
+#include <string.h>
+#include "perf_timing.h"
+#include "vjthread.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__APPLE__)
+#include <mach/mach_time.h>
+#else
+#include <time.h>
+#include <sys/time.h>
+#endif
+
+#define PERF_TIMING_DEPTH 8
+
+int perf_timing_armed = 0;
+
+static unsigned long long perf_timing_ns[PERF_T_COUNT];
+static int perf_timing_stack[PERF_TIMING_DEPTH];
+static unsigned perf_timing_depth;
+static unsigned long long perf_timing_last;
+
+static const char *const perf_timing_names[PERF_T_COUNT] =
+{
+   "m68k",
+   "gpu",
+   "dsp",
+   "blitter_fast",
+   "blitter_accurate",
+   "op",
+   "render",
+   "audio_resample",
+   "cd_decode",
+   "savestate"
+};
+
+static unsigned long long perf_timing_now(void)
+{
+#if defined(_WIN32)
+   static LARGE_INTEGER f;   /* frequency is fixed for the process */
+   LARGE_INTEGER c;
+   if (f.QuadPart == 0)
+      QueryPerformanceFrequency(&f);
+   QueryPerformanceCounter(&c);
+   return (unsigned long long)(c.QuadPart / f.QuadPart) * 1000000000ULL
+        + (unsigned long long)(c.QuadPart % f.QuadPart) * 1000000000ULL
+          / (unsigned long long)f.QuadPart;
+#elif defined(__APPLE__)
+   static mach_timebase_info_data_t tb;
+   if (tb.denom == 0)
+      mach_timebase_info(&tb);
+   return (unsigned long long)mach_absolute_time() * tb.numer / tb.denom;
+#else
+#if defined(CLOCK_MONOTONIC)
+   struct timespec ts;
+   if (clock_gettime(CLOCK_MONOTONIC, &ts) == 0)
+      return (unsigned long long)ts.tv_sec * 1000000000ULL
+           + (unsigned long long)ts.tv_nsec;
+#endif
+   {
+      struct timeval tv;
+      gettimeofday(&tv, NULL);
+      return (unsigned long long)tv.tv_sec * 1000000000ULL
+           + (unsigned long long)tv.tv_usec * 1000ULL;
+   }
+#endif
+}
+
+void perf_timing_reset(void)
+{
+   memset(perf_timing_ns, 0, sizeof(perf_timing_ns));
+   perf_timing_depth = 0;
+}
+
+void perf_timing_arm(int armed)
+{
+   if (armed && !perf_timing_armed)
+      perf_timing_reset();
+   perf_timing_armed = armed ? 1 : 0;
+}
+
+/* Charge the time since the last transition to the running region. */
+static void perf_timing_charge(void)
+{
+   unsigned long long now = perf_timing_now();
+   unsigned top;
+
+   if (perf_timing_depth)
+   {
+      top = perf_timing_depth < PERF_TIMING_DEPTH ? perf_timing_depth
+                                                  : PERF_TIMING_DEPTH;
+      perf_timing_ns[perf_timing_stack[top - 1]] += now - perf_timing_last;
+   }
+   perf_timing_last = now;
+}
+
+/* The stack and totals belong to the emulation thread.  A worker that
+ * reaches a region -- the threaded DSP running a blit after it parks --
+ * is not timed; the emulation thread is charging its wait meanwhile. */
+void perf_timing_enter(int region)
+{
+   if (VJThreadIsWorker())
+      return;
+   perf_timing_charge();
+   if (perf_timing_depth < PERF_TIMING_DEPTH)
+      perf_timing_stack[perf_timing_depth] = region;
+   perf_timing_depth++;
+}
+
+void perf_timing_leave(void)
+{
+   /* Armed inside the region: its enter was never seen. */
+   if (!perf_timing_depth || VJThreadIsWorker())
+      return;
+   perf_timing_charge();
+   perf_timing_depth--;
+}
+
+const char *perf_timing_name(unsigned region)
+{
+   return region < PERF_T_COUNT ? perf_timing_names[region]
+                                : (const char *)0;
+}
+
+unsigned long long *perf_timing_find(const char *name)
+{
+   unsigned i;
+
+   if (!name)
+      return (unsigned long long *)0;
+   for (i = 0; i < PERF_T_COUNT; i++)
+      if (strcmp(perf_timing_names[i], name) == 0)
+         return &perf_timing_ns[i];
+   return (unsigned long long *)0;
+}
+
+void perf_timing_dump(FILE *out)
+{
+   unsigned i;
+
+   if (!out)
+      out = stderr;
+   fprintf(out, "[perf] host time by subsystem (ms):\n");
+   for (i = 0; i < PERF_T_COUNT; i++)
+      fprintf(out, "[perf]   %-40s %.3f\n", perf_timing_names[i],
+              (double)perf_timing_ns[i] / 1e6);
+}
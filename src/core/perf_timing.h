@@ -0,0 +1,85 @@
+/*
+ * perf_timing.h - host time spent per subsystem, armed at run time.
+ *
+ * perf_counters.h counts events, and only in BENCH_PROFILE builds.  This
+ * is its timing counterpart: every build carries the regions, and
+ * perf_timing_arm() switches them on.  Disarmed, a region costs one load
+ * and one not-taken branch.
+ *
+ * Usage:
+ *
+ *   #include "perf_timing.h"
+ *
+ *   PERF_TIME_ENTER(PERF_T_OP);
+ *   OPProcessList(halfline, render);
+ *   PERF_TIME_LEAVE();
+ *
+ * Time is exclusive: entering a region pauses the one it nests in, so a
+ * blit the GPU starts is charged to the blitter, not to the GPU, and the
+ * regions add up to no more than the wall time.  Time outside every
+ * region (the event dispatch itself, the frontend callbacks) is charged
+ * to nobody; a harness that also times retro_run() sees it as the gap.
+ *
+ * Only the emulation thread is timed.  Work handed to a worker thread
+ * (the threaded DSP, the scanline render worker, CD read-ahead) is
+ * charged as the time the emulation thread spends handing it over and
+ * waiting for it, and a region the worker itself reaches -- a blit the
+ * threaded DSP starts after it parks -- is skipped there
+ * (VJThreadIsWorker()), so the totals are never written from two
+ * threads.
+ *
+ * Totals are in nanoseconds of a monotonic clock and only ever grow;
+ * a harness snapshots perf_timing_find() before and after retro_run()
+ * for per-frame figures, as with perf_counters_find().
+ *
+ * C89-clean.
+ */
+#ifndef VJ_PERF_TIMING_H
+#define VJ_PERF_TIMING_H
+
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Regions, in the order perf_timing_name() lists them. */
+enum
+{
+   PERF_T_M68K = 0,
+   PERF_T_GPU,
+   PERF_T_DSP,
+   PERF_T_BLIT_FAST,
+   PERF_T_BLIT_ACCURATE,
+   PERF_T_OP,
+   PERF_T_RENDER,
+   PERF_T_AUDIO,
+   PERF_T_CD,
+   PERF_T_STATE,
+   PERF_T_COUNT
+};
+
+extern int perf_timing_armed;
+
+/* Arming resets the totals; disarming keeps them for reading. */
+void perf_timing_arm(int armed);
+void perf_timing_reset(void);
+void perf_timing_enter(int region);
+void perf_timing_leave(void);
+
+/* Region names ("m68k", "gpu", ...); NULL past PERF_T_COUNT. */
+const char *perf_timing_name(unsigned region);
+/* Return a pointer to the named region's total, or NULL if unknown. */
+unsigned long long *perf_timing_find(const char *name);
+void perf_timing_dump(FILE *out);
+
+#define PERF_TIME_ENTER(region) \
+   do { if (perf_timing_armed) perf_timing_enter(region); } while (0)
+#define PERF_TIME_LEAVE() \
+   do { if (perf_timing_armed) perf_timing_leave(); } while (0)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VJ_PERF_TIMING_H */
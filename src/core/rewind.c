@@ -0,0 +1,295 @@
+/*
+ * rewind.c: in-core rewind history -- compressed XOR deltas in a byte
+ * ring.  See rewind.h.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "rewind.h"
+#include "perf_counters.h"
+
+PERF_COUNTER(rewind_commits);
+PERF_COUNTER(rewind_steps);
+PERF_COUNTER(rewind_evicted);
+
+/* miniz, compiled into deps/libchdr/unity.o with -DMINIZ_DEFLATE_APIS.
+ * Local prototypes as in src/tom/texdump.c. */
+size_t tdefl_compress_mem_to_mem(void *pOut_buf, size_t out_buf_len,
+      const void *pSrc_buf, size_t src_buf_len, int flags);
+size_t tinfl_decompress_mem_to_mem(void *pOut_buf, size_t out_buf_len,
+      const void *pSrc_buf, size_t src_buf_len, int flags);
+
+#define TDEFL_FASTEST         (0x04000 | 1)   /* greedy parsing, one probe */
+#define TINFL_MEM_FAILED      ((size_t)-1)
+
+#define REWIND_BLOCK          256             /* bytes per bitmap bit */
+#define REWIND_MAX_ENTRIES    65536
+
+/* Entry payload, first byte. */
+#define REWIND_RAW            0
+#define REWIND_DEFLATE        1
+
+typedef struct
+{
+   uint32_t off;
+   uint32_t len;
+} RewindEntry;
+
+static size_t       stateBytes;
+static size_t       bitmapBytes;
+static size_t       packMax;
+
+static uint64_t    *head;        /* newest state */
+static uint64_t    *scratch;     /* capture buffer, then the delta */
+static uint8_t     *pack;        /* bitmap + changed blocks */
+
+static uint8_t     *ring;
+static size_t       ringSize;
+static size_t       wpos;
+
+static RewindEntry *entries;
+static unsigned     entOldest;
+static unsigned     entCount;
+static size_t       bytesUsed;
+
+static bool         haveHead;
+
+void RewindFree(void)
+{
+   free(head);
+   free(scratch);
+   free(pack);
+   free(ring);
+   free(entries);
+   head = scratch = NULL;
+   pack = ring = NULL;
+   entries = NULL;
+   stateBytes = ringSize = 0;
+   RewindClear();
+}
+
+void RewindClear(void)
+{
+   entOldest = entCount = 0;
+   wpos = bytesUsed = 0;
+   haveHead = false;
+}
+
+bool RewindConfigure(size_t stateSize, size_t budget)
+{
+   size_t fixed;
+
+   RewindFree();
+   if (budget == 0 || stateSize == 0 || (stateSize % REWIND_BLOCK) != 0)
+      return budget == 0;
+
+   bitmapBytes = stateSize / REWIND_BLOCK / 8 + 1;
+   packMax     = bitmapBytes + stateSize;
+   fixed       = 2 * stateSize + packMax
+               + REWIND_MAX_ENTRIES * sizeof(RewindEntry);
+   /* Room for at least a few full-size deltas, or it is not a history. */
+   if (budget < fixed + 4 * (packMax + 1))
+      return false;
+
+   head     = (uint64_t *)calloc(1, stateSize);
+   scratch  = (uint64_t *)calloc(1, stateSize);
+   pack     = (uint8_t *)malloc(packMax);
+   entries  = (RewindEntry *)malloc(REWIND_MAX_ENTRIES * sizeof(RewindEntry));
+   ringSize = budget - fixed;
+   ring     = (uint8_t *)malloc(ringSize);
+   if (!head || !scratch || !pack || !entries || !ring)
+   {
+      RewindFree();
+      return false;
+   }
+   stateBytes = stateSize;
+   return true;
+}
+
+uint8_t *RewindCaptureBuffer(void)
+{
+   return (uint8_t *)scratch;
+}
+
+static void DropOldest(void)
+{
+   bytesUsed -= entries[entOldest].len;
+   entOldest = (entOldest + 1) % REWIND_MAX_ENTRIES;
+   if (--entCount == 0)
+      wpos = 0;
+   PERF_INC(rewind_evicted);
+}
+
+/* Where a new entry of len bytes goes, evicting the oldest until it
+ * fits.  Entries sit in capture order around the ring, so the free space
+ * is always [wpos, oldest) cyclically. */
+static size_t Reserve(size_t len)
+{
+   if (entCount == REWIND_MAX_ENTRIES)
+      DropOldest();
+
+   for (;;)
+   {
+      size_t o;
+
+      if (entCount == 0)
+         return 0;
+
+      o = entries[entOldest].off;
+      if (wpos > o)
+      {
+         if (len <= ringSize - wpos)
+            return wpos;
+         if (len <= o)
+            return 0;
+      }
+      else if (len <= o - wpos)
+         return wpos;
+
+      DropOldest();
+   }
+}
+
+void RewindCommit(void)
+{
+   const size_t words = REWIND_BLOCK / 8;
+   size_t nblocks, b, packed, stored;
+   uint8_t *bitmap, *dst;
+   bool deflated;
+   unsigned idx;
+
+   if (!ring)
+      return;
+   PERF_INC(rewind_commits);
+
+   if (!haveHead)
+   {
+      memcpy(head, scratch, stateBytes);
+      haveHead = true;
+      return;
+   }
+
+   /* One pass: scratch becomes the delta, head the new state, and every
+    * block with a nonzero delta is appended to the pack. */
+   nblocks = stateBytes / REWIND_BLOCK;
+   bitmap  = pack;
+   memset(bitmap, 0, bitmapBytes);
+   packed  = bitmapBytes;
+   for (b = 0; b < nblocks; b++)
+   {
+      uint64_t *h = head + b * words;
+      uint64_t *s = scratch + b * words;
+      uint64_t any = 0;
+      size_t w;
+
+      for (w = 0; w < words; w++)
+      {
+         uint64_t n = s[w];
+         uint64_t d = n ^ h[w];
+         h[w] = n;
+         s[w] = d;
+         any |= d;
+      }
+      if (any)
+      {
+         bitmap[b >> 3] |= (uint8_t)(1u << (b & 7));
+         memcpy(pack + packed, s, REWIND_BLOCK);
+         packed += REWIND_BLOCK;
+      }
+   }
+
+   /* The delta is in the pack now; scratch is free to hold the output. */
+   dst    = (uint8_t *)scratch;
+   stored = tdefl_compress_mem_to_mem(dst + 1, stateBytes - 1, pack, packed,
+         TDEFL_FASTEST);
+   /* Incompressible (or larger than a state): keep the pack raw. */
+   deflated = (stored != 0);
+   if (deflated)
+      dst[0] = REWIND_DEFLATE;
+   stored = deflated ? stored + 1 : packed + 1;
+
+   if (stored > ringSize)
+   {
+      /* Cannot be held at all: the chain is broken here. */
+      entOldest = entCount = 0;
+      wpos = bytesUsed = 0;
+      return;
+   }
+
+   idx = (entOldest + entCount) % REWIND_MAX_ENTRIES;
+   entries[idx].off = (uint32_t)Reserve(stored);
+   entries[idx].len = (uint32_t)stored;
+   if (deflated)
+      memcpy(ring + entries[idx].off, dst, stored);
+   else
+   {
+      ring[entries[idx].off] = REWIND_RAW;
+      memcpy(ring + entries[idx].off + 1, pack, packed);
+   }
+   wpos = entries[idx].off + stored;
+   entCount++;
+   bytesUsed += stored;
+}
+
+const uint8_t *RewindStepBack(void)
+{
+   const RewindEntry *e;
+   const uint8_t *data, *blk;
+   size_t nblocks, b, unpacked;
+   const size_t words = REWIND_BLOCK / 8;
+   unsigned idx;
+
+   if (!ring || entCount == 0)
+      return NULL;
+   PERF_INC(rewind_steps);
+
+   idx  = (entOldest + entCount - 1) % REWIND_MAX_ENTRIES;
+   e    = &entries[idx];
+   data = ring + e->off;
+
+   if (data[0] == REWIND_DEFLATE)
+   {
+      unpacked = tinfl_decompress_mem_to_mem(pack, packMax, data + 1,
+            e->len - 1, 0);
+      if (unpacked == TINFL_MEM_FAILED || unpacked < bitmapBytes)
+      {
+         RewindClear();
+         return NULL;
+      }
+   }
+   else
+      memcpy(pack, data + 1, e->len - 1);
+
+   nblocks = stateBytes / REWIND_BLOCK;
+   blk     = pack + bitmapBytes;
+   for (b = 0; b < nblocks; b++)
+   {
+      if (pack[b >> 3] & (1u << (b & 7)))
+      {
+         uint64_t *h = head + b * words;
+         uint64_t d[REWIND_BLOCK / 8];
+         size_t w;
+
+         memcpy(d, blk, REWIND_BLOCK);
+         for (w = 0; w < words; w++)
+            h[w] ^= d[w];
+         blk += REWIND_BLOCK;
+      }
+   }
+
+   entCount--;
+   bytesUsed -= e->len;
+   wpos = entCount ? e->off : 0;
+   return (const uint8_t *)head;
+}
+
+unsigned RewindDepth(void)
+{
+   return entCount;
+}
+
+size_t RewindBytesUsed(void)
+{
+   return bytesUsed;
+}
@@ -0,0 +1,59 @@
+/*
+ * rewind.h: in-core rewind history.
+ *
+ * A frontend's generic rewind keeps whole state blobs; at 2.5 MB each
+ * that is most of a gigabyte for ten seconds.  This keeps one full state
+ * (the newest) plus a ring of compressed XOR deltas, each turning a state
+ * back into the one captured before it:
+ *
+ *    delta[n] = state[n-1] ^ state[n]
+ *
+ * Stepping back is one inflate and one XOR into the head regardless of
+ * how much history is kept; when the byte budget is full the oldest
+ * delta is dropped, which only forgets the oldest state.
+ *
+ * A delta is mostly zero, so it is stored as a bitmap of the 256-byte
+ * blocks that changed followed by those blocks, the pair deflated with
+ * miniz at its fastest setting (deps/libchdr/unity.c, MINIZ_DEFLATE_APIS).
+ *
+ * The module only moves bytes; libretro.c serializes into
+ * RewindCaptureBuffer() and unserializes what RewindStepBack() returns.
+ * History is host-side bookkeeping and is never part of a savestate.
+ */
+#ifndef __REWIND_H__
+#define __REWIND_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <boolean.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* (Re)size for states of stateSize bytes and a history of at most
+ * budget bytes, working buffers included.  Drops history; false when
+ * the budget cannot hold a few full-size deltas.  budget == 0 frees
+ * everything. */
+bool     RewindConfigure(size_t stateSize, size_t budget);
+void     RewindFree(void);
+
+/* Forget history; the next commit starts a new chain. */
+void     RewindClear(void);
+
+/* Capture: serialize into the buffer, then commit it as the newest state. */
+uint8_t *RewindCaptureBuffer(void);
+void     RewindCommit(void);
+
+/* Drop the newest state and return the one captured before it, which
+ * becomes the head; NULL when nothing older is held. */
+const uint8_t *RewindStepBack(void);
+
+unsigned RewindDepth(void);          /* states reachable by stepping back */
+size_t   RewindBytesUsed(void);      /* compressed deltas currently held */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __REWIND_H__ */
@@ -0,0 +1,164 @@
+/*
+ * risc_block.h — pre-decoded instruction stream and straight-line
+ * "superblock" discovery shared by the two Jaguar RISC interpreters
+ * (GPU in src/tom/gpu.c, DSP in src/jerry/dsp.c).
+ *
+ * Each core keeps one RISCDecodedOp per 16-bit word of its local RAM,
+ * kept coherent WRITE-THROUGH: every store into local RAM calls
+ * RISCDecodeRange() on the bytes it touched, so an entry is never
+ * stale and the fetch side tests no valid bit (see the comment on
+ * gpu_decoded in gpu.c).
+ *
+ * On top of the plain decode, each entry records the straight-line run
+ * that starts at it: how many consecutive instructions from here are
+ * "straight" (touch only registers, flags and the MAC accumulator --
+ * no memory access, no branch, no PC-relative immediate fetch, no
+ * control-register write) and their summed base cycles.  Nothing in
+ * such a run can raise or mask an interrupt, stop the core, stall on
+ * the bus or change the instruction stream, so the exec loop may run
+ * the whole run back-to-back and charge its cycle total once, with no
+ * per-instruction bookkeeping, whenever the slice budget covers it.
+ * Runs are capped at RISC_RUN_MAX instructions so a store only ever
+ * re-links a bounded stretch behind the word it changed.
+ *
+ * Which opcodes are straight is per core (the GPU and DSP opcode maps
+ * differ in slots 32/33, 42, 48, 62 and 63); each core passes its own
+ * 64-entry table.  The execution loop itself also stays in each core,
+ * because it has to reach the core's static computed-goto dispatch.
+ *
+ * Everything here is derived from local RAM and is never serialized.
+ * Static inline for the same reason as blitter_simd_*.h: these sit on
+ * the local-RAM store path and the exec loop, and there is no LTO on
+ * the desktop targets.
+ */
+
+#ifndef RISC_BLOCK_H
+#define RISC_BLOCK_H
+
+#include <stdint.h>
+#include <retro_inline.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Longest run one RISCDecodedOp will describe. */
+#define RISC_RUN_MAX 32
+
+typedef struct
+{
+   uint8_t  index;      /* opcode >> 10: dispatch slot */
+   uint8_t  reg1;       /* (opcode >> 5) & 0x1F: IMM_1 / RM */
+   uint8_t  reg2;       /* opcode & 0x1F: IMM_2 / RN */
+   uint8_t  cycles;     /* <core>_opcode_cycles[index] */
+   uint8_t  run;        /* straight instructions starting here; 0 = not straight */
+   uint8_t  pad;
+   uint16_t run_cycles; /* summed cycles of those `run` instructions */
+} RISCDecodedOp;
+
+typedef struct
+{
+   RISCDecodedOp *ops;        /* one per local-RAM word */
+   const uint8_t *ram;        /* local RAM, big-endian words */
+   uint32_t       words;      /* entries in ops[]; a power of two */
+   const uint8_t *cycles;     /* [64] base cost per opcode */
+   const uint8_t *straight;   /* [64] non-zero = straight (see above) */
+} RISCDecodeTable;
+
+/* Re-split word w of local RAM into ops[w] (run fields untouched). */
+static INLINE void RISCDecodeWord(const RISCDecodeTable *t, uint32_t w)
+{
+   uint16_t       opcode = ((uint16_t)t->ram[w << 1] << 8) | (uint16_t)t->ram[(w << 1) + 1];
+   RISCDecodedOp *op     = &t->ops[w];
+
+   op->index  = (uint8_t)(opcode >> 10);
+   op->reg1   = (uint8_t)((opcode >> 5) & 0x1F);
+   op->reg2   = (uint8_t)(opcode & 0x1F);
+   op->cycles = t->cycles[opcode >> 10];
+}
+
+/* Recompute ops[w]'s run from ops[w + 1]'s.  A run never continues past
+ * the end of local RAM: the PC leaves the table there.  Returns non-zero
+ * if the entry changed. */
+static INLINE int RISCLinkWord(const RISCDecodeTable *t, uint32_t w)
+{
+   RISCDecodedOp *op  = &t->ops[w];
+   uint8_t        run = 0;
+   uint16_t       cyc = 0;
+
+   if (t->straight[op->index])
+   {
+      const RISCDecodedOp *next = (w + 1 < t->words) ? op + 1 : NULL;
+
+      if (!next || !next->run)
+      {
+         run = 1;
+         cyc = op->cycles;
+      }
+      else if (next->run < RISC_RUN_MAX)
+      {
+         run = (uint8_t)(next->run + 1);
+         cyc = (uint16_t)(op->cycles + next->run_cycles);
+      }
+      else
+      {
+         /* next's run is full: ours drops its last instruction. */
+         run = RISC_RUN_MAX;
+         cyc = (uint16_t)(op->cycles + next->run_cycles - op[RISC_RUN_MAX].cycles);
+      }
+   }
+
+   if (op->run == run && op->run_cycles == cyc)
+      return 0;
+   op->run        = run;
+   op->run_cycles = cyc;
+   return 1;
+}
+
+/* Re-decode words [first, last] (no wrap) and re-link every run that
+ * can reach them: the span itself back to front, then backwards.  The
+ * walk stops at a non-straight entry (no run crosses it), or at an
+ * unchanged entry once it is more than RISC_RUN_MAX words in front of
+ * the span -- closer than that, a capped run can still have dropped a
+ * span word's cycles off its far end without its own fields changing.
+ * A full rebuild (first == 0) has nothing in front of it to walk. */
+static INLINE void RISCDecodeSpan(const RISCDecodeTable *t, uint32_t first, uint32_t last)
+{
+   uint32_t w;
+
+   for (w = first; w <= last; w++)
+      RISCDecodeWord(t, w);
+   for (w = last + 1; w-- > first; )
+      RISCLinkWord(t, w);
+   for (w = first; w-- > 0; )
+   {
+      int changed = RISCLinkWord(t, w);
+      if (!t->ops[w].run || (!changed && w + RISC_RUN_MAX < first))
+         break;
+   }
+}
+
+/* Bring the table up to date after a store to local-RAM bytes
+ * [off, off + len).  Word indices wrap like the cores' byte offsets do
+ * (GPUWriteWord at $FFF stores its low byte at $000). */
+static INLINE void RISCDecodeRange(const RISCDecodeTable *t, uint32_t off, uint32_t len)
+{
+   uint32_t first = (off >> 1) & (t->words - 1);
+   uint32_t count = ((off + len - 1) >> 1) - (off >> 1) + 1;
+
+   if (count > t->words)
+      count = t->words;
+   if (first + count > t->words)
+   {
+      RISCDecodeSpan(t, 0, first + count - t->words - 1);
+      RISCDecodeSpan(t, first, t->words - 1);
+   }
+   else
+      RISCDecodeSpan(t, first, first + count - 1);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RISC_BLOCK_H */
@@ -0,0 +1,138 @@
+/*
+ * risc_idle.h — idle-loop skipping shared by the two Jaguar RISC
+ * interpreters (GPU in src/tom/gpu.c, DSP in src/jerry/dsp.c).
+ *
+ * Titles park the GPU or DSP in short polling loops (`load (r1),r2;
+ * cmpq #0,r2; jr EQ,loop; nop`, or a bare `jr T,self` waiting for an
+ * interrupt) and burn the rest of the slice there.  Nothing else runs
+ * while one <core>Exec() call is in progress: the 68000 writes that the
+ * loop might be waiting for split the slice into separate calls
+ * (GPUSyncToM68K / DSPSyncToM68K), interrupts arrive between calls, and
+ * the threaded DSP rolls its whole slice back on any conflict.  So
+ * within one call, an iteration that
+ *
+ *   - stores nothing,
+ *   - loads only from local RAM or plain main RAM (no I/O register, no
+ *     watched page: nothing whose value or side effects depend on time),
+ *   - runs nothing that touches state outside the registers, flags, MAC
+ *     accumulator and divide remainder,
+ *
+ * and arrives back at its head with that state unchanged is a fixed
+ * point: every further iteration in the call replays it exactly, at the
+ * same cost (the bus cost of a load depends only on its address).  The
+ * core checks the first three conditions per instruction while a head
+ * is watched and gives up on the loop at the first violation; this
+ * header does the rest.
+ *
+ * The skip charges whole iterations in one step and leaves 1..`per`
+ * cycles of budget, so the last iteration still runs for real and the
+ * call ends on the same instruction, with the same budget left over,
+ * as running every iteration would.  The liveness count moves on by
+ * the skipped iterations' opcodes too.
+ *
+ * Loops whose state moves (a counter, a pointer walk) fail the compare;
+ * the watch then ignores the next RISC_IDLE_BACKOFF backward branches
+ * so a busy inner loop pays for one snapshot in that many iterations.
+ *
+ * Host-side only: the watch is reset at every <core>Exec() entry and
+ * never serialized.
+ */
+
+#ifndef RISC_IDLE_H
+#define RISC_IDLE_H
+
+#include <stdint.h>
+#include <string.h>
+#include <retro_inline.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Longest loop watched: branch to head, in bytes. */
+#define RISC_IDLE_SPAN      64
+/* Backward branches ignored after a loop turned out not to be idle. */
+#define RISC_IDLE_BACKOFF   16
+/* Words of packed core state compared at the head. */
+#define RISC_IDLE_STATE     72
+
+typedef struct
+{
+   uint32_t head;       /* loop head being watched; 0 = none */
+   uint32_t backoff;    /* backward branches left to ignore */
+   int32_t  cycles;     /* slice budget left at the head */
+   uint32_t opcodes;    /* liveness count at the head */
+   uint32_t state[RISC_IDLE_STATE];
+   uint64_t skipped;    /* cycles skipped (statistics) */
+   uint32_t skips;      /* skips taken (statistics) */
+} RISCIdleWatch;
+
+/* Forget the watched loop; <core>Exec() entry. */
+static INLINE void RISCIdleReset(RISCIdleWatch *w)
+{
+   w->head    = 0;
+   w->backoff = 0;
+}
+
+/* The watched iteration did something a replay could not reproduce. */
+static INLINE void RISCIdleAbandon(RISCIdleWatch *w)
+{
+   w->head    = 0;
+   w->backoff = RISC_IDLE_BACKOFF;
+}
+
+/* A short backward branch just landed on `pc`: does RISCIdleBranch()
+ * want the core's state?  No while backing off from a busy loop, which
+ * is what keeps those cheap. */
+static INLINE int RISCIdleWanted(RISCIdleWatch *w, uint32_t pc)
+{
+   if (w->head == pc || !w->backoff)
+      return 1;
+   w->backoff--;
+   return 0;
+}
+
+/* ... and `cycles` of budget are left; `state` is the core's packed
+ * state (unused words zero).  Returns the cycles to take off the
+ * budget; *opcodes has then already moved on by the skipped
+ * iterations. */
+static INLINE int32_t RISCIdleBranch(RISCIdleWatch *w, uint32_t pc,
+      int32_t cycles, uint32_t *opcodes, const uint32_t *state)
+{
+   int32_t  per, iters;
+   uint32_t ops;
+
+   if (w->head != pc)
+   {
+      w->head    = pc;
+      w->cycles  = cycles;
+      w->opcodes = *opcodes;
+      memcpy(w->state, state, sizeof(w->state));
+      return 0;
+   }
+
+   per = w->cycles - cycles;
+   if (per <= 0 || memcmp(w->state, state, sizeof(w->state)) != 0)
+   {
+      RISCIdleAbandon(w);
+      return 0;
+   }
+
+   ops        = *opcodes - w->opcodes;
+   iters      = cycles > 0 ? (cycles - 1) / per : 0;
+   *opcodes  += (uint32_t)iters * ops;
+   w->opcodes = *opcodes;
+   w->cycles  = cycles - iters * per;
+   if (iters)
+   {
+      w->skipped += (uint64_t)iters * (uint32_t)per;
+      w->skips++;
+   }
+   return iters * per;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RISC_IDLE_H */
@@ -0,0 +1,444 @@
+/*
+ * risc_jit.c - x86-64 code generator for straight-line GPU/DSP runs.
+ * See risc_jit.h for the model (what a block is, who charges cycles,
+ * how blocks are invalidated).
+ *
+ * Generated code keeps no Jaguar state in host registers across
+ * instructions: every operand is read from and written back to the
+ * register bank, and each flag byte is stored as soon as it is produced.
+ * That costs a few loads a block could otherwise avoid, but it means a
+ * handler call in the middle of a block needs no spill/reload and sees
+ * exactly the state the interpreter would.
+ *
+ * Host register use (all callee-saved, so handler calls preserve them):
+ *    rbx  current bank            r13  &flag_z
+ *    r12  alternate bank          r14  &flag_n
+ *                                 r15  &flag_c
+ * eax/ecx are scratch.  Five pushes after the return address leave rsp
+ * 16-byte aligned for the handler calls.
+ *
+ * The functions are always defined so the rest of the core needs no
+ * #ifdefs; without RISC_JIT_X64 RISCJitEnable() just reports failure.
+ */
+#include <string.h>
+#include "risc_jit.h"
+
+#ifdef RISC_JIT_X64
+
+#include <sys/mman.h>
+
+#ifndef MAP_ANONYMOUS
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+
+#define RISC_JIT_CODE_SIZE (1024 * 1024)
+/* Upper bound on one block: prologue/epilogue plus the longest op
+ * sequence (a handler call, 44 bytes) for every instruction. */
+#define RISC_JIT_BLOCK_MAX (64 + RISC_RUN_MAX * 48)
+
+#define HR_EAX 0
+#define HR_ECX 1
+#define HR_EBX 3
+#define HR_R12 12
+#define HR_R13 13
+#define HR_R14 14
+#define HR_R15 15
+
+#define BANK   HR_EBX
+#define ALT    HR_R12
+#define FLAG_Z HR_R13
+#define FLAG_N HR_R14
+#define FLAG_C HR_R15
+
+/* setcc condition nibbles */
+#define CC_C   0x2
+#define CC_NC  0x3
+#define CC_Z   0x4
+#define CC_S   0x8
+
+/* group-1 ALU /digit and the matching "op r32, r/m32" opcode */
+#define ALU_ADD 0
+#define ALU_OR  1
+#define ALU_AND 4
+#define ALU_SUB 5
+#define ALU_CMP 7
+
+#define SH_ROR 1
+#define SH_SHL 4
+#define SH_SHR 5
+#define SH_SAR 7
+
+/* Output cursor; one per compile so the two cores never share one. */
+typedef struct
+{
+   uint8_t *p;
+} RISCJitEmit;
+
+static void emit8(RISCJitEmit *e, uint8_t b)
+{
+   *e->p++ = b;
+}
+
+static void emit32(RISCJitEmit *e, uint32_t v)
+{
+   emit8(e, (uint8_t)v);
+   emit8(e, (uint8_t)(v >> 8));
+   emit8(e, (uint8_t)(v >> 16));
+   emit8(e, (uint8_t)(v >> 24));
+}
+
+static void emit64(RISCJitEmit *e, uint64_t v)
+{
+   emit32(e, (uint32_t)v);
+   emit32(e, (uint32_t)(v >> 32));
+}
+
+/* opcode (one byte, or 0x0Fxx) with a ModRM memory operand [base + disp]. */
+static void emit_mem(RISCJitEmit *e, uint32_t opc, int reg, int base, int32_t disp)
+{
+   uint8_t rex = 0x40 | ((reg & 8) ? 4 : 0) | ((base & 8) ? 1 : 0);
+   uint8_t mod;
+
+   if (rex != 0x40)
+      emit8(e, rex);
+   if (opc > 0xFF)
+      emit8(e, (uint8_t)(opc >> 8));
+   emit8(e, (uint8_t)opc);
+
+   if (disp == 0 && (base & 7) != 5)
+      mod = 0x00;
+   else if (disp >= -128 && disp <= 127)
+      mod = 0x40;
+   else
+      mod = 0x80;
+   emit8(e, mod | ((reg & 7) << 3) | (base & 7));
+   if ((base & 7) == 4)
+      emit8(e, 0x24);                      /* SIB: [base] */
+   if (mod == 0x40)
+      emit8(e, (uint8_t)disp);
+   else if (mod == 0x80)
+      emit32(e, (uint32_t)disp);
+}
+
+/* opcode (one byte, or 0x0Fxx) with a register-direct ModRM (eax..edi). */
+static void emit_reg(RISCJitEmit *e, uint32_t opc, int reg, int rm)
+{
+   if (opc > 0xFF)
+      emit8(e, (uint8_t)(opc >> 8));
+   emit8(e, (uint8_t)opc);
+   emit8(e, 0xC0 | ((reg & 7) << 3) | (rm & 7));
+}
+
+static void emit_mov_imm64(RISCJitEmit *e, int hr, uint64_t v)
+{
+   emit8(e, 0x48 | ((hr & 8) ? 1 : 0));    /* REX.W */
+   emit8(e, 0xB8 + (hr & 7));
+   emit64(e, v);
+}
+
+#define LOAD(hr, base, r)   emit_mem(e, 0x8B, (hr), (base), (int32_t)(r) * 4)
+#define STORE(base, r, hr)  emit_mem(e, 0x89, (hr), (base), (int32_t)(r) * 4)
+/* op eax, [bank + 4*r] for a group-1 ALU op */
+#define ALU_MEM(alu, r)     emit_mem(e, ((alu) << 3) | 0x03, HR_EAX, BANK, (int32_t)(r) * 4)
+#define SETCC(cc, flag)     emit_mem(e, 0x0F90 | (cc), 0, (flag), 0)
+
+static void set_zn(RISCJitEmit *e)
+{
+   SETCC(CC_Z, FLAG_Z);
+   SETCC(CC_S, FLAG_N);
+}
+
+static void set_znc(RISCJitEmit *e)
+{
+   set_zn(e);
+   SETCC(CC_C, FLAG_C);
+}
+
+/* alu eax, imm */
+static void alu_imm(RISCJitEmit *e, int alu, int32_t imm)
+{
+   if (imm >= -128 && imm <= 127)
+   {
+      emit_reg(e, 0x83, alu, HR_EAX);
+      emit8(e, (uint8_t)imm);
+   }
+   else
+   {
+      emit_reg(e, 0x81, alu, HR_EAX);
+      emit32(e, (uint32_t)imm);
+   }
+}
+
+static void shift_imm(RISCJitEmit *e, int sh, uint32_t k)
+{
+   emit_reg(e, 0xC1, sh, HR_EAX);
+   emit8(e, (uint8_t)k);
+}
+
+/* bt eax, bit; setc [flag_c] -- the pre-shift carry of the q-shifts. */
+static void carry_from_bit(RISCJitEmit *e, uint32_t bit)
+{
+   emit_reg(e, 0x0FBA, 4, HR_EAX);
+   emit8(e, (uint8_t)bit);
+   SETCC(CC_C, FLAG_C);
+}
+
+/* CF = flag_c, ready for adc/sbb.  The interpreters only ever store 0/1. */
+static void load_carry(RISCJitEmit *e)
+{
+   emit_mem(e, 0x0FB6, HR_ECX, FLAG_C, 0);  /* movzx ecx, byte [flag_c] */
+   emit_reg(e, 0xF7, 3, HR_ECX);            /* neg ecx: CF = (ecx != 0) */
+}
+
+static void test_eax(RISCJitEmit *e)
+{
+   emit_reg(e, 0x85, HR_EAX, HR_EAX);
+}
+
+static void call_handler(RISCJitEmit *e, const RISCJit *j, const RISCDecodedOp *op)
+{
+   emit_mov_imm64(e, HR_EAX, (uint64_t)(uintptr_t)j->param1);
+   emit_mem(e, 0xC7, 0, HR_EAX, 0);
+   emit32(e, op->reg1);
+   emit_mov_imm64(e, HR_EAX, (uint64_t)(uintptr_t)j->param2);
+   emit_mem(e, 0xC7, 0, HR_EAX, 0);
+   emit32(e, op->reg2);
+   emit_mov_imm64(e, HR_EAX, (uint64_t)(uintptr_t)j->handlers[op->index]);
+   emit_reg(e, 0xFF, 2, HR_EAX);            /* call rax */
+}
+
+/* Emit one instruction; `pc` is its own address.  Each case mirrors the
+ * interpreter handler of the same slot, which is identical in gpu.c and
+ * dsp.c for every slot handled inline here. */
+static void emit_op(RISCJitEmit *e, const RISCJit *j, const RISCDecodedOp *op, uint32_t pc)
+{
+   uint32_t rm = op->reg1, rn = op->reg2, imm = op->reg1;
+   uint32_t qimm = imm ? imm : 32;       /* <core>_convert_zero[] */
+
+   switch (op->index)
+   {
+      case 0:  /* add */
+      case 4:  /* sub */
+         LOAD(HR_EAX, BANK, rn);
+         ALU_MEM(op->index ? ALU_SUB : ALU_ADD, rm);
+         STORE(BANK, rn, HR_EAX);
+         set_znc(e);
+         break;
+      case 1:  /* addc */
+      case 5:  /* subc: RN + ~RM + !C with inverted carry out == sbb */
+         load_carry(e);
+         LOAD(HR_EAX, BANK, rn);
+         emit_mem(e, op->index == 1 ? 0x13 : 0x1B, HR_EAX, BANK, (int32_t)rm * 4);
+         STORE(BANK, rn, HR_EAX);
+         set_znc(e);
+         break;
+      case 2:  /* addq */
+      case 6:  /* subq */
+         LOAD(HR_EAX, BANK, rn);
+         alu_imm(e, op->index == 2 ? ALU_ADD : ALU_SUB, (int32_t)qimm);
+         STORE(BANK, rn, HR_EAX);
+         set_znc(e);
+         break;
+      case 3:  /* addqt */
+      case 7:  /* subqt */
+         emit_mem(e, 0x83, op->index == 3 ? ALU_ADD : ALU_SUB, BANK, (int32_t)rn * 4);
+         emit8(e, (uint8_t)qimm);
+         break;
+      case 8:  /* neg: C = (RN != 0), as SET_ZNC_SUB(0, RN, res) */
+         LOAD(HR_EAX, BANK, rn);
+         emit_reg(e, 0xF7, 3, HR_EAX);
+         STORE(BANK, rn, HR_EAX);
+         set_znc(e);
+         break;
+      case 9:  /* and */
+      case 10: /* or */
+      case 11: /* xor */
+         LOAD(HR_EAX, BANK, rn);
+         emit_mem(e, op->index == 9 ? 0x23 : op->index == 10 ? 0x0B : 0x33,
+               HR_EAX, BANK, (int32_t)rm * 4);
+         STORE(BANK, rn, HR_EAX);
+         set_zn(e);
+         break;
+      case 12: /* not */
+         LOAD(HR_EAX, BANK, rn);
+         emit_reg(e, 0xF7, 2, HR_EAX);
+         STORE(BANK, rn, HR_EAX);
+         test_eax(e);
+         set_zn(e);
+         break;
+      case 13: /* btst: Z = !bit */
+         emit_mem(e, 0x0FBA, 4, BANK, (int32_t)rn * 4);
+         emit8(e, (uint8_t)imm);
+         SETCC(CC_NC, FLAG_Z);
+         break;
+      case 14: /* bset */
+      case 15: /* bclr */
+         LOAD(HR_EAX, BANK, rn);
+         if (op->index == 14)
+            alu_imm(e, ALU_OR, (int32_t)(1u << imm));
+         else
+            alu_imm(e, ALU_AND, (int32_t)~(1u << imm));
+         STORE(BANK, rn, HR_EAX);
+         set_zn(e);
+         break;
+      case 24: /* shlq: shift by 32 - imm, C = old bit 31 */
+      case 25: /* shrq: C = old bit 0 */
+      case 27: /* sharq: C = old bit 0 */
+         if (imm == 0)
+         {
+            /* A 32-bit shift: leave it to the handler's own C semantics. */
+            call_handler(e, j, op);
+            break;
+         }
+         LOAD(HR_EAX, BANK, rn);
+         carry_from_bit(e, op->index == 24 ? 31 : 0);
+         shift_imm(e, op->index == 24 ? SH_SHL : op->index == 25 ? SH_SHR : SH_SAR,
+               op->index == 24 ? 32 - imm : imm);
+         STORE(BANK, rn, HR_EAX);
+         set_zn(e);
+         break;
+      case 29: /* rorq: C = old bit 31; rotate count imm & 31 */
+         LOAD(HR_EAX, BANK, rn);
+         carry_from_bit(e, 31);
+         if (imm & 31)
+            shift_imm(e, SH_ROR, imm & 31);
+         STORE(BANK, rn, HR_EAX);
+         test_eax(e);
+         set_zn(e);
+         break;
+      case 30: /* cmp */
+         LOAD(HR_EAX, BANK, rn);
+         ALU_MEM(ALU_CMP, rm);
+         set_znc(e);
+         break;
+      case 31: /* cmpq: signed 5-bit immediate */
+         LOAD(HR_EAX, BANK, rn);
+         alu_imm(e, ALU_CMP, (imm & 0x10) ? (int32_t)imm - 32 : (int32_t)imm);
+         set_znc(e);
+         break;
+      case 34: /* move */
+         LOAD(HR_EAX, BANK, rm);
+         STORE(BANK, rn, HR_EAX);
+         break;
+      case 35: /* moveq */
+         emit_mem(e, 0xC7, 0, BANK, (int32_t)rn * 4);
+         emit32(e, imm);
+         break;
+      case 36: /* moveta */
+         LOAD(HR_EAX, BANK, rm);
+         STORE(ALT, rn, HR_EAX);
+         break;
+      case 37: /* movefa */
+         LOAD(HR_EAX, ALT, rm);
+         STORE(BANK, rn, HR_EAX);
+         break;
+      case 51: /* move pc: the instruction's own address */
+         emit_mem(e, 0xC7, 0, BANK, (int32_t)rn * 4);
+         emit32(e, pc);
+         break;
+      case 57: /* nop */
+         break;
+      default:
+         call_handler(e, j, op);
+         break;
+   }
+}
+
+int RISCJitEnable(RISCJit *j)
+{
+   if (!j->code)
+   {
+      void *p = mmap(NULL, RISC_JIT_CODE_SIZE, PROT_READ | PROT_WRITE | PROT_EXEC,
+            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (p == MAP_FAILED)
+         return 0;
+      j->code      = (uint8_t *)p;
+      j->code_size = RISC_JIT_CODE_SIZE;
+   }
+   RISCJitFlush(j);
+   return 1;
+}
+
+void RISCJitRelease(RISCJit *j)
+{
+   if (j->code)
+      munmap(j->code, j->code_size);
+   j->code      = NULL;
+   j->code_size = 0;
+   j->code_used = 0;
+   memset(j->blocks, 0, j->words * sizeof(j->blocks[0]));
+   memset(j->heat, 0, j->words);
+}
+
+RISCJitBlock RISCJitCompile(RISCJit *j, const RISCDecodedOp *ops, uint32_t w)
+{
+   const RISCDecodedOp *op = &ops[w];
+   uint32_t n = op->run, i;
+   RISCJitEmit emit, *e = &emit;
+   uint8_t *start;
+   RISCJitBlock block;
+
+   if (!j->code || n == 0)
+      return NULL;
+   if (j->code_size - j->code_used < RISC_JIT_BLOCK_MAX)
+      RISCJitFlush(j);
+
+   start = e->p = j->code + j->code_used;
+
+   emit8(e, 0x53);                               /* push rbx */
+   emit8(e, 0x41); emit8(e, 0x54);               /* push r12 */
+   emit8(e, 0x41); emit8(e, 0x55);               /* push r13 */
+   emit8(e, 0x41); emit8(e, 0x56);               /* push r14 */
+   emit8(e, 0x41); emit8(e, 0x57);               /* push r15 */
+   emit8(e, 0x48); emit8(e, 0x89); emit8(e, 0xFB); /* mov rbx, rdi */
+   emit8(e, 0x49); emit8(e, 0x89); emit8(e, 0xF4); /* mov r12, rsi */
+   emit_mov_imm64(e, FLAG_Z, (uint64_t)(uintptr_t)j->flag_z);
+   emit_mov_imm64(e, FLAG_N, (uint64_t)(uintptr_t)j->flag_n);
+   emit_mov_imm64(e, FLAG_C, (uint64_t)(uintptr_t)j->flag_c);
+
+   for (i = 0; i < n; i++)
+      emit_op(e, j, &op[i], j->ram_base + ((w + i) << 1));
+
+   emit8(e, 0x41); emit8(e, 0x5F);               /* pop r15 */
+   emit8(e, 0x41); emit8(e, 0x5E);               /* pop r14 */
+   emit8(e, 0x41); emit8(e, 0x5D);               /* pop r13 */
+   emit8(e, 0x41); emit8(e, 0x5C);               /* pop r12 */
+   emit8(e, 0x5B);                               /* pop rbx */
+   emit8(e, 0xC3);                               /* ret */
+
+   j->code_used = (uint32_t)(((e->p - j->code) + 15) & ~15);
+
+   /* Object-to-function pointer conversion; fine on every host we
+    * emit code for. */
+   memcpy(&block, &start, sizeof(block));
+   j->blocks[w] = block;
+   return block;
+}
+
+#else /* !RISC_JIT_X64 */
+
+int RISCJitEnable(RISCJit *j)
+{
+   (void)j;
+   return 0;
+}
+
+void RISCJitRelease(RISCJit *j)
+{
+   (void)j;
+}
+
+RISCJitBlock RISCJitCompile(RISCJit *j, const RISCDecodedOp *ops, uint32_t w)
+{
+   (void)j; (void)ops; (void)w;
+   return NULL;
+}
+
+#endif /* RISC_JIT_X64 */
+
+void RISCJitFlush(RISCJit *j)
+{
+   j->code_used = 0;
+   memset(j->blocks, 0, j->words * sizeof(j->blocks[0]));
+   memset(j->heat, 0, j->words);
+}
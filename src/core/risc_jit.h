@@ -0,0 +1,134 @@
+/*
+ * risc_jit.h — optional x86-64 translation of the straight-line runs
+ * tracked by risc_block.h, shared by the GPU (src/tom/gpu.c) and DSP
+ * (src/jerry/dsp.c) interpreters.
+ *
+ * A compiled block is the native equivalent of one superblock: the
+ * `run` instructions starting at a local-RAM word, executed back-to-back
+ * with no per-instruction bookkeeping.  The exec loop decides when a
+ * block may run (same slice-budget rule as the interpreted superblock),
+ * charges its run_cycles, and advances the PC; the block itself only
+ * updates registers, flags and whatever the called handlers touch.
+ *
+ * Blocks take the current and alternate register banks as arguments
+ * instead of baking in a bank address, so one translation stays valid
+ * across GPUUpdateRegisterBanks/DSPUpdateRegisterBanks flips.  The
+ * common ALU opcodes (add/sub/logic/bit/quick shifts/compare/moves) are
+ * emitted inline; every other straight opcode becomes a call into the
+ * core's own handler table, so the interpreter stays the one definition
+ * of those semantics.
+ *
+ * Coherence piggybacks on the decode table: the core calls
+ * RISCJitInvalidate() from the same place it calls RISCDecodeRange(),
+ * which drops every block whose run could cover a stored byte.  Code
+ * space is never reclaimed piecemeal; when the buffer fills, everything
+ * is flushed and recompiled on demand.  Like the decode table, nothing
+ * here is ever serialized.
+ *
+ * Only built for x86-64 System V hosts (GCC/Clang on Linux, the BSDs
+ * and macOS).  Elsewhere -- or with -DVJ_NO_RISC_JIT, or when the host
+ * refuses an executable mapping -- RISCJitEnable() fails and the core
+ * stays on the interpreter.
+ */
+
+#ifndef RISC_JIT_H
+#define RISC_JIT_H
+
+#include <stdint.h>
+#include <string.h>
+#include <retro_inline.h>
+
+#include "risc_block.h"
+
+#if defined(__GNUC__) && defined(__x86_64__) && !defined(_WIN32) && !defined(VJ_NO_RISC_JIT)
+#define RISC_JIT_X64 1
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Entries into a run before it is worth translating. */
+#define RISC_JIT_HEAT 4
+
+typedef void (*RISCJitBlock)(uint32_t *reg, uint32_t *alt);
+
+typedef struct
+{
+   /* Filled in once by the owning core. */
+   uint8_t      *flag_z, *flag_n, *flag_c;
+   uint32_t     *param1, *param2;   /* <core>_opcode_first/second_parameter */
+   void        (**handlers)();      /* <core>_opcode[64] */
+   uint32_t      ram_base;          /* local RAM address of word 0 (move pc) */
+   RISCJitBlock *blocks;            /* [words] block starting at each word */
+   uint8_t      *heat;              /* [words] entries seen while untranslated */
+   uint32_t      words;             /* a power of two, as in RISCDecodeTable */
+
+   /* Executable code buffer, mapped by RISCJitEnable(). */
+   uint8_t      *code;
+   uint32_t      code_size;
+   uint32_t      code_used;
+} RISCJit;
+
+/* Map the code buffer if needed and drop all blocks.  Returns 0 when no
+ * translation is possible on this host/build; the core must then keep
+ * interpreting. */
+int RISCJitEnable(RISCJit *j);
+
+/* Unmap the code buffer (core shutdown). */
+void RISCJitRelease(RISCJit *j);
+
+/* Forget every block and reuse the whole buffer. */
+void RISCJitFlush(RISCJit *j);
+
+/* Translate the run starting at ops[w] (ops[w].run > 0) and record it in
+ * blocks[w].  Returns NULL if the run cannot be translated. */
+RISCJitBlock RISCJitCompile(RISCJit *j, const RISCDecodedOp *ops, uint32_t w);
+
+/* Drop blocks starting in words [first, last] and the RISC_RUN_MAX - 1
+ * words in front of them (no wrap: runs never do). */
+static INLINE void RISCJitDropSpan(RISCJit *j, uint32_t first, uint32_t last)
+{
+   uint32_t lo = (first >= RISC_RUN_MAX - 1) ? first - (RISC_RUN_MAX - 1) : 0;
+
+   memset(&j->blocks[lo], 0, (last - lo + 1) * sizeof(j->blocks[0]));
+   memset(&j->heat[lo], 0, last - lo + 1);
+}
+
+/* Counterpart of RISCDecodeRange(): call it for the same byte range
+ * after every store to local RAM.  A no-op until the buffer exists. */
+static INLINE void RISCJitInvalidate(RISCJit *j, uint32_t off, uint32_t len)
+{
+   uint32_t first, count;
+
+   if (!j->code)
+      return;
+   first = (off >> 1) & (j->words - 1);
+   count = ((off + len - 1) >> 1) - (off >> 1) + 1;
+   if (count >= j->words)
+      RISCJitFlush(j);
+   else if (first + count > j->words)
+   {
+      RISCJitDropSpan(j, 0, first + count - j->words - 1);
+      RISCJitDropSpan(j, first, j->words - 1);
+   }
+   else
+      RISCJitDropSpan(j, first, first + count - 1);
+}
+
+/* Block for the run at ops[w], translating it once it has been entered
+ * RISC_JIT_HEAT times; NULL means "interpret it this time". */
+static INLINE RISCJitBlock RISCJitLookup(RISCJit *j, const RISCDecodedOp *ops, uint32_t w)
+{
+   if (j->blocks[w])
+      return j->blocks[w];
+   if (++j->heat[w] < RISC_JIT_HEAT)
+      return NULL;
+   return RISCJitCompile(j, ops, w);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RISC_JIT_H */
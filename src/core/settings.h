@@ -31,6 +31,7 @@ struct VJSettings
 	bool useFastBlitter;
 	bool blitterTiming;
 	bool gpuPipelineTiming;
+	bool dacSliceCuts;
 
 	int32_t joyport;
 	bool hardwareTypeAlpine;
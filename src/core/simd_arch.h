@@ -0,0 +1,36 @@
+/*
+ * simd_arch.h - per-arch selection shared by the SIMD kernels.
+ *
+ * Exactly one arch is built in: Makefile.common picks it (BLITTER_SIMD,
+ * or host detection), compiles the matching blitter_simd_<arch>.c and
+ * simd_ops_<arch>.c, and passes -DBLITTER_SIMD_<ARCH>.  Builds that do
+ * not go through it (every MSVC target, and anything else without the
+ * define) get scalar.
+ *
+ * Every kernel header -- blitter_simd.h, line_simd.h, op_simd.h,
+ * dac_fir.h -- picks its <name>_<arch>.h by the SIMD_ARCH_<ARCH> set
+ * here, and marks its inline functions SIMD_INLINE, so the choice is
+ * made in one place.
+ */
+#ifndef VJ_SIMD_ARCH_H
+#define VJ_SIMD_ARCH_H
+
+#if defined(BLITTER_SIMD_NEON)
+#  define SIMD_ARCH_NEON 1
+#elif defined(BLITTER_SIMD_SSE2)
+#  define SIMD_ARCH_SSE2 1
+#else
+#  define SIMD_ARCH_SCALAR 1
+#endif
+
+/* Portable always-inline, spelled to include the inline keyword itself
+ * (MSVC's __forceinline IS the inline keyword for that compiler). */
+#if defined(_MSC_VER)
+#  define SIMD_INLINE __forceinline
+#elif defined(__GNUC__) || defined(__clang__)
+#  define SIMD_INLINE inline __attribute__((always_inline))
+#else
+#  define SIMD_INLINE inline
+#endif
+
+#endif /* VJ_SIMD_ARCH_H */
@@ -0,0 +1,105 @@
+/*
+ * SIMD kernel ops -- out-of-line scalar vtables.
+ *
+ * The scanline converters (line_simd.h), the DAC's polyphase FIR
+ * (dac_fir.h) and the Object Processor's span writers (op_simd.h) live
+ * in their scalar headers as static inline functions, so tom.c, dac.c
+ * and op.c inline them.  This file only provides the function-pointer
+ * tables their tests call, the same way blitter_simd_scalar.c does for
+ * the blitter, so each test exercises the very same code the core runs.
+ */
+
+/* Select our own arch before simd_arch.h picks one, as
+ * blitter_simd_scalar.c does: this file must get the scalar inline set
+ * even when a test is built by hand without -DBLITTER_SIMD_SCALAR. */
+#ifndef BLITTER_SIMD_SCALAR
+#define BLITTER_SIMD_SCALAR 1
+#endif
+
+#include "simd_arch.h"
+#include "../tom/line_simd.h"
+#include "../tom/op_simd.h"
+#include "../jerry/dac_fir.h"
+
+/* Scanline converters (line_simd.h): tom.c inlines them,
+ * test/test_line_simd.c calls them through this table. */
+
+static void ops_line_cry16(uint32_t *dst, const uint8_t *src, unsigned count,
+                           unsigned scale, const line_simd_luts *luts)
+{
+   line_simd_cry16(dst, src, count, scale, luts);
+}
+
+static void ops_line_rgb24(uint32_t *dst, const uint8_t *src, unsigned count,
+                           unsigned scale, const line_simd_luts *luts)
+{
+   line_simd_rgb24(dst, src, count, scale, luts);
+}
+
+static void ops_line_rgb16(uint32_t *dst, const uint8_t *src, unsigned count,
+                           unsigned scale, const line_simd_luts *luts)
+{
+   line_simd_rgb16(dst, src, count, scale, luts);
+}
+
+static void ops_line_mix16(uint32_t *dst, const uint8_t *src, unsigned count,
+                           unsigned scale, const line_simd_luts *luts)
+{
+   line_simd_mix16(dst, src, count, scale, luts);
+}
+
+const line_simd_ops_t line_simd_ops = {
+   ops_line_cry16,
+   ops_line_rgb24,
+   ops_line_rgb16,
+   ops_line_mix16
+};
+
+/* The DAC's polyphase FIR (dac_fir.h): dac.c inlines it,
+ * test/test_dac_fir.c calls it through this table. */
+
+static void ops_dac_fir_block(int16_t *dst, const int16_t *taps,
+                              const uint8_t *phase,
+                              const int16_t (*coef)[DAC_FIR_TAPS],
+                              unsigned count)
+{
+   dac_fir_block(dst, taps, phase, coef, count);
+}
+
+const dac_fir_ops_t dac_fir_ops = {
+   ops_dac_fir_block
+};
+
+/* The Object Processor's bitmap spans (op_simd.h), the same way: op.c
+ * inlines them, test/test_op_simd.c calls them through this table. */
+
+static void ops_op_span16(uint8_t *dst, const uint8_t *src,
+                          unsigned count, const uint8_t *palette)
+{
+   op_span16(dst, src, count, palette);
+}
+
+static void ops_op_span16_trans(uint8_t *dst, const uint8_t *src,
+                                unsigned count, const uint8_t *palette)
+{
+   op_span16_trans(dst, src, count, palette);
+}
+
+static void ops_op_clut8(uint8_t *dst, const uint8_t *src,
+                         unsigned count, const uint8_t *palette)
+{
+   op_clut8(dst, src, count, palette);
+}
+
+static void ops_op_clut8_trans(uint8_t *dst, const uint8_t *src,
+                               unsigned count, const uint8_t *palette)
+{
+   op_clut8_trans(dst, src, count, palette);
+}
+
+const op_simd_ops_t op_simd_ops = {
+   ops_op_span16,
+   ops_op_span16_trans,
+   ops_op_clut8,
+   ops_op_clut8_trans
+};
@@ -58,7 +58,10 @@ extern "C" {
  *     the analog / driving controller (#437) appended 5 bytes per port —
  *     bank, last row, latched ADC X/Y, switch mask — to the chunk; a
  *     pre-extension v12 state reads them from the zero-fill tail, which
- *     is inert (see inputdev.h). */
+ *     is inert (see inputdev.h).  The event scheduler's absolute clocks
+ *     (two uint64 tick counts, EventClockStateSave) follow the input
+ *     chunk; zeros from a pre-extension tail just restart them on a
+ *     cycle boundary. */
 #define STATE_MAGIC     0x564A5353  /* "VJSS" */
 #define STATE_VERSION   12
 /* Oldest layout retro_unserialize still accepts.  States between
@@ -174,6 +177,8 @@ size_t BlitterStateLoad(const uint8_t *buf);
 
 size_t EventStateSave(uint8_t *buf);
 size_t EventStateLoad(const uint8_t *buf);
+size_t EventClockStateSave(uint8_t *buf);
+size_t EventClockStateLoad(const uint8_t *buf);
 
 size_t EepromStateSave(uint8_t *buf);
 size_t EepromStateLoad(const uint8_t *buf);
@@ -0,0 +1,197 @@
+/*
+ * state_delta.c: dirty-page tracking of main RAM for fast in-session
+ * savestates.  See state_delta.h.
+ */
+
+#include <string.h>
+#include <time.h>
+
+#include "state_delta.h"
+#include "perf_counters.h"
+
+PERF_COUNTER(state_serialize_calls);
+PERF_COUNTER(state_serialize_reused);
+PERF_COUNTER(state_serialize_bytes);
+
+uint32_t stateDeltaDirty[STATE_DELTA_PAGES / 32];
+uint32_t stateDeltaWatch[STATE_DELTA_PAGES / 32];
+
+static bool deltaEnabled = false;
+
+/* The buffer the last complete image went to, and what it carries. */
+static const uint8_t *deltaBlob = NULL;
+static size_t   deltaBlobSize = 0;
+static size_t   deltaWritten = 0;
+static uint32_t deltaNonce = 0;
+
+/* The save in progress. */
+static bool     deltaReuse = false;
+static size_t   deltaPendingSize = 0;
+static size_t   deltaBytes = 0;
+
+void StateDeltaMarkRange(uint32_t addr, uint32_t len)
+{
+   uint32_t first, count, i;
+
+   if (len == 0)
+      return;
+   if (len >= 0x200000)
+   {
+      StateDeltaMarkAll();
+      return;
+   }
+
+   first = (addr & 0x1FFFFF) >> STATE_DELTA_PAGE_SHIFT;
+   count = (((addr & (STATE_DELTA_PAGE_SIZE - 1)) + len - 1) >> STATE_DELTA_PAGE_SHIFT) + 1;
+
+   for (i = 0; i < count; i++)
+   {
+      uint32_t p = (first + i) & (STATE_DELTA_PAGES - 1);
+      stateDeltaDirty[p >> 5] |= 1u << (p & 31);
+      stateDeltaWatch[p >> 5] |= 1u << (p & 31);
+   }
+}
+
+void StateDeltaMarkAll(void)
+{
+   memset(stateDeltaDirty, 0xFF, sizeof(stateDeltaDirty));
+   memset(stateDeltaWatch, 0xFF, sizeof(stateDeltaWatch));
+}
+
+void StateDeltaForget(void)
+{
+   deltaBlob = NULL;
+   deltaReuse = false;
+   StateDeltaMarkAll();
+}
+
+void StateDeltaSetEnabled(bool enabled)
+{
+   if (enabled != deltaEnabled)
+   {
+      deltaEnabled = enabled;
+      StateDeltaForget();
+   }
+}
+
+/* Nonces only need to differ from every earlier one this session and,
+ * with high probability, from whatever a stale buffer holds; the salt
+ * keeps a state file from a previous session with a matching counter
+ * from ever passing for the tracked image. */
+static uint32_t NextNonce(void)
+{
+   static uint32_t salt = 0;
+   static uint32_t counter = 0;
+   uint32_t n;
+
+   if (!salt)
+      salt = ((uint32_t)time(NULL) * 2654435761u) | 1u;
+
+   do
+      n = salt ^ (++counter * 0x9E3779B9u);
+   while (n == 0 || n == deltaNonce);
+
+   return n;
+}
+
+uint32_t StateDeltaSaveBegin(const uint8_t *blob, size_t size, uint32_t oldReserved, bool allowed)
+{
+   PERF_INC(state_serialize_calls);
+   deltaBytes = 0;
+   deltaPendingSize = size;
+   deltaReuse = false;
+
+   if (!deltaEnabled || !allowed)
+   {
+      deltaBlob = NULL;
+      deltaNonce = 0;
+      return 0;
+   }
+
+   deltaReuse = (deltaBlob && blob == deltaBlob && size == deltaBlobSize
+         && oldReserved == deltaNonce);
+   if (deltaReuse)
+      PERF_INC(state_serialize_reused);
+
+   deltaNonce = NextNonce();
+   return deltaNonce;
+}
+
+size_t StateDeltaSaveRAM(uint8_t *dst, const uint8_t *ram)
+{
+   size_t copied = 0;
+   unsigned w;
+
+   if (!deltaReuse)
+   {
+      memcpy(dst, ram, 0x200000);
+      copied = 0x200000;
+   }
+   else
+   {
+      for (w = 0; w < STATE_DELTA_PAGES / 32; w++)
+      {
+         uint32_t bits = stateDeltaDirty[w];
+         uint32_t b;
+
+         for (b = 0; bits; b++, bits >>= 1)
+         {
+            if (bits & 1)
+            {
+               size_t off = (size_t)(w * 32 + b) << STATE_DELTA_PAGE_SHIFT;
+               memcpy(dst + off, ram + off, STATE_DELTA_PAGE_SIZE);
+               copied += STATE_DELTA_PAGE_SIZE;
+            }
+         }
+      }
+   }
+
+   memset(stateDeltaDirty, 0, sizeof(stateDeltaDirty));
+   deltaBytes += copied;
+   return copied;
+}
+
+bool StateDeltaNeedZeroFill(size_t written)
+{
+   /* The tail past `written` is zero from the previous image as long as
+    * the payload did not shrink or grow since. */
+   return !(deltaReuse && written == deltaWritten);
+}
+
+void StateDeltaSaveEnd(const uint8_t *blob, bool ok, size_t written)
+{
+   if (ok)
+   {
+      /* Non-RAM chunks are always rewritten; the tail only when filled. */
+      deltaBytes += written - 0x200000;
+      if (StateDeltaNeedZeroFill(written))
+         deltaBytes += deltaPendingSize - written;
+      PERF_ADD(state_serialize_bytes, deltaBytes);
+   }
+
+   deltaReuse = false;
+   if (!ok || !deltaEnabled || deltaNonce == 0)
+   {
+      deltaBlob = NULL;
+      return;
+   }
+
+   deltaBlob = blob;
+   deltaBlobSize = deltaPendingSize;
+   deltaWritten = written;
+}
+
+size_t StateDeltaLastBytes(void)
+{
+   return deltaBytes;
+}
+
+void StateDeltaLoaded(const uint8_t *blob, uint32_t reserved)
+{
+   if (deltaBlob && blob == deltaBlob && reserved != 0 && reserved == deltaNonce)
+      memset(stateDeltaDirty, 0, sizeof(stateDeltaDirty));
+   else
+      StateDeltaMarkAll();
+   /* RAM was replaced either way as far as in-frame watchers know. */
+   memset(stateDeltaWatch, 0xFF, sizeof(stateDeltaWatch));
+}
@@ -0,0 +1,92 @@
+/*
+ * state_delta.h: dirty-page tracking of main RAM for fast in-session
+ * savestates (run-ahead).
+ *
+ * Every main-RAM store path that already carries the blit-memo write
+ * hook (68K, JaguarWriteByte/Word/Long for GPU/DSP/OP, the blitter
+ * engines, the memo's own replay) also sets one bit per 4 KB page here;
+ * writers that bypass those paths (CD HLE, the NVM BIOS stub, reset)
+ * mark their ranges explicitly.  The bits record what changed since the
+ * last retro_serialize() that went through StateDeltaSaveRAM().
+ *
+ * The on-disk layout is unchanged: a state is always the full blob.  The
+ * delta is in how it is produced.  When the frontend hands back the same
+ * buffer it got last time and that buffer still carries the nonce we
+ * wrote into the header's reserved word, the buffer already holds the
+ * previous image, so only dirty pages (and the small non-RAM chunks) are
+ * rewritten.  Anything else -- a different buffer, a foreign or stale
+ * nonce, the option off -- is a full copy, which is what the core
+ * always did.  Loading a state replaces RAM wholesale: loading the
+ * tracked buffer itself leaves nothing dirty, anything else marks every
+ * page.
+ *
+ * Limitation: host-side writes through retro_get_memory_data() (frontend
+ * cheats) are invisible here; the option is off by default.
+ *
+ * stateDeltaWatch is a second copy of the same marks for in-frame
+ * consumers (the OP's object-list index): it is never touched by the
+ * save path and is cleared by whoever reads it.
+ */
+#ifndef __STATE_DELTA_H__
+#define __STATE_DELTA_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <boolean.h>
+#include <retro_inline.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define STATE_DELTA_PAGE_SHIFT 12                          /* 4 KB pages */
+#define STATE_DELTA_PAGE_SIZE  (1u << STATE_DELTA_PAGE_SHIFT)
+#define STATE_DELTA_PAGES      (0x200000 >> STATE_DELTA_PAGE_SHIFT)
+
+extern uint32_t stateDeltaDirty[STATE_DELTA_PAGES / 32];
+extern uint32_t stateDeltaWatch[STATE_DELTA_PAGES / 32];
+
+/* Hot-path mark for a single store of at most 4 bytes at a main-RAM
+ * address: the first and last byte's pages (a store can straddle). */
+static INLINE void StateDeltaMark(uint32_t addr, uint32_t len)
+{
+   uint32_t p0 = (addr & 0x1FFFFF) >> STATE_DELTA_PAGE_SHIFT;
+   uint32_t p1 = ((addr + len - 1) & 0x1FFFFF) >> STATE_DELTA_PAGE_SHIFT;
+
+   stateDeltaDirty[p0 >> 5] |= 1u << (p0 & 31);
+   stateDeltaDirty[p1 >> 5] |= 1u << (p1 & 31);
+   stateDeltaWatch[p0 >> 5] |= 1u << (p0 & 31);
+   stateDeltaWatch[p1 >> 5] |= 1u << (p1 & 31);
+}
+
+/* Any length; addresses are folded into the 2 MB window. */
+void StateDeltaMarkRange(uint32_t addr, uint32_t len);
+void StateDeltaMarkAll(void);
+
+/* Option layer. */
+void StateDeltaSetEnabled(bool enabled);
+
+/* retro_serialize(), in order: Begin before the header is written, with
+ * the reserved word the buffer holds now (returns the one to write),
+ * SaveRAM in place of the 2 MB copy (returns the bytes actually copied),
+ * NeedZeroFill before the tail memset, End once the blob is complete
+ * (ok=false on failure). */
+uint32_t StateDeltaSaveBegin(const uint8_t *blob, size_t size, uint32_t oldReserved, bool allowed);
+size_t   StateDeltaSaveRAM(uint8_t *dst, const uint8_t *ram);
+bool     StateDeltaNeedZeroFill(size_t written);
+void     StateDeltaSaveEnd(const uint8_t *blob, bool ok, size_t written);
+
+/* Bytes the last retro_serialize() actually wrote into its buffer. */
+size_t   StateDeltaLastBytes(void);
+
+/* retro_unserialize(), after RAM was loaded from blob. */
+void StateDeltaLoaded(const uint8_t *blob, uint32_t reserved);
+
+/* Content load/unload: no buffer is trusted any more. */
+void StateDeltaForget(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __STATE_DELTA_H__ */
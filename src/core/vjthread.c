@@ -0,0 +1,240 @@
+/*
+ * vjthread.c: pthreads behind HAVE_PTHREADS, stubs otherwise.  See
+ * vjthread.h.
+ */
+
+#include <stdlib.h>
+
+#include "vjthread.h"
+
+#ifdef HAVE_PTHREADS
+
+#include <pthread.h>
+#include <unistd.h>
+
+/* Spin iterations before a VJEventWait() sleeps: a few microseconds,
+ * about one scheduler slice. */
+#define VJ_EVENT_SPIN 4000
+
+struct vj_thread
+{
+   pthread_t handle;
+   void    (*fn)(void *);
+   void     *arg;
+};
+
+struct vj_lock
+{
+   pthread_mutex_t mutex;
+   pthread_cond_t  cond;
+};
+
+struct vj_event
+{
+   vj_lock      *lock;
+   volatile int  count;
+   volatile int  sleeping;
+   int           spin;
+};
+
+/* Set (to the vj_thread) on every thread VJThreadStart() creates. */
+static pthread_key_t  vj_worker_key;
+static pthread_once_t vj_worker_once = PTHREAD_ONCE_INIT;
+static int            vj_worker_key_ok;
+
+static void vj_worker_key_init(void)
+{
+   vj_worker_key_ok = (pthread_key_create(&vj_worker_key, NULL) == 0);
+}
+
+static void *vj_thread_entry(void *data)
+{
+   vj_thread *thread = (vj_thread *)data;
+
+   if (vj_worker_key_ok)
+      pthread_setspecific(vj_worker_key, thread);
+   thread->fn(thread->arg);
+   return NULL;
+}
+
+bool VJThreadIsWorker(void)
+{
+   pthread_once(&vj_worker_once, vj_worker_key_init);
+   return vj_worker_key_ok && pthread_getspecific(vj_worker_key) != NULL;
+}
+
+vj_thread *VJThreadStart(void (*fn)(void *), void *arg)
+{
+   vj_thread *thread = (vj_thread *)calloc(1, sizeof(*thread));
+
+   if (!thread)
+      return NULL;
+   thread->fn  = fn;
+   thread->arg = arg;
+   pthread_once(&vj_worker_once, vj_worker_key_init);
+   if (pthread_create(&thread->handle, NULL, vj_thread_entry, thread) != 0)
+   {
+      free(thread);
+      return NULL;
+   }
+   return thread;
+}
+
+void VJThreadJoin(vj_thread *thread)
+{
+   if (!thread)
+      return;
+   pthread_join(thread->handle, NULL);
+   free(thread);
+}
+
+vj_lock *VJLockNew(void)
+{
+   vj_lock *lock = (vj_lock *)calloc(1, sizeof(*lock));
+
+   if (!lock)
+      return NULL;
+   if (pthread_mutex_init(&lock->mutex, NULL) != 0)
+   {
+      free(lock);
+      return NULL;
+   }
+   if (pthread_cond_init(&lock->cond, NULL) != 0)
+   {
+      pthread_mutex_destroy(&lock->mutex);
+      free(lock);
+      return NULL;
+   }
+   return lock;
+}
+
+void VJLockFree(vj_lock *lock)
+{
+   if (!lock)
+      return;
+   pthread_cond_destroy(&lock->cond);
+   pthread_mutex_destroy(&lock->mutex);
+   free(lock);
+}
+
+void VJLock(vj_lock *lock)         { pthread_mutex_lock(&lock->mutex); }
+void VJUnlock(vj_lock *lock)       { pthread_mutex_unlock(&lock->mutex); }
+void VJLockWait(vj_lock *lock)     { pthread_cond_wait(&lock->cond, &lock->mutex); }
+void VJLockSignal(vj_lock *lock)   { pthread_cond_broadcast(&lock->cond); }
+
+int VJAtomicGet(volatile int *p)
+{
+   return __atomic_load_n(p, __ATOMIC_SEQ_CST);
+}
+
+void VJAtomicSet(volatile int *p, int value)
+{
+   __atomic_store_n(p, value, __ATOMIC_SEQ_CST);
+}
+
+static void vj_cpu_relax(void)
+{
+#if defined(__i386__) || defined(__x86_64__)
+   __builtin_ia32_pause();
+#elif defined(__aarch64__) || (defined(__arm__) && defined(__ARM_ARCH_7A__))
+   __asm__ __volatile__("yield");
+#endif
+}
+
+vj_event *VJEventNew(void)
+{
+   vj_event *ev = (vj_event *)calloc(1, sizeof(*ev));
+
+   if (!ev)
+      return NULL;
+   ev->lock = VJLockNew();
+   if (!ev->lock)
+   {
+      free(ev);
+      return NULL;
+   }
+   /* Spinning on one core only delays the thread being waited for. */
+   ev->spin = (sysconf(_SC_NPROCESSORS_ONLN) > 1) ? VJ_EVENT_SPIN : 0;
+   return ev;
+}
+
+void VJEventFree(vj_event *ev)
+{
+   if (!ev)
+      return;
+   VJLockFree(ev->lock);
+   free(ev);
+}
+
+unsigned VJEventCount(vj_event *ev)
+{
+   return (unsigned)VJAtomicGet(&ev->count);
+}
+
+/* The poster bumps the count then reads `sleeping`; the waiter sets
+ * `sleeping` then reads the count.  Both sequentially consistent, so at
+ * least one sees the other's store: either the waiter finds the new
+ * count, or the poster takes the lock -- which the waiter holds until
+ * it is inside VJLockWait() -- and wakes it. */
+void VJEventPost(vj_event *ev)
+{
+   __atomic_add_fetch(&ev->count, 1, __ATOMIC_SEQ_CST);
+   if (VJAtomicGet(&ev->sleeping))
+   {
+      VJLock(ev->lock);
+      VJLockSignal(ev->lock);
+      VJUnlock(ev->lock);
+   }
+}
+
+unsigned VJEventWait(vj_event *ev, unsigned seen)
+{
+   unsigned now;
+   int i;
+
+   for (i = 0; i < ev->spin; i++)
+   {
+      now = VJEventCount(ev);
+      if (now != seen)
+         return now;
+      vj_cpu_relax();
+   }
+
+   VJLock(ev->lock);
+   VJAtomicSet(&ev->sleeping, 1);
+   while ((now = VJEventCount(ev)) == seen)
+      VJLockWait(ev->lock);
+   VJAtomicSet(&ev->sleeping, 0);
+   VJUnlock(ev->lock);
+   return now;
+}
+
+#else /* !HAVE_PTHREADS */
+
+vj_thread *VJThreadStart(void (*fn)(void *), void *arg)
+{
+   (void)fn;
+   (void)arg;
+   return NULL;
+}
+
+void VJThreadJoin(vj_thread *thread) { (void)thread; }
+bool VJThreadIsWorker(void)          { return false; }
+
+vj_lock *VJLockNew(void)             { return NULL; }
+void VJLockFree(vj_lock *lock)       { (void)lock; }
+void VJLock(vj_lock *lock)           { (void)lock; }
+void VJUnlock(vj_lock *lock)         { (void)lock; }
+void VJLockWait(vj_lock *lock)       { (void)lock; }
+void VJLockSignal(vj_lock *lock)     { (void)lock; }
+
+vj_event *VJEventNew(void)                     { return NULL; }
+void VJEventFree(vj_event *ev)                 { (void)ev; }
+unsigned VJEventCount(vj_event *ev)            { (void)ev; return 0; }
+void VJEventPost(vj_event *ev)                 { (void)ev; }
+unsigned VJEventWait(vj_event *ev, unsigned s) { (void)ev; return s; }
+
+int VJAtomicGet(volatile int *p)               { return *p; }
+void VJAtomicSet(volatile int *p, int value)   { *p = value; }
+
+#endif /* HAVE_PTHREADS */
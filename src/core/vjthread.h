@@ -0,0 +1,74 @@
+/*
+ * vjthread.h: the few threading primitives the core uses.
+ *
+ * libretro-common's rthreads is not vendored here, so this is a thin
+ * pthreads wrapper behind HAVE_PTHREADS (set by the Makefile for the
+ * unix and osx platforms, which also link -lpthread).  Everywhere else
+ * VJThreadStart() returns NULL and callers keep their synchronous path;
+ * nothing may depend on a thread actually running.
+ *
+ * A vj_lock is a mutex with one condition variable.  Every user so far
+ * is a single producer handing work to a single worker, where one
+ * broadcast condition is enough and two would only add ways to miss a
+ * wakeup.
+ *
+ * A vj_event is for handoffs too frequent to sleep on every time (one
+ * per scheduler slice): a counter one thread posts and one other thread
+ * waits on.  With a spare core the waiter spins on the counter for a
+ * few microseconds before it sleeps; on a single core it sleeps at once.
+ */
+#ifndef __VJTHREAD_H__
+#define __VJTHREAD_H__
+
+#include <boolean.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct vj_thread vj_thread;
+typedef struct vj_lock   vj_lock;
+
+/* Run fn(arg) on a new thread; NULL when threads are unavailable or
+ * creation failed. */
+vj_thread *VJThreadStart(void (*fn)(void *), void *arg);
+void       VJThreadJoin(vj_thread *thread);
+/* True on a thread VJThreadStart() created, false on the thread(s) the
+ * frontend calls the core on. */
+bool       VJThreadIsWorker(void);
+
+/* NULL when threads are unavailable. */
+vj_lock   *VJLockNew(void);
+void       VJLockFree(vj_lock *lock);
+void       VJLock(vj_lock *lock);
+void       VJUnlock(vj_lock *lock);
+/* Atomically release the lock and sleep until the next VJLockSignal();
+ * holds the lock again on return.  May wake spuriously: callers loop on
+ * their own condition. */
+void       VJLockWait(vj_lock *lock);
+/* Wake every VJLockWait() sleeper.  Call with the lock held. */
+void       VJLockSignal(vj_lock *lock);
+
+typedef struct vj_event vj_event;
+
+/* NULL when threads are unavailable. */
+vj_event  *VJEventNew(void);
+void       VJEventFree(vj_event *ev);
+unsigned   VJEventCount(vj_event *ev);
+/* Bump the count and wake the waiter.  Stores made before the post are
+ * visible to a thread that has seen the new count. */
+void       VJEventPost(vj_event *ev);
+/* Return once the count differs from `seen`, with the new count.  Read
+ * the count before testing the condition it guards, then wait on that
+ * value, or a post in between is missed. */
+unsigned   VJEventWait(vj_event *ev, unsigned seen);
+
+/* Sequentially consistent access to a flag two threads share. */
+int        VJAtomicGet(volatile int *p);
+void       VJAtomicSet(volatile int *p, int value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __VJTHREAD_H__ */
@@ -13,6 +13,7 @@
 #include <string.h>
 #include "vjtrace.h"
 #include "vjag_memory.h"             /* who enum: JAGUAR, DSP, GPU, ...; jaguarMainRAM */
+#include "jaguar.h"                  /* JaguarMemoryMapRebuild */
 #include "../m68000/m68kinterface.h" /* m68k_get_reg */
 #include "../tom/tom.h"              /* tomRam8 for halfline (VC) and TOMREG snapshot section */
 #include "../jerry/dsp.h"            /* DSP declarations: DSPGetRAM, DSPGetFlags */
@@ -121,11 +122,11 @@ static uint32_t vjt_pc_of(uint32_t who)
        *
        * pcQueue/pcQPtr (src/core/jaguar.c) is the fix, and is already
        * exactly what vjtrace_backtrace() below relies on for the same
-       * reason: M68KInstructionHook() latches regs.pc into
-       * pcQueue[pcQPtr] and only then increments pcQPtr, once per
-       * instruction, called from src/m68000/m68kinterface.c
-       * immediately before that instruction's opcode dispatch -- i.e.
-       * strictly before any memory access the instruction makes. So
+       * reason: m68k_execute() (src/m68000/m68kinterface.c) latches
+       * regs.pc into pcQueue[pcQPtr] and only then increments pcQPtr,
+       * once per instruction, immediately before that instruction's
+       * opcode dispatch -- i.e. strictly before any memory access the
+       * instruction makes. So
        * the most recently queued entry, at
        * pcQueue[(pcQPtr - 1) & (VJT_PCHIST_CAP - 1)], is always the
        * start PC of whichever instruction is CURRENTLY executing: the
@@ -137,8 +138,8 @@ static uint32_t vjt_pc_of(uint32_t who)
        * (pcQueue is a plain BSS array; an unwritten slot reads back as
        * PC=0 rather than crashing or returning garbage -- the same
        * KNOWN LIMITATION already documented on vjtrace_backtrace() in
-       * vjtrace.h). M68KInstructionHook() runs unconditionally from
-       * that first instruction on and always runs before any memory
+       * vjtrace.h). That push runs unconditionally from that first
+       * instruction on and always runs before any memory
        * access that instruction makes, so by the time this function is
        * reachable from a real M68K-attributed bus access, pcQPtr is
        * already >= 1 and that pre-first-instruction case cannot
@@ -221,10 +222,17 @@ int vjtrace_watch_add(uint32_t lo, uint32_t hi, unsigned rw)
    watches[vjtrace_nwatch].lo = lo;
    watches[vjtrace_nwatch].hi = hi;
    watches[vjtrace_nwatch].rw = rw;
-   return (int)vjtrace_nwatch++;
+   vjtrace_nwatch++;
+   /* An armed watch turns the bus fast path off (it has no hook). */
+   JaguarMemoryMapRebuild();
+   return (int)vjtrace_nwatch - 1;
 }
 
-void vjtrace_watch_clear(void) { vjtrace_nwatch = 0; }
+void vjtrace_watch_clear(void)
+{
+   vjtrace_nwatch = 0;
+   JaguarMemoryMapRebuild();
+}
 
 void vjtrace_watch_check(uint32_t addr, uint32_t value, uint32_t who, int is_write)
 {
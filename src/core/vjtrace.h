@@ -191,7 +191,7 @@ void vjtrace_watch_check(uint32_t addr, uint32_t value, uint32_t who, int is_wri
  * instruction's fetch in the overwhelming majority of cases (859 of
  * 861 opcode handlers, measured). vjt_pc_of() (src/core/vjtrace.c)
  * instead reads the most recent entry of pcQueue/pcQPtr
- * (src/core/jaguar.c), which M68KInstructionHook() latches BEFORE each
+ * (src/core/jaguar.c), which m68k_execute() latches BEFORE each
  * instruction's opcode handler runs -- see the comment on vjt_pc_of()
  * for the full argument.
  *
@@ -301,14 +301,14 @@ void vjtrace_pchist_dsp(uint32_t pc);
  * zero-filled or stale fabricated history.
  *
  * M68K reads the existing pcQueue/pcQPtr ring in src/core/jaguar.c
- * rather than a duplicate (see M68KInstructionHook(), jaguar.c:332).
+ * rather than a duplicate (pushed by m68k_execute(), m68kinterface.c).
  * KNOWN LIMITATION: that ring has no fill counter of its own, and
- * adding one means touching jaguar.c's per-instruction hot path, which
+ * adding one means touching m68k_execute()'s per-instruction path, which
  * is out of scope for this module. vjtrace_backtrace() therefore
  * assumes it is full and can return zero/stale-placeholder entries for
  * the first VJT_PCHIST_CAP 68K instructions of emulation (pcQueue is a
  * plain BSS array, so unwritten slots read as PC=0). In practice
- * M68KInstructionHook() runs unconditionally every 68K instruction from
+ * m68k_execute() pushes it unconditionally every 68K instruction from
  * the very first one executed (it is not gated by VJ_TRACE), so this
  * window closes within roughly VJT_PCHIST_CAP instructions of core
  * boot -- a few dozen microseconds -- and does not recur afterward. */
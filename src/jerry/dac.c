@@ -17,12 +17,30 @@
 /* The libretro audio path resamples from the I2S rate (determined by
  * SCLK) to 48 kHz output using linear interpolation.  When SCLK changes
  * mid-frame (e.g. Skyhammer / Iron Soldier 2 pitch effects), the
- * resampler adapts to the new rate on the next sample callback.
+ * resampler adapts to the new rate from the next output sample on.
  *
  * I2S samples (written by the DSP to LTXD/RTXD) are captured into a
- * ring buffer at the hardware I2S rate.  DSPSampleCallback fires at
- * 48 kHz and linearly interpolates between ring buffer entries to
- * produce the output stream. */
+ * ring buffer at the hardware I2S rate, each stamped with the JERRY
+ * event clock.  The 48 kHz output is rendered in one pass at frame end
+ * (DACRenderFrame, from SoundCallback): every output sample is placed
+ * at the event-clock tick the old per-sample callback fired at, and
+ * sees exactly the captures and the rate that callback saw.  The
+ * machine side never observed the output stream, so nothing but the
+ * host's audio depends on when it is computed.
+ *
+ * The buffer index follows from the frame's tick span at render time,
+ * so DSPSampleCallback no longer renders anything.  It still runs on
+ * the old cadence by default (vjs.dacSliceCuts), to cut processor
+ * slices where the reference schedule did; switched off, it is not
+ * scheduled at all.
+ *
+ * The interpolation itself is selectable (virtualjaguar_audio_resampler):
+ * linear, a 16-tap windowed-sinc polyphase FIR over the same cursor
+ * (dac_fir.h, SIMD per the blitter_simd arch split), or none at all --
+ * the frame's raw captures handed over at the I2S rate for the frontend
+ * to resample.  None of them is machine state: the native path keeps
+ * the read cursor parked just behind the write cursor, so a switch in
+ * either direction resumes without a resync. */
 
 #include "dac.h"
 #include "log.h"  /* CDDA-DIAG */
@@ -36,8 +54,12 @@
 #include "tom.h"
 #include "m68000/m68kinterface.h"
 #include "settings.h"
+#include "perf_timing.h"
 
 #include <libretro.h>
+#include <retro_inline.h>
+
+#include "dac_fir.h"
 
 extern retro_audio_sample_batch_t audio_batch_cb;
 
@@ -57,6 +79,20 @@ extern retro_audio_sample_batch_t audio_batch_cb;
 #define I2S_TARGET_LAG		2
 #define I2S_RESYNC_LAG		256
 
+/* Read cursor: 32.32 fixed point in ring samples.  Interpolation uses
+ * the top 15 fraction bits, so a sample delta times the fraction fits
+ * an int32. */
+#define I2S_PHASE_ONE		((uint64_t)1 << 32)
+#define I2S_FRAC_BITS		15
+
+/* Output pairs per frame the render scratch holds (BUFPAL is 960). */
+#define I2S_BATCH_MAX		2048
+
+/* SCLK/SMODE changes remembered per frame.  A title that reprograms
+ * the port more often than this within one frame gets its last few
+ * changes merged into the final entry. */
+#define I2S_RATE_LOG_SIZE	64
+
 /* Jaguar memory locations */
 
 #define LTXD			0xF1A148
@@ -78,10 +114,60 @@ static int16_t i2sRingR[I2S_RING_SIZE];
 static uint32_t i2sWritePos = 0;	/* next write position in ring */
 static uint32_t i2sWriteCount = 0;	/* total samples captured this frame */
 static uint32_t i2sNonZeroCount = 0;	/* samples with non-zero amplitude this frame */
-static double i2sPhase = 0.0;		/* fractional read position */
+static uint64_t i2sPhase = 0;		/* read position, 32.32 fixed point */
 static double i2sRateRatio = 1.0;	/* i2s_rate / 48000.0 */
+static uint64_t i2sStep = I2S_PHASE_ONE;	/* ratio x step scale, 32.32 */
 static uint32_t i2sResyncCount = 0;	/* gross-drift resyncs this session (diagnostic) */
 
+/* Event-clock tick each ring slot was captured at (JERRY domain). */
+static uint64_t i2sCaptureTick[I2S_RING_SIZE];
+
+/* The frame being rendered: opened by DACPrepareFrame, consumed by
+ * DACRenderFrame.  Output pair k is due at i2sFirstTick + k periods;
+ * i2sRateLog holds the step in force from each tick on. */
+static bool i2sFrameOpen = false;
+static uint32_t i2sFrameWritePos = 0;
+static uint16_t i2sFrameHoldL = 0, i2sFrameHoldR = 0;
+static uint64_t i2sFirstTick = 0;
+static struct
+{
+   uint64_t tick;
+   uint64_t step;
+} i2sRateLog[I2S_RATE_LOG_SIZE];
+static unsigned i2sRateLogCount = 0;
+
+/* Render scratch: ring slots and fraction per output pair. */
+static uint16_t i2sIdx0[I2S_BATCH_MAX];
+static uint16_t i2sIdx1[I2S_BATCH_MAX];
+static int32_t i2sFrac[I2S_BATCH_MAX];
+
+/* Output path (DAC_RESAMPLER_*).  A host setting, like dacAudioOutput:
+ * the machine and the cursor run the same whichever is chosen. */
+static int dacResampler = DAC_RESAMPLER_LINEAR;
+
+/* Band-limited path.  The coefficient table is built for a cutoff just
+ * below the lower of the two Nyquist limits and rebuilt only when the
+ * frame's fastest rate moves that cutoff.  The output is evaluated
+ * DAC_FIR_TAPS / 2 - 1 ring samples behind the cursor, so every tap
+ * but the newest is one the linear path has already seen captured. */
+#define I2S_FIR_ROLLOFF		0.90
+#define I2S_FIR_DELAY		(DAC_FIR_TAPS / 2 - 1)
+#define I2S_FIR_BLOCK		64	/* pairs gathered per kernel call */
+
+static int16_t i2sFirCoef[DAC_FIR_PHASES][DAC_FIR_TAPS];
+static double i2sFirCutoff = 0.0;	/* 0: table not built yet */
+static int16_t i2sFirTaps[I2S_FIR_BLOCK * 2 * DAC_FIR_TAPS];
+static uint8_t i2sFirPhase[I2S_FIR_BLOCK];
+
+/* Native path: one frame of captures, interleaved for the frontend. */
+static int16_t i2sNativeOut[2 * I2S_RING_SIZE];
+
+/* Whether this frame's audio will be heard (DACSetAudioOutput).  Off, the
+ * read cursor still advances sample by sample -- it is machine state and
+ * the next heard frame continues from it -- but nothing is interpolated or
+ * handed to the frontend. */
+static bool dacAudioOutput = true;
+
 /* Output-sample cadence, derived per frame in DACPrepareFrame (#393).
  *
  * The batch is a fixed `length` (800 NTSC / 960 PAL pairs) but the
@@ -102,12 +188,16 @@ static uint32_t i2sResyncCount = 0;	/* gross-drift resyncs this session (diagnos
  * field (period = frame_us / pairs) and scale the per-sample phase
  * step by the same factor (frame_periods / pairs), so per-frame
  * consumption equals capture identically -- for any VP, any SCLK,
- * master or slave mode.  The half-period first-callback offset keeps
- * the final callback strictly inside the frame, away from the
+ * master or slave mode.  The half-period first-sample offset keeps
+ * the final sample strictly inside the frame, away from the
  * frame-boundary race with HalflineCallback. */
 static double i2sSamplePeriodUs = 1000000.0 / (double)DAC_AUDIO_RATE;
 static double i2sStepScale = 1.0;
 
+/* Output instants left in the frame for DSPSampleCallback to cut at
+ * (vjs.dacSliceCuts only). */
+static int i2sSliceCuts = 0;
+
 /* Private function prototypes */
 static void DACUpdateSCLKRate(void);
 
@@ -132,13 +222,18 @@ void DACReset(void)
    i2sWritePos = 0;
    i2sWriteCount = 0;
    i2sNonZeroCount = 0;
-   i2sPhase = 0.0;
+   i2sPhase = 0;
    i2sRateRatio = 1.0;
+   i2sStep = I2S_PHASE_ONE;
    i2sResyncCount = 0;
    i2sSamplePeriodUs = 1000000.0 / (double)DAC_AUDIO_RATE;
    i2sStepScale = 1.0;
+   i2sSliceCuts = 0;
+   i2sFrameOpen = false;
+   i2sRateLogCount = 0;
    memset(i2sRingL, 0, sizeof(i2sRingL));
    memset(i2sRingR, 0, sizeof(i2sRingR));
+   memset(i2sCaptureTick, 0, sizeof(i2sCaptureTick));
 }
 
 void DACDone(void)
@@ -157,10 +252,10 @@ uint32_t DACGetI2SNonZeroCount(void)
 
 /* Diagnostics for the resample cursor pair (issue #393): the distance the
  * read cursor trails the write cursor, and how many times the gross-drift
- * resync in DSPSampleCallback has snapped it back. */
+ * resync in DACRenderFrame has snapped it back. */
 double DACGetI2SLag(void)
 {
-   return (double)i2sWritePos - i2sPhase;
+   return (double)i2sWritePos - (double)i2sPhase / (double)I2S_PHASE_ONE;
 }
 
 uint32_t DACGetI2SResyncCount(void)
@@ -205,6 +300,23 @@ static void DACUpdateSCLKRate(void)
       i2sRateRatio = 0.01;
    if (i2sRateRatio > 16.0)
       i2sRateRatio = 16.0;
+
+   i2sStep = (uint64_t)(i2sRateRatio * i2sStepScale * (double)I2S_PHASE_ONE + 0.5);
+
+   /* Mid-frame change (a DSP or 68000 write to SCLK/SMODE).  The writer
+    * runs inside a slice, where the JERRY clock still reads the slice
+    * start; output samples due after that tick are the ones the old
+    * per-sample event dispatched after the slice, with the new rate. */
+   if (i2sFrameOpen)
+   {
+      uint64_t now = GetEventClock(EVENT_JERRY);
+
+      if (i2sRateLog[i2sRateLogCount - 1].tick != now
+            && i2sRateLogCount < I2S_RATE_LOG_SIZE)
+         i2sRateLogCount++;
+      i2sRateLog[i2sRateLogCount - 1].tick = now;
+      i2sRateLog[i2sRateLogCount - 1].step = i2sStep;
+   }
 }
 
 /* Called when the DSP writes a sample pair to LTXD/RTXD.
@@ -213,22 +325,11 @@ static void DACCaptureSample(int16_t left, int16_t right)
 {
    i2sRingL[i2sWritePos & I2S_RING_MASK] = left;
    i2sRingR[i2sWritePos & I2S_RING_MASK] = right;
+   i2sCaptureTick[i2sWritePos & I2S_RING_MASK] = GetEventClock(EVENT_JERRY);
    i2sWritePos++;
    i2sWriteCount++;
    if (left != 0 || right != 0)
       i2sNonZeroCount++;
-
-   /* Both cursors run monotonically for the whole session; fold them
-    * back together once per ring lap.  Subtracting a whole ring size
-    * leaves every masked index unchanged, keeps the uint32 write cursor
-    * from wrapping and the double read cursor in a range where adding
-    * a fractional step still resolves exactly. */
-   if (i2sWritePos >= (uint32_t)(2 * I2S_RING_SIZE)
-       && i2sPhase >= (double)I2S_RING_SIZE)
-   {
-      i2sWritePos -= (uint32_t)I2S_RING_SIZE;
-      i2sPhase    -= (double)I2S_RING_SIZE;
-   }
 }
 
 /* One I2S word strobe has elapsed: latch whatever the DSP left in
@@ -240,7 +341,7 @@ static void DACCaptureSample(int16_t left, int16_t right)
  * never reach the DAC.  Capturing on every RTXD write instead fabricated
  * samples that were never transmitted: Atari Karts (master mode, SCLK=19)
  * writes 417 pairs per frame against 346 word strobes, so the ring grew
- * 20% faster than DSPSampleCallback consumed it and DACPrepareFrame threw
+ * 20% faster than the resampler consumed it and DACPrepareFrame threw
  * the surplus away on the next frame.  That reset yanked the output phase
  * forward once per frame -- a 60 Hz step of mean amplitude ~2959 (peak
  * 21881) in an otherwise ~110-amplitude signal, heard as constant
@@ -252,80 +353,252 @@ void DACWordStrobe(void)
    DACCaptureSample((int16_t)(*ltxd), (int16_t)(*rtxd));
 }
 
+/* One output-sample instant has passed.  The sample itself is
+ * DACRenderFrame's; the event only cuts the processor slice where the
+ * reference scheduler always has (see the top of this file), and is
+ * only scheduled with vjs.dacSliceCuts on. */
 void DSPSampleCallback(void)
 {
-   int16_t outL, outR;
-   uint32_t idx0, idx1;
-   double frac;
-   int32_t s0L, s1L, s0R, s1R;
+   if (--i2sSliceCuts > 0)
+      SetCallbackTime(DSPSampleCallback, i2sSamplePeriodUs, EVENT_JERRY);
+}
+
+/* Interpolate `d` (a sample delta) by `frac` / 2^I2S_FRAC_BITS,
+ * truncating toward zero as the old double-precision path did. */
+static INLINE int32_t DACLerp(int32_t d, int32_t frac)
+{
+   int32_t p = d * frac;
+
+   return (p + ((p >> 31) & ((1 << I2S_FRAC_BITS) - 1))) >> I2S_FRAC_BITS;
+}
+
+#define I2S_PI			3.14159265358979323846
+
+/* sin() for the table build without pulling libm into the core: reduce
+ * to [-pi, pi] and sum the Taylor series well past double precision. */
+static double DACSin(double x)
+{
+   double term, sum;
+   int n;
+
+   x -= 2.0 * I2S_PI * (double)(long)(x / (2.0 * I2S_PI));
+   if (x > I2S_PI)
+      x -= 2.0 * I2S_PI;
+   else if (x < -I2S_PI)
+      x += 2.0 * I2S_PI;
+   term = sum = x;
+   for (n = 1; n < 14; n++)
+   {
+      term *= -x * x / (double)((2 * n) * (2 * n + 1));
+      sum += term;
+   }
+   return sum;
+}
+
+/* Fill the polyphase table for `cutoff` (fraction of the ring's
+ * Nyquist rate): Blackman-windowed sinc, each phase row rounded to Q14
+ * and trimmed so it sums to exactly unity gain. */
+static void DACBuildFir(double cutoff)
+{
+   const double half = (double)(DAC_FIR_TAPS / 2);
+   int p, j;
+
+   for (p = 0; p < DAC_FIR_PHASES; p++)
+   {
+      double frac = (double)p / (double)DAC_FIR_PHASES;
+      double h[DAC_FIR_TAPS];
+      double sum = 0.0;
+      int32_t total = 0;
+      int peak = 0;
+
+      for (j = 0; j < DAC_FIR_TAPS; j++)
+      {
+         double x = (double)(j - I2S_FIR_DELAY) - frac;
+         double t = I2S_PI * cutoff * x;
+         double win = 0.42 + 0.5 * DACSin(I2S_PI * x / half + 0.5 * I2S_PI)
+                    + 0.08 * DACSin(2.0 * I2S_PI * x / half + 0.5 * I2S_PI);
+
+         h[j] = (x == 0.0 ? 1.0 : DACSin(t) / t) * win;
+         sum += h[j];
+      }
+      for (j = 0; j < DAC_FIR_TAPS; j++)
+      {
+         double q = h[j] / sum * (double)(1 << DAC_FIR_SHIFT);
 
-   /* Guard: hold current register value until the ring has data */
-   if (i2sWritePos < 2)
+         i2sFirCoef[p][j] = (int16_t)(q >= 0.0 ? (int)(q + 0.5)
+                                               : -(int)(0.5 - q));
+         total += i2sFirCoef[p][j];
+         if (h[j] > h[peak])
+            peak = j;
+      }
+      i2sFirCoef[p][peak] += (int16_t)((1 << DAC_FIR_SHIFT) - total);
+   }
+   i2sFirCutoff = cutoff;
+}
+
+/* Band-limited interpolation pass for pairs [first, count): gather each
+ * pair's taps -- the DAC_FIR_TAPS - 1 ring samples ending at its idx0,
+ * then idx1, which carry the same write-cursor clamp as the linear
+ * path -- a block at a time, and run the kernel over the block. */
+static void DACRenderFir(int16_t *out, int first, int count)
+{
+   uint64_t fastest = 0;
+   double cutoff;
+   unsigned r;
+   int k, b;
+
+   for (r = 0; r < i2sRateLogCount; r++)
+      if (i2sRateLog[r].step > fastest)
+         fastest = i2sRateLog[r].step;
+   cutoff = (double)I2S_PHASE_ONE / (double)fastest;
+   if (cutoff > 1.0)
+      cutoff = 1.0;
+   cutoff = (double)(int)(cutoff * I2S_FIR_ROLLOFF * 256.0 + 0.5) / 256.0;
+   if (cutoff != i2sFirCutoff)
+      DACBuildFir(cutoff);
+
+   for (k = first; k < count; k += I2S_FIR_BLOCK)
    {
-      outL = (int16_t)(*ltxd);
-      outR = (int16_t)(*rtxd);
+      int block = count - k < I2S_FIR_BLOCK ? count - k : I2S_FIR_BLOCK;
+
+      for (b = 0; b < block; b++)
+      {
+         int16_t *t = i2sFirTaps + b * 2 * DAC_FIR_TAPS;
+         uint32_t start = (uint32_t)(i2sIdx0[k + b] - (DAC_FIR_TAPS - 2))
+                        & I2S_RING_MASK;
+         int j;
+
+         if (start <= I2S_RING_SIZE - (DAC_FIR_TAPS - 1))
+         {
+            memcpy(t, i2sRingL + start, (DAC_FIR_TAPS - 1) * sizeof(*t));
+            memcpy(t + DAC_FIR_TAPS, i2sRingR + start,
+                   (DAC_FIR_TAPS - 1) * sizeof(*t));
+         }
+         else
+         {
+            for (j = 0; j < DAC_FIR_TAPS - 1; j++)
+            {
+               t[j] = i2sRingL[(start + j) & I2S_RING_MASK];
+               t[DAC_FIR_TAPS + j] = i2sRingR[(start + j) & I2S_RING_MASK];
+            }
+         }
+         t[DAC_FIR_TAPS - 1] = i2sRingL[i2sIdx1[k + b]];
+         t[2 * DAC_FIR_TAPS - 1] = i2sRingR[i2sIdx1[k + b]];
+         i2sFirPhase[b] = (uint8_t)(i2sFrac[k + b]
+               >> (I2S_FRAC_BITS - DAC_FIR_PHASE_BITS));
+      }
+      dac_fir_block(out + 2 * k, i2sFirTaps, i2sFirPhase,
+                    (const int16_t (*)[DAC_FIR_TAPS])i2sFirCoef, block);
    }
-   else
+}
+
+/* Produce this frame's output into `buffer`: the first pass walks the
+ * read cursor through every output instant the frame reached, the
+ * second interpolates.  Returns the pairs produced; the rest of the
+ * batch is SoundCallback's to pad. */
+static int DACRenderFrame(uint16_t * buffer, int length)
+{
+   uint64_t end = GetEventClock(EVENT_JERRY);
+   uint64_t period = EventUsecToTicks(i2sSamplePeriodUs);
+   uint64_t due = i2sFirstTick;
+   uint64_t step = i2sRateLog[0].step;
+   uint32_t w = i2sFrameWritePos;
+   unsigned rate = 0;
+   int pairs = length / 2;
+   int lead = 0;
+   int n, k;
+
+   if (pairs > I2S_BATCH_MAX)
+      pairs = I2S_BATCH_MAX;
+
+   /* Cursor pass.  Output pair k stands where the event would have
+    * fired: it sees every capture stamped at or before its tick, the
+    * rate last changed before it, and exists only if it fell before
+    * the frame-ending halfline (which won ties on the event clock). */
+   for (n = 0; n < pairs && due < end; n++, due += period)
    {
+      int64_t lag;
+      uint32_t idx0, idx1;
+
+      while (w < i2sWritePos && i2sCaptureTick[w & I2S_RING_MASK] <= due)
+         w++;
+      while (rate + 1 < i2sRateLogCount && i2sRateLog[rate + 1].tick < due)
+         step = i2sRateLog[++rate].step;
+
+      /* Nothing captured yet: the pair is the holding register, as it
+       * stood when the frame opened. */
+      if (w < 2)
+      {
+         lead = n + 1;
+         continue;
+      }
+
       /* i2sPhase is a monotonic read cursor into the captured I2S
        * stream; it advances by the rate ratio per 48 kHz output sample
        * and carries across frames.  Both cursors are rebased together
-       * in DACCaptureSample, which leaves masked indices unchanged.
+       * below, which leaves masked indices unchanged.
        *
        * Resetting the cursor every frame (the old scheme) discarded the
        * read position and re-anchored at the newest sample, stepping
-       * the output once per frame at 60 Hz. */
-      double lag = (double)i2sWritePos - i2sPhase;
-
-      /* Resync only on gross drift: a rate change mid-stream (SCLK
+       * the output once per frame at 60 Hz.
+       *
+       * Resync only on gross drift: a rate change mid-stream (SCLK
        * write), a savestate load, or a DSP that stopped feeding the
        * port.  In steady state capture and consumption both derive
        * from SCLK, so the lag stays put. */
-      if (lag < 0.0 || lag > (double)I2S_RESYNC_LAG)
+      lag = (int64_t)((uint64_t)w << 32) - (int64_t)i2sPhase;
+      if (lag < 0 || lag > (int64_t)I2S_RESYNC_LAG << 32)
       {
          i2sResyncCount++;
-         i2sPhase = (double)i2sWritePos - (double)I2S_TARGET_LAG;
-         if (i2sPhase < 0.0)
-            i2sPhase = 0.0;
-         lag = (double)i2sWritePos - i2sPhase;
+         i2sPhase = (uint64_t)(w - I2S_TARGET_LAG) << 32;
+         lag = (int64_t)I2S_TARGET_LAG << 32;
       }
 
-      idx0 = (uint32_t)i2sPhase;
-      frac = i2sPhase - (double)idx0;
-      idx1 = idx0 + 1;
-
       /* Never read at or past the write cursor: those slots hold the
        * previous lap of the ring. */
-      if (idx0 >= i2sWritePos)
-         idx0 = i2sWritePos - 1;
-      if (idx1 >= i2sWritePos)
-         idx1 = i2sWritePos - 1;
-
-      s0L = (int32_t)i2sRingL[idx0 & I2S_RING_MASK];
-      s1L = (int32_t)i2sRingL[idx1 & I2S_RING_MASK];
-      s0R = (int32_t)i2sRingR[idx0 & I2S_RING_MASK];
-      s1R = (int32_t)i2sRingR[idx1 & I2S_RING_MASK];
-
-      outL = (int16_t)(s0L + (int32_t)((double)(s1L - s0L) * frac));
-      outR = (int16_t)(s0R + (int32_t)((double)(s1R - s0R) * frac));
+      idx0 = (uint32_t)(i2sPhase >> 32);
+      idx1 = idx0 + 1;
+      if (idx0 >= w)
+         idx0 = w - 1;
+      if (idx1 >= w)
+         idx1 = w - 1;
+      i2sIdx0[n] = (uint16_t)(idx0 & I2S_RING_MASK);
+      i2sIdx1[n] = (uint16_t)(idx1 & I2S_RING_MASK);
+      i2sFrac[n] = (int32_t)(i2sPhase >> (32 - I2S_FRAC_BITS))
+                 & ((1 << I2S_FRAC_BITS) - 1);
 
       /* Underrun: hold position until the next capture lands rather
        * than running past the write head. */
-      if (lag > 1.0)
-         i2sPhase += i2sRateRatio * i2sStepScale;
+      if (lag > (int64_t)I2S_PHASE_ONE)
+         i2sPhase += step;
    }
 
-   sampleBuffer[bufferIndex + 0] = (uint16_t)outL;
-   sampleBuffer[bufferIndex + 1] = (uint16_t)outR;
-   bufferIndex += 2;
-
-   if (bufferIndex >= numberOfSamples)
+   /* Interpolation pass: no branches, no cursor state. */
+   if (dacAudioOutput)
    {
-      bufferDone = true;
-      return;
+      for (k = 0; k < lead; k++)
+      {
+         buffer[2 * k + 0] = i2sFrameHoldL;
+         buffer[2 * k + 1] = i2sFrameHoldR;
+      }
+      if (dacResampler == DAC_RESAMPLER_SINC)
+         DACRenderFir((int16_t *)buffer, lead, n);
+      else
+      {
+         for (k = lead; k < n; k++)
+         {
+            int32_t l0 = i2sRingL[i2sIdx0[k]];
+            int32_t r0 = i2sRingR[i2sIdx0[k]];
+
+            buffer[2 * k + 0] = (uint16_t)(l0
+                  + DACLerp(i2sRingL[i2sIdx1[k]] - l0, i2sFrac[k]));
+            buffer[2 * k + 1] = (uint16_t)(r0
+                  + DACLerp(i2sRingR[i2sIdx1[k]] - r0, i2sFrac[k]));
+         }
+      }
    }
 
-   SetCallbackTime(DSPSampleCallback, i2sSamplePeriodUs, EVENT_JERRY);
+   return n;
 }
 
 void DACPrepareFrame(int length)
@@ -334,7 +607,6 @@ void DACPrepareFrame(int length)
    int out_pairs;
    double halfline_us, frame_us, pairs;
 
-   RemoveCallback(DSPSampleCallback);
    bufferIndex = 0;
    numberOfSamples = length;
    bufferDone = false;
@@ -362,19 +634,104 @@ void DACPrepareFrame(int length)
    i2sNonZeroCount = 0;
 
    /* Refresh rate ratio in case SCLK was written between frames */
+   i2sFrameOpen = false;
    DACUpdateSCLKRate();
 
-   SetCallbackTime(DSPSampleCallback, 0.5 * i2sSamplePeriodUs, EVENT_JERRY);
+   /* Open the frame: the first output sample is due half a period in,
+    * as the first event used to be scheduled. */
+   i2sFrameWritePos = i2sWritePos;
+   i2sFrameHoldL = (uint16_t)(*ltxd);
+   i2sFrameHoldR = (uint16_t)(*rtxd);
+   i2sFirstTick = GetEventClock(EVENT_JERRY) + EventUsecToTicks(0.5 * i2sSamplePeriodUs);
+   i2sRateLog[0].tick = GetEventClock(EVENT_JERRY);
+   i2sRateLog[0].step = i2sStep;
+   i2sRateLogCount = 1;
+   i2sFrameOpen = true;
+
+   /* A chain left over from a frame that ended early would otherwise
+    * run alongside the new one and eat into its countdown. */
+   RemoveCallback(DSPSampleCallback);
+   i2sSliceCuts = out_pairs;
+   if (vjs.dacSliceCuts)
+      SetCallbackTime(DSPSampleCallback, 0.5 * i2sSamplePeriodUs, EVENT_JERRY);
+}
+
+/* Both cursors run monotonically for the whole session; fold them
+ * back together once per ring lap.  Subtracting a whole ring size
+ * leaves every masked index unchanged and keeps the uint32 write
+ * cursor from wrapping. */
+static void DACRebaseCursors(void)
+{
+   if (i2sWritePos >= (uint32_t)(2 * I2S_RING_SIZE)
+       && i2sPhase >= (uint64_t)I2S_RING_SIZE << 32)
+   {
+      i2sWritePos -= (uint32_t)I2S_RING_SIZE;
+      i2sPhase    -= (uint64_t)I2S_RING_SIZE << 32;
+   }
+}
+
+/* Native-rate output: every pair the word strobe latched this frame,
+ * as is.  The count follows the I2S rate (DACGetI2SRate), not the
+ * fixed batch, so the frontend sees exactly the hardware stream. */
+static void DACSendNative(void)
+{
+   uint32_t count = 0;
+   uint32_t i;
+
+   PERF_TIME_ENTER(PERF_T_AUDIO);
+   if (i2sFrameOpen)
+      count = i2sWritePos - i2sFrameWritePos;
+   if (count > I2S_RING_SIZE)
+      count = I2S_RING_SIZE;
+   i2sFrameOpen = false;
+   bufferIndex = numberOfSamples;
+   bufferDone = true;
+
+   if (dacAudioOutput)
+   {
+      uint32_t pos = i2sWritePos - count;
+
+      for (i = 0; i < count; i++, pos++)
+      {
+         i2sNativeOut[2 * i + 0] = i2sRingL[pos & I2S_RING_MASK];
+         i2sNativeOut[2 * i + 1] = i2sRingR[pos & I2S_RING_MASK];
+      }
+   }
+
+   /* Park the read cursor where the resampling paths keep it, so
+    * switching back to one of them continues without a resync. */
+   if (i2sWritePos >= I2S_TARGET_LAG)
+      i2sPhase = (uint64_t)(i2sWritePos - I2S_TARGET_LAG) << 32;
+   DACRebaseCursors();
+   PERF_TIME_LEAVE();
+
+   if (dacAudioOutput && count)
+      audio_batch_cb(i2sNativeOut, count);
 }
 
 void SoundCallback(void * userdata, uint16_t * buffer, int length)
 {
+   int produced = 0;
+
+   if (dacResampler == DAC_RESAMPLER_NATIVE)
+   {
+      DACSendNative();
+      return;
+   }
+
+   PERF_TIME_ENTER(PERF_T_AUDIO);
+   if (i2sFrameOpen)
+      produced = DACRenderFrame(buffer, length);
+   i2sFrameOpen = false;
+   bufferIndex = 2 * produced;
+   bufferDone = bufferIndex >= numberOfSamples;
 
    /* An NTSC field is 524 halflines = 16651.56 us = 799.27 periods of
-    * the 48 kHz sample clock, so the event chain lands 799 pairs and
-    * the 800th does not exist yet.  Pad it by HOLDING the last pair the
-    * resampler produced: a DAC starved of new data keeps transmitting
-    * what it last received.
+    * the 48 kHz sample clock.  With the #393 cadence every output
+    * instant lands inside the field, but a frame cut short (VP
+    * reprogrammed mid-frame) can still end before the last one.  Pad
+    * it by HOLDING the last pair the resampler produced: a DAC starved
+    * of new data keeps transmitting what it last received.
     *
     * The batch stays a fixed `length`, which is what keeps the
     * delivered rate exactly on the advertised rate (800 pairs x the
@@ -404,19 +761,46 @@ void SoundCallback(void * userdata, uint16_t * buffer, int length)
 
       for (idx = bufferIndex; idx < length; idx += 2)
       {
-         buffer[idx + 0] = holdL;
-         buffer[idx + 1] = holdR;
+         if (dacAudioOutput)
+         {
+            buffer[idx + 0] = holdL;
+            buffer[idx + 1] = holdR;
+         }
 
          /* A held pair still stands for one output period of real
           * time: advance the read cursor for it too, or the deficit
           * accumulates into a gross-drift resync skip (#393).  Same
-          * underrun guard as DSPSampleCallback. */
-         if (((double)i2sWritePos - i2sPhase) > 1.0)
-            i2sPhase += i2sRateRatio * i2sStepScale;
+          * underrun guard as DACRenderFrame. */
+         if ((int64_t)(((uint64_t)i2sWritePos << 32) - i2sPhase)
+               > (int64_t)I2S_PHASE_ONE)
+            i2sPhase += i2sStep;
       }
    }
 
-   audio_batch_cb((int16_t *)buffer, length / 2);
+   DACRebaseCursors();
+   PERF_TIME_LEAVE();
+
+   if (dacAudioOutput)
+      audio_batch_cb((int16_t *)buffer, length / 2);
+}
+
+void DACSetAudioOutput(bool enabled)
+{
+   dacAudioOutput = enabled;
+}
+
+void DACSetResampler(int mode)
+{
+   if (mode < DAC_RESAMPLER_LINEAR || mode > DAC_RESAMPLER_NATIVE)
+      mode = DAC_RESAMPLER_LINEAR;
+   dacResampler = mode;
+}
+
+/* The rate the word strobe latches pairs at: the native path's output
+ * rate, which the frontend has to be told about. */
+double DACGetI2SRate(void)
+{
+   return i2sRateRatio * (double)DAC_AUDIO_RATE;
 }
 
 /* LTXD/RTXD/SCLK/SMODE ($F1A148/4C/50/54) */
@@ -505,6 +889,7 @@ uint16_t DACReadWord(uint32_t offset, uint32_t who)
 size_t DACStateSave(uint8_t *buf)
 {
 	uint8_t *start = buf;
+	double phase;
 
 	STATE_SAVE_VAR(buf, bufferIndex);
 	STATE_SAVE_VAR(buf, numberOfSamples);
@@ -512,7 +897,10 @@ size_t DACStateSave(uint8_t *buf)
 	STATE_SAVE_VAR(buf, i2sWritePos);
 	STATE_SAVE_VAR(buf, i2sWriteCount);
 	STATE_SAVE_VAR(buf, i2sNonZeroCount);
-	STATE_SAVE_VAR(buf, i2sPhase);
+	/* The read cursor is kept in fixed point but travels as the double
+	 * the layout has always carried; 32.32 converts exactly. */
+	phase = (double)i2sPhase / (double)I2S_PHASE_ONE;
+	STATE_SAVE_VAR(buf, phase);
 	STATE_SAVE_VAR(buf, i2sRateRatio);
 
 	/* v8: the I2S hardware registers themselves.  They live in
@@ -539,6 +927,7 @@ size_t DACStateSave(uint8_t *buf)
 size_t DACStateLoad(const uint8_t *buf, uint32_t stateVersion)
 {
 	const uint8_t *start = buf;
+	double phase;
 
 	STATE_LOAD_VAR(buf, bufferIndex);
 	STATE_LOAD_VAR(buf, numberOfSamples);
@@ -572,12 +961,13 @@ size_t DACStateLoad(const uint8_t *buf, uint32_t stateVersion)
 		i2sNonZeroCount = 0;
 	if (stateVersion >= STATE_VERSION_DAC_I2S_RESAMPLER)
 	{
-		STATE_LOAD_VAR(buf, i2sPhase);
+		STATE_LOAD_VAR(buf, phase);
 		STATE_LOAD_VAR(buf, i2sRateRatio);
+		i2sPhase = phase > 0.0 ? (uint64_t)(phase * (double)I2S_PHASE_ONE) : 0;
 	}
 	else
 	{
-		i2sPhase = 0.0;
+		i2sPhase = 0;
 		i2sRateRatio = 1.0;
 	}
 
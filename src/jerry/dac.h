@@ -22,6 +22,9 @@ uint32_t DACGetI2SWriteCount(void);
 uint32_t DACGetI2SNonZeroCount(void);
 double DACGetI2SLag(void);
 uint32_t DACGetI2SResyncCount(void);
+void DACSetAudioOutput(bool enabled);
+void DACSetResampler(int mode);
+double DACGetI2SRate(void);
 
 // DAC memory access
 
@@ -42,6 +45,12 @@ extern uint16_t *sampleBuffer;
 #define SMODE_FALLING		0x10
 #define SMODE_EVERYWORD		0x20
 
+// Output paths (DACSetResampler)
+
+#define DAC_RESAMPLER_LINEAR	0	// 48 kHz, linear interpolation
+#define DAC_RESAMPLER_SINC		1	// 48 kHz, windowed-sinc polyphase FIR
+#define DAC_RESAMPLER_NATIVE	2	// raw captures at the I2S rate
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,67 @@
+/*
+ * SIMD polyphase FIR kernel for the DAC's band-limited resampler
+ *
+ * Laid out like blitter_simd.h: the per-arch split of simd_arch.h, a
+ * static inline function in a header so dac.c inlines it, and an
+ * out-of-line vtable built by src/core/simd_ops_<arch>.c so
+ * test/test_dac_fir.c validates exactly the code the core runs.
+ *
+ * dac.c gathers, for each output pair, DAC_FIR_TAPS consecutive ring
+ * samples per channel (left taps, then right) and picks one row of a
+ * DAC_FIR_PHASES x DAC_FIR_TAPS table of Q14 coefficients by the
+ * read cursor's fraction.  The kernel is only the dot products:
+ *
+ *   out = sat16((sum(tap[j] * coef[j]) + (1 << 13)) >> 14)
+ *
+ * per channel, written as an interleaved L/R pair.  Each coefficient
+ * row sums to 1 << 14 and its absolute sum stays well below 1 << 16,
+ * so the 32-bit accumulator cannot overflow for any int16 input.
+ */
+
+#ifndef DAC_FIR_H
+#define DAC_FIR_H
+
+#include <stdint.h>
+
+#include "simd_arch.h"
+
+#define DAC_FIR_TAPS		16
+#define DAC_FIR_PHASE_BITS	8
+#define DAC_FIR_PHASES		(1 << DAC_FIR_PHASE_BITS)
+#define DAC_FIR_SHIFT		14
+
+typedef void (*dac_fir_fn)(int16_t *dst, const int16_t *taps,
+                           const uint8_t *phase,
+                           const int16_t (*coef)[DAC_FIR_TAPS],
+                           unsigned count);
+
+typedef struct
+{
+   /* `count` pairs: taps[k * 2 * DAC_FIR_TAPS ...] with row
+    * coef[phase[k]] -> dst[2 * k], dst[2 * k + 1]. */
+   dac_fir_fn block;
+} dac_fir_ops_t;
+
+extern const dac_fir_ops_t dac_fir_ops;
+
+static SIMD_INLINE
+int16_t dac_fir_sat16(int32_t acc)
+{
+   acc = (acc + (1 << (DAC_FIR_SHIFT - 1))) >> DAC_FIR_SHIFT;
+   if (acc > 32767)
+      return 32767;
+   if (acc < -32768)
+      return -32768;
+   return (int16_t)acc;
+}
+
+/* dac_fir_block for the selected arch. */
+#if defined(SIMD_ARCH_NEON)
+#  include "dac_fir_neon.h"
+#elif defined(SIMD_ARCH_SSE2)
+#  include "dac_fir_sse2.h"
+#else
+#  include "dac_fir_scalar.h"
+#endif
+
+#endif /* DAC_FIR_H */
@@ -0,0 +1,55 @@
+#ifndef DAC_FIR_NEON_H
+#define DAC_FIR_NEON_H
+
+/* Included by dac_fir.h once the arch has been selected.
+ * Do not include directly. */
+#ifndef DAC_FIR_H
+#error "include dac_fir.h, not dac_fir_neon.h"
+#endif
+
+#include <arm_neon.h>
+
+/*
+ * Polyphase FIR -- ARM NEON implementation (ARMv7 and AArch64)
+ *
+ * One output pair per step: four vmlal_s16 per channel, two levels of
+ * vpadd for the horizontal sum (ARMv7 has no vaddvq), and vqrshrn
+ * does the rounding shift and the int16 saturation in one go.
+ */
+
+static SIMD_INLINE
+void dac_fir_block(int16_t *dst, const int16_t *taps, const uint8_t *phase,
+                   const int16_t (*coef)[DAC_FIR_TAPS], unsigned count)
+{
+   unsigned k;
+
+   for (k = 0; k < count; k++, taps += 2 * DAC_FIR_TAPS)
+   {
+      const int16_t *c = coef[phase[k]];
+      int16x8_t c0 = vld1q_s16(c);
+      int16x8_t c1 = vld1q_s16(c + 8);
+      int16x8_t l0 = vld1q_s16(taps);
+      int16x8_t l1 = vld1q_s16(taps + 8);
+      int16x8_t r0 = vld1q_s16(taps + 16);
+      int16x8_t r1 = vld1q_s16(taps + 24);
+      int32x4_t l  = vmull_s16(vget_low_s16(l0), vget_low_s16(c0));
+      int32x4_t r  = vmull_s16(vget_low_s16(r0), vget_low_s16(c0));
+      int32x2_t lr;
+      int16x4_t out;
+
+      l = vmlal_s16(l, vget_high_s16(l0), vget_high_s16(c0));
+      l = vmlal_s16(l, vget_low_s16(l1),  vget_low_s16(c1));
+      l = vmlal_s16(l, vget_high_s16(l1), vget_high_s16(c1));
+      r = vmlal_s16(r, vget_high_s16(r0), vget_high_s16(c0));
+      r = vmlal_s16(r, vget_low_s16(r1),  vget_low_s16(c1));
+      r = vmlal_s16(r, vget_high_s16(r1), vget_high_s16(c1));
+
+      lr  = vpadd_s32(vpadd_s32(vget_low_s32(l), vget_high_s32(l)),
+                      vpadd_s32(vget_low_s32(r), vget_high_s32(r)));
+      out = vqrshrn_n_s32(vcombine_s32(lr, lr), DAC_FIR_SHIFT);
+      vst1_lane_s16(dst + 2 * k + 0, out, 0);
+      vst1_lane_s16(dst + 2 * k + 1, out, 1);
+   }
+}
+
+#endif /* DAC_FIR_NEON_H */
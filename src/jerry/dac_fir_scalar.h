@@ -0,0 +1,38 @@
+#ifndef DAC_FIR_SCALAR_H
+#define DAC_FIR_SCALAR_H
+
+/* Included by dac_fir.h once the arch has been selected.
+ * Do not include directly. */
+#ifndef DAC_FIR_H
+#error "include dac_fir.h, not dac_fir_scalar.h"
+#endif
+
+/*
+ * Polyphase FIR -- portable scalar implementation
+ *
+ * Two 16-tap multiply-accumulates per output pair.  Also the shape of
+ * the reference test/test_dac_fir.c compares the SIMD variants against.
+ */
+
+static SIMD_INLINE
+void dac_fir_block(int16_t *dst, const int16_t *taps, const uint8_t *phase,
+                   const int16_t (*coef)[DAC_FIR_TAPS], unsigned count)
+{
+   unsigned k, j;
+
+   for (k = 0; k < count; k++, taps += 2 * DAC_FIR_TAPS)
+   {
+      const int16_t *c = coef[phase[k]];
+      int32_t l = 0, r = 0;
+
+      for (j = 0; j < DAC_FIR_TAPS; j++)
+      {
+         l += (int32_t)taps[j] * c[j];
+         r += (int32_t)taps[DAC_FIR_TAPS + j] * c[j];
+      }
+      dst[2 * k + 0] = dac_fir_sat16(l);
+      dst[2 * k + 1] = dac_fir_sat16(r);
+   }
+}
+
+#endif /* DAC_FIR_SCALAR_H */
@@ -0,0 +1,51 @@
+#ifndef DAC_FIR_SSE2_H
+#define DAC_FIR_SSE2_H
+
+/* Included by dac_fir.h once the arch has been selected.
+ * Do not include directly. */
+#ifndef DAC_FIR_H
+#error "include dac_fir.h, not dac_fir_sse2.h"
+#endif
+
+#include <string.h>
+#include <emmintrin.h>  /* SSE2 */
+
+/*
+ * Polyphase FIR -- x86/x64 SSE2 implementation
+ *
+ * One output pair per step: pmaddwd folds the 16 taps of each channel
+ * into four 32-bit partial sums, two unpacks put left and right side
+ * by side for the horizontal add, and packssdw does the int16
+ * saturation.
+ */
+
+static SIMD_INLINE
+void dac_fir_block(int16_t *dst, const int16_t *taps, const uint8_t *phase,
+                   const int16_t (*coef)[DAC_FIR_TAPS], unsigned count)
+{
+   const __m128i round = _mm_set1_epi32(1 << (DAC_FIR_SHIFT - 1));
+   unsigned k;
+
+   for (k = 0; k < count; k++, taps += 2 * DAC_FIR_TAPS)
+   {
+      const int16_t *c = coef[phase[k]];
+      int32_t pair;
+      __m128i c0 = _mm_loadu_si128((const __m128i *)c);
+      __m128i c1 = _mm_loadu_si128((const __m128i *)(c + 8));
+      __m128i l  = _mm_add_epi32(
+            _mm_madd_epi16(_mm_loadu_si128((const __m128i *)taps), c0),
+            _mm_madd_epi16(_mm_loadu_si128((const __m128i *)(taps + 8)), c1));
+      __m128i r  = _mm_add_epi32(
+            _mm_madd_epi16(_mm_loadu_si128((const __m128i *)(taps + 16)), c0),
+            _mm_madd_epi16(_mm_loadu_si128((const __m128i *)(taps + 24)), c1));
+      /* l0 r0 l1 r1 + l2 r2 l3 r3, then the two halves: L R in lanes 0-1. */
+      __m128i s  = _mm_add_epi32(_mm_unpacklo_epi32(l, r),
+                                 _mm_unpackhi_epi32(l, r));
+      s = _mm_add_epi32(s, _mm_srli_si128(s, 8));
+      s = _mm_srai_epi32(_mm_add_epi32(s, round), DAC_FIR_SHIFT);
+      pair = _mm_cvtsi128_si32(_mm_packs_epi32(s, s));
+      memcpy(dst + 2 * k, &pair, sizeof(pair));
+   }
+}
+
+#endif /* DAC_FIR_SSE2_H */
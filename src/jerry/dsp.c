@@ -29,6 +29,11 @@
 #include "m68000/m68kinterface.h"
 #include "settings.h"
 #include "../core/vjtrace.h"
+#include "../core/risc_block.h"
+#include "../core/risc_jit.h"
+#include "../core/risc_idle.h"
+#include "../core/vjthread.h"
+#include "../core/perf_timing.h"
 
 // Seems alignment in loads & stores was off...
 #define DSP_CORRECT_ALIGNMENT
@@ -300,6 +305,53 @@ uint8_t dsp_branch_condition_table[32 * 8];
 static uint16_t mirror_table[65536];
 static uint8_t dsp_ram_8[0x2000];
 
+/* Pre-decoded instruction stream over DSP local RAM -- the same
+ * write-through scheme and entry layout as gpu_decoded[] in gpu.c (see
+ * the comment there and src/core/risc_block.h).  Iron Soldier spends ~67% of its frame in DSPExec plus the
+ * jr delay slot (docs/op-perf-profile.md); each step from SRAM is now
+ * one 4-byte load instead of a byte-pair fetch and field split.
+ *
+ * Every store into dsp_ram_8 re-decodes the words it touched: the
+ * DSPWrite* paths, the HLE sound-engine auto-ack clears in
+ * DSPReadWord/Long, DSPReset and DSPStateLoad.  DSPGetRAM() hands out
+ * a raw writable pointer (test harnesses poke programs through it), so
+ * it marks the whole table stale and the next DSPExec entry rebuilds
+ * it.  Derived state, never serialized; DSPSetDecodeCache() exists
+ * only for A/B runs. */
+static RISCDecodedOp dsp_decoded[0x1000];
+static int dsp_decode_cache = 1;
+static int dsp_decode_stale = 0;
+/* Run straight-line superblocks (risc_block.h) in one step. */
+static int dsp_superblocks = 1;
+/* x86-64 translation of hot superblocks; see gpu_jit_enabled. */
+static int dsp_jit_enabled = 0;
+static RISCJitBlock dsp_jit_blocks[0x1000];
+static uint8_t dsp_jit_heat[0x1000];
+/* Skip the repeats of an idle polling loop (risc_idle.h). */
+static int dsp_idle_skip = 1;
+static RISCIdleWatch dsp_idle;
+
+/* Straight-line run members for the DSP opcode map; see the GPU's
+ * gpu_opcode_straight.  Slots that differ from the GPU: 32 subqmod,
+ * 33 sat16s, 42 sat32s, 48 mirror, 63 addqmod are straight; 62 is
+ * unassigned on the DSP and ends a run like any other oddity. */
+static const uint8_t dsp_opcode_straight[64] =
+{
+	1, 1, 1, 1, 1, 1, 1, 1,		/* add addc addq addqt sub subc subq subqt */
+	1, 1, 1, 1, 1, 1, 1, 1,		/* neg and or xor not btst bset bclr */
+	1, 1, 1, 1, 1, 1, 1, 1,		/* mult imult imultn resmac imacn div abs sh */
+	1, 1, 1, 1, 1, 1, 1, 1,		/* shlq shrq sha sharq ror rorq cmp cmpq */
+	1, 1, 1, 1, 1, 1, 0, 0,		/* subqmod sat16s move moveq moveta movefa movei loadb */
+	0, 0, 1, 0, 0, 0, 0, 0,		/* loadw load sat32s load_r14_i load_r15_i storeb storew store */
+	1, 0, 0, 1, 0, 0, 0, 1,		/* mirror store_r14_i store_r15_i move_pc jump jr mmult mtoi */
+	1, 1, 0, 0, 0, 0, 0, 1		/* normi nop load_r14_ri load_r15_ri store_r14_ri store_r15_ri illegal addqmod */
+};
+
+static const RISCDecodeTable dsp_decode_table =
+{
+	dsp_decoded, dsp_ram_8, 0x1000, dsp_opcode_cycles, dsp_opcode_straight
+};
+
 static uint32_t dspgo_poll_count;
 
 #define BRANCH_CONDITION(x)		dsp_branch_condition_table[(x) + ((jaguar_flags & 7) << 5)]
@@ -335,8 +387,318 @@ void dsp_reset_stats(void)
 {
 }
 
+static RISCJit dsp_jit =
+{
+	&dsp_flag_z, &dsp_flag_n, &dsp_flag_c,
+	&dsp_opcode_first_parameter, &dsp_opcode_second_parameter,
+	dsp_opcode, DSP_WORK_RAM_BASE,
+	dsp_jit_blocks, dsp_jit_heat, 0x1000,
+	NULL, 0, 0
+};
+
+/* Re-decode every word overlapping SRAM bytes [off, off + len), and
+ * drop any translation that could cover them. */
+INLINE static void DSPDecodeRange(uint32_t off, uint32_t len)
+{
+	RISCDecodeRange(&dsp_decode_table, off, len);
+	RISCJitInvalidate(&dsp_jit, off, len);
+}
+
+void DSPSetDecodeCache(int enabled)
+{
+	dsp_decode_cache = enabled ? 1 : 0;
+}
+
+void DSPSetSuperblocks(int enabled)
+{
+	dsp_superblocks = enabled ? 1 : 0;
+}
+
+void DSPSetIdleSkip(int enabled)
+{
+	dsp_idle_skip = enabled ? 1 : 0;
+}
+
+void DSPIdleSkipStats(uint64_t * cycles, uint32_t * skips)
+{
+	if (cycles)
+		*cycles = dsp_idle.skipped;
+	if (skips)
+		*skips = dsp_idle.skips;
+}
+
+int DSPSetJit(int enabled)
+{
+	if (!enabled)
+		dsp_jit_enabled = 0;
+	else if (!dsp_jit_enabled)
+		dsp_jit_enabled = RISCJitEnable(&dsp_jit);
+	return dsp_jit_enabled;
+}
+
+/* ---- Threaded DSP ----
+ *
+ * JaguarExecuteNew() runs each slice as 68000, then GPU, then DSP, and
+ * on sound-heavy titles the DSP's share is the biggest.  With
+ * DSPSetThreaded(true) a worker thread starts the DSP's share while the
+ * main thread is still running the other two.  That only matches running
+ * it afterwards while neither side can see the other, so the worker
+ * speculates:
+ *
+ *  - It runs freely while the DSP touches nothing but its registers,
+ *    its local RAM and its control registers.  The first access to
+ *    anything else -- main RAM, TOM, the JERRY peripherals, or D_CTRL,
+ *    which reaches the 68000 and JERRY interrupt logic -- parks it until
+ *    the 68000 and GPU are through the slice (dsp_spec_external).  That
+ *    access and the rest of the slice then happen where the serial order
+ *    puts them, with the main thread waiting.
+ *
+ *  - Anything on the main thread that reaches the DSP during the slice
+ *    -- a 68000, GPU, blitter or OP access to DSP RAM or registers,
+ *    DSPSyncToM68K(), an interrupt -- would find the DSP too far ahead.
+ *    That is a conflict (dsp_spec_claim): the worker is stopped, the DSP
+ *    is rolled back to the start of the slice and the slice is finished
+ *    serially.  The rollback is a copy of the registers taken when the
+ *    slice was handed out plus an undo log of the local RAM the worker
+ *    wrote.
+ *
+ * Either way the result is bit-identical to the serial scheduler; the
+ * mode only decides how much of the DSP's slice overlaps the other two
+ * processors.  The DSP state changes hands only through the vj_event
+ * handoffs.  After a rollback the next few slices run serially, so a
+ * title that polls DSP RAM every slice does not pay for a snapshot it
+ * throws away each time. */
+#define DSP_SPEC_UNDO_MAX	512
+#define DSP_SPEC_BACKOFF	32
+
+typedef struct dsp_spec_undo
+{
+	uint32_t off;
+	uint8_t old[4];
+} dsp_spec_undo;
+
+/* What a speculative DSPExec() can change before it parks.  The
+ * pipeline and scoreboard are only touched from the D_CTRL path, which
+ * parks first. */
+typedef struct dsp_spec_snapshot
+{
+	uint64_t acc;
+	uint32_t pc, remain, modulo, flags, matrix_control, pointer_to_matrix;
+	uint32_t data_organization, control, div_control;
+	uint8_t flag_z, flag_n, flag_c;
+	uint32_t bank0[32], bank1[32];
+	uint32_t * reg, * alternate_reg, * pre_store_bank;
+	uint32_t first_parameter, second_parameter;
+	uint32_t in_exec, release_flag, flags_retire_delay;
+	uint32_t go_poll_count, opcode_count;
+	uint64_t idle_skipped;
+	uint32_t idle_skips;
+	int32_t slice_spent;
+	int decode_stale;
+	bool imask_cleared;
+} dsp_spec_snapshot;
+
+static vj_thread * dspThread;
+static vj_event * dspToWorker;			// slice handed out, 68K+GPU done, abort, quit
+static vj_event * dspToMain;			// slice finished
+static volatile int dspSpecSlice;		// last slice handed out
+static volatile int dspSpecFinished;	// last slice the worker finished
+static volatile int dspSpecMainDone;	// 68K and GPU are through this slice
+static volatile int dspSpecAbort;		// roll this slice back
+static volatile int dspSpecQuit;
+/* Main thread only. */
+static int dspSpecSeq;
+static bool dspSpecPending;				// the worker holds the DSP this slice
+static uint32_t dspSpecBackoff;
+/* Whichever thread is running the DSP. */
+static bool dspSpecLive;				// this DSPExec() is speculative
+static bool dspSpecAborted;
+static dsp_spec_snapshot dspSpecSnap;
+static dsp_spec_undo dspSpecUndo[DSP_SPEC_UNDO_MAX];
+static uint32_t dspSpecUndoCount;
+/* See DSPThreadStats(). */
+static uint32_t dspThreadSlices, dspThreadParks, dspThreadRollbacks;
+
+static void dsp_spec_save(dsp_spec_snapshot * s)
+{
+	s->acc = dsp_acc;
+	s->pc = dsp_pc;
+	s->remain = dsp_remain;
+	s->modulo = dsp_modulo;
+	s->flags = dsp_flags;
+	s->matrix_control = dsp_matrix_control;
+	s->pointer_to_matrix = dsp_pointer_to_matrix;
+	s->data_organization = dsp_data_organization;
+	s->control = dsp_control;
+	s->div_control = dsp_div_control;
+	s->flag_z = dsp_flag_z;
+	s->flag_n = dsp_flag_n;
+	s->flag_c = dsp_flag_c;
+	memcpy(s->bank0, dsp_reg_bank_0, sizeof(s->bank0));
+	memcpy(s->bank1, dsp_reg_bank_1, sizeof(s->bank1));
+	s->reg = dsp_reg;
+	s->alternate_reg = dsp_alternate_reg;
+	s->pre_store_bank = dspPreStoreBank;
+	s->first_parameter = dsp_opcode_first_parameter;
+	s->second_parameter = dsp_opcode_second_parameter;
+	s->in_exec = dsp_in_exec;
+	s->release_flag = dsp_releaseTimeSlice_flag;
+	s->flags_retire_delay = dspFlagsRetireDelay;
+	s->go_poll_count = dspgo_poll_count;
+	s->opcode_count = dsp_exec_opcode_count;
+	s->idle_skipped = dsp_idle.skipped;
+	s->idle_skips = dsp_idle.skips;
+	s->slice_spent = dspSliceSpent;
+	s->decode_stale = dsp_decode_stale;
+	s->imask_cleared = IMASKCleared;
+}
+
+static void dsp_spec_restore(const dsp_spec_snapshot * s)
+{
+	dsp_acc = s->acc;
+	dsp_pc = s->pc;
+	dsp_remain = s->remain;
+	dsp_modulo = s->modulo;
+	dsp_flags = s->flags;
+	dsp_matrix_control = s->matrix_control;
+	dsp_pointer_to_matrix = s->pointer_to_matrix;
+	dsp_data_organization = s->data_organization;
+	dsp_control = s->control;
+	dsp_div_control = s->div_control;
+	dsp_flag_z = s->flag_z;
+	dsp_flag_n = s->flag_n;
+	dsp_flag_c = s->flag_c;
+	memcpy(dsp_reg_bank_0, s->bank0, sizeof(s->bank0));
+	memcpy(dsp_reg_bank_1, s->bank1, sizeof(s->bank1));
+	dsp_reg = s->reg;
+	dsp_alternate_reg = s->alternate_reg;
+	dspPreStoreBank = s->pre_store_bank;
+	dsp_opcode_first_parameter = s->first_parameter;
+	dsp_opcode_second_parameter = s->second_parameter;
+	dsp_in_exec = s->in_exec;
+	dsp_releaseTimeSlice_flag = s->release_flag;
+	dspFlagsRetireDelay = s->flags_retire_delay;
+	dspgo_poll_count = s->go_poll_count;
+	dsp_exec_opcode_count = s->opcode_count;
+	dsp_idle.skipped = s->idle_skipped;
+	dsp_idle.skips = s->idle_skips;
+	dspSliceSpent = s->slice_spent;
+	dsp_decode_stale = s->decode_stale;
+	IMASKCleared = s->imask_cleared;
+}
+
+/* Wait for the worker to be done with the current slice. */
+static void dsp_thread_wait(void)
+{
+	unsigned seen = VJEventCount(dspToMain);
+
+	while (VJAtomicGet(&dspSpecFinished) != dspSpecSeq)
+		seen = VJEventWait(dspToMain, seen);
+}
+
+/* Worker side: the DSP is about to do something the serial order puts
+ * after the 68000 and GPU slices.  Park until they are done, then carry
+ * on for real.  False when the slice is being rolled back instead: the
+ * caller skips the access, and clearing DSPGO stops DSPExec() at the
+ * next instruction.  The restore puts both right. */
+static bool dsp_spec_external(void)
+{
+	unsigned seen;
+
+	if (dspSpecAborted)
+		return false;
+
+	dspThreadParks++;
+	seen = VJEventCount(dspToWorker);
+	while (!VJAtomicGet(&dspSpecMainDone) && !VJAtomicGet(&dspSpecAbort))
+		seen = VJEventWait(dspToWorker, seen);
+
+	if (VJAtomicGet(&dspSpecAbort))
+	{
+		dspSpecAborted = true;
+		dsp_control &= ~DSPGO;
+		return false;
+	}
+	dspSpecLive = false;
+	return true;
+}
+
+/* True when a DSP access has to be skipped; see dsp_spec_external(). */
+#define DSP_SPEC_SKIP()		(dspSpecLive && !dsp_spec_external())
+
+/* Worker side: keep the local-RAM long at `off` for a rollback before a
+ * store changes it.  A full log ends speculation like an external access. */
+static bool dsp_spec_log(uint32_t off)
+{
+	dsp_spec_undo * u;
+
+	if (dspSpecUndoCount == DSP_SPEC_UNDO_MAX)
+		return dsp_spec_external();
+
+	u = &dspSpecUndo[dspSpecUndoCount++];
+	u->off = off & 0x1FFC;
+	memcpy(u->old, &dsp_ram_8[u->off], 4);
+	return true;
+}
+
+/* Main side: something is about to reach the DSP mid-slice.  Stop the
+ * worker and put the DSP back where the slice started; the caller and
+ * then the rest of the slice go ahead serially. */
+static void dsp_spec_claim(void)
+{
+	dspSpecPending = false;
+	VJAtomicSet(&dspSpecAbort, 1);
+	VJEventPost(dspToWorker);
+	dsp_thread_wait();
+
+	while (dspSpecUndoCount)
+	{
+		const dsp_spec_undo * u = &dspSpecUndo[--dspSpecUndoCount];
+
+		memcpy(&dsp_ram_8[u->off], u->old, 4);
+		DSPDecodeRange(u->off, 4);
+	}
+	dsp_spec_restore(&dspSpecSnap);
+	dspThreadRollbacks++;
+	dspSpecBackoff = DSP_SPEC_BACKOFF;
+}
+
+#define DSP_SPEC_CLAIM()	do { if (dspSpecPending) dsp_spec_claim(); } while (0)
+
+/* Fetch the opcode at dsp_pc into the decode globals and return its
+ * dispatch index; *cycles gets its base cost.  Shared by the exec loop
+ * and the jump/jr delay slot. */
+INLINE static uint32_t DSPFetchOpcode(uint32_t *cycles)
+{
+	uint32_t off = dsp_pc - DSP_WORK_RAM_BASE;
+	uint16_t opcode;
+
+	/* SRAM and word-aligned: one load from the decoded stream. */
+	if (dsp_decode_cache && (off & 0xFFFFE001) == 0)
+	{
+		const RISCDecodedOp *op = &dsp_decoded[off >> 1];
+		dsp_opcode_first_parameter  = op->reg1;
+		dsp_opcode_second_parameter = op->reg2;
+		*cycles = op->cycles;
+		return op->index;
+	}
+
+	if (off < 0x2000)
+		opcode = ((uint16_t)dsp_ram_8[off] << 8) | (uint16_t)dsp_ram_8[off + 1];
+	else
+		opcode = DSPReadWord(dsp_pc, DSP);
+	dsp_opcode_first_parameter  = (opcode >> 5) & 0x1F;
+	dsp_opcode_second_parameter = opcode & 0x1F;
+	*cycles = dsp_opcode_cycles[opcode >> 10];
+	return opcode >> 10;
+}
+
 void DSPReleaseTimeslice(void)
 {
+	/* From the 68000 or GPU while the worker has the slice: the serial
+	 * order would clear it again when the DSP's share starts. */
+	if (dspSpecPending)
+		return;
 	dsp_releaseTimeSlice_flag = 1;
 }
 
@@ -384,6 +746,9 @@ void dsp_build_branch_condition_table(void)
 
 uint8_t DSPReadByte(uint32_t offset, uint32_t who/*=UNKNOWN*/)
 {
+	if (who != DSP)
+		DSP_SPEC_CLAIM();
+
 	if (offset >= DSP_WORK_RAM_BASE && offset <= (DSP_WORK_RAM_BASE + 0x1FFF))
 		return dsp_ram_8[offset - DSP_WORK_RAM_BASE];
 
@@ -404,11 +769,16 @@ uint8_t DSPReadByte(uint32_t offset, uint32_t who/*=UNKNOWN*/)
 			return(data&0xff);
 	}
 
+	if (DSP_SPEC_SKIP())
+		return 0;
 	return JaguarReadByte(offset, who);
 }
 
 uint16_t DSPReadWord(uint32_t offset, uint32_t who/*=UNKNOWN*/)
 {
+	if (who != DSP)
+		DSP_SPEC_CLAIM();
+
 	offset &= 0xFFFFFFFE;
 
 	if (offset >= DSP_WORK_RAM_BASE && offset <= DSP_WORK_RAM_BASE+0x1FFF)
@@ -423,6 +793,7 @@ uint16_t DSPReadWord(uint32_t offset, uint32_t who/*=UNKNOWN*/)
 				&& offset >= DSP_SOUND_CMD_BASE && offset < DSP_SOUND_CMD_END)
 		{
 			SET16(dsp_ram_8, offset, 0);
+			DSPDecodeRange(offset, 2);
 			return 0;
 		}
 
@@ -437,11 +808,16 @@ uint16_t DSPReadWord(uint32_t offset, uint32_t who/*=UNKNOWN*/)
       return data >> 16;
 	}
 
+	if (DSP_SPEC_SKIP())
+		return 0;
 	return JaguarReadWord(offset, who);
 }
 
 uint32_t DSPReadLong(uint32_t offset, uint32_t who/*=UNKNOWN*/)
 {
+   if (who != DSP)
+      DSP_SPEC_CLAIM();
+
    offset &= 0xFFFFFFFC;
 
    if (offset >= DSP_WORK_RAM_BASE && offset <= DSP_WORK_RAM_BASE + 0x1FFF)
@@ -484,6 +860,7 @@ uint32_t DSPReadLong(uint32_t offset, uint32_t who/*=UNKNOWN*/)
             && offset >= DSP_SOUND_CMD_BASE && offset < DSP_SOUND_CMD_END)
       {
          SET32(dsp_ram_8, offset, 0);
+         DSPDecodeRange(offset, 4);
          return 0;
       }
 
@@ -559,15 +936,23 @@ uint32_t DSPReadLong(uint32_t offset, uint32_t who/*=UNKNOWN*/)
       return 0xFFFFFFFF;
    }
 
+   if (DSP_SPEC_SKIP())
+      return 0;
    return JaguarReadLong(offset, who);
 }
 
 void DSPWriteByte(uint32_t offset, uint8_t data, uint32_t who/*=UNKNOWN*/)
 {
+   if (who != DSP)
+      DSP_SPEC_CLAIM();
+
    if ((offset >= DSP_WORK_RAM_BASE) && (offset < DSP_WORK_RAM_BASE+0x2000))
    {
       offset -= DSP_WORK_RAM_BASE;
+      if (dspSpecLive && !dsp_spec_log(offset))
+         return;
       dsp_ram_8[offset] = data;
+      DSPDecodeRange(offset, 1);
       return;
    }
    if ((offset >= DSP_CONTROL_RAM_BASE) && (offset < DSP_CONTROL_RAM_BASE+0x20))
@@ -588,11 +973,16 @@ void DSPWriteByte(uint32_t offset, uint8_t data, uint32_t who/*=UNKNOWN*/)
       return;
    }
 
+   if (DSP_SPEC_SKIP())
+      return;
    JaguarWriteByte(offset, data, who);
 }
 
 void DSPWriteWord(uint32_t offset, uint16_t data, uint32_t who/*=UNKNOWN*/)
 {
+   if (who != DSP)
+      DSP_SPEC_CLAIM();
+
    offset &= 0xFFFFFFFE;
 
    if ((offset >= DSP_WORK_RAM_BASE) && (offset < DSP_WORK_RAM_BASE+0x2000))
@@ -602,6 +992,9 @@ void DSPWriteWord(uint32_t offset, uint16_t data, uint32_t who/*=UNKNOWN*/)
       if (offset >= 0xF1B270 && offset <= 0xF1B277)
       {
          static uint32_t mboxWrites = 0;
+         /* The log line reads 68000 state. */
+         if (DSP_SPEC_SKIP())
+            return;
          mboxWrites++;
          if (mboxWrites <= 40 || (mboxWrites % 10000) == 0)
             LOG_DBG("[CDDA] DSP mailbox write.w $%06X = $%04X who=%u 68kpc=$%06X\n",
@@ -630,8 +1023,11 @@ void DSPWriteWord(uint32_t offset, uint16_t data, uint32_t who/*=UNKNOWN*/)
          }
       }
       offset -= DSP_WORK_RAM_BASE;
+      if (dspSpecLive && !dsp_spec_log(offset))
+         return;
       dsp_ram_8[offset] = data >> 8;
       dsp_ram_8[offset+1] = data & 0xFF;
+      DSPDecodeRange(offset, 2);
       //CC only!
       return;
    }
@@ -659,11 +1055,16 @@ void DSPWriteWord(uint32_t offset, uint16_t data, uint32_t who/*=UNKNOWN*/)
       return;
    }
 
+   if (DSP_SPEC_SKIP())
+      return;
    JaguarWriteWord(offset, data, who);
 }
 
 void DSPWriteLong(uint32_t offset, uint32_t data, uint32_t who/*=UNKNOWN*/)
 {
+   if (who != DSP)
+      DSP_SPEC_CLAIM();
+
    offset &= 0xFFFFFFFC;
 
    if (offset >= DSP_WORK_RAM_BASE && offset <= DSP_WORK_RAM_BASE + 0x1FFF)
@@ -675,13 +1076,19 @@ void DSPWriteLong(uint32_t offset, uint32_t data, uint32_t who/*=UNKNOWN*/)
       if (offset >= 0xF1B270 && offset <= 0xF1B277)
       {
          static uint32_t mboxWritesL = 0;
+         /* The log line reads 68000 state. */
+         if (DSP_SPEC_SKIP())
+            return;
          mboxWritesL++;
          if (mboxWritesL <= 40 || (mboxWritesL % 10000) == 0)
             LOG_DBG("[CDDA] DSP mailbox write $%06X = $%08X who=%u 68kpc=$%06X\n",
                     offset, data, who, m68k_get_reg(NULL, M68K_REG_PC));
       }
       offset -= DSP_WORK_RAM_BASE;
+      if (dspSpecLive && !dsp_spec_log(offset))
+         return;
       SET32(dsp_ram_8, offset, data);
+      DSPDecodeRange(offset, 4);
       //CC only!
       return;
    }
@@ -780,6 +1187,9 @@ void DSPWriteLong(uint32_t offset, uint32_t data, uint32_t who/*=UNKNOWN*/)
             {
                uint32_t mask;
                bool wasRunning = DSP_RUNNING;
+               /* Reaches the 68000 and JERRY interrupt logic. */
+               if (DSP_SPEC_SKIP())
+                  break;
                dspgo_poll_count = 0;
                // Check for DSP -> CPU interrupt
                if (data & CPUINT)
@@ -826,6 +1236,8 @@ void DSPWriteLong(uint32_t offset, uint32_t data, uint32_t who/*=UNKNOWN*/)
       return;
    }
 
+   if (DSP_SPEC_SKIP())
+      return;
    JaguarWriteLong(offset, data, who);
 }
 
@@ -913,6 +1325,8 @@ void DSPHandleIRQsNP(void)
 void DSPSetIRQLine(int irqline, int state)
 {
 	uint32_t mask = (irqline < 5) ? (INT_LAT0 << irqline) : INT_LAT5;
+
+	DSP_SPEC_CLAIM();
 	dsp_control &= ~mask;
 
 	if (state)
@@ -929,6 +1343,8 @@ bool DSPIsRunning(void)
 
 uint8_t * DSPGetRAM(void)
 {
+	DSP_SPEC_CLAIM();
+	dsp_decode_stale = 1;
 	return dsp_ram_8;
 }
 
@@ -967,6 +1383,8 @@ void DSPReset(void)
 
 	dsp_pc				  = 0x00F1B000;
 	dspgo_poll_count	  = 0;
+	dsp_idle.skipped	  = 0;
+	dsp_idle.skips		  = 0;
 	dsp_acc				  = 0x00000000;
 	dsp_remain			  = 0x00000000;
 	dsp_modulo			  = 0xFFFFFFFF;
@@ -1008,10 +1426,14 @@ void DSPReset(void)
 	{
 		memset(dsp_ram_8, 0, DSP_RAM_SIZE);
 	}
+	DSPDecodeRange(0, DSP_RAM_SIZE);
 }
 
 void DSPDone(void)
 {
+	DSPSetThreaded(false);
+	RISCJitRelease(&dsp_jit);
+	dsp_jit_enabled = 0;
 }
 
 void DSPBeginSlice(uint32_t riscCycles)
@@ -1034,6 +1456,7 @@ void DSPSyncToM68K(void)
 {
 	int32_t target, run;
 
+	DSP_SPEC_CLAIM();
 	if (!DSP_RUNNING || dsp_in_exec)
 		return;
 
@@ -1047,13 +1470,176 @@ void DSPSyncToM68K(void)
 		return;
 
 	dspSliceSpent += run;
+	PERF_TIME_ENTER(PERF_T_DSP);
 	DSPExec(run);
+	PERF_TIME_LEAVE();
+}
+
+/* Worker thread: run each slice handed out until told to quit. */
+static void dsp_thread_main(void * arg)
+{
+	unsigned seen = VJEventCount(dspToWorker);
+	int ran = VJAtomicGet(&dspSpecSlice);
+
+	(void)arg;
+	for (;;)
+	{
+		int slice;
+
+		while ((slice = VJAtomicGet(&dspSpecSlice)) == ran
+				&& !VJAtomicGet(&dspSpecQuit))
+			seen = VJEventWait(dspToWorker, seen);
+		if (slice == ran)
+			break;
+
+		dspSpecLive = true;
+		dspSpecAborted = false;
+		DSPExec(DSPSliceRemaining());
+		dspSpecLive = false;
+
+		ran = slice;
+		VJAtomicSet(&dspSpecFinished, slice);
+		VJEventPost(dspToMain);
+	}
+}
+
+/* Hand the DSP's share of the slice to the worker, to run while the
+ * 68000 and GPU run theirs.  Call after DSPBeginSlice(). */
+void DSPStartSlice(void)
+{
+	if (!dspThread || !DSP_RUNNING)
+		return;
+	if (dspSpecBackoff)
+	{
+		dspSpecBackoff--;
+		return;
+	}
+
+	dsp_spec_save(&dspSpecSnap);
+	dspSpecUndoCount = 0;
+	VJAtomicSet(&dspSpecMainDone, 0);
+	VJAtomicSet(&dspSpecAbort, 0);
+	dspSpecPending = true;
+	dspThreadSlices++;
+	VJAtomicSet(&dspSpecSlice, ++dspSpecSeq);
+	VJEventPost(dspToWorker);
+}
+
+/* Run what is left of the DSP's share: wait for the worker, or run it
+ * here when the slice was not handed out or was rolled back. */
+void DSPFinishSlice(void)
+{
+	if (!dspSpecPending)
+	{
+		DSPExec(DSPSliceRemaining());
+		return;
+	}
+
+	dspSpecPending = false;
+	VJAtomicSet(&dspSpecMainDone, 1);
+	VJEventPost(dspToWorker);
+	dsp_thread_wait();
+}
+
+bool DSPSetThreaded(bool enabled)
+{
+	if (enabled && !dspThread)
+	{
+		dspToWorker = VJEventNew();
+		dspToMain = VJEventNew();
+		dspSpecQuit = 0;
+		dspSpecBackoff = 0;
+		if (dspToWorker && dspToMain)
+			dspThread = VJThreadStart(dsp_thread_main, NULL);
+		if (!dspThread)
+		{
+			VJEventFree(dspToWorker);
+			VJEventFree(dspToMain);
+			dspToWorker = dspToMain = NULL;
+		}
+	}
+	else if (!enabled && dspThread)
+	{
+		/* Only called between slices, with the worker idle. */
+		VJAtomicSet(&dspSpecQuit, 1);
+		VJEventPost(dspToWorker);
+		VJThreadJoin(dspThread);
+		VJEventFree(dspToWorker);
+		VJEventFree(dspToMain);
+		dspThread = NULL;
+		dspToWorker = dspToMain = NULL;
+	}
+	return dspThread != NULL;
+}
+
+void DSPThreadStats(uint32_t * slices, uint32_t * parks, uint32_t * rollbacks)
+{
+	*slices = dspThreadSlices;
+	*parks = dspThreadParks;
+	*rollbacks = dspThreadRollbacks;
+}
+
+/* Idle-loop watch (risc_idle.h); see GPUIdleReadable and GPUIdleSafe
+ * in gpu.c.  DSP local RAM is $F1B000-$F1CFFF. */
+static int DSPIdleReadable(uint32_t addr)
+{
+	if (addr >= DSP_WORK_RAM_BASE && addr <= DSP_WORK_RAM_BASE + 0x1FF8)
+		return 1;
+	return addr < 0x1FFFF8
+		&& jaguarReadPage[addr >> JAG_PAGE_SHIFT]
+		&& jaguarReadPage[(addr + 7) >> JAG_PAGE_SHIFT];
+}
+
+static int DSPIdleSafe(uint32_t index, uint32_t rm)
+{
+	if (dsp_opcode_straight[index])
+		return 1;
+	switch (index)
+	{
+		case 38:						/* movei */
+			return 1;
+		case 39: case 40: case 41:
+			return DSPIdleReadable(dsp_reg[rm]);
+		case 43:
+			return DSPIdleReadable(dsp_reg[14] + (dsp_convert_zero[rm] << 2));
+		case 44:
+			return DSPIdleReadable(dsp_reg[15] + (dsp_convert_zero[rm] << 2));
+		case 58:
+			return DSPIdleReadable(dsp_reg[14] + dsp_reg[rm]);
+		case 59:
+			return DSPIdleReadable(dsp_reg[15] + dsp_reg[rm]);
+		case 52: case 53:
+		{
+			uint32_t off = dsp_pc - DSP_WORK_RAM_BASE;
+			const RISCDecodedOp * ds;
+
+			if (!dsp_decode_cache || (off & 0xFFFFE001) != 0)
+				return 0;
+			ds = &dsp_decoded[off >> 1];
+			return ds->index != 52 && ds->index != 53
+				&& DSPIdleSafe(ds->index, ds->reg1);
+		}
+	}
+	return 0;
+}
+
+static void DSPIdleState(uint32_t * state)
+{
+	memcpy(state, dsp_reg_bank_0, 32 * sizeof(uint32_t));
+	memcpy(state + 32, dsp_reg_bank_1, 32 * sizeof(uint32_t));
+	state[64] = dsp_flag_z | (dsp_flag_n << 1) | (dsp_flag_c << 2);
+	state[65] = (uint32_t)dsp_acc;
+	state[66] = (uint32_t)(dsp_acc >> 32);
+	state[67] = dsp_remain;
+	state[68] = state[69] = state[70] = state[71] = 0;
 }
 
 /* DSP execution core */
 
 void DSPExec(int32_t cycles)
 {
+	int idle;
+
 #ifdef DSP_SINGLE_STEPPING
 	if (dsp_control & 0x18)
 	{
@@ -1063,11 +1649,24 @@ void DSPExec(int32_t cycles)
 #endif
 	dsp_releaseTimeSlice_flag = 0;
 	dsp_in_exec++;
+	idle = dsp_idle_skip;
+#ifdef VJ_TRACE
+	if (vjtrace_armed)
+		idle = 0;
+#endif
+	RISCIdleReset(&dsp_idle);
+
+	if (dsp_decode_stale)
+	{
+		DSPDecodeRange(0, sizeof(dsp_ram_8));
+		dsp_decode_stale = 0;
+	}
 
 	while (cycles > 0 && DSP_RUNNING)
 	{
-      uint16_t opcode;
       uint32_t index;
+      uint32_t op_cycles;
+      uint32_t op_pc;
 #ifdef VJ_TRACE
       VJT_PCHIST_DSP(dsp_pc);
 #endif
@@ -1108,28 +1707,77 @@ void DSPExec(int32_t cycles)
 		 * SRAM.  Earlier versions of this check used `<= 0x1FFFFF`
 		 * and would have false-flagged DSP code running from a RAM
 		 * mirror at $200000-$7FFFFF or from cart ROM at $800000+.
-		 * Caught by Copilot review on PR #182. */
-		if (!((dsp_pc <= 0x00E3FFFF) ||
-		      (dsp_pc >= DSP_WORK_RAM_BASE && dsp_pc < DSP_WORK_RAM_BASE + 0x2000)))
+		 * Caught by Copilot review on PR #182.
+		 *
+		 * SRAM is tested first (one unsigned compare) since that is
+		 * where DSP code lives nearly all the time. */
+		if ((uint32_t)(dsp_pc - DSP_WORK_RAM_BASE) >= 0x2000
+		      && dsp_pc > 0x00E3FFFF)
 		{
 			cycles = 0;
 			break;
 		}
 
-		if (dsp_pc >= DSP_WORK_RAM_BASE && dsp_pc < DSP_WORK_RAM_BASE + 0x2000)
+		/* Straight-line superblock (risc_block.h); see the matching
+		 * block in GPUExec.  Only entered with no D_FLAGS store in
+		 * flight: then IMASKCleared was just consumed above and nothing
+		 * in the run can set it again, so the per-instruction interrupt
+		 * check and retire countdown would both be no-ops. */
+		if (dsp_superblocks && dsp_decode_cache && dspFlagsRetireDelay == 0)
 		{
 			uint32_t off = dsp_pc - DSP_WORK_RAM_BASE;
-			opcode = ((uint16_t)dsp_ram_8[off] << 8) | (uint16_t)dsp_ram_8[off + 1];
+
+			if ((off & 0xFFFFE001) == 0)
+			{
+				const RISCDecodedOp *op = &dsp_decoded[off >> 1];
+
+				if (op->run > 1 && cycles > (int32_t)op->run_cycles)
+				{
+					uint32_t n = op->run;
+					RISCJitBlock block = dsp_jit_enabled
+						? RISCJitLookup(&dsp_jit, dsp_decoded, off >> 1) : NULL;
+
+					cycles -= op->run_cycles;
+					dsp_exec_opcode_count += n;
+					if (block)
+					{
+#ifdef VJ_TRACE
+						uint32_t i;
+						for (i = 0; i < n; i++)
+							VJT_PCHIST_DSP(dsp_pc + i * 2);
+#endif
+						block(dsp_reg, dsp_alternate_reg);
+						dsp_pc += n * 2;
+						op += n - 1;
+						dsp_opcode_first_parameter  = op->reg1;
+						dsp_opcode_second_parameter = op->reg2;
+					}
+					else for (;;)
+					{
+#ifdef VJ_TRACE
+						VJT_PCHIST_DSP(dsp_pc);
+#endif
+						dsp_opcode_first_parameter  = op->reg1;
+						dsp_opcode_second_parameter = op->reg2;
+						dsp_pc += 2;
+						dsp_executeOpcode(op->index);
+						if (--n == 0)
+							break;
+						op++;
+					}
+					continue;
+				}
+			}
 		}
-		else
-			opcode = DSPReadWord(dsp_pc, DSP);
-		index = opcode >> 10;
-		dsp_opcode_first_parameter = (opcode >> 5) & 0x1F;
-		dsp_opcode_second_parameter = opcode & 0x1F;
+
+		op_pc = dsp_pc;
+		index = DSPFetchOpcode(&op_cycles);
 		dsp_pc += 2;
 		dsp_exec_opcode_count++;
+		if (dsp_idle.head && !DSPIdleSafe(index, dsp_opcode_first_parameter))
+			RISCIdleAbandon(&dsp_idle);
 		dsp_executeOpcode(index);
-		cycles -= dsp_opcode_cycles[index];
+		cycles -= (int32_t)op_cycles;
 
 		/* Age out a D_FLAGS store once the instruction that was already
 		 * behind it in the pipeline has run (see DSPWriteLong, D_FLAGS
@@ -1137,6 +1785,21 @@ void DSPExec(int32_t cycles)
 		 * dsp_opcode_jump reaching for the pre-store bank. */
 		if (dspFlagsRetireDelay)
 			dspFlagsRetireDelay--;
+
+		/* A taken short backward branch (risc_idle.h).  Not with a
+		 * D_FLAGS store in flight: nothing in a replayable iteration
+		 * can start one, so the watched state never holds one either. */
+		if (idle && (index == 52 || index == 53)
+			&& dsp_pc <= op_pc && op_pc - dsp_pc < RISC_IDLE_SPAN
+			&& dspFlagsRetireDelay == 0 && !IMASKCleared
+			&& RISCIdleWanted(&dsp_idle, dsp_pc))
+		{
+			uint32_t state[RISC_IDLE_STATE];
+
+			DSPIdleState(state);
+			cycles -= RISCIdleBranch(&dsp_idle, dsp_pc, cycles,
+				&dsp_exec_opcode_count, state);
+		}
 	}
 
 	dsp_in_exec--;
@@ -1345,22 +2008,12 @@ INLINE static void dsp_opcode_jump(void)
 		uint32_t delayed_pc = dspFlagsRetireDelay
 		                      ? dspPreStoreBank[dsp_opcode_first_parameter]
 		                      : RM;
-		uint16_t ds_opcode;
-		uint32_t ds_index;
+		uint32_t ds_index, ds_cycles;
 		/* Inline delay-slot: fetch-decode-execute one instruction at current
 		 * PC before applying the branch target.  This replaces the old
 		 * recursive DSPExec(1) call, avoiding full function-call overhead,
 		 * redundant IRQ checks, and pipeline-state save/restore. */
-		if (dsp_pc >= DSP_WORK_RAM_BASE && dsp_pc < DSP_WORK_RAM_BASE + 0x2000)
-		{
-			uint32_t off = dsp_pc - DSP_WORK_RAM_BASE;
-			ds_opcode = ((uint16_t)dsp_ram_8[off] << 8) | (uint16_t)dsp_ram_8[off + 1];
-		}
-		else
-			ds_opcode = DSPReadWord(dsp_pc, DSP);
-		ds_index = ds_opcode >> 10;
-		dsp_opcode_first_parameter  = (ds_opcode >> 5) & 0x1F;
-		dsp_opcode_second_parameter = ds_opcode & 0x1F;
+		ds_index = DSPFetchOpcode(&ds_cycles);	/* slot cost: see dsp_opcode_cycles */
 		dsp_pc += 2;
 		dsp_exec_opcode_count++;
 		dsp_executeOpcode(ds_index);
@@ -1383,21 +2036,11 @@ INLINE static void dsp_opcode_jr(void)
 	{
 		int32_t offset = ((IMM_1 & 0x10) ? 0xFFFFFFF0 | IMM_1 : IMM_1);		/* Sign extend IMM_1 */
 		int32_t delayed_pc = dsp_pc + (offset * 2);
-		uint16_t ds_opcode;
-		uint32_t ds_index;
+		uint32_t ds_index, ds_cycles;
 		/* Inline delay-slot: fetch-decode-execute one instruction at current
 		 * PC before applying the branch target.  Same rationale as in
 		 * dsp_opcode_jump above. */
-		if (dsp_pc >= DSP_WORK_RAM_BASE && dsp_pc < DSP_WORK_RAM_BASE + 0x2000)
-		{
-			uint32_t off = dsp_pc - DSP_WORK_RAM_BASE;
-			ds_opcode = ((uint16_t)dsp_ram_8[off] << 8) | (uint16_t)dsp_ram_8[off + 1];
-		}
-		else
-			ds_opcode = DSPReadWord(dsp_pc, DSP);
-		ds_index = ds_opcode >> 10;
-		dsp_opcode_first_parameter  = (ds_opcode >> 5) & 0x1F;
-		dsp_opcode_second_parameter = ds_opcode & 0x1F;
+		ds_index = DSPFetchOpcode(&ds_cycles);	/* slot cost: see dsp_opcode_cycles */
 		dsp_pc += 2;
 		dsp_exec_opcode_count++;
 		dsp_executeOpcode(ds_index);
@@ -1582,7 +2225,7 @@ INLINE static void dsp_opcode_storeb(void)
 {
 	if (RM >= DSP_WORK_RAM_BASE && RM <= (DSP_WORK_RAM_BASE + 0x1FFF))
 		DSPWriteLong(RM, RN & 0xFF, DSP);
-	else
+	else if (!DSP_SPEC_SKIP())
 		JaguarWriteByte(RM, RN, DSP);
 }
 
@@ -1592,12 +2235,12 @@ INLINE static void dsp_opcode_storew(void)
 #ifdef DSP_CORRECT_ALIGNMENT_STORE
 	if (RM >= DSP_WORK_RAM_BASE && RM <= (DSP_WORK_RAM_BASE + 0x1FFF))
 		DSPWriteLong(RM & 0xFFFFFFFE, RN & 0xFFFF, DSP);
-	else
+	else if (!DSP_SPEC_SKIP())
 		JaguarWriteWord(RM & 0xFFFFFFFE, RN, DSP);
 #else
 	if (RM >= DSP_WORK_RAM_BASE && RM <= (DSP_WORK_RAM_BASE + 0x1FFF))
 		DSPWriteLong(RM, RN & 0xFFFF, DSP);
-	else
+	else if (!DSP_SPEC_SKIP())
 		JaguarWriteWord(RM, RN, DSP);
 #endif
 }
@@ -1624,7 +2267,7 @@ INLINE static void dsp_opcode_loadb(void)
 		 * (see gpu_opcode_loadb). */
 		RN = DSPReadLong(RM & 0xFFFFFFFC, DSP);
 	}
-	else
+	else if (!DSP_SPEC_SKIP())
 		RN = JaguarReadByte(RM, DSP);
 }
 
@@ -1638,10 +2281,10 @@ INLINE static void dsp_opcode_loadw(void)
 		RN = DSPReadLong(RM & 0xFFFFFFFC, DSP);
 	}
 #ifdef DSP_CORRECT_ALIGNMENT
-	else
+	else if (!DSP_SPEC_SKIP())
 		RN = JaguarReadWord(RM & 0xFFFFFFFE, DSP);
 #else
-	else
+	else if (!DSP_SPEC_SKIP())
 		RN = JaguarReadWord(RM, DSP);
 #endif
 }
@@ -3131,6 +3774,7 @@ size_t DSPStateLoad(const uint8_t *buf)
    uint8_t active_bank;
 
    STATE_LOAD_BUF(buf, dsp_ram_8, sizeof(dsp_ram_8));
+   DSPDecodeRange(0, sizeof(dsp_ram_8));
    STATE_LOAD_VAR(buf, dsp_pc);
    STATE_LOAD_VAR(buf, dsp_acc);
    STATE_LOAD_VAR(buf, dsp_remain);
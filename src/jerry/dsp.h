@@ -27,6 +27,26 @@ void DSPSetIRQLine(int irqline, int state);
 void DSPBeginSlice(uint32_t riscCycles);
 int32_t DSPSliceRemaining(void);
 void DSPSyncToM68K(void);
+/* Threaded DSP: DSPStartSlice() hands the DSP's share of the slice to a
+ * worker thread, to run while the 68000 and GPU run theirs;
+ * DSPFinishSlice() replaces DSPExec(DSPSliceRemaining()) at the end of
+ * the slice.  Results are identical to the serial order -- see the
+ * comment in dsp.c.  DSPSetThreaded() returns whether the worker runs;
+ * call it between frames only. */
+void DSPStartSlice(void);
+void DSPFinishSlice(void);
+bool DSPSetThreaded(bool enabled);
+/* Slices handed to the worker, parks on an external access, rollbacks. */
+void DSPThreadStats(uint32_t *slices, uint32_t *parks, uint32_t *rollbacks);
+/* Toggle the pre-decoded SRAM instruction stream; see GPUSetDecodeCache. */
+void DSPSetDecodeCache(int enabled);
+/* Toggle straight-line superblock execution; see GPUSetSuperblocks. */
+void DSPSetSuperblocks(int enabled);
+/* Toggle x86-64 translation of hot superblocks; see GPUSetJit. */
+int DSPSetJit(int enabled);
+/* Toggle idle-loop skipping; see GPUSetIdleSkip / GPUIdleSkipStats. */
+void DSPSetIdleSkip(int enabled);
+void DSPIdleSkipStats(uint64_t *cycles, uint32_t *skips);
 uint8_t DSPReadByte(uint32_t offset, uint32_t who);
 uint16_t DSPReadWord(uint32_t offset, uint32_t who);
 uint32_t DSPReadLong(uint32_t offset, uint32_t who);
@@ -35,6 +55,8 @@ void DSPWriteWord(uint32_t offset, uint16_t data, uint32_t who);
 void DSPWriteLong(uint32_t offset, uint32_t data, uint32_t who);
 void DSPReleaseTimeslice(void);
 bool DSPIsRunning(void);
+/* Raw local-RAM pointer.  Writes through it must land before the next
+ * DSPExec() call, which re-syncs the decoded instruction stream. */
 uint8_t *DSPGetRAM(void);
 uint32_t DSPGetFlags(void);
 
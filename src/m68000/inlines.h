@@ -79,11 +79,48 @@ static INLINE void m68k_do_jsr(uint32_t oldpc, uint32_t dest)
    m68k_setpc(dest);
 }
 
-// For now, we'll punt this crap...
+// Instruction stream reads go through the fetch window (m68kinterface.h):
+// inside it an opcode or extension word is a compare and a load, not a
+// trip through m68k_read_memory_16.
 // (Also, notice that the byte read is at address + 1...)
-#define get_ibyte(o)	m68k_read_memory_8(regs.pc + (o) + 1)
-#define get_iword(o)	m68k_read_memory_16(regs.pc + (o))
-#define get_ilong(o)	m68k_read_memory_32(regs.pc + (o))
+static INLINE uint32_t get_ibyte(int32_t o)
+{
+   uint32_t a = (regs.pc + o + 1) & 0x00FFFFFF;
+
+   if (a - m68kFetchStart <= 0xFFFF)
+   {
+      m68kFetchPending += m68kFetchCharge;
+      return m68kFetchBase[a - m68kFetchStart];
+   }
+   return m68k_read_memory_8(a);
+}
+
+static INLINE uint32_t get_iword(int32_t o)
+{
+   uint32_t a = (regs.pc + o) & 0x00FFFFFF;
+
+   if (a - m68kFetchStart <= 0xFFFE)
+   {
+      const uint8_t * p = m68kFetchBase + (a - m68kFetchStart);
+      m68kFetchPending += m68kFetchCharge;
+      return ((uint32_t)p[0] << 8) | p[1];
+   }
+   return m68k_fetch_16(a);
+}
+
+static INLINE uint32_t get_ilong(int32_t o)
+{
+   uint32_t a = (regs.pc + o) & 0x00FFFFFF;
+
+   if (a - m68kFetchStart <= 0xFFFC)
+   {
+      const uint8_t * p = m68kFetchBase + (a - m68kFetchStart);
+      m68kFetchPending += 2 * m68kFetchCharge;
+      return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16)
+         | ((uint32_t)p[2] << 8) | p[3];
+   }
+   return m68k_fetch_32(a);
+}
 
 // We don't use this crap, so let's comment out for now...
 static INLINE void refill_prefetch(uint32_t currpc, uint32_t offs)
@@ -157,6 +157,11 @@ int m68k_execute(int num_cycles)
 	regs.remainingCycles -= regs.interruptCycles;
 	regs.interruptCycles = 0;
 
+	// Reopen the fetch window on the first fetch: it picks up whether
+	// fetches are charged (the DRAM timing option can change between
+	// slices).
+	m68kFetchStart = M68K_FETCH_NONE;
+
 	/* Main loop.  Keep going until we run out of clock cycles */
 	do
 	{
@@ -200,11 +205,17 @@ int m68k_execute(int num_cycles)
 		}
 
 #ifdef M68K_HOOK_FUNCTION
-		M68KInstructionHook();
+		pcQueue[pcQPtr] = regs.pc;
+		pcQPtr = (pcQPtr + 1) & 0x3FF;
+		if (M68K_HOOK_PENDING(regs.pc))
+			M68KInstructionHook();
 #endif
 		opcode = get_iword(0);
 		cycles = (int32_t)(*cpuFunctionTable[opcode])(opcode);
 		regs.remainingCycles -= cycles;
+
+		if (m68kFetchPending)
+			m68k_fetch_flush();
 	}
 	while (regs.remainingCycles > 0);
 
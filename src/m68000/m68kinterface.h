@@ -92,14 +92,35 @@ void m68k_write_memory_8(unsigned int address, unsigned int value);
 void m68k_write_memory_16(unsigned int address, unsigned int value);
 void m68k_write_memory_32(unsigned int address, unsigned int value);
 
+// Instruction-fetch window: get_iword() & co. (inlines.h) read straight
+// from m68kFetchBase while the fetch address is inside the 64K page at
+// m68kFetchStart, and call m68k_fetch_16/32 to move the window when it
+// isn't.  Each window fetch adds m68kFetchCharge bus accesses to
+// m68kFetchPending, which m68k_fetch_flush() charges in one go.
+#define M68K_FETCH_NONE 0x80000000u	// m68kFetchStart of a closed window
+extern unsigned int m68kFetchStart;
+extern const unsigned char * m68kFetchBase;
+extern unsigned int m68kFetchCharge;
+extern unsigned int m68kFetchPending;
+unsigned int m68k_fetch_16(unsigned int address);
+unsigned int m68k_fetch_32(unsigned int address);
+void m68k_fetch_flush(void);
+
 int irq_ack_handler(int);
 
 // Convenience functions
 
-// Uncomment this to have the emulated CPU call a hook function after every instruction
+// Uncomment this to have the emulated CPU call a hook function before every
+// instruction whose PC is set in m68kHookMap, and record the PC history
 // NB: This must be implemented by the user!
 #define M68K_HOOK_FUNCTION
 #ifdef M68K_HOOK_FUNCTION
+#define M68K_HOOK_MAP_WORDS	(0x1000000 / 64)	// one bit per word address
+#define M68K_HOOK_PENDING(pc) \
+	(m68kHookMap[((pc) & 0xFFFFFF) >> 6] & (1u << (((pc) >> 1) & 31)))
+extern unsigned int m68kHookMap[];
+extern unsigned int pcQueue[];
+extern unsigned int pcQPtr;
 void M68KInstructionHook(void);
 #endif
 
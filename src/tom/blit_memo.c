@@ -24,6 +24,7 @@
 #include "vjag_memory.h"
 #include "shadowfb.h"
 #include "state.h"     /* BlitterStateSave/Load: the canonical state blob */
+#include "state_delta.h"
 #include "vjtrace.h"
 #include "log.h"
 #include "jaguar.h"    /* jaguarMemTrackInserted, jaguarMainROMCRC32 */
@@ -325,6 +326,7 @@ static void bm_apply_log(const bm_entry *e)
       val  = e->log[i * 2 + 1];
       addr = rec & 0x1FFFFF;
       len  = rec >> 28;
+      StateDeltaMark(addr, len == 1 || len == 2 ? len : 4);
       switch (len)
       {
          case 1:
@@ -463,6 +465,7 @@ static int bm_alloc_shadow_arena(void)
               "memo disabled\n",
               (unsigned)(sizeof(bm_shadow_rec) * BM_SH_ARENA_RECS));
       blitMemoMode = BLIT_MEMO_OFF;
+      JaguarMemoryMapRebuild();
       return 0;
    }
    bmShUsed = 0;
@@ -492,6 +495,7 @@ static int bm_alloc_pool(void)
               "memo disabled (raise BM_STATE_MAX)\n",
               (unsigned)len, (unsigned)BM_STATE_MAX);
       blitMemoMode = BLIT_MEMO_OFF;
+      JaguarMemoryMapRebuild();
       return 0;
    }
    bmStateLen = (uint32_t)len;
@@ -502,6 +506,7 @@ static int bm_alloc_pool(void)
       LOG_WRN("[BLITMEMO] pool allocation failed (%u bytes); memo disabled\n",
               (unsigned)(sizeof(bm_entry) * BM_ENTRIES));
       blitMemoMode = BLIT_MEMO_OFF;
+      JaguarMemoryMapRebuild();
       return 0;
    }
    memset(bmHashTab, 0xFF, sizeof(bmHashTab));
@@ -867,6 +872,8 @@ void BlitMemoSetMode(int mode)
    if (mode == blitMemoMode)
       return;
    blitMemoMode = mode;
+   /* The RAM pages of the bus fast path skip the memo hooks. */
+   JaguarMemoryMapRebuild();
    BlitMemoFlush();
 
    if (mode == BLIT_MEMO_OFF)
@@ -912,6 +919,7 @@ void BlitMemoShutdown(void)
    bmScratchShN = 0;
    blitMemoMode = BLIT_MEMO_OFF;
    blitMemoRecording = 0;
+   JaguarMemoryMapRebuild();
    bmPoolNext = 0;
    memset(bmPageGen, 0, sizeof(bmPageGen));
    memset(bmPageGenChain, 0, sizeof(bmPageGenChain));
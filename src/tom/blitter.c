@@ -29,6 +29,7 @@
 #include "perf_counters.h"
 #include "shadowfb.h"
 #include "state.h"
+#include "state_delta.h"
 #include "blit_memo.h"
 #include "../core/vjtrace.h"
 
@@ -102,6 +103,7 @@ static BLITTER_ALWAYS_INLINE void blitter_write_byte(uint32_t addr, uint8_t data
    {
       if (blitMemoMode)
          BlitMemoWriteHook(addr, 1, data);
+      StateDeltaMark(addr, 1);
       jaguarMainRAM[addr & 0x1FFFFF] = data;
       return;
    }
@@ -115,6 +117,7 @@ static BLITTER_ALWAYS_INLINE void blitter_write_word(uint32_t addr, uint16_t dat
    {
       if (blitMemoMode)
          BlitMemoWriteHook(addr, 2, data);
+      StateDeltaMark(addr, 2);
       a = addr & 0x1FFFFF;
       jaguarMainRAM[a]                   = (uint8_t)(data >> 8);
       jaguarMainRAM[(a + 1) & 0x1FFFFF] = (uint8_t)(data & 0xFF);
@@ -130,6 +133,7 @@ static BLITTER_ALWAYS_INLINE void blitter_write_long(uint32_t addr, uint32_t dat
    {
       if (blitMemoMode)
          BlitMemoWriteHook(addr, 4, data);
+      StateDeltaMark(addr, 4);
       a = addr & 0x1FFFFF;
       jaguarMainRAM[a]                   = (uint8_t)((data >> 24) & 0xFF);
       jaguarMainRAM[(a + 1) & 0x1FFFFF] = (uint8_t)((data >> 16) & 0xFF);
@@ -159,6 +163,75 @@ PERF_COUNTER(blitter_inner_idle);
 PERF_COUNTER(blitter_phrase_reads);
 PERF_COUNTER(blitter_phrase_writes);
 
+/* Command specialisation (see blitter_generic() and BlitterMidsummer2()).
+ * Each engine keeps a table of the signatures worth a specialised copy of
+ * its loop; a small direct-mapped cache maps a blit's signature to its
+ * copy, or to NULL for the generic loop.  Host-side only: nothing here is
+ * emulated state, and the tables never change, so the caches never need
+ * flushing. */
+typedef void (*blit_instance_fn)(void);
+
+typedef struct
+{
+   uint64_t sig;
+   blit_instance_fn fn;
+} blit_instance;
+
+#define BLIT_SPEC_CACHE 32
+
+typedef struct
+{
+   uint64_t sig[BLIT_SPEC_CACHE];
+   blit_instance_fn fn[BLIT_SPEC_CACHE];
+   bool valid[BLIT_SPEC_CACHE];
+} blit_spec_cache;
+
+static bool blitSpecialise = true;
+static uint32_t blitSpecHits, blitSpecMisses;
+
+static blit_instance_fn blit_spec_lookup(blit_spec_cache * cache,
+      const blit_instance * table, unsigned count, uint64_t sig)
+{
+   unsigned slot = (unsigned)(sig ^ (sig >> 21) ^ (sig >> 37)) & (BLIT_SPEC_CACHE - 1);
+   blit_instance_fn fn = NULL;
+   unsigned i;
+
+   if (cache->valid[slot] && cache->sig[slot] == sig)
+      return cache->fn[slot];
+
+   for (i = 0; i < count; i++)
+   {
+      if (table[i].sig == sig)
+      {
+         fn = table[i].fn;
+         break;
+      }
+   }
+
+   cache->sig[slot] = sig;
+   cache->fn[slot] = fn;
+   cache->valid[slot] = true;
+   return fn;
+}
+
+void BlitterSpecialiseEnable(int enable)
+{
+   blitSpecialise = (enable != 0);
+}
+
+int BlitterSpecialiseIsEnabled(void)
+{
+   return blitSpecialise;
+}
+
+void BlitterSpecialiseStats(uint32_t * hits, uint32_t * misses)
+{
+   if (hits)
+      *hits = blitSpecHits;
+   if (misses)
+      *misses = blitSpecMisses;
+}
+
 #define REG(A)	(((uint32_t)blitter_ram[(A)] << 24) | ((uint32_t)blitter_ram[(A)+1] << 16) \
 				| ((uint32_t)blitter_ram[(A)+2] << 8) | (uint32_t)blitter_ram[(A)+3])
 #define WREG(A,D)	(blitter_ram[(A)] = ((D)>>24)&0xFF, blitter_ram[(A)+1] = ((D)>>16)&0xFF, \
@@ -548,11 +621,18 @@ static void shadow_hires_sub_fast(shadowfb_sub *out, uint32_t cmd,
 // of removing all the unnecessary code caching. If it turns out to be a good way
 // to optimize the blitter, then we may revisit it in the future...
 
-// Generic blit handler
-void blitter_generic(uint32_t cmd)
+// Generic blit loop.  Everything the command word and the two channels'
+// depth and phrase mode decide comes in as a parameter, so the hot
+// signatures below instantiate it with constants and the compiler folds
+// the per-pixel tests away.  Only the pixel-depth field (bits 3-5) of
+// a1_flags/a2_flags is read, and the phrase-mode parameters shadow the
+// statics of the same name.
+static BLITTER_ALWAYS_INLINE void blitter_generic_loop(uint32_t cmd,
+      uint32_t a1_flags, uint32_t a2_flags,
+      uint8_t a1_phrase_mode, uint8_t a2_phrase_mode)
 {
    uint32_t srcdata, srczdata, dstdata, dstzdata, writedata, inhibit;
-   uint32_t bppSrc = (DSTA2 ? 1 << ((REG(A1_FLAGS) >> 3) & 0x07) : 1 << ((REG(A2_FLAGS) >> 3) & 0x07));
+   uint32_t bppSrc = (DSTA2 ? 1 << ((a1_flags >> 3) & 0x07) : 1 << ((a2_flags >> 3) & 0x07));
 
    while (outer_loop--)
    {
@@ -578,37 +658,37 @@ void blitter_generic(uint32_t cmd)
             //				if (SRCEN)
             if (SRCEN || SRCENX)	// Not sure if this is correct... (seems to be...!)
             {
-               srcdata = READ_PIXEL(a2, REG(A2_FLAGS));
+               srcdata = READ_PIXEL(a2, a2_flags);
 
                if (SRCENZ)
-                  srczdata = READ_ZDATA(a2, REG(A2_FLAGS));
+                  srczdata = READ_ZDATA(a2, a2_flags);
                else if (cmd & 0x0001C020)	// PATDSEL | TOPBEN | TOPNEN | DSTWRZ
-                  srczdata = READ_RDATA(SRCZINT, a2, REG(A2_FLAGS), a2_phrase_mode);
+                  srczdata = READ_RDATA(SRCZINT, a2, a2_flags, a2_phrase_mode);
             }
             else	// Use SRCDATA register...
             {
-               srcdata = READ_RDATA(SRCDATA, a2, REG(A2_FLAGS), a2_phrase_mode);
+               srcdata = READ_RDATA(SRCDATA, a2, a2_flags, a2_phrase_mode);
 
                if (cmd & 0x0001C020)		// PATDSEL | TOPBEN | TOPNEN | DSTWRZ
-                  srczdata = READ_RDATA(SRCZINT, a2, REG(A2_FLAGS), a2_phrase_mode);
+                  srczdata = READ_RDATA(SRCZINT, a2, a2_flags, a2_phrase_mode);
             }
 
             // load dst data and Z
             if (DSTEN)
             {
-               dstdata = READ_PIXEL(a1, REG(A1_FLAGS));
+               dstdata = READ_PIXEL(a1, a1_flags);
 
                if (DSTENZ)
-                  dstzdata = READ_ZDATA(a1, REG(A1_FLAGS));
+                  dstzdata = READ_ZDATA(a1, a1_flags);
                else
-                  dstzdata = READ_RDATA(DSTZ, a1, REG(A1_FLAGS), a1_phrase_mode);
+                  dstzdata = READ_RDATA(DSTZ, a1, a1_flags, a1_phrase_mode);
             }
             else
             {
-               dstdata = READ_RDATA(DSTDATA, a1, REG(A1_FLAGS), a1_phrase_mode);
+               dstdata = READ_RDATA(DSTDATA, a1, a1_flags, a1_phrase_mode);
 
                if (DSTENZ)
-                  dstzdata = READ_RDATA(DSTZ, a1, REG(A1_FLAGS), a1_phrase_mode);
+                  dstzdata = READ_RDATA(DSTZ, a1, a1_flags, a1_phrase_mode);
             }
 
             if (GOURZ)
@@ -656,14 +736,14 @@ void blitter_generic(uint32_t cmd)
                      if (srcdata == 0)
                         inhibit = 1;
                   }
-                  else if (srcdata == 0 || srcdata == READ_RDATA(PATTERNDATA, a2, REG(A2_FLAGS), a2_phrase_mode))
+                  else if (srcdata == 0 || srcdata == READ_RDATA(PATTERNDATA, a2, a2_flags, a2_phrase_mode))
                      inhibit = 1;
                }
                else
                {
                   // compare destination pixel with pattern pixel
-                  if (dstdata == READ_RDATA(PATTERNDATA, a1, REG(A1_FLAGS), a1_phrase_mode))
-                     //						if (dstdata != READ_RDATA(PATTERNDATA, a1, REG(A1_FLAGS), a1_phrase_mode))
+                  if (dstdata == READ_RDATA(PATTERNDATA, a1, a1_flags, a1_phrase_mode))
+                     //						if (dstdata != READ_RDATA(PATTERNDATA, a1, a1_flags, a1_phrase_mode))
                      inhibit = 1;
                }
             }
@@ -689,7 +769,7 @@ void blitter_generic(uint32_t cmd)
                if (PATDSEL)
                {
                   // use pattern data for write data
-                  writedata = READ_RDATA(PATTERNDATA, a1, REG(A1_FLAGS), a1_phrase_mode);
+                  writedata = READ_RDATA(PATTERNDATA, a1, a1_flags, a1_phrase_mode);
                }
                else if (ADDDSEL)
                {
@@ -758,9 +838,9 @@ void blitter_generic(uint32_t cmd)
                //				if (/*a1_phrase_mode || BKGWREN ||*/ !inhibit)
             {
                // write to the destination
-               WRITE_PIXEL(a1, REG(A1_FLAGS), writedata);
+               WRITE_PIXEL(a1, a1_flags, writedata);
                if (DSTWRZ)
-                  WRITE_ZDATA(a1, REG(A1_FLAGS), srczdata);
+                  WRITE_ZDATA(a1, a1_flags, srczdata);
 
                /* True-color shadow store (see shadowfb.h): record the
                 * full-precision intensity for gouraud / intensity-shade
@@ -773,7 +853,7 @@ void blitter_generic(uint32_t cmd)
                 * all blit content reaches the Nx surface (design
                 * section 4). */
                if ((shadowFBActive || shadowHiresActive)
-                     && (((REG(A1_FLAGS) >> 3) & 0x07) == 4))
+                     && (((a1_flags >> 3) & 0x07) == 4))
                {
                   uint16_t sfb_frac = 0;
                   if (!inhibit && (GOURD || SRCSHADE))
@@ -809,33 +889,33 @@ void blitter_generic(uint32_t cmd)
             // load src data and Z
             if (SRCEN)
             {
-               srcdata = READ_PIXEL(a1, REG(A1_FLAGS));
+               srcdata = READ_PIXEL(a1, a1_flags);
                if (SRCENZ)
-                  srczdata = READ_ZDATA(a1, REG(A1_FLAGS));
+                  srczdata = READ_ZDATA(a1, a1_flags);
                else if (cmd & 0x0001C020)	// PATDSEL | TOPBEN | TOPNEN | DSTWRZ
-                  srczdata = READ_RDATA(SRCZINT, a1, REG(A1_FLAGS), a1_phrase_mode);
+                  srczdata = READ_RDATA(SRCZINT, a1, a1_flags, a1_phrase_mode);
             }
             else
             {
-               srcdata = READ_RDATA(SRCDATA, a1, REG(A1_FLAGS), a1_phrase_mode);
+               srcdata = READ_RDATA(SRCDATA, a1, a1_flags, a1_phrase_mode);
                if (cmd & 0x001C020)	// PATDSEL | TOPBEN | TOPNEN | DSTWRZ
-                  srczdata = READ_RDATA(SRCZINT, a1, REG(A1_FLAGS), a1_phrase_mode);
+                  srczdata = READ_RDATA(SRCZINT, a1, a1_flags, a1_phrase_mode);
             }
 
             // load dst data and Z
             if (DSTEN)
             {
-               dstdata = READ_PIXEL(a2, REG(A2_FLAGS));
+               dstdata = READ_PIXEL(a2, a2_flags);
                if (DSTENZ)
-                  dstzdata = READ_ZDATA(a2, REG(A2_FLAGS));
+                  dstzdata = READ_ZDATA(a2, a2_flags);
                else
-                  dstzdata = READ_RDATA(DSTZ, a2, REG(A2_FLAGS), a2_phrase_mode);
+                  dstzdata = READ_RDATA(DSTZ, a2, a2_flags, a2_phrase_mode);
             }
             else
             {
-               dstdata = READ_RDATA(DSTDATA, a2, REG(A2_FLAGS), a2_phrase_mode);
+               dstdata = READ_RDATA(DSTDATA, a2, a2_flags, a2_phrase_mode);
                if (DSTENZ)
-                  dstzdata = READ_RDATA(DSTZ, a2, REG(A2_FLAGS), a2_phrase_mode);
+                  dstzdata = READ_RDATA(DSTZ, a2, a2_flags, a2_phrase_mode);
             }
 
             if (GOURZ)
@@ -866,12 +946,12 @@ void blitter_generic(uint32_t cmd)
                      if (srcdata == 0)
                         inhibit = 1;
                   }
-                  else if (srcdata == 0 || srcdata == READ_RDATA(PATTERNDATA, a1, REG(A1_FLAGS), a1_phrase_mode))
+                  else if (srcdata == 0 || srcdata == READ_RDATA(PATTERNDATA, a1, a1_flags, a1_phrase_mode))
                      inhibit = 1;
                }
                else
                {
-                  if (dstdata == READ_RDATA(PATTERNDATA, a2, REG(A2_FLAGS), a2_phrase_mode))
+                  if (dstdata == READ_RDATA(PATTERNDATA, a2, a2_flags, a2_phrase_mode))
                      inhibit = 1;
                }
             }
@@ -888,7 +968,7 @@ void blitter_generic(uint32_t cmd)
                if (PATDSEL)
                {
                   // use pattern data for write data
-                  writedata = READ_RDATA(PATTERNDATA, a2, REG(A2_FLAGS), a2_phrase_mode);
+                  writedata = READ_RDATA(PATTERNDATA, a2, a2_flags, a2_phrase_mode);
                }
                else if (ADDDSEL)
                {
@@ -938,15 +1018,15 @@ void blitter_generic(uint32_t cmd)
 
             if (/*a2_phrase_mode || */BKGWREN || !inhibit)
             {
-               WRITE_PIXEL(a2, REG(A2_FLAGS), writedata);
+               WRITE_PIXEL(a2, a2_flags, writedata);
 
                if (DSTWRZ)
-                  WRITE_ZDATA(a2, REG(A2_FLAGS), srczdata);
+                  WRITE_ZDATA(a2, a2_flags, srczdata);
 
                /* True-color + hi-res shadow stores, A2-destination twin
                 * of the A1 branch above (see shadowfb.h). */
                if ((shadowFBActive || shadowHiresActive)
-                     && (((REG(A2_FLAGS) >> 3) & 0x07) == 4))
+                     && (((a2_flags >> 3) & 0x07) == 4))
                {
                   uint16_t sfb_frac = 0;
                   if (!inhibit && (GOURD || SRCSHADE))
@@ -976,7 +1056,7 @@ void blitter_generic(uint32_t cmd)
                      int sh2 = 0;
                      shadowfb_sub sblk[4];
                      if (shadowHiresN == 2 && !inhibit && SRCEN && !BCOMPEN
-                           && (((REG(A1_FLAGS) >> 3) & 0x07) == 4)
+                           && (((a1_flags >> 3) & 0x07) == 4)
                            && (SRCSHADE || (!GOURD && !PATDSEL)))
                      {
                         int32_t hx = 0, hy = 0, vx = 0, vy = 0;
@@ -1155,6 +1235,59 @@ void blitter_generic(uint32_t cmd)
    WREG(A2_PIXEL,  (a2_y & 0xFFFF0000) | ((a2_x >> 16) & 0xFFFF));
 }
 
+/* Fast-engine instances: command word, A1 and A2 pixel depth (the log2
+ * field of A1/A2_FLAGS), A1 and A2 phrase mode.  Between them these cover
+ * about 99% of the pixels the in-tree ROMs blit. */
+#define BLIT_FAST_HOT(X) \
+   X(00010200, 4, 4, 1, 1)   /* 16bpp pattern fill, A1 phrase */ \
+   X(00010200, 4, 4, 1, 0)   /* the same, A2 pixel mode */ \
+   X(00011000, 4, 5, 1, 1)   /* Gouraud fill */ \
+   X(00011008, 4, 4, 0, 1)   /* Gouraud span over the destination */ \
+   X(01800001, 4, 4, 1, 1)   /* phrase copy */ \
+   X(01800005, 4, 4, 1, 1)   /* phrase copy with SRCENX */ \
+   X(41802F41, 4, 4, 0, 0)   /* clipped, shaded texture walk into A2 */
+
+#define BLIT_FAST_SIG(cmd, a1d, a2d, a1p, a2p) \
+   (((uint64_t)(cmd) << 16) | ((a1d) << 12) | ((a2d) << 8) | ((a1p) << 4) | (a2p))
+
+#define BLIT_FAST_DEFINE(cmd, a1d, a2d, a1p, a2p) \
+   static void blit_fast_##cmd##_##a1d##a2d##a1p##a2p(void) \
+   { \
+      blitter_generic_loop(0x##cmd, (a1d) << 3, (a2d) << 3, a1p, a2p); \
+   }
+
+#define BLIT_FAST_ENTRY(cmd, a1d, a2d, a1p, a2p) \
+   { BLIT_FAST_SIG(0x##cmd, a1d, a2d, a1p, a2p), blit_fast_##cmd##_##a1d##a2d##a1p##a2p },
+
+BLIT_FAST_HOT(BLIT_FAST_DEFINE)
+
+static const blit_instance blitFastInstances[] = { BLIT_FAST_HOT(BLIT_FAST_ENTRY) };
+static blit_spec_cache blitFastCache;
+
+// Generic blit handler
+void blitter_generic(uint32_t cmd)
+{
+   uint32_t a1_flags = REG(A1_FLAGS), a2_flags = REG(A2_FLAGS);
+
+   if (blitSpecialise)
+   {
+      blit_instance_fn fn = blit_spec_lookup(&blitFastCache, blitFastInstances,
+            sizeof(blitFastInstances) / sizeof(blitFastInstances[0]),
+            BLIT_FAST_SIG(cmd, (a1_flags >> 3) & 0x07, (a2_flags >> 3) & 0x07,
+               a1_phrase_mode, a2_phrase_mode));
+
+      if (fn)
+      {
+         blitSpecHits++;
+         fn();
+         return;
+      }
+      blitSpecMisses++;
+   }
+
+   blitter_generic_loop(cmd, a1_flags, a2_flags, a1_phrase_mode, a2_phrase_mode);
+}
+
 void blitter_blit(uint32_t cmd)
 {
    uint32_t m, e;
@@ -2156,9 +2289,10 @@ static double bm2_trace_threshold_ms = 0.3; /* dump any blit slower than this */
 static uint64_t bm2_trace_t0;
 #endif
 
-void BlitterMidsummer2(void)
+// The accurate engine, as a template on the command word: see
+// BlitterMidsummer2() below for the instances.
+static BLITTER_ALWAYS_INLINE void blitter_midsummer2_run(uint32_t cmd)
 {
-   uint32_t cmd = (PERF_INC(blitter_calls), GET32(blitter_ram, COMMAND));
 #ifdef BLITTER_TRACE
    bm2_trace_t0 = mach_absolute_time();
 #endif
@@ -4020,6 +4154,260 @@ fc_inner_done:
 #endif
 }
 
+/* Bulk phrase path for the accurate engine.
+ *
+ * Two command classes do nothing the state machine can tell apart from a
+ * plain phrase store: a pattern fill (PATDSEL, no source, no Gouraud, no
+ * Z, no comparator) and a straight copy (SRCEN with LFU = source).  When
+ * the walkers run in phrase mode from phrase boundaries and every line is
+ * a whole number of phrases, each phrase gets the full dstart/dend mask,
+ * the source shift is zero, and DATA reduces to PATD or the source
+ * phrase.  With SRCENX the extra read at the start of each line only
+ * moves the source on by a phrase, since nothing is shifted in from it.
+ * blitter_bulk_phrase() recognises those blits at launch, runs each line
+ * as a store or copy of whole phrases on main RAM, and writes back the
+ * pointers the state machine leaves.  It declines, and the state machine
+ * runs as before, when a line would leave main RAM or wrap X, or when a
+ * host-side consumer needs every store (blit memo, hi-res shadow).
+ *
+ * BlitDurationSysclks() prices the blit from the registers before
+ * dispatch, so the bus timing is the same on either path. */
+
+#define BULK_CMD_FREE   0x2000C600   /* UPDA1, UPDA2, TOPBEN, TOPNEN, BUSHI */
+#define BULK_CMD_LFU    0x01E00000
+#define BULK_CMD_FILL   0x00010000   /* PATDSEL */
+#define BULK_CMD_COPY   0x01800001   /* SRCEN, LFU_A | LFU_AN */
+#define BULK_CMD_SRCENX 0x00000004
+
+static bool blitBulk = true;
+static uint32_t blitBulkBlits;
+
+PERF_COUNTER(blitter_bulk);
+
+void BlitterBulkEnable(int enable)
+{
+   blitBulk = (enable != 0);
+}
+
+int BlitterBulkIsEnabled(void)
+{
+   return blitBulk;
+}
+
+void BlitterBulkStats(uint32_t * blits)
+{
+   if (blits)
+      *blits = blitBulkBlits;
+}
+
+/* Phrase address of pixel (x, y) on a pitch-1 walker, as ADDRGEN forms
+ * it; 0xFFFFFFFF if a line of `pixels` from there would not be a run of
+ * consecutive phrases inside main RAM. */
+static uint32_t blitter_bulk_line(uint32_t base, uint8_t pixsize, uint8_t width,
+      int16_t x, int16_t y, uint32_t pixels)
+{
+   uint64_t pa = (uint64_t)addrgen_ya((uint16_t)y, width) + (uint16_t)x;
+   uint32_t addr;
+
+   if ((uint32_t)(uint16_t)x + pixels > 0x10000
+         || ((pa + pixels) << pixsize) > 0xFFFFFFFFu)
+      return 0xFFFFFFFF;
+
+   addr = ((((base >> 3) + (uint32_t)((pa << pixsize) >> 6)) & 0x1FFFFF) << 3);
+   if (addr + (pixels << pixsize >> 3) > 0x200000)
+      return 0xFFFFFFFF;
+   return addr;
+}
+
+static bool blitter_bulk_phrase(uint32_t cmd)
+{
+   bool copy = (cmd & 0x00000001) != 0;
+   bool srcenx = (cmd & BULK_CMD_SRCENX) != 0;
+   bool upda1 = (cmd & 0x00000200) != 0, upda2 = (cmd & 0x00000400) != 0;
+   uint32_t a1_flags = GET32(blitter_ram, A1_FLAGS);
+   uint32_t a2_flags = GET32(blitter_ram, A2_FLAGS);
+   uint8_t pixsize = (a1_flags >> 3) & 0x07;
+   uint8_t a1_width = (blitter_ram[A1_FLAGS + 2] >> 1) & 0x3F;
+   uint8_t a2_width = (blitter_ram[A2_FLAGS + 2] >> 1) & 0x3F;
+   uint32_t a1_base = GET32(blitter_ram, A1_BASE) & 0xFFFFFFF8;
+   uint32_t a2_base = GET32(blitter_ram, A2_BASE) & 0xFFFFFFF8;
+   uint16_t lines = GET16(blitter_ram, PIXLINECOUNTER);
+   uint16_t icount = GET16(blitter_ram, PIXLINECOUNTER + 2);
+   int16_t a1_step_x = (int16_t)GET16(blitter_ram, A1_STEP + 2);
+   int16_t a1_step_y = (int16_t)GET16(blitter_ram, A1_STEP + 0);
+   int16_t a2_step_x = (int16_t)GET16(blitter_ram, A2_STEP + 2);
+   int16_t a2_step_y = (int16_t)GET16(blitter_ram, A2_STEP + 0);
+   int16_t a1_x, a1_y, a2_x, a2_y;
+   uint32_t ppp, bytes, src_pixels, dst, src = 0;
+   uint8_t pat[8];
+   unsigned pass, line;
+
+   if (!blitBulk || blitMemoMode || blitMemoRecording || shadowHiresActive)
+      return false;
+
+   if (copy ? (cmd & ~(BULK_CMD_FREE | BULK_CMD_SRCENX)) != BULK_CMD_COPY
+            : (cmd & ~(BULK_CMD_FREE | BULK_CMD_LFU)) != BULK_CMD_FILL)
+      return false;
+
+   /* Pitch 1, phrase XADD, no YADD or sign bits, 8 to 32bpp; a copy's
+    * source walker matches and has no A2 mask. */
+   if (pixsize < 3 || pixsize > 5 || (a1_flags & 0x001F0003))
+      return false;
+   if (copy && (((a2_flags >> 3) & 0x07) != pixsize || (a2_flags & 0x001F8003)))
+      return false;
+
+   ppp = 64 >> pixsize;
+   if (lines == 0 || icount == 0 || (icount & (ppp - 1)))
+      return false;
+   bytes = ((uint32_t)icount << pixsize) >> 3;
+   src_pixels = icount + (srcenx ? ppp : 0);
+
+   /* Pass 0 walks every line and declines on the first one that does not
+    * qualify; pass 1 runs the blit.  Nothing is written before pass 1. */
+   for (pass = 0; pass < 2; pass++)
+   {
+      a1_x = (int16_t)GET16(blitter_ram, A1_PIXEL + 2);
+      a1_y = (int16_t)GET16(blitter_ram, A1_PIXEL + 0);
+      a2_x = (int16_t)GET16(blitter_ram, A2_PIXEL + 2);
+      a2_y = (int16_t)GET16(blitter_ram, A2_PIXEL + 0);
+
+      if (pass == 1)
+      {
+         uint64_t patd = GET64(blitter_ram, PATTERNDATA);
+         unsigned i;
+
+         for (i = 0; i < 8; i++)
+            pat[i] = (uint8_t)(patd >> (56 - 8 * i));
+         VJT_EMIT(VJT_EV_BLIT_CMD, BLITTER, cmd, a1_base);
+      }
+
+      for (line = 0; line < lines; line++)
+      {
+         if (pass == 0)
+         {
+            if ((a1_x & (ppp - 1)) || (copy && (a2_x & (ppp - 1))))
+               return false;
+            dst = blitter_bulk_line(a1_base, pixsize, a1_width, a1_x, a1_y, icount);
+            if (dst == 0xFFFFFFFF)
+               return false;
+            if (copy)
+            {
+               src = blitter_bulk_line(a2_base, pixsize, a2_width, a2_x, a2_y, src_pixels);
+               if (src == 0xFFFFFFFF)
+                  return false;
+            }
+         }
+         else
+         {
+            uint8_t * d;
+            uint32_t k;
+
+            dst = blitter_bulk_line(a1_base, pixsize, a1_width, a1_x, a1_y, icount);
+            d = jaguarMainRAM + dst;
+            StateDeltaMarkRange(dst, bytes);
+
+            if (!copy)
+            {
+               for (k = 0; k < bytes; k += 8)
+                  memcpy(d + k, pat, 8);
+            }
+            else
+            {
+               uint8_t * s;
+
+               src = blitter_bulk_line(a2_base, pixsize, a2_width, a2_x, a2_y, src_pixels);
+               s = jaguarMainRAM + src + (srcenx ? 8 : 0);
+               /* The state machine reads each source phrase just before
+                * writing its destination phrase.  A forward overlap
+                * therefore repeats data, which memmove would not. */
+               if (d <= s || d >= s + bytes)
+                  memmove(d, s, bytes);
+               else
+                  for (k = 0; k < bytes; k += 8)
+                     memcpy(d + k, s + k, 8);
+               PERF_ADD(blitter_phrase_reads, (bytes >> 3) + (srcenx ? 1 : 0));
+            }
+            PERF_ADD(blitter_inner, bytes >> 3);
+            PERF_ADD(blitter_phrase_writes, bytes >> 3);
+         }
+
+         a1_x = (int16_t)(a1_x + icount);
+         if (copy)
+            a2_x = (int16_t)(a2_x + src_pixels);
+         if (upda1)
+         {
+            a1_x = (int16_t)(a1_x + a1_step_x);
+            a1_y = (int16_t)(a1_y + a1_step_y);
+         }
+         if (upda2)
+         {
+            a2_x = (int16_t)(a2_x + a2_step_x);
+            a2_y = (int16_t)(a2_y + a2_step_y);
+         }
+      }
+   }
+
+   SET16(blitter_ram, A1_PIXEL + 2, a1_x);
+   SET16(blitter_ram, A1_PIXEL + 0, a1_y);
+   SET16(blitter_ram, A2_PIXEL + 2, a2_x);
+   SET16(blitter_ram, A2_PIXEL + 0, a2_y);
+
+   blitBulkBlits++;
+   PERF_INC(blitter_bulk);
+   return true;
+}
+
+/* Accurate-engine instances, keyed on the command word alone: the flags
+ * it decodes feed every state-machine tick, while the depth and walk
+ * fields are decoded once per blit. */
+#define BLIT_ACC_HOT(X) \
+   X(00010200)   /* pattern fill */ \
+   X(00011000)   /* Gouraud fill */ \
+   X(00011008)   /* Gouraud span over the destination */ \
+   X(01800001)   /* copy */ \
+   X(01800005)   /* copy with SRCENX */ \
+   X(41802F41)   /* clipped, shaded texture walk into A2 */
+
+#define BLIT_ACC_SIG(cmd)     ((uint64_t)(cmd) << 16)
+
+#define BLIT_ACC_DEFINE(cmd) \
+   static void blit_acc_##cmd(void) \
+   { \
+      blitter_midsummer2_run(0x##cmd); \
+   }
+
+#define BLIT_ACC_ENTRY(cmd)   { BLIT_ACC_SIG(0x##cmd), blit_acc_##cmd },
+
+BLIT_ACC_HOT(BLIT_ACC_DEFINE)
+
+static const blit_instance blitAccInstances[] = { BLIT_ACC_HOT(BLIT_ACC_ENTRY) };
+static blit_spec_cache blitAccCache;
+
+void BlitterMidsummer2(void)
+{
+   uint32_t cmd = (PERF_INC(blitter_calls), GET32(blitter_ram, COMMAND));
+
+   if (blitter_bulk_phrase(cmd))
+      return;
+
+   if (blitSpecialise)
+   {
+      blit_instance_fn fn = blit_spec_lookup(&blitAccCache, blitAccInstances,
+            sizeof(blitAccInstances) / sizeof(blitAccInstances[0]),
+            BLIT_ACC_SIG(cmd));
+
+      if (fn)
+      {
+         blitSpecHits++;
+         fn();
+         return;
+      }
+      blitSpecMisses++;
+   }
+
+   blitter_midsummer2_run(cmd);
+}
+
 // Various pieces of the blitter puzzle are teased out here...
 
 static void ADDRGEN(uint32_t *address, uint32_t *pixa, bool gena2, bool zaddr,
@@ -32,6 +32,22 @@ void BlitterWriteLong(uint32_t, uint32_t, uint32_t who);
 uint32_t blitter_reg_read(uint32_t offset);
 void blitter_reg_write(uint32_t offset, uint32_t data);
 
+/* Command specialisation: hot command signatures run specialised copies
+ * of the engine loops (on by default).  Off runs every blit through the
+ * generic loops, which stay the reference.  Stats count blits run by a
+ * copy (hits) and by the generic loop while enabled (misses). */
+void BlitterSpecialiseEnable(int enable);
+int BlitterSpecialiseIsEnabled(void);
+void BlitterSpecialiseStats(uint32_t *hits, uint32_t *misses);
+
+/* Bulk phrase path: the accurate engine runs whole-phrase pattern fills
+ * and straight copies on main RAM as block stores (on by default).  Off
+ * sends them through the state machine, which stays the reference.
+ * Stats count the blits the bulk path ran. */
+void BlitterBulkEnable(int enable);
+int BlitterBulkIsEnabled(void);
+void BlitterBulkStats(uint32_t *blits);
+
 void BlitterCompareEnable(int enable);
 int BlitterCompareIsEnabled(void);
 void BlitterCompareGetStats(uint32_t *total, uint32_t *diffs, uint32_t *skipped);
@@ -50,12 +66,26 @@ void BlitterCompareDumpCmdStats(void);
  *                    Default mask=0 = accept all.
  *   SetVerbose:      on diff, dump the full pre-blit register set and
  *                    a side-by-side byte-pair hexdump of the differing
- *                    destination region. */
+ *                    destination region.
+ *   SetPair:         what the two sides are.  BLIT_CMP_PAIR_ENGINES
+ *                    (default) diffs the fast engine against the
+ *                    accurate one; BLIT_CMP_PAIR_SPECIALISED diffs the
+ *                    engine vjs.useFastBlitter selects with command
+ *                    specialisation on ("fast" in the log) against its
+ *                    generic loop ("acc"), registers included;
+ *                    BLIT_CMP_PAIR_BULK does the same for the accurate
+ *                    engine's bulk phrase path against its state
+ *                    machine. */
 void BlitterCompareSetFrame(uint32_t frame);
 void BlitterCompareSetFrameWindow(uint32_t first, uint32_t last);
 void BlitterCompareSetCmdMask(uint32_t mask, uint32_t value);
 void BlitterCompareSetVerbose(int verbose);
 
+#define BLIT_CMP_PAIR_ENGINES     0
+#define BLIT_CMP_PAIR_SPECIALISED 1
+#define BLIT_CMP_PAIR_BULK        2
+void BlitterCompareSetPair(int pair);
+
 #ifdef __cplusplus
 }
 #endif
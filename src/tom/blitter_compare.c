@@ -48,6 +48,7 @@ static uint32_t blit_cmp_frame_last = 0xFFFFFFFFu;
 static uint32_t blit_cmp_filter_mask = 0;     /* 0 = accept all */
 static uint32_t blit_cmp_filter_value = 0;
 static int blit_cmp_verbose = 0;
+static int blit_cmp_pair = BLIT_CMP_PAIR_ENGINES;
 
 /* Run the non-compare default blit path.  Used when a filter rejects
  * a blit so game state still advances normally — mirrors the dispatch
@@ -60,6 +61,17 @@ static void blit_cmp_run_default(uint32_t cmd)
       BlitterMidsummer2();
 }
 
+/* One side of a same-engine pair: the optimisation under test on ("fast"
+ * in the log) or off ("acc"). */
+static void blit_cmp_run_variant(uint32_t cmd, int on)
+{
+   if (blit_cmp_pair == BLIT_CMP_PAIR_BULK)
+      BlitterBulkEnable(on);
+   else
+      BlitterSpecialiseEnable(on);
+   blit_cmp_run_default(cmd);
+}
+
 /* Verbose diff dump.  Prints pre-blit register snapshot, fast vs accurate
  * post-blit register deltas, and a side-by-side hexdump of the first 32
  * bytes of the differing destination region.  Caller gates by
@@ -279,6 +291,11 @@ void BlitterCompareSetVerbose(int verbose)
    blit_cmp_verbose = verbose ? 1 : 0;
 }
 
+void BlitterCompareSetPair(int pair)
+{
+   blit_cmp_pair = pair;
+}
+
 void BlitterCompareGetStats(uint32_t *total, uint32_t *diffs, uint32_t *skipped)
 {
    if (total) *total = blit_cmp_total;
@@ -318,6 +335,8 @@ void BlitterRunComparison(void)
    uint32_t i;
    uint8_t pre_regs[0x100];
    uint8_t fast_regs[0x100];
+   int spec_was, bulk_was;
+   int reg_diff;
 
    blit_cmp_total++;
 
@@ -395,7 +414,14 @@ void BlitterRunComparison(void)
       return;
    }
 
-   blitter_blit(cmd);
+   /* The specialised and bulk pairs run the selected engine both times,
+    * with and then without the optimisation. */
+   spec_was = BlitterSpecialiseIsEnabled();
+   bulk_was = BlitterBulkIsEnabled();
+   if (blit_cmp_pair != BLIT_CMP_PAIR_ENGINES)
+      blit_cmp_run_variant(cmd, 1);
+   else
+      blitter_blit(cmd);
 
    memcpy(blit_cmp_fast_region, jaguarMainRAM + save_start, save_size);
    memcpy(fast_regs, blitter_ram, sizeof(fast_regs));
@@ -403,7 +429,14 @@ void BlitterRunComparison(void)
       memcpy(jaguarMainRAM + save_start, blit_cmp_saved_region, save_size);
       BlitterStateLoad(blit_cmp_state_buf);
 
-      BlitterMidsummer2();
+      if (blit_cmp_pair != BLIT_CMP_PAIR_ENGINES)
+      {
+         blit_cmp_run_variant(cmd, 0);
+         BlitterSpecialiseEnable(spec_was);
+         BlitterBulkEnable(bulk_was);
+      }
+      else
+         BlitterMidsummer2();
 
       if (blit_cmp_logged < 10)
       {
@@ -446,7 +479,18 @@ void BlitterRunComparison(void)
       }
    }
 
-   if (diff_bytes > 0)
+   /* The engines leave different register side effects by design; the
+    * specialised loops and the bulk path must not. */
+   reg_diff = (blit_cmp_pair != BLIT_CMP_PAIR_ENGINES
+         && memcmp(fast_regs, blitter_ram, sizeof(fast_regs)) != 0);
+   if (reg_diff && diff_bytes == 0 && blit_cmp_logged < BLIT_CMP_MAX_LOG)
+   {
+      blit_cmp_logged++;
+      LOG_WRN("[BLIT CMP] #%u REG DIFF cmd=%08X (memory identical)\n",
+         (unsigned)blit_cmp_total, (unsigned)cmd);
+   }
+
+   if (diff_bytes > 0 || reg_diff)
    {
       int ci;
       int found_bucket = 0;
@@ -468,7 +512,7 @@ void BlitterRunComparison(void)
          blit_cmp_diff_cmd_count++;
       }
 
-      if (blit_cmp_logged < BLIT_CMP_MAX_LOG)
+      if (diff_bytes > 0 && blit_cmp_logged < BLIT_CMP_MAX_LOG)
       {
          uint16_t n_pix = GET16(blitter_ram, PIXLINECOUNTER + 2);
          uint16_t n_lin = GET16(blitter_ram, PIXLINECOUNTER);
@@ -9,6 +9,7 @@
 #include "gpu.h"
 #include "settings.h"
 #include "vjag_memory.h"
+#include "perf_timing.h"
 
 #define A1_FLAGS        ((uint32_t)0x04)
 #define A1_PIXEL        ((uint32_t)0x0C)
@@ -340,6 +341,8 @@ void BlitterWriteWord(uint32_t offset, uint16_t data, uint32_t who/*=UNKNOWN*/)
       if (texReplaceEnabled)
          trBlit = TexReplacePreBlit();
 
+      PERF_TIME_ENTER(vjs.useFastBlitter ? PERF_T_BLIT_FAST
+                                         : PERF_T_BLIT_ACCURATE);
       if (BlitterCompareIsEnabled())
          BlitterRunComparison();
       else if (!BlitMemoLaunch())
@@ -350,6 +353,7 @@ void BlitterWriteWord(uint32_t offset, uint16_t data, uint32_t who/*=UNKNOWN*/)
          else
             BlitterMidsummer2();
       }
+      PERF_TIME_LEAVE();
 
       if (trBlit)
          TexReplacePostBlit();
@@ -4,7 +4,8 @@
  * Provides architecture-specific implementations of the blitter's
  * hottest data-path operations. Only one implementation is active per
  * build; the arch is selected in Makefile.common, which compiles the
- * matching blitter_simd_<arch>.c *and* passes -DBLITTER_SIMD_<ARCH>.
+ * matching blitter_simd_<arch>.c *and* passes -DBLITTER_SIMD_<ARCH>
+ * (see simd_arch.h).
  *
  * The implementations live in blitter_simd_<arch>.h as static inline
  * functions so BlitterMidsummer2 can inline them.  That matters: these
@@ -28,15 +29,9 @@
 #include <stdint.h>
 #include <boolean.h>
 
-/* Portable always-inline, spelled to include the inline keyword itself
- * (MSVC's __forceinline IS the inline keyword for that compiler). */
-#if defined(_MSC_VER)
-#  define BLITTER_SIMD_INLINE __forceinline
-#elif defined(__GNUC__) || defined(__clang__)
-#  define BLITTER_SIMD_INLINE inline __attribute__((always_inline))
-#else
-#  define BLITTER_SIMD_INLINE inline
-#endif
+#include "simd_arch.h"
+
+#define BLITTER_SIMD_INLINE SIMD_INLINE
 
 typedef struct
 {
@@ -90,9 +85,9 @@ extern const blitter_simd_ops_t blitter_simd_ops;
  * every MSVC target) get scalar, which is what those already selected.
  * A mismatch between the -D and the compiled .c is a hard compile error
  * rather than a silent slow path -- see blitter_simd_<arch>.c. */
-#if defined(BLITTER_SIMD_NEON)
+#if defined(SIMD_ARCH_NEON)
 #  include "blitter_simd_neon.h"
-#elif defined(BLITTER_SIMD_SSE2)
+#elif defined(SIMD_ARCH_SSE2)
 #  include "blitter_simd_sse2.h"
 #else
 #  include "blitter_simd_scalar.h"
@@ -37,6 +37,10 @@
 #include "settings.h"
 #include "../core/vjtrace.h"
 #include "../core/crash_detect.h"
+#include "../core/risc_block.h"
+#include "../core/risc_jit.h"
+#include "../core/risc_idle.h"
+#include "../core/perf_timing.h"
 
 
 // Seems alignment in loads & stores was off...
@@ -543,6 +547,42 @@ void (*gpu_opcode[64])()=
 static uint8_t gpu_ram_8[0x1000];
 uint32_t gpu_pc;
 
+/* Pre-decoded instruction stream over GPU local RAM.
+ *
+ * GPUExec is ~74% of frame time on yarc (docs/op-perf-profile.md), and
+ * every step used to re-fetch the opcode byte-by-byte from gpu_ram_8 and
+ * re-split it into dispatch index and register fields.  gpu_decoded[]
+ * keeps one entry per 16-bit word of local RAM with those fields already
+ * split out, so a step from local RAM is a single 4-byte load.
+ *
+ * The table is kept coherent WRITE-THROUGH rather than by invalidation:
+ * every store into gpu_ram_8 re-decodes the word(s) it touched.  All
+ * writers funnel through GPUWriteByte/Word/Long -- the GPU's own stores,
+ * the 68K and blitter (via TOMWrite*), CD HLE mailbox pokes -- and
+ * GPUReset/GPUStateLoad rebuild it wholesale.  The fetch side therefore
+ * never tests a valid bit and an entry can never be stale, whether or
+ * not the cache is currently switched on.
+ *
+ * Code running out of main RAM or cart ROM, and odd PCs (an unaligned
+ * G_PC write), take the original fetch path.  Derived state: never
+ * serialized.  Switchable (GPUSetDecodeCache) purely so the two paths
+ * can be A/B'd; both are bit-identical.
+ *
+ * The entry layout and the straight-line run tracking on top of it are
+ * shared with the DSP: see src/core/risc_block.h. */
+static RISCDecodedOp gpu_decoded[0x800];
+static int gpu_decode_cache = 1;
+/* Run straight-line superblocks (risc_block.h) in one step. */
+static int gpu_superblocks = 1;
+/* Run hot superblocks as x86-64 translations (risc_jit.h); off by
+ * default so the interpreter stays the reference. */
+static int gpu_jit_enabled = 0;
+static RISCJitBlock gpu_jit_blocks[0x800];
+static uint8_t gpu_jit_heat[0x800];
+/* Skip the repeats of an idle polling loop (risc_idle.h). */
+static int gpu_idle_skip = 1;
+static RISCIdleWatch gpu_idle;
+
 
 /* Diagnostic IRQ counters (see gpu.h). Pure observability — incremented on
  * GPUSetIRQLine(line, ASSERT_LINE), reset in GPUReset. */
@@ -747,6 +787,104 @@ uint32_t GPUGetFlags(void)
 }
 #endif /* VJ_TRACE */
 
+/* Opcodes that touch only registers, flags and the MAC accumulator:
+ * the members of a straight-line run (see risc_block.h).  Everything
+ * else -- movei (fetches its immediate through the PC), loads, stores,
+ * jump/jr, mmult (reads matrix RAM) -- ends a run. */
+static const uint8_t gpu_opcode_straight[64] =
+{
+   1, 1, 1, 1, 1, 1, 1, 1,    /* add addc addq addqt sub subc subq subqt */
+   1, 1, 1, 1, 1, 1, 1, 1,    /* neg and or xor not btst bset bclr */
+   1, 1, 1, 1, 1, 1, 1, 1,    /* mult imult imultn resmac imacn div abs sh */
+   1, 1, 1, 1, 1, 1, 1, 1,    /* shlq shrq sha sharq ror rorq cmp cmpq */
+   1, 1, 1, 1, 1, 1, 0, 0,    /* sat8 sat16 move moveq moveta movefa movei loadb */
+   0, 0, 0, 0, 0, 0, 0, 0,    /* loadw load loadp load_r14_i load_r15_i storeb storew store */
+   0, 0, 0, 1, 0, 0, 0, 1,    /* storep store_r14_i store_r15_i move_pc jump jr mmult mtoi */
+   1, 1, 0, 0, 0, 0, 1, 1     /* normi nop load_r14_ri load_r15_ri store_r14_ri store_r15_ri sat24 pack */
+};
+
+static const RISCDecodeTable gpu_decode_table =
+{
+   gpu_decoded, gpu_ram_8, 0x800, gpu_opcode_cycles, gpu_opcode_straight
+};
+
+static RISCJit gpu_jit =
+{
+   &gpu_flag_z, &gpu_flag_n, &gpu_flag_c,
+   &gpu_opcode_first_parameter, &gpu_opcode_second_parameter,
+   gpu_opcode, GPU_WORK_RAM_BASE,
+   gpu_jit_blocks, gpu_jit_heat, 0x800,
+   NULL, 0, 0
+};
+
+/* Re-decode every word overlapping local-RAM bytes [off, off + len),
+ * and drop any translation that could cover them. */
+INLINE static void GPUDecodeRange(uint32_t off, uint32_t len)
+{
+   RISCDecodeRange(&gpu_decode_table, off, len);
+   RISCJitInvalidate(&gpu_jit, off, len);
+}
+
+void GPUSetDecodeCache(int enabled)
+{
+   gpu_decode_cache = enabled ? 1 : 0;
+}
+
+void GPUSetSuperblocks(int enabled)
+{
+   gpu_superblocks = enabled ? 1 : 0;
+}
+
+void GPUSetIdleSkip(int enabled)
+{
+   gpu_idle_skip = enabled ? 1 : 0;
+}
+
+void GPUIdleSkipStats(uint64_t *cycles, uint32_t *skips)
+{
+   if (cycles)
+      *cycles = gpu_idle.skipped;
+   if (skips)
+      *skips = gpu_idle.skips;
+}
+
+int GPUSetJit(int enabled)
+{
+   if (!enabled)
+      gpu_jit_enabled = 0;
+   else if (!gpu_jit_enabled)
+      gpu_jit_enabled = RISCJitEnable(&gpu_jit);
+   return gpu_jit_enabled;
+}
+
+/* Fetch the opcode at gpu_pc into the decode globals and return its
+ * dispatch index; *cycles gets its base cost.  Shared by the exec loop
+ * and the jump/jr delay slot so both see the same stream. */
+INLINE static uint32_t GPUFetchOpcode(uint32_t *cycles)
+{
+   uint32_t off = gpu_pc - GPU_WORK_RAM_BASE;
+   uint16_t opcode;
+
+   /* Local RAM and word-aligned: one load from the decoded stream. */
+   if (gpu_decode_cache && (off & 0xFFFFF001) == 0)
+   {
+      const RISCDecodedOp *op = &gpu_decoded[off >> 1];
+      gpu_opcode_first_parameter  = op->reg1;
+      gpu_opcode_second_parameter = op->reg2;
+      *cycles = op->cycles;
+      return op->index;
+   }
+
+   if (off < 0x1000)
+      opcode = ((uint16_t)gpu_ram_8[off] << 8) | (uint16_t)gpu_ram_8[off + 1];
+   else
+      opcode = GPUReadWord(gpu_pc, GPU);
+   gpu_opcode_first_parameter  = (opcode >> 5) & 0x1F;
+   gpu_opcode_second_parameter = opcode & 0x1F;
+   *cycles = gpu_opcode_cycles[opcode >> 10];
+   return opcode >> 10;
+}
+
 void build_branch_condition_table(void)
 {
    unsigned i, j;
@@ -890,6 +1028,7 @@ void GPUWriteByte(uint32_t offset, uint8_t data, uint32_t who/*=UNKNOWN*/)
    if ((offset >= GPU_WORK_RAM_BASE) && (offset <= GPU_WORK_RAM_BASE + 0x0FFF))
    {
       gpu_ram_8[offset & 0xFFF] = data;
+      GPUDecodeRange(offset & 0xFFF, 1);
 
       return;
    }
@@ -920,6 +1059,7 @@ void GPUWriteWord(uint32_t offset, uint16_t data, uint32_t who/*=UNKNOWN*/)
    {
       gpu_ram_8[offset & 0xFFF] = (data>>8) & 0xFF;
       gpu_ram_8[(offset+1) & 0xFFF] = data & 0xFF;//*/
+      GPUDecodeRange(offset & 0xFFF, 2);
 
       return;
    }
@@ -965,6 +1105,7 @@ void GPUWriteLong(uint32_t offset, uint32_t data, uint32_t who/*=UNKNOWN*/)
    {
       offset &= 0xFFF;
       SET32(gpu_ram_8, offset, data);
+      GPUDecodeRange(offset, 4);
       return;
    }
    else if ((offset >= GPU_CONTROL_RAM_BASE) && (offset <= GPU_CONTROL_RAM_BASE + 0x1C))
@@ -1262,6 +1403,8 @@ void GPUDone(void)
     * build_branch_condition_table() early-outs on non-NULL pointer. */
    free(branch_condition_table);
    branch_condition_table = NULL;
+   RISCJitRelease(&gpu_jit);
+   gpu_jit_enabled = 0;
 }
 
 /* Drop the sub-cycle bus-stall remainder when the RISC clock scale
@@ -1290,6 +1433,8 @@ void GPUReset(void)
    gpu_pc				  = 0x00F03000;
    gpu_irq0_count       = 0;
    gpu_irq3_count       = 0;
+   gpu_idle.skipped     = 0;
+   gpu_idle.skips       = 0;
    gpuExecSliceBudget   = 0;
    gpuExecSliceRemaining = 0;
    gpu_control			  = 0x00002800;			// Correctly sets this as TOM Rev. 2
@@ -1326,6 +1471,7 @@ void GPUReset(void)
    // Contents of local RAM are quasi-stable; we simulate this by randomizing RAM contents
    for(i=0; i<4096; i+=4)
       *((uint32_t *)(&gpu_ram_8[i])) = JaguarRand();
+   GPUDecodeRange(0, 0x1000);
 }
 
 uint32_t GPUReadPC(void)
@@ -1415,13 +1561,79 @@ void GPUSyncToM68K(void)
       return;
 
    gpuSliceSpent += run;
+   PERF_TIME_ENTER(PERF_T_GPU);
    GPUExec(run);
+   PERF_TIME_LEAVE();
+}
+
+/* Idle-loop watch (risc_idle.h).  A load the watch can replay: GPU
+ * local RAM, or main RAM behind a plain page-table entry (no
+ * watchpoint, no memo recording) -- both free of side effects and
+ * costing the same on every access. */
+static int GPUIdleReadable(uint32_t addr)
+{
+   if (addr >= GPU_WORK_RAM_BASE && addr <= GPU_WORK_RAM_BASE + 0xFF8)
+      return 1;
+   return addr < 0x1FFFF8
+      && jaguarReadPage[addr >> JAG_PAGE_SHIFT]
+      && jaguarReadPage[(addr + 7) >> JAG_PAGE_SHIFT];
+}
+
+/* Can the watched iteration go on through this instruction?  Called
+ * with gpu_pc past it, before it runs.  jump/jr run their delay slot
+ * inside the opcode, so the slot is vetted here too; that needs the
+ * loop in local RAM, where the decoded stream has it. */
+static int GPUIdleSafe(uint32_t index, uint32_t rm)
+{
+   if (gpu_opcode_straight[index])
+      return 1;
+   switch (index)
+   {
+      case 38:                      /* movei */
+         return 1;
+      case 39: case 40: case 41: case 42:
+         return GPUIdleReadable(gpu_reg[rm]);
+      case 43:
+         return GPUIdleReadable(gpu_reg[14] + (gpu_convert_zero[rm] << 2));
+      case 44:
+         return GPUIdleReadable(gpu_reg[15] + (gpu_convert_zero[rm] << 2));
+      case 58:
+         return GPUIdleReadable(gpu_reg[14] + gpu_reg[rm]);
+      case 59:
+         return GPUIdleReadable(gpu_reg[15] + gpu_reg[rm]);
+      case 52: case 53:
+      {
+         uint32_t off = gpu_pc - GPU_WORK_RAM_BASE;
+         const RISCDecodedOp *ds;
+
+         if (!gpu_decode_cache || (off & 0xFFFFF001) != 0)
+            return 0;
+         ds = &gpu_decoded[off >> 1];
+         return ds->index != 52 && ds->index != 53
+            && GPUIdleSafe(ds->index, ds->reg1);
+      }
+   }
+   return 0;
+}
+
+/* Everything a replayable iteration can change. */
+static void GPUIdleState(uint32_t *state)
+{
+   memcpy(state, gpu_reg_bank_0, 32 * sizeof(uint32_t));
+   memcpy(state + 32, gpu_reg_bank_1, 32 * sizeof(uint32_t));
+   state[64] = gpu_flag_z | (gpu_flag_n << 1) | (gpu_flag_c << 2);
+   state[65] = gpu_acc;
+   state[66] = gpu_remain;
+   state[67] = gpu_hidata;
+   state[68] = state[69] = state[70] = state[71] = 0;
 }
 
 // Main GPU execution core
 
 void GPUExec(int32_t cycles)
 {
+   int idle;
+
    if (!GPU_RUNNING)
       return;
 
@@ -1444,26 +1656,90 @@ void GPUExec(int32_t cycles)
    gpu_releaseTimeSlice_flag = 0;
    gpu_in_exec++;
    gpuExecSliceBudget = cycles;
+   /* The pipeline model's scoreboard clock moves per instruction, and
+    * the PC history wants every iteration. */
+   idle = gpu_idle_skip && !vjs.gpuPipelineTiming;
+#ifdef VJ_TRACE
+   if (vjtrace_armed)
+      idle = 0;
+#endif
+   RISCIdleReset(&gpu_idle);
 
    while (cycles > 0 && GPU_RUNNING)
    {
-      uint16_t opcode;
       uint32_t index;
+      uint32_t op_cycles;
+      uint32_t op_pc;
+      /* Straight-line superblock (risc_block.h): when the slice budget
+       * covers the whole run, execute it back-to-back and charge its
+       * cycle total once.  Nothing in a run can stall, branch, touch
+       * memory or G_CTRL, so the per-instruction bookkeeping below would
+       * be a no-op for each of them: the bus/core stalls stay 0 and the
+       * single-step barrier cannot newly trip.  The pipeline model wants
+       * every instruction (scoreboard), so it keeps the per-instruction
+       * path.  `cycles > run_cycles`
+       * guarantees the budget is still positive before the run's last
+       * instruction, exactly as the per-instruction loop would see it. */
+      if (gpu_superblocks && gpu_decode_cache && !vjs.gpuPipelineTiming)
+      {
+         uint32_t off = gpu_pc - GPU_WORK_RAM_BASE;
+
+         if ((off & 0xFFFFF001) == 0)
+         {
+            const RISCDecodedOp *op = &gpu_decoded[off >> 1];
+
+            if (op->run > 1 && cycles > (int32_t)op->run_cycles)
+            {
+               uint32_t n = op->run;
+               RISCJitBlock block = gpu_jit_enabled
+                  ? RISCJitLookup(&gpu_jit, gpu_decoded, off >> 1) : NULL;
+
+               cycles -= op->run_cycles;
+               gpu_exec_opcode_count += n;
+               gpu_bus_stall = 0;
+               gpu_pipe_core_stall = 0;
+               if (block)
+               {
+#ifdef VJ_TRACE
+                  uint32_t i;
+                  for (i = 0; i < n; i++)
+                     VJT_PCHIST_GPU(gpu_pc + i * 2);
+#endif
+                  block(gpu_reg, gpu_alternate_reg);
+                  gpu_pc += n * 2;
+                  op += n - 1;
+                  gpu_opcode_first_parameter  = op->reg1;
+                  gpu_opcode_second_parameter = op->reg2;
+               }
+               else for (;;)
+               {
+#ifdef VJ_TRACE
+                  VJT_PCHIST_GPU(gpu_pc);
+#endif
+                  gpu_opcode_first_parameter  = op->reg1;
+                  gpu_opcode_second_parameter = op->reg2;
+                  gpu_pc += 2;
+                  executeOpcode(op->index);
+                  if (--n == 0)
+                     break;
+                  op++;
+               }
+               /* Leave the serialized/observable per-instruction state as
+                * the last instruction of the run left it. */
+               gpu_instruction = ((uint32_t)op->index << 10) | ((uint32_t)op->reg1 << 5) | op->reg2;
+               gpuExecSliceRemaining = cycles + op->cycles;
+               continue;
+            }
+         }
+      }
       gpuExecSliceRemaining = cycles;
 #ifdef VJ_TRACE
       VJT_PCHIST_GPU(gpu_pc);
 #endif
-      if (gpu_pc >= GPU_WORK_RAM_BASE && gpu_pc < GPU_WORK_RAM_BASE + 0x1000)
-      {
-         uint32_t off = gpu_pc - GPU_WORK_RAM_BASE;
-         opcode = ((uint16_t)gpu_ram_8[off] << 8) | (uint16_t)gpu_ram_8[off + 1];
-      }
-      else
-         opcode = GPUReadWord(gpu_pc, GPU);
-      index = opcode >> 10;
-      gpu_instruction = opcode;	// Added for GPU #3...
-      gpu_opcode_first_parameter  = (opcode >> 5) & 0x1F;
-      gpu_opcode_second_parameter = opcode & 0x1F;
+      op_pc = gpu_pc;
+      index = GPUFetchOpcode(&op_cycles);
+      gpu_instruction = (index << 10) | (gpu_opcode_first_parameter << 5)
+                      | gpu_opcode_second_parameter;	// Added for GPU #3...
 
       //$E400 -> 1110 01 -> $39 -> 57
       gpu_pc += 2;
@@ -1475,6 +1751,8 @@ void GPUExec(int32_t cycles)
        * charged, via the same gpu_bus_stall channel as DRAM costs). */
       if (vjs.gpuPipelineTiming)
          GPUPipeCheckUse(index);
+      if (gpu_idle.head && !GPUIdleSafe(index, gpu_opcode_first_parameter))
+         RISCIdleAbandon(&gpu_idle);
 #if 0
       gpu_opcode[index]();
 #else
@@ -1482,7 +1760,7 @@ void GPUExec(int32_t cycles)
 #endif
       if (vjs.gpuPipelineTiming)
       {
-         gpu_pipe_clock += (uint64_t)gpu_opcode_cycles[index] + gpu_bus_stall
+         gpu_pipe_clock += (uint64_t)op_cycles + gpu_bus_stall
                          + gpu_pipe_core_stall;
          gpu_pipe_prev_dest =
             (gpu_pipe_flags[index] & 4) ? (uint8_t)gpu_opcode_second_parameter
@@ -1514,11 +1792,13 @@ void GPUExec(int32_t cycles)
          gpu_stall_scale_accum += gpu_bus_stall * riscClockScalePct;
          stall_scaled = gpu_stall_scale_accum / 100u;
          gpu_stall_scale_accum %= 100u;
-         cycles -= gpu_opcode_cycles[index] + (int32_t)stall_scaled
+         cycles -= (int32_t)op_cycles + (int32_t)stall_scaled
                  + (int32_t)gpu_pipe_core_stall;
+         /* The remainder carries between iterations: no fixed cost. */
+         RISCIdleAbandon(&gpu_idle);
       }
       else
-         cycles -= gpu_opcode_cycles[index] + (int32_t)gpu_bus_stall
+         cycles -= (int32_t)op_cycles + (int32_t)gpu_bus_stall
                  + (int32_t)gpu_pipe_core_stall;
 
       /* Single-step barrier (G_CTRL SINGLE_STEP, bit 3): a running RISC core
@@ -1535,6 +1815,19 @@ void GPUExec(int32_t cycles)
        * single-step mode). */
       if (gpu_control & 0x08)
          break;
+
+      /* A taken short backward branch: the head of a loop that may be
+       * idling (risc_idle.h). */
+      if (idle && (index == 52 || index == 53)
+         && gpu_pc <= op_pc && op_pc - gpu_pc < RISC_IDLE_SPAN
+         && RISCIdleWanted(&gpu_idle, gpu_pc))
+      {
+         uint32_t state[RISC_IDLE_STATE];
+
+         GPUIdleState(state);
+         cycles -= RISCIdleBranch(&gpu_idle, gpu_pc, cycles,
+               &gpu_exec_opcode_count, state);
+      }
    }
 
    gpu_in_exec--;
@@ -1768,22 +2061,12 @@ INLINE static void gpu_opcode_jump(void)
    if (BRANCH_CONDITION(IMM_2))
    {
       uint32_t delayed_pc = RM;
-      uint16_t ds_opcode;
-      uint32_t ds_index;
+      uint32_t ds_index, ds_cycles;
       /* Inline delay-slot: fetch-decode-execute one instruction at current
        * PC before applying the branch target.  This replaces the old
        * recursive GPUExec(1) call, avoiding full function-call overhead,
        * redundant IRQ checks, and pipeline-state save/restore. */
-      if (gpu_pc >= GPU_WORK_RAM_BASE && gpu_pc < GPU_WORK_RAM_BASE + 0x1000)
-      {
-         uint32_t off = gpu_pc - GPU_WORK_RAM_BASE;
-         ds_opcode = ((uint16_t)gpu_ram_8[off] << 8) | (uint16_t)gpu_ram_8[off + 1];
-      }
-      else
-         ds_opcode = GPUReadWord(gpu_pc, GPU);
-      ds_index = ds_opcode >> 10;
-      gpu_opcode_first_parameter  = (ds_opcode >> 5) & 0x1F;
-      gpu_opcode_second_parameter = ds_opcode & 0x1F;
+      ds_index = GPUFetchOpcode(&ds_cycles);
       gpu_pc += 2;
       gpu_in_delay_slot = 1;
       gpu_ds_branch_target = delayed_pc;
@@ -1797,8 +2080,8 @@ INLINE static void gpu_opcode_jump(void)
           * loop, and a taken JUMP costs ~2 dead refill ticks on top
           * (INS_EXEC.NET, R12).  Both only under the option so the
           * default path stays byte-identical. */
-         gpu_pipe_core_stall += (uint32_t)gpu_opcode_cycles[ds_index] + 2u;
-         gpu_pipe_stall_total += (uint64_t)gpu_opcode_cycles[ds_index] + 2u;
+         gpu_pipe_core_stall += ds_cycles + 2u;
+         gpu_pipe_stall_total += (uint64_t)ds_cycles + 2u;
       }
       gpu_in_delay_slot = 0;
       /* If the delay-slot instruction dispatched an interrupt, gpu_pc is
@@ -1818,21 +2101,11 @@ INLINE static void gpu_opcode_jr(void)
    {
       int32_t offset     = ((IMM_1 & 0x10) ? 0xFFFFFFF0 | IMM_1 : IMM_1);		/* Sign extend IMM_1 */
       int32_t delayed_pc = gpu_pc + (offset * 2);
-      uint16_t ds_opcode;
-      uint32_t ds_index;
+      uint32_t ds_index, ds_cycles;
       /* Inline delay-slot: fetch-decode-execute one instruction at current
        * PC before applying the branch target.  Same rationale as in
        * gpu_opcode_jump above. */
-      if (gpu_pc >= GPU_WORK_RAM_BASE && gpu_pc < GPU_WORK_RAM_BASE + 0x1000)
-      {
-         uint32_t off = gpu_pc - GPU_WORK_RAM_BASE;
-         ds_opcode = ((uint16_t)gpu_ram_8[off] << 8) | (uint16_t)gpu_ram_8[off + 1];
-      }
-      else
-         ds_opcode = GPUReadWord(gpu_pc, GPU);
-      ds_index = ds_opcode >> 10;
-      gpu_opcode_first_parameter  = (ds_opcode >> 5) & 0x1F;
-      gpu_opcode_second_parameter = ds_opcode & 0x1F;
+      ds_index = GPUFetchOpcode(&ds_cycles);
       gpu_pc += 2;
       gpu_in_delay_slot = 1;
       gpu_ds_branch_target = (uint32_t)delayed_pc;
@@ -1844,8 +2117,8 @@ INLINE static void gpu_opcode_jr(void)
       {
          /* Delay-slot charge + taken-JR refill (~3 dead ticks, R13):
           * the JR target is computed a tick later than JUMP's. */
-         gpu_pipe_core_stall += (uint32_t)gpu_opcode_cycles[ds_index] + 3u;
-         gpu_pipe_stall_total += (uint64_t)gpu_opcode_cycles[ds_index] + 3u;
+         gpu_pipe_core_stall += ds_cycles + 3u;
+         gpu_pipe_stall_total += (uint64_t)ds_cycles + 3u;
       }
       gpu_in_delay_slot = 0;
       /* See gpu_opcode_jump: don't clobber a vector jump dispatched by
@@ -2695,6 +2968,7 @@ size_t GPUStateLoad(const uint8_t *buf)
    uint8_t active_bank;
 
    STATE_LOAD_BUF(buf, gpu_ram_8, sizeof(gpu_ram_8));
+   GPUDecodeRange(0, sizeof(gpu_ram_8));
    STATE_LOAD_VAR(buf, gpu_pc);
    STATE_LOAD_VAR(buf, gpu_acc);
    STATE_LOAD_VAR(buf, gpu_remain);
@@ -34,6 +34,22 @@ void GPUChargeBusStall(uint32_t sysclks);
 /* Zero the pipeline/gateway timing model's transient state (option
  * toggle, reset, savestate load). */
 void GPUPipeTimingReset(void);
+/* Toggle the pre-decoded local-RAM instruction stream (host-side only;
+ * emulated behaviour is identical either way). */
+void GPUSetDecodeCache(int enabled);
+/* Toggle straight-line superblock execution (src/core/risc_block.h);
+ * only takes effect while the decode cache is on. */
+void GPUSetSuperblocks(int enabled);
+/* Toggle the x86-64 translation of hot superblocks (src/core/risc_jit.h);
+ * needs superblocks on.  Returns whether it is now active: 0 on hosts
+ * without a code generator or when executable memory is refused. */
+int GPUSetJit(int enabled);
+/* Toggle skipping the repeats of an idle polling loop
+ * (src/core/risc_idle.h); results and cycle accounting are identical
+ * either way.  GPUIdleSkipStats() reports the cycles skipped and the
+ * number of skips since reset (either pointer may be NULL). */
+void GPUSetIdleSkip(int enabled);
+void GPUIdleSkipStats(uint64_t *cycles, uint32_t *skips);
 void GPUHandleIRQs(void);
 void GPUSetIRQLine(int irqline, int state);
 
@@ -0,0 +1,113 @@
+/*
+ * SIMD scanline converters for TOM's line buffer renderers
+ *
+ * Laid out like blitter_simd.h: the per-arch split of simd_arch.h,
+ * static inline functions in a header so tom.c inlines them, and an
+ * out-of-line vtable built by src/core/simd_ops_<arch>.c so
+ * test/test_line_simd.c validates exactly the code the core runs.
+ *
+ * Each converter turns `count` big-endian line-buffer pixels at `src`
+ * into count * scale XRGB8888 pixels at `dst` (scale is TOM's
+ * pwidth_scale, 1 or 2), bit-exact with the CRY16ToRGB32 /
+ * RGB16ToRGB32 / MIX16ToRGB32 lookups:
+ *
+ *   - RGB16 and the 24bpp layout are pure mask-and-shift expansions.
+ *   - CRY needs the 16x16 chroma tables, but only per high byte: the
+ *     SIMD variants gather one packed B/G/R triple per pixel from a
+ *     1 KB table (line_simd_luts.chroma) and multiply by the intensity
+ *     byte in 16-bit lanes, instead of hitting the 256 KB CRY16ToRGB32
+ *     at a data-dependent index.
+ *   - MIX computes both and selects per pixel on bit 0.
+ *
+ * The scalar variants keep the big lookup tables -- on a host without
+ * SIMD one load per pixel is still the cheapest decode.
+ */
+
+#ifndef LINE_SIMD_H
+#define LINE_SIMD_H
+
+#include <stdint.h>
+
+#include "simd_arch.h"
+
+typedef struct
+{
+   const uint32_t *cry;     /* CRY16ToRGB32 */
+   const uint32_t *rgb;     /* RGB16ToRGB32 */
+   const uint32_t *mix;     /* MIX16ToRGB32 */
+   /* 256 entries indexed by a CRY pixel's high byte (cyan << 4 | red):
+    * bluecv | greencv << 8 | redcv << 16, i.e. the XRGB8888 byte order
+    * of the full-intensity colour with alpha 0. */
+   const uint32_t *chroma;
+} line_simd_luts;
+
+typedef void (*line_simd_fn)(uint32_t *dst, const uint8_t *src,
+                             unsigned count, unsigned scale,
+                             const line_simd_luts *luts);
+
+typedef struct
+{
+   line_simd_fn cry16;      /* video mode 0 */
+   line_simd_fn rgb24;      /* video mode 1: bytes G R x B per pixel */
+   line_simd_fn rgb16;      /* video mode 3 */
+   line_simd_fn mix16;      /* video mode 4: bit 0 set = RGB16 */
+} line_simd_ops_t;
+
+extern const line_simd_ops_t line_simd_ops;
+
+/* Shared tails: the per-pixel lookup every variant falls back to for
+ * the pixels that do not fill a vector, and for scales above 2. */
+static SIMD_INLINE
+void line_simd_lut16(uint32_t *dst, const uint8_t *src, unsigned count,
+                     unsigned scale, const uint32_t *lut)
+{
+   unsigned s;
+
+   if (scale == 1)
+   {
+      for (; count; count--, src += 2)
+         *dst++ = lut[((uint32_t)src[0] << 8) | src[1]];
+      return;
+   }
+   while (count--)
+   {
+      uint32_t px = lut[((uint32_t)src[0] << 8) | src[1]];
+      for (s = 0; s < scale; s++)
+         *dst++ = px;
+      src += 2;
+   }
+}
+
+static SIMD_INLINE
+void line_simd_tail24(uint32_t *dst, const uint8_t *src, unsigned count,
+                      unsigned scale)
+{
+   unsigned s;
+
+   if (scale == 1)
+   {
+      for (; count; count--, src += 4)
+         *dst++ = 0xFF000000 | ((uint32_t)src[1] << 16)
+                | ((uint32_t)src[0] << 8) | src[3];
+      return;
+   }
+   while (count--)
+   {
+      uint32_t px = 0xFF000000 | ((uint32_t)src[1] << 16)
+                  | ((uint32_t)src[0] << 8) | src[3];
+      for (s = 0; s < scale; s++)
+         *dst++ = px;
+      src += 4;
+   }
+}
+
+/* line_simd_cry16 / _rgb24 / _rgb16 / _mix16 for the selected arch. */
+#if defined(SIMD_ARCH_NEON)
+#  include "line_simd_neon.h"
+#elif defined(SIMD_ARCH_SSE2)
+#  include "line_simd_sse2.h"
+#else
+#  include "line_simd_scalar.h"
+#endif
+
+#endif /* LINE_SIMD_H */
@@ -0,0 +1,140 @@
+#ifndef LINE_SIMD_NEON_H
+#define LINE_SIMD_NEON_H
+
+/* Included by line_simd.h once the arch has been selected.
+ * Do not include directly. */
+#ifndef LINE_SIMD_H
+#error "include line_simd.h, not line_simd_neon.h"
+#endif
+
+#include <arm_neon.h>
+
+/*
+ * Scanline converters -- ARM NEON implementation (ARMv7 and AArch64)
+ *
+ * Four pixels per step.  vrev16 does the big-endian swap, vtbl1
+ * broadcasts each CRY intensity byte across its pixel's channels and
+ * vmull_u8 / vshrn do the (chroma * intensity) >> 8 in one widening
+ * multiply.  The chroma gather stays four scalar loads from the 1 KB
+ * table: a 256-entry byte lookup is four vqtbl4 on AArch64 only, and
+ * nothing at all on ARMv7.
+ */
+
+/* Store four pixels, doubled when TOM's pwidth_scale is 2. */
+static SIMD_INLINE
+void line_simd_neon_store4(uint32_t *dst, uint32x4_t px, unsigned scale)
+{
+   if (scale == 2)
+   {
+      uint32x4x2_t d = vzipq_u32(px, px);
+      vst1q_u32(dst,     d.val[0]);
+      vst1q_u32(dst + 4, d.val[1]);
+   }
+   else
+      vst1q_u32(dst, px);
+}
+
+/* Four big-endian 16-bit pixels, zero-extended into 32-bit lanes. */
+static SIMD_INLINE
+uint32x4_t line_simd_neon_load16x4(const uint8_t *src)
+{
+   return vmovl_u16(vreinterpret_u16_u8(vrev16_u8(vld1_u8(src))));
+}
+
+/* RRRR RBBB BBGG GGGG -> FF RRRRR000 GGGGGG00 BBBBB000 */
+static SIMD_INLINE
+uint32x4_t line_simd_neon_rgb4(uint32x4_t p)
+{
+   uint32x4_t r = vshlq_n_u32(vandq_u32(p, vdupq_n_u32(0xF800)), 8);
+   uint32x4_t g = vshlq_n_u32(vandq_u32(p, vdupq_n_u32(0x003F)), 10);
+   uint32x4_t b = vshrq_n_u32(vandq_u32(p, vdupq_n_u32(0x07C0)), 3);
+   return vorrq_u32(vorrq_u32(r, g), vorrq_u32(b, vdupq_n_u32(0xFF000000)));
+}
+
+/* Four CRY pixels: (chroma byte * intensity) >> 8 per channel. */
+static SIMD_INLINE
+uint32x4_t line_simd_neon_cry4(const uint8_t *src, const uint32_t *chroma)
+{
+   /* Bytes 1, 3, 5, 7 are the intensities; each fills its pixel's four
+    * byte lanes (the alpha lane multiplies a zero chroma byte). */
+   uint8x8_t  raw = vld1_u8(src);
+   uint8x8_t  y01 = vtbl1_u8(raw, vcreate_u8(0x0303030301010101ULL));
+   uint8x8_t  y23 = vtbl1_u8(raw, vcreate_u8(0x0707070705050505ULL));
+   uint32x4_t c   = vdupq_n_u32(chroma[src[0]]);
+   uint8x16_t cb;
+   uint8x8_t  lo, hi;
+
+   c  = vsetq_lane_u32(chroma[src[2]], c, 1);
+   c  = vsetq_lane_u32(chroma[src[4]], c, 2);
+   c  = vsetq_lane_u32(chroma[src[6]], c, 3);
+   cb = vreinterpretq_u8_u32(c);
+   lo = vshrn_n_u16(vmull_u8(vget_low_u8(cb),  y01), 8);
+   hi = vshrn_n_u16(vmull_u8(vget_high_u8(cb), y23), 8);
+   return vorrq_u32(vreinterpretq_u32_u8(vcombine_u8(lo, hi)),
+                    vdupq_n_u32(0xFF000000));
+}
+
+static SIMD_INLINE
+void line_simd_cry16(uint32_t *dst, const uint8_t *src, unsigned count,
+                     unsigned scale, const line_simd_luts *luts)
+{
+   if (scale <= 2)
+   {
+      for (; count >= 4; count -= 4, src += 8, dst += 4 * scale)
+         line_simd_neon_store4(dst, line_simd_neon_cry4(src, luts->chroma), scale);
+   }
+   line_simd_lut16(dst, src, count, scale, luts->cry);
+}
+
+static SIMD_INLINE
+void line_simd_rgb24(uint32_t *dst, const uint8_t *src, unsigned count,
+                     unsigned scale, const line_simd_luts *luts)
+{
+   (void)luts;
+   if (scale <= 2)
+   {
+      for (; count >= 4; count -= 4, src += 16, dst += 4 * scale)
+      {
+         /* G R x B in memory -> FF R G B */
+         uint32x4_t v  = vreinterpretq_u32_u8(vld1q_u8(src));
+         uint32x4_t rg = vandq_u32(vshlq_n_u32(v, 8), vdupq_n_u32(0x00FFFF00));
+         uint32x4_t px = vorrq_u32(vorrq_u32(rg, vshrq_n_u32(v, 24)),
+                                   vdupq_n_u32(0xFF000000));
+         line_simd_neon_store4(dst, px, scale);
+      }
+   }
+   line_simd_tail24(dst, src, count, scale);
+}
+
+static SIMD_INLINE
+void line_simd_rgb16(uint32_t *dst, const uint8_t *src, unsigned count,
+                     unsigned scale, const line_simd_luts *luts)
+{
+   if (scale <= 2)
+   {
+      for (; count >= 4; count -= 4, src += 8, dst += 4 * scale)
+         line_simd_neon_store4(dst, line_simd_neon_rgb4(line_simd_neon_load16x4(src)),
+                               scale);
+   }
+   line_simd_lut16(dst, src, count, scale, luts->rgb);
+}
+
+static SIMD_INLINE
+void line_simd_mix16(uint32_t *dst, const uint8_t *src, unsigned count,
+                     unsigned scale, const line_simd_luts *luts)
+{
+   if (scale <= 2)
+   {
+      for (; count >= 4; count -= 4, src += 8, dst += 4 * scale)
+      {
+         uint32x4_t p    = line_simd_neon_load16x4(src);
+         uint32x4_t mask = vtstq_u32(p, vdupq_n_u32(1));
+         line_simd_neon_store4(dst, vbslq_u32(mask, line_simd_neon_rgb4(p),
+                                              line_simd_neon_cry4(src, luts->chroma)),
+                               scale);
+      }
+   }
+   line_simd_lut16(dst, src, count, scale, luts->mix);
+}
+
+#endif /* LINE_SIMD_NEON_H */
@@ -0,0 +1,47 @@
+#ifndef LINE_SIMD_SCALAR_H
+#define LINE_SIMD_SCALAR_H
+
+/* Included by line_simd.h once the arch has been selected.
+ * Do not include directly. */
+#ifndef LINE_SIMD_H
+#error "include line_simd.h, not line_simd_scalar.h"
+#endif
+
+/*
+ * Scanline converters -- portable scalar implementation
+ *
+ * The loops tom.c's renderers used to run inline: one lookup-table
+ * load per 16-bit pixel.  Also the reference test/test_line_simd.c
+ * compares the SIMD variants against.
+ */
+
+static SIMD_INLINE
+void line_simd_cry16(uint32_t *dst, const uint8_t *src, unsigned count,
+                     unsigned scale, const line_simd_luts *luts)
+{
+   line_simd_lut16(dst, src, count, scale, luts->cry);
+}
+
+static SIMD_INLINE
+void line_simd_rgb24(uint32_t *dst, const uint8_t *src, unsigned count,
+                     unsigned scale, const line_simd_luts *luts)
+{
+   (void)luts;
+   line_simd_tail24(dst, src, count, scale);
+}
+
+static SIMD_INLINE
+void line_simd_rgb16(uint32_t *dst, const uint8_t *src, unsigned count,
+                     unsigned scale, const line_simd_luts *luts)
+{
+   line_simd_lut16(dst, src, count, scale, luts->rgb);
+}
+
+static SIMD_INLINE
+void line_simd_mix16(uint32_t *dst, const uint8_t *src, unsigned count,
+                     unsigned scale, const line_simd_luts *luts)
+{
+   line_simd_lut16(dst, src, count, scale, luts->mix);
+}
+
+#endif /* LINE_SIMD_SCALAR_H */
@@ -0,0 +1,149 @@
+#ifndef LINE_SIMD_SSE2_H
+#define LINE_SIMD_SSE2_H
+
+/* Included by line_simd.h once the arch has been selected.
+ * Do not include directly. */
+#ifndef LINE_SIMD_H
+#error "include line_simd.h, not line_simd_sse2.h"
+#endif
+
+#include <emmintrin.h>  /* SSE2 */
+
+/*
+ * Scanline converters -- x86/x64 SSE2 implementation
+ *
+ * Four pixels per step.  SSE2 has no byte shuffle, so the big-endian
+ * swap is a pair of 16-bit shifts, and the CRY chroma gather is four
+ * scalar loads from the 1 KB chroma table -- the 8x8 -> 16-bit
+ * multiply that follows is what the vector unit is for.
+ */
+
+#define LINE_SIMD_SSE2_ALPHA _mm_set1_epi32((int)0xFF000000u)
+
+/* Store four pixels, doubled when TOM's pwidth_scale is 2. */
+static SIMD_INLINE
+void line_simd_sse2_store4(uint32_t *dst, __m128i px, unsigned scale)
+{
+   if (scale == 2)
+   {
+      _mm_storeu_si128((__m128i *)dst,       _mm_unpacklo_epi32(px, px));
+      _mm_storeu_si128((__m128i *)(dst + 4), _mm_unpackhi_epi32(px, px));
+   }
+   else
+      _mm_storeu_si128((__m128i *)dst, px);
+}
+
+/* Four big-endian 16-bit pixels, zero-extended into 32-bit lanes. */
+static SIMD_INLINE
+__m128i line_simd_sse2_load16x4(const uint8_t *src)
+{
+   __m128i raw = _mm_loadl_epi64((const __m128i *)src);
+   __m128i sw  = _mm_or_si128(_mm_slli_epi16(raw, 8), _mm_srli_epi16(raw, 8));
+   return _mm_unpacklo_epi16(sw, _mm_setzero_si128());
+}
+
+/* RRRR RBBB BBGG GGGG -> FF RRRRR000 GGGGGG00 BBBBB000 */
+static SIMD_INLINE
+__m128i line_simd_sse2_rgb4(__m128i p)
+{
+   __m128i r = _mm_slli_epi32(_mm_and_si128(p, _mm_set1_epi32(0xF800)), 8);
+   __m128i g = _mm_slli_epi32(_mm_and_si128(p, _mm_set1_epi32(0x003F)), 10);
+   __m128i b = _mm_srli_epi32(_mm_and_si128(p, _mm_set1_epi32(0x07C0)), 3);
+   return _mm_or_si128(_mm_or_si128(r, g), _mm_or_si128(b, LINE_SIMD_SSE2_ALPHA));
+}
+
+/* Four CRY pixels: (chroma byte * intensity) >> 8 per channel. */
+static SIMD_INLINE
+__m128i line_simd_sse2_cry4(const uint8_t *src, const uint32_t *chroma)
+{
+   const __m128i zero = _mm_setzero_si128();
+   /* In memory each pixel is {cyan:red, intensity}, so as a
+    * little-endian word the intensity is the high byte. */
+   __m128i raw = _mm_loadl_epi64((const __m128i *)src);
+   __m128i y   = _mm_srli_epi16(raw, 8);
+   __m128i yy  = _mm_unpacklo_epi16(y, y);          /* y0 y0 y1 y1 ... */
+   __m128i c   = _mm_set_epi32((int)chroma[src[6]], (int)chroma[src[4]],
+                               (int)chroma[src[2]], (int)chroma[src[0]]);
+   __m128i lo  = _mm_mullo_epi16(_mm_unpacklo_epi8(c, zero),
+                                 _mm_unpacklo_epi32(yy, yy));
+   __m128i hi  = _mm_mullo_epi16(_mm_unpackhi_epi8(c, zero),
+                                 _mm_unpackhi_epi32(yy, yy));
+   __m128i px  = _mm_packus_epi16(_mm_srli_epi16(lo, 8), _mm_srli_epi16(hi, 8));
+   return _mm_or_si128(px, LINE_SIMD_SSE2_ALPHA);
+}
+
+static SIMD_INLINE
+void line_simd_cry16(uint32_t *dst, const uint8_t *src, unsigned count,
+                     unsigned scale, const line_simd_luts *luts)
+{
+   if (scale <= 2)
+   {
+      for (; count >= 4; count -= 4, src += 8, dst += 4 * scale)
+         line_simd_sse2_store4(dst, line_simd_sse2_cry4(src, luts->chroma), scale);
+   }
+   line_simd_lut16(dst, src, count, scale, luts->cry);
+}
+
+static SIMD_INLINE
+void line_simd_rgb24(uint32_t *dst, const uint8_t *src, unsigned count,
+                     unsigned scale, const line_simd_luts *luts)
+{
+   (void)luts;
+   if (scale <= 2)
+   {
+      for (; count >= 4; count -= 4, src += 16, dst += 4 * scale)
+      {
+         /* G R x B in memory -> FF R G B */
+         __m128i v  = _mm_loadu_si128((const __m128i *)src);
+         __m128i rg = _mm_and_si128(_mm_slli_epi32(v, 8), _mm_set1_epi32(0x00FFFF00));
+         __m128i px = _mm_or_si128(_mm_or_si128(rg, _mm_srli_epi32(v, 24)),
+                                   LINE_SIMD_SSE2_ALPHA);
+         line_simd_sse2_store4(dst, px, scale);
+      }
+   }
+   line_simd_tail24(dst, src, count, scale);
+}
+
+static SIMD_INLINE
+void line_simd_rgb16(uint32_t *dst, const uint8_t *src, unsigned count,
+                     unsigned scale, const line_simd_luts *luts)
+{
+   if (scale <= 2)
+   {
+      for (; count >= 4; count -= 4, src += 8, dst += 4 * scale)
+         line_simd_sse2_store4(dst, line_simd_sse2_rgb4(line_simd_sse2_load16x4(src)),
+                               scale);
+   }
+   line_simd_lut16(dst, src, count, scale, luts->rgb);
+}
+
+static SIMD_INLINE
+void line_simd_mix16(uint32_t *dst, const uint8_t *src, unsigned count,
+                     unsigned scale, const line_simd_luts *luts)
+{
+   if (scale <= 2)
+   {
+      const __m128i one = _mm_set1_epi32(1);
+      for (; count >= 4; count -= 4, src += 8, dst += 4 * scale)
+      {
+         /* Decode only the kind present; a group that mixes both goes
+          * through the table rather than paying for two decodes. */
+         __m128i p    = line_simd_sse2_load16x4(src);
+         __m128i mask = _mm_cmpeq_epi32(_mm_and_si128(p, one), one);
+         int     rgb  = _mm_movemask_ps(_mm_castsi128_ps(mask));
+         if (rgb == 0xF)
+            line_simd_sse2_store4(dst, line_simd_sse2_rgb4(p), scale);
+         else if (rgb == 0)
+            line_simd_sse2_store4(dst, line_simd_sse2_cry4(src, luts->chroma), scale);
+         else
+            line_simd_sse2_store4(dst, _mm_set_epi32(
+               (int)luts->mix[((uint32_t)src[6] << 8) | src[7]],
+               (int)luts->mix[((uint32_t)src[4] << 8) | src[5]],
+               (int)luts->mix[((uint32_t)src[2] << 8) | src[3]],
+               (int)luts->mix[((uint32_t)src[0] << 8) | src[1]]), scale);
+      }
+   }
+   line_simd_lut16(dst, src, count, scale, luts->mix);
+}
+
+#endif /* LINE_SIMD_SSE2_H */
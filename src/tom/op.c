@@ -21,9 +21,12 @@
 #include "gpu.h"
 #include "jaguar.h"
 #include "m68000/m68kinterface.h"
+#include "op_simd.h"
 #include "shadowfb.h"
 #include "vjag_memory.h"
 #include "tom.h"
+#include "../core/perf_counters.h"
+#include "../core/state_delta.h"
 #include "../core/vjtrace.h"
 
 #define BLEND_Y(dst, src)	op_blend_y[(((uint16_t)dst<<8)) | ((uint16_t)(src))]
@@ -50,12 +53,29 @@
 #define OP_GPU_RELEASE_GUARD_CYCLES   4000
 #define OP_GPU_RELEASE_STEP_CYCLES    16
 
+/* Object-list index: direct-mapped by phrase address. */
+#define OP_INDEX_BITS   10
+#define OP_INDEX_SIZE   (1u << OP_INDEX_BITS)
+
+/* Portable always-inline, spelled like blitter.c's BLITTER_ALWAYS_INLINE
+ * so call sites use `static OP_ALWAYS_INLINE ...`.  Forces the bitmap
+ * kernels and their helpers into each specialised instance so depth and
+ * flags fold to constants there. */
+#if defined(_MSC_VER)
+#  define OP_ALWAYS_INLINE __forceinline
+#elif defined(__GNUC__) || defined(__clang__)
+#  define OP_ALWAYS_INLINE inline __attribute__((always_inline))
+#else
+#  define OP_ALWAYS_INLINE inline
+#endif
+
 // Private function prototypes
 
 void OPProcessFixedBitmap(uint64_t p0, uint64_t p1, bool render);
 void OPProcessScaledBitmap(uint64_t p0, uint64_t p1, uint64_t p2, bool render);
 void OPDiscoverObjects(uint32_t address);
 uint64_t OPLoadPhrase(uint32_t offset);
+static void OPIndexFlush(void);
 
 // Local global variables
 
@@ -71,8 +91,66 @@ static uint32_t op_pointer;
 
 int32_t phraseWidthToPixels[8] = { 64, 32, 16, 8, 4, 2, 0, 0 };
 
-
-static void OPAdvanceScaledSource(uint16_t *horizontalRemainder, uint16_t hscale,
+/* Object-list index.  OPProcessList walks the whole list from OLP on
+ * every halfline, and most of what it fetches is the first phrase of
+ * objects the ypos/height test rejects or of branches that resolve the
+ * same way every time.  The index remembers that phrase (type, ypos,
+ * height, link -- everything the walk decides on) by address for the
+ * rest of the field, so those objects are decided without a RAM read.
+ * Rendered objects still fetch their second and third phrases through
+ * the bus, and every write-back still goes to RAM exactly as before; the
+ * index just takes the new phrase along.
+ *
+ * It stays exact because every main-RAM writer marks stateDeltaWatch:
+ * at each list start and after each GPU object's inline run, a write
+ * into any page holding an indexed phrase drops the whole index.  The
+ * OP's own write-backs do not count as foreign writes.  Host-side pokes
+ * through retro_get_memory_data() only happen between frames, and the
+ * index is dropped at every field start, so they are seen too.
+ *
+ * A hit charges the bus arbiter the two OP clocks the fetch would have,
+ * and only phrases whose read would take the side-effect-free page-map
+ * path are served (no trace watch or blit memo in the way), so timing
+ * and traces are unchanged.  Host-side only: nothing goes in a state. */
+typedef struct
+{
+   uint64_t p0;
+   uint32_t addr;
+   uint32_t gen;
+} op_index_entry_t;
+
+static op_index_entry_t opIndex[OP_INDEX_SIZE];
+static uint32_t opIndexGen = 1;
+static uint32_t opIndexPages[STATE_DELTA_PAGES / 32];
+static int opIndexLastHalfline = -1;
+static bool opIndexEnabled = true;
+static uint64_t opIndexHits = 0;
+static uint64_t opIndexMisses = 0;
+
+PERF_COUNTER(op_index_hits);
+PERF_COUNTER(op_index_misses);
+PERF_COUNTER(op_index_flushes);
+
+/* Bitmap kernels.  OPProcessFixedBitmap and OPProcessScaledBitmap are
+ * each one loop body (op_fixed_bitmap / op_scaled_bitmap) that tests
+ * depth and the RMW/TRANS flags per pixel.  Every (depth, RMW, TRANS)
+ * combination gets its own copy of that body with them as constants
+ * (OP_KERNELS below), so each copy is only the per-pixel work its
+ * objects need.  REFLECT stays a runtime value: it only picks the sign
+ * of the line-buffer step.  The unreflected, non-RMW 16bpp and 8bpp
+ * fixed copies also write whole runs through the op_simd.h spans when
+ * the pixel data is behind a side-effect-free page (op_fixed_span).
+ * Off runs everything through the generic call, which stays the
+ * reference.  Host-side only: nothing here is emulated state. */
+static bool opKernels = true;
+static uint64_t opKernelHits = 0;
+static uint64_t opKernelMisses = 0;
+
+PERF_COUNTER(op_kernel_hits);
+PERF_COUNTER(op_kernel_spans);
+
+
+static OP_ALWAYS_INLINE void OPAdvanceScaledSource(uint16_t *horizontalRemainder, uint16_t hscale,
       int bitsPerPixel, int *pixCount, uint64_t *pixels)
 {
    *horizontalRemainder += 0x20;
@@ -86,7 +164,7 @@ static void OPAdvanceScaledSource(uint16_t *horizontalRemainder, uint16_t hscale
 }
 
 
-static void OPSkipScaledDestinationPixels(uint32_t destPixels, uint16_t hscale,
+static OP_ALWAYS_INLINE void OPSkipScaledDestinationPixels(uint32_t destPixels, uint16_t hscale,
       int bitsPerPixel, int phrasePixels, uint32_t pitchBytes, uint32_t *data,
       uint32_t *iwidth, uint16_t *horizontalRemainder, int *pixCount,
       uint64_t *pixels)
@@ -143,27 +221,24 @@ static void OPSkipScaledDestinationPixels(uint32_t destPixels, uint16_t hscale,
  * read side effect (CD/TOM/JERRY register space -- object pixel data is
  * never legitimately there on real hardware, but bail rather than
  * assume). */
-static uint16_t op_hires_scale_peek(uint32_t data, int pixCount,
+static OP_ALWAYS_INLINE uint16_t op_hires_scale_peek(uint32_t data, int pixCount,
       uint16_t horizontalRemainder, uint16_t hscale, uint32_t pitchBytes,
       int phrasePixels, uint32_t iwidthRemaining, uint16_t stockValue16)
 {
    uint16_t rem;
    int count;
-   int steps;
    uint32_t phrasesNeeded;
    uint32_t addr;
 
    rem = (uint16_t)(horizontalRemainder + (0x20 / SHADOWFB_HIRES_MAX_N));
    count = pixCount;
-   steps = 0;
 
-   while (rem >= hscale)
+   // The sub-step walk in one division: rem / hscale source pixels.
+   if (rem >= hscale)
    {
-      rem -= hscale;
-      count++;
-
-      if (++steps > 64)			// pathological hscale: bail, don't spin
+      if (hscale == 0 || rem / hscale > 64)	// pathological hscale: bail
          return stockValue16;
+      count += rem / hscale;
    }
 
    phrasesNeeded = (uint32_t)count / (uint32_t)phrasePixels;
@@ -198,13 +273,12 @@ static uint16_t op_hires_scale_peek(uint32_t data, int pixCount,
  * 2bpp and 4bpp together are 0.5% of Val d'Isere's scaled CLUT pixels and
  * 1bpp never occurs, so the remaining depths are deliberately left unwired
  * rather than carrying untested bit-extraction paths. */
-static int op_hires_scale_peek_clut(uint32_t data, int pixCount,
+static OP_ALWAYS_INLINE int op_hires_scale_peek_clut(uint32_t data, int pixCount,
       uint16_t horizontalRemainder, uint16_t hscale, uint32_t pitchBytes,
       int bpp, uint32_t iwidthRemaining, int stockIndex)
 {
    uint16_t rem;
    int count;
-   int steps;
    int pixelsPerPhrase;
    int bitOff;
    int shift;
@@ -214,15 +288,13 @@ static int op_hires_scale_peek_clut(uint32_t data, int pixCount,
 
    rem = (uint16_t)(horizontalRemainder + (0x20 / SHADOWFB_HIRES_MAX_N));
    count = pixCount;
-   steps = 0;
 
-   while (rem >= hscale)
+   /* The sub-step walk in one division, as in op_hires_scale_peek. */
+   if (rem >= hscale)
    {
-      rem -= hscale;
-      count++;
-
-      if (++steps > 64)			/* pathological hscale: bail, don't spin */
+      if (hscale == 0 || rem / hscale > 64)	/* pathological hscale: bail */
          return stockIndex;
+      count += rem / hscale;
    }
 
    pixelsPerPhrase = 64 / bpp;
@@ -297,6 +369,8 @@ void OPInit(void)
 //
 void OPReset(void)
 {
+   OPIndexFlush();
+   opIndexLastHalfline = -1;
 }
 
 
@@ -470,6 +544,114 @@ void OPStorePhrase(uint32_t offset, uint64_t p)
    JaguarWriteLong(offset + 4, p & 0xFFFFFFFF, OP);
 }
 
+
+static void OPIndexFlush(void)
+{
+   if (++opIndexGen == 0)
+   {
+      memset(opIndex, 0, sizeof(opIndex));
+      opIndexGen = 1;
+   }
+   memset(opIndexPages, 0, sizeof(opIndexPages));
+}
+
+
+// Drop the index if anything wrote into one of its pages since the last look
+static void OPIndexSync(void)
+{
+   uint32_t hit = 0;
+   unsigned w;
+
+   for (w = 0; w < STATE_DELTA_PAGES / 32; w++)
+      hit |= stateDeltaWatch[w] & opIndexPages[w];
+
+   if (hit)
+   {
+      PERF_INC(op_index_flushes);
+      OPIndexFlush();
+   }
+   memset(stateDeltaWatch, 0, sizeof(stateDeltaWatch));
+}
+
+
+// OPLoadPhrase through the index
+static uint64_t OPIndexLoad(uint32_t offset)
+{
+   op_index_entry_t *e;
+   uint32_t page;
+
+   offset &= ~0x07;
+   if (!opIndexEnabled || offset >= 0x200000
+         || !jaguarReadPage[offset >> JAG_PAGE_SHIFT])
+      return OPLoadPhrase(offset);
+
+   e = &opIndex[(offset >> 3) & (OP_INDEX_SIZE - 1)];
+   if (e->gen == opIndexGen && e->addr == offset)
+   {
+      // The two longs OPLoadPhrase would have fetched
+      if (busArbiter.enabled)
+         bus_arbiter_op_charge(2);
+      opIndexHits++;
+      PERF_INC(op_index_hits);
+      return e->p0;
+   }
+
+   opIndexMisses++;
+   PERF_INC(op_index_misses);
+   e->p0   = OPLoadPhrase(offset);
+   e->addr = offset;
+   e->gen  = opIndexGen;
+   page = offset >> STATE_DELTA_PAGE_SHIFT;
+   opIndexPages[page >> 5] |= 1u << (page & 31);
+   return e->p0;
+}
+
+
+// OPStorePhrase that keeps the index current instead of invalidating it
+static void OPIndexStore(uint32_t offset, uint64_t p)
+{
+   op_index_entry_t *e;
+   uint32_t page, bit, seen;
+
+   offset &= ~0x07;
+   if (!opIndexEnabled || offset >= 0x200000)
+   {
+      OPStorePhrase(offset, p);
+      return;
+   }
+
+   page = offset >> STATE_DELTA_PAGE_SHIFT;
+   bit  = 1u << (page & 31);
+   seen = stateDeltaWatch[page >> 5] & bit;
+   OPStorePhrase(offset, p);
+   if (!seen)
+      stateDeltaWatch[page >> 5] &= ~bit;
+
+   e = &opIndex[(offset >> 3) & (OP_INDEX_SIZE - 1)];
+   if (e->gen == opIndexGen && e->addr == offset)
+      e->p0 = p;
+}
+
+
+void OPSetListIndex(bool enabled)
+{
+   if (enabled != opIndexEnabled)
+   {
+      opIndexEnabled = enabled;
+      OPIndexFlush();
+      opIndexLastHalfline = -1;
+   }
+}
+
+
+void OPListIndexStats(uint64_t *hits, uint64_t *misses)
+{
+   if (hits)
+      *hits = opIndexHits;
+   if (misses)
+      *misses = opIndexMisses;
+}
+
 //
 // Object Processor main routine
 //
@@ -488,6 +670,15 @@ void OPProcessList(int halfline, bool render)
    //       pixels wide...
    halfline &= 0x7FF;
 
+   if (opIndexEnabled)
+   {
+      // A new field (or a repeat of this halfline) starts from RAM
+      if (halfline <= opIndexLastHalfline)
+         OPIndexFlush();
+      opIndexLastHalfline = halfline;
+      OPIndexSync();
+   }
+
    op_pointer = OPGetListPointer();
    VJT_EMIT(VJT_EV_OP_LIST_START, OP, op_pointer, (uint32_t)halfline);
 
@@ -501,7 +692,7 @@ void OPProcessList(int halfline, bool render)
       inhibit     = false;
       // *** END OP PROCESSOR TESTING ONLY ***
 
-      p0          = OPLoadPhrase(op_pointer);
+      p0          = OPIndexLoad(op_pointer);
       op_pointer += 8;
 
       VJT_EMIT(VJT_EV_OP_OBJECT, OP, op_pointer - 8, (uint32_t)((uint8_t)p0 & 0x07));
@@ -554,7 +745,7 @@ void OPProcessList(int halfline, bool render)
                      p0 &= ~0xFFFFF80000FFC000LL;		// Mask out old data...
                      p0 |= (uint64_t)height << 14;
                      p0 |= data << 40;
-                     OPStorePhrase(oldOPP, p0);
+                     OPIndexStore(oldOPP, p0);
                   }
 
                // OP bottom 3 bits are hardwired to zero. The link address reflects
@@ -629,14 +820,14 @@ void OPProcessList(int halfline, bool render)
                         p0 &= ~0xFFFFF80000FFC000LL;	// Mask out old data...
                         p0 |= (uint64_t)height << 14;
                         p0 |= data << 40;
-                        OPStorePhrase(oldOPP, p0);
+                        OPIndexStore(oldOPP, p0);
                      }
 
                      remainder -= 0x20;					// 1.0f in [3.5] fixed point format
 
                      p2 &= ~0x0000000000FF0000LL;
                      p2 |= (uint64_t)remainder << 16;
-                     OPStorePhrase(oldOPP + 16, p2);
+                     OPIndexStore(oldOPP + 16, p2);
                   }
 
                // OP bottom 3 bits are hardwired to zero. The link address reflects
@@ -695,6 +886,10 @@ void OPProcessList(int halfline, bool render)
                    * the GPU still sees this object in OB. */
                   return;
                }
+
+               // The ISR may have rewritten the list
+               if (opIndexEnabled)
+                  OPIndexSync();
                break;
             }
          case OBJECT_TYPE_BRANCH:
@@ -776,8 +971,105 @@ void OPProcessList(int halfline, bool render)
 }
 
 
-// Store fixed size bitmap in line buffer
-void OPProcessFixedBitmap(uint64_t p0, uint64_t p1, bool render)
+/* Span path of the fixed-bitmap kernels: unreflected, non-RMW 8bpp
+ * and 16bpp objects whose every phrase fetch -- including the one 8bpp
+ * makes past its last drawn phrase -- lands in one page the bus would
+ * read without side effects.  Writes the same pixels the per-pixel loop
+ * would from the host copy through the op_simd.h spans, charges the bus
+ * arbiter the same two clocks per phrase, and makes the same shadow
+ * resolves.  Returns false, having done nothing, when the loop has to
+ * run instead. */
+static OP_ALWAYS_INLINE bool op_fixed_span(uint8_t *lbuf, uint8_t *tomRam8,
+      uint32_t data, uint32_t iwidth, uint32_t pitch, uint32_t firstPix,
+      uint8_t depth, bool flagTRANS)
+{
+   const uint8_t *palette = &tomRam8[0x400];
+   uint32_t phrasePixels = (depth == 3 ? 8 : 4);
+   uint32_t pixelBytes = (depth == 3 ? 1 : 2);
+   uint32_t reads = (depth == 3 ? iwidth + 1 : iwidth);
+   uint32_t skip = (firstPix & 0x30) >> (depth == 3 ? 3 : 4);
+   uint32_t last, k, i;
+   const uint8_t *page;
+   const uint8_t *src;
+   uint8_t *dst;
+   int idx;
+
+   if (iwidth == 0 || iwidth > 0x3FF)
+      return false;
+
+   last = data + (reads - 1) * pitch + 7;
+   if (last > 0xFFFFFF || (data >> JAG_PAGE_SHIFT) != (last >> JAG_PAGE_SHIFT))
+      return false;
+
+   page = jaguarReadPage[data >> JAG_PAGE_SHIFT];
+   if (!page)
+      return false;
+   src = page + (data & JAG_PAGE_MASK);
+
+   if (busArbiter.enabled)
+      bus_arbiter_op_charge(2 * reads);
+   PERF_INC(op_kernel_spans);
+
+   // Pitch 1 is one run; any other pitch is one run per phrase.
+   dst = lbuf;
+   for (k = 0; k < iwidth; k++)
+   {
+      uint32_t count = (pitch == 8 ? iwidth * phrasePixels : phrasePixels) - skip;
+      const uint8_t *run = src + k * pitch + skip * pixelBytes;
+
+      if (depth == 3)
+      {
+         if (flagTRANS)
+            op_clut8_trans(dst, run, count, palette);
+         else
+            op_clut8(dst, run, count, palette);
+      }
+      else
+      {
+         if (flagTRANS)
+            op_span16_trans(dst, run, count, palette);
+         else
+            op_span16(dst, run, count, palette);
+      }
+
+      dst += count * 2;
+      skip = 0;
+      if (pitch == 8)
+         break;
+   }
+
+   if (depth != 4 || !(shadowFBActive || shadowHiresActive))
+      return true;
+
+   // The per-pixel loop's shadow resolves, in the same order.
+   skip = (firstPix & 0x30) >> 4;
+   idx = (int)((lbuf - &tomRam8[0x1800]) >> 1);
+   for (k = 0; k < iwidth; k++)
+   {
+      for (i = skip; i < 4; i++, idx++)
+      {
+         uint32_t offset = k * pitch + (i << 1);
+         uint16_t value16 = (uint16_t)(((uint16_t)src[offset] << 8) | src[offset + 1]);
+
+         if (flagTRANS && value16 == 0)
+            continue;
+         if (shadowFBActive)
+            ShadowFBLineFromRAM(idx, data + offset, value16);
+         if (shadowHiresActive)
+            ShadowHiresLineFromRAM(idx, data + offset, value16);
+      }
+      skip = 0;
+   }
+
+   return true;
+}
+
+
+/* Fixed-bitmap kernel.  depth and the RMW/TRANS bits of kflags are
+ * constants in the OP_KERNELS instances and the object's own values in
+ * the generic call; spans (instances only) allows op_fixed_span. */
+static OP_ALWAYS_INLINE void op_fixed_bitmap(uint64_t p0, uint64_t p1,
+      uint8_t depth, uint8_t kflags, bool spans)
 {
    uint32_t lbufAddress;
    uint8_t * currentLineBuffer;
@@ -788,7 +1080,6 @@ void OPProcessFixedBitmap(uint64_t p0, uint64_t p1, bool render)
    uint32_t clippedWidth = 0, phraseClippedWidth = 0, dataClippedWidth = 0;//, phrasePixel = 0;
    // Need to make sure that when writing that it stays within the line buffer...
    // LBUF ($F01800 - $F01D9E) 360 x 32-bit RAM
-   uint8_t depth = (p1 >> 12) & 0x07;				// Color depth of image
    int32_t xpos = ((int16_t)((p1 << 4) & 0xFFFF)) >> 4;// Image xpos in LBUF
    uint32_t iwidth = (p1 >> 28) & 0x3FF;				// Image width in *phrases*
    uint32_t data = (p0 >> 40) & 0xFFFFF8;			// Pixel data address
@@ -798,8 +1089,8 @@ void OPProcessFixedBitmap(uint64_t p0, uint64_t p1, bool render)
    //Optimize: break these out to their own BOOL values
    uint8_t flags = (p1 >> 45) & 0x07;				// REFLECT (0), RMW (1), TRANS (2)
    bool flagREFLECT = ((flags & OPFLAG_REFLECT) ? true : false),
-        flagRMW = ((flags & OPFLAG_RMW) ? true : false),
-        flagTRANS = ((flags & OPFLAG_TRANS) ? true : false);
+        flagRMW = ((kflags & OPFLAG_RMW) ? true : false),
+        flagTRANS = ((kflags & OPFLAG_TRANS) ? true : false);
    // "For images with 1 to 4 bits/pixel the top 7 to 4 bits of the index
    //  provide the most significant bits of the palette address."
    uint8_t index = (p1 >> 37) & 0xFE;				// CLUT index offset (upper pix, 1-4 bpp)
@@ -822,9 +1113,6 @@ void OPProcessFixedBitmap(uint64_t p0, uint64_t p1, bool render)
    if (iwidth == 0)
       iwidth = 1;
 
-   if (!render)
-      return;
-
    startPos = xpos;
    endPos = xpos +
       (!flagREFLECT ? (phraseWidthToPixels[depth] * iwidth) - 1
@@ -908,6 +1196,11 @@ void OPProcessFixedBitmap(uint64_t p0, uint64_t p1, bool render)
    lbufAddress = 0x1800 + (startPos * 2);
    currentLineBuffer = &tomRam8[lbufAddress];
 
+   if (spans && !flagRMW && !flagREFLECT && (depth == 3 || depth == 4)
+         && op_fixed_span(currentLineBuffer, tomRam8, data, iwidth, pitch,
+            firstPix, depth, flagTRANS))
+      return;
+
    // Render.
 
    // Hmm. We check above for 24 BPP mode, but don't do anything about it below...
@@ -1237,8 +1530,57 @@ void OPProcessFixedBitmap(uint64_t p0, uint64_t p1, bool render)
    }
 }
 
-// Store scaled bitmap in line buffer
-void OPProcessScaledBitmap(uint64_t p0, uint64_t p1, uint64_t p2, bool render)
+/* One instance per depth (1/2/4/8/16/24 bpp) and RMW/TRANS pair; the
+ * tables are indexed [depth][(flags >> 1) & 3]. */
+#define OP_KERNELS(X) X(0) X(1) X(2) X(3) X(4) X(5)
+
+typedef void (*op_fixed_fn)(uint64_t p0, uint64_t p1);
+typedef void (*op_scaled_fn)(uint64_t p0, uint64_t p1, uint64_t p2);
+
+#define OP_FIXED_DEFINE(d) \
+   static void op_fixed_##d##_0(uint64_t p0, uint64_t p1) \
+   { op_fixed_bitmap(p0, p1, d, 0, true); } \
+   static void op_fixed_##d##_R(uint64_t p0, uint64_t p1) \
+   { op_fixed_bitmap(p0, p1, d, OPFLAG_RMW, true); } \
+   static void op_fixed_##d##_T(uint64_t p0, uint64_t p1) \
+   { op_fixed_bitmap(p0, p1, d, OPFLAG_TRANS, true); } \
+   static void op_fixed_##d##_TR(uint64_t p0, uint64_t p1) \
+   { op_fixed_bitmap(p0, p1, d, OPFLAG_TRANS | OPFLAG_RMW, true); }
+
+#define OP_FIXED_ENTRY(d) \
+   { op_fixed_##d##_0, op_fixed_##d##_R, op_fixed_##d##_T, op_fixed_##d##_TR },
+
+OP_KERNELS(OP_FIXED_DEFINE)
+
+static const op_fixed_fn opFixedKernels[6][4] = { OP_KERNELS(OP_FIXED_ENTRY) };
+
+// Store fixed size bitmap in line buffer
+void OPProcessFixedBitmap(uint64_t p0, uint64_t p1, bool render)
+{
+   uint8_t depth = (p1 >> 12) & 0x07;				// Color depth of image
+   uint8_t flags = (p1 >> 45) & 0x07;				// REFLECT (0), RMW (1), TRANS (2)
+
+   if (!render)
+      return;
+
+   if (opKernels)
+   {
+      if (depth < 6)
+      {
+         opKernelHits++;
+         PERF_INC(op_kernel_hits);
+         opFixedKernels[depth][(flags >> 1) & 3](p0, p1);
+         return;
+      }
+      opKernelMisses++;
+   }
+
+   op_fixed_bitmap(p0, p1, depth, flags, false);
+}
+
+/* Scaled-bitmap kernel; depth and kflags as for op_fixed_bitmap. */
+static OP_ALWAYS_INLINE void op_scaled_bitmap(uint64_t p0, uint64_t p1,
+      uint64_t p2, uint8_t depth, uint8_t kflags)
 {
    uint32_t lbufAddress;
    uint8_t * currentLineBuffer;
@@ -1254,7 +1596,6 @@ void OPProcessScaledBitmap(uint64_t p0, uint64_t p1, uint64_t p2, bool render)
    int32_t lbufWidth = 719;	// Zero based limit...
    // Need to make sure that when writing that it stays within the line buffer...
    // LBUF ($F01800 - $F01D9E) 360 x 32-bit RAM
-   uint8_t depth = (p1 >> 12) & 0x07;				// Color depth of image
    int32_t xpos = ((int16_t)((p1 << 4) & 0xFFFF)) >> 4;// Image xpos in LBUF
    uint32_t iwidth = (p1 >> 28) & 0x3FF;				// Image width in *phrases*
    uint32_t data = (p0 >> 40) & 0xFFFFF8;			// Pixel data address
@@ -1263,8 +1604,8 @@ void OPProcessScaledBitmap(uint64_t p0, uint64_t p1, uint64_t p2, bool render)
    //	uint8_t flags = (p1 >> 45) & 0x0F;	// REFLECT, RMW, TRANS, RELEASE
    uint8_t flags = (p1 >> 45) & 0x07;				// REFLECT (0), RMW (1), TRANS (2)
    bool flagREFLECT = ((flags & OPFLAG_REFLECT) ? true : false),
-        flagRMW = ((flags & OPFLAG_RMW) ? true : false),
-        flagTRANS = ((flags & OPFLAG_TRANS) ? true : false);
+        flagRMW = ((kflags & OPFLAG_RMW) ? true : false),
+        flagTRANS = ((kflags & OPFLAG_TRANS) ? true : false);
    uint8_t index = (p1 >> 37) & 0xFE;				// CLUT index offset (upper pix, 1-4 bpp)
    uint32_t pitch = (p1 >> 15) & 0x07;				// Phrase pitch
 
@@ -1285,7 +1626,7 @@ void OPProcessScaledBitmap(uint64_t p0, uint64_t p1, uint64_t p2, bool render)
    int32_t visibleEnd;
 
    // Looks like an hscale of zero means don't draw!
-   if (!render || hscale == 0)
+   if (hscale == 0)
       return;
 
    if (iwidth == 0)
@@ -1911,3 +2252,57 @@ void OPProcessScaledBitmap(uint64_t p0, uint64_t p1, uint64_t p2, bool render)
       }
    }
 }
+
+#define OP_SCALED_DEFINE(d) \
+   static void op_scaled_##d##_0(uint64_t p0, uint64_t p1, uint64_t p2) \
+   { op_scaled_bitmap(p0, p1, p2, d, 0); } \
+   static void op_scaled_##d##_R(uint64_t p0, uint64_t p1, uint64_t p2) \
+   { op_scaled_bitmap(p0, p1, p2, d, OPFLAG_RMW); } \
+   static void op_scaled_##d##_T(uint64_t p0, uint64_t p1, uint64_t p2) \
+   { op_scaled_bitmap(p0, p1, p2, d, OPFLAG_TRANS); } \
+   static void op_scaled_##d##_TR(uint64_t p0, uint64_t p1, uint64_t p2) \
+   { op_scaled_bitmap(p0, p1, p2, d, OPFLAG_TRANS | OPFLAG_RMW); }
+
+#define OP_SCALED_ENTRY(d) \
+   { op_scaled_##d##_0, op_scaled_##d##_R, op_scaled_##d##_T, op_scaled_##d##_TR },
+
+OP_KERNELS(OP_SCALED_DEFINE)
+
+static const op_scaled_fn opScaledKernels[6][4] = { OP_KERNELS(OP_SCALED_ENTRY) };
+
+// Store scaled bitmap in line buffer
+void OPProcessScaledBitmap(uint64_t p0, uint64_t p1, uint64_t p2, bool render)
+{
+   uint8_t depth = (p1 >> 12) & 0x07;				// Color depth of image
+   uint8_t flags = (p1 >> 45) & 0x07;				// REFLECT (0), RMW (1), TRANS (2)
+
+   if (!render)
+      return;
+
+   if (opKernels)
+   {
+      if (depth < 6)
+      {
+         opKernelHits++;
+         PERF_INC(op_kernel_hits);
+         opScaledKernels[depth][(flags >> 1) & 3](p0, p1, p2);
+         return;
+      }
+      opKernelMisses++;
+   }
+
+   op_scaled_bitmap(p0, p1, p2, depth, flags);
+}
+
+void OPSetBitmapKernels(bool enabled)
+{
+   opKernels = enabled;
+}
+
+void OPBitmapKernelStats(uint64_t *hits, uint64_t *misses)
+{
+   if (hits)
+      *hits = opKernelHits;
+   if (misses)
+      *misses = opKernelMisses;
+}
@@ -25,6 +25,16 @@ void OPSetStatusRegister(uint32_t data);
 uint32_t OPGetStatusRegister(void);
 void OPSetCurrentObject(uint64_t object);
 void OPNotifyOBFWrite(void);
+void OPSetListIndex(bool enabled);
+void OPListIndexStats(uint64_t *hits, uint64_t *misses);
+
+/* Bitmap kernels: every depth/RMW/TRANS combination of the fixed and
+ * scaled bitmap loops runs a specialised copy (on by default).  Off runs
+ * them through the generic loops, which stay the reference.  Stats count
+ * objects run by a copy (hits) and by the generic loop while enabled
+ * (misses). */
+void OPSetBitmapKernels(bool enabled);
+void OPBitmapKernelStats(uint64_t *hits, uint64_t *misses);
 
 #define OPFLAG_RELEASE		8					// Bus release bit
 #define OPFLAG_TRANS		4					// Transparency bit
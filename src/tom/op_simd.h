@@ -0,0 +1,85 @@
+/*
+ * SIMD span writers for the Object Processor's bitmap kernels
+ *
+ * Laid out like blitter_simd.h: the per-arch split of simd_arch.h,
+ * static inline functions in a header so op.c inlines them, and an
+ * out-of-line vtable built by src/core/simd_ops_<arch>.c so
+ * test/test_op_simd.c validates exactly the code the core runs.
+ *
+ * op.c uses these for the unreflected, non-RMW runs of 16bpp and 8bpp
+ * bitmaps whose pixel data sits behind a plain page-table entry.  A
+ * span is `count` consecutive source pixels written to `count`
+ * consecutive line-buffer words:
+ *
+ *   - span16:       each big-endian source word copied as-is.
+ *   - span16_trans: the same, but a zero word leaves the line buffer
+ *                   alone (TRANS).
+ *   - clut8:        each source byte indexes the 256-entry palette
+ *                   (TOM's CLUT, two bytes per entry, copied as-is).
+ *   - clut8_trans:  the same, but index 0 leaves the line buffer alone.
+ *
+ * Bytes of pixels that are not written are never touched, so a span
+ * writes exactly what the per-pixel loop writes.
+ */
+
+#ifndef OP_SIMD_H
+#define OP_SIMD_H
+
+#include <stdint.h>
+#include <string.h>
+#include <boolean.h>
+
+#include "simd_arch.h"
+
+typedef void (*op_span_fn)(uint8_t *dst, const uint8_t *src,
+                           unsigned count, const uint8_t *palette);
+
+typedef struct
+{
+   op_span_fn span16;       /* palette unused */
+   op_span_fn span16_trans; /* palette unused */
+   op_span_fn clut8;
+   op_span_fn clut8_trans;
+} op_simd_ops_t;
+
+extern const op_simd_ops_t op_simd_ops;
+
+/* Shared tails: the per-pixel step every variant falls back to for the
+ * pixels that do not fill a vector. */
+static SIMD_INLINE
+void op_span16_tail(uint8_t *dst, const uint8_t *src, unsigned count,
+                    bool trans)
+{
+   for (; count; count--, dst += 2, src += 2)
+   {
+      if (trans && (src[0] | src[1]) == 0)
+         continue;
+      dst[0] = src[0];
+      dst[1] = src[1];
+   }
+}
+
+static SIMD_INLINE
+void op_clut8_tail(uint8_t *dst, const uint8_t *src, unsigned count,
+                   const uint8_t *palette, bool trans)
+{
+   for (; count; count--, dst += 2, src++)
+   {
+      if (trans && *src == 0)
+         continue;
+      dst[0] = palette[*src << 1];
+      dst[1] = palette[(*src << 1) + 1];
+   }
+}
+
+/* op_span16 / _span16_trans / _clut8 / _clut8_trans for the selected
+ * arch. */
+#if defined(SIMD_ARCH_NEON)
+#  include "op_simd_neon.h"
+#elif defined(SIMD_ARCH_SSE2)
+#  include "op_simd_sse2.h"
+#else
+#  include "op_simd_scalar.h"
+#endif
+
+#endif /* OP_SIMD_H */
@@ -0,0 +1,101 @@
+#ifndef OP_SIMD_NEON_H
+#define OP_SIMD_NEON_H
+
+/* Included by op_simd.h once the arch has been selected.
+ * Do not include directly. */
+#ifndef OP_SIMD_H
+#error "include op_simd.h, not op_simd_neon.h"
+#endif
+
+#include <arm_neon.h>
+
+/*
+ * OP span writers -- ARM NEON implementation (ARMv7 and AArch64)
+ *
+ * Eight pixels per step.  TRANS is a vceq against zero and a vbsl with
+ * what the line buffer already holds.  The CLUT gather stays eight
+ * scalar loads set lane by lane, as in line_simd_neon.h; the palette
+ * words are loaded and stored host-order, which is the byte copy the
+ * per-pixel loop does.
+ */
+
+/* One palette word, host order. */
+static SIMD_INLINE
+uint16_t op_simd_neon_clut(const uint8_t *palette, uint8_t idx)
+{
+   uint16_t w;
+   memcpy(&w, palette + (idx << 1), 2);
+   return w;
+}
+
+/* Eight palette words for the eight indices at src, set lane by lane
+ * rather than bounced through memory. */
+static SIMD_INLINE
+uint16x8_t op_simd_neon_clut8x8(const uint8_t *src, const uint8_t *palette)
+{
+   uint16x8_t v = vdupq_n_u16(op_simd_neon_clut(palette, src[0]));
+   v = vsetq_lane_u16(op_simd_neon_clut(palette, src[1]), v, 1);
+   v = vsetq_lane_u16(op_simd_neon_clut(palette, src[2]), v, 2);
+   v = vsetq_lane_u16(op_simd_neon_clut(palette, src[3]), v, 3);
+   v = vsetq_lane_u16(op_simd_neon_clut(palette, src[4]), v, 4);
+   v = vsetq_lane_u16(op_simd_neon_clut(palette, src[5]), v, 5);
+   v = vsetq_lane_u16(op_simd_neon_clut(palette, src[6]), v, 6);
+   return vsetq_lane_u16(op_simd_neon_clut(palette, src[7]), v, 7);
+}
+
+/* dst = px in the lanes skip leaves zero; skipped lanes keep dst. */
+static SIMD_INLINE
+void op_simd_neon_blend(uint8_t *dst, uint16x8_t px, uint16x8_t skip)
+{
+   uint8x16_t old = vld1q_u8(dst);
+   vst1q_u8(dst, vbslq_u8(vreinterpretq_u8_u16(skip), old,
+         vreinterpretq_u8_u16(px)));
+}
+
+static SIMD_INLINE
+void op_span16(uint8_t *dst, const uint8_t *src, unsigned count,
+               const uint8_t *palette)
+{
+   (void)palette;
+   for (; count >= 8; count -= 8, dst += 16, src += 16)
+      vst1q_u8(dst, vld1q_u8(src));
+   op_span16_tail(dst, src, count, false);
+}
+
+static SIMD_INLINE
+void op_span16_trans(uint8_t *dst, const uint8_t *src, unsigned count,
+                     const uint8_t *palette)
+{
+   (void)palette;
+   for (; count >= 8; count -= 8, dst += 16, src += 16)
+   {
+      uint16x8_t px = vreinterpretq_u16_u8(vld1q_u8(src));
+      op_simd_neon_blend(dst, px, vceqq_u16(px, vdupq_n_u16(0)));
+   }
+   op_span16_tail(dst, src, count, true);
+}
+
+static SIMD_INLINE
+void op_clut8(uint8_t *dst, const uint8_t *src, unsigned count,
+              const uint8_t *palette)
+{
+   for (; count >= 8; count -= 8, dst += 16, src += 8)
+      vst1q_u8(dst, vreinterpretq_u8_u16(op_simd_neon_clut8x8(src, palette)));
+   op_clut8_tail(dst, src, count, palette, false);
+}
+
+static SIMD_INLINE
+void op_clut8_trans(uint8_t *dst, const uint8_t *src, unsigned count,
+                    const uint8_t *palette)
+{
+   for (; count >= 8; count -= 8, dst += 16, src += 8)
+   {
+      /* Index 0 is transparent, whatever palette entry 0 holds. */
+      uint16x8_t idx = vmovl_u8(vld1_u8(src));
+      op_simd_neon_blend(dst, op_simd_neon_clut8x8(src, palette),
+            vceqq_u16(idx, vdupq_n_u16(0)));
+   }
+   op_clut8_tail(dst, src, count, palette, true);
+}
+
+#endif /* OP_SIMD_NEON_H */
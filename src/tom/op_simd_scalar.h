@@ -0,0 +1,48 @@
+#ifndef OP_SIMD_SCALAR_H
+#define OP_SIMD_SCALAR_H
+
+/* Included by op_simd.h once the arch has been selected.
+ * Do not include directly. */
+#ifndef OP_SIMD_H
+#error "include op_simd.h, not op_simd_scalar.h"
+#endif
+
+/*
+ * OP span writers -- portable scalar implementation
+ *
+ * The opaque 16bpp span is a straight copy; the rest is the per-pixel
+ * step.  Also the shape of the reference test/test_op_simd.c compares
+ * the SIMD variants against.
+ */
+
+static SIMD_INLINE
+void op_span16(uint8_t *dst, const uint8_t *src, unsigned count,
+               const uint8_t *palette)
+{
+   (void)palette;
+   memcpy(dst, src, (size_t)count * 2);
+}
+
+static SIMD_INLINE
+void op_span16_trans(uint8_t *dst, const uint8_t *src, unsigned count,
+                     const uint8_t *palette)
+{
+   (void)palette;
+   op_span16_tail(dst, src, count, true);
+}
+
+static SIMD_INLINE
+void op_clut8(uint8_t *dst, const uint8_t *src, unsigned count,
+              const uint8_t *palette)
+{
+   op_clut8_tail(dst, src, count, palette, false);
+}
+
+static SIMD_INLINE
+void op_clut8_trans(uint8_t *dst, const uint8_t *src, unsigned count,
+                    const uint8_t *palette)
+{
+   op_clut8_tail(dst, src, count, palette, true);
+}
+
+#endif /* OP_SIMD_SCALAR_H */
@@ -0,0 +1,107 @@
+#ifndef OP_SIMD_SSE2_H
+#define OP_SIMD_SSE2_H
+
+/* Included by op_simd.h once the arch has been selected.
+ * Do not include directly. */
+#ifndef OP_SIMD_H
+#error "include op_simd.h, not op_simd_sse2.h"
+#endif
+
+#include <emmintrin.h>  /* SSE2 */
+
+/*
+ * OP span writers -- x86/x64 SSE2 implementation
+ *
+ * Eight pixels per step.  TRANS is a pcmpeqw against zero and an
+ * and/andnot blend with what the line buffer already holds.  The CLUT
+ * gather stays eight scalar loads (SSE2 has no gather) inserted lane by
+ * lane; the palette words are loaded and stored host-order, which is
+ * the byte copy the per-pixel loop does.
+ */
+
+/* One palette word, host order. */
+static SIMD_INLINE
+int op_simd_sse2_clut(const uint8_t *palette, uint8_t idx)
+{
+   uint16_t w;
+   memcpy(&w, palette + (idx << 1), 2);
+   return w;
+}
+
+/* Eight palette words for the eight indices at src, pinsrw'd straight
+ * into the vector rather than bounced through memory. */
+static SIMD_INLINE
+__m128i op_simd_sse2_clut8x8(const uint8_t *src, const uint8_t *palette)
+{
+   __m128i v = _mm_cvtsi32_si128(op_simd_sse2_clut(palette, src[0]));
+   v = _mm_insert_epi16(v, op_simd_sse2_clut(palette, src[1]), 1);
+   v = _mm_insert_epi16(v, op_simd_sse2_clut(palette, src[2]), 2);
+   v = _mm_insert_epi16(v, op_simd_sse2_clut(palette, src[3]), 3);
+   v = _mm_insert_epi16(v, op_simd_sse2_clut(palette, src[4]), 4);
+   v = _mm_insert_epi16(v, op_simd_sse2_clut(palette, src[5]), 5);
+   v = _mm_insert_epi16(v, op_simd_sse2_clut(palette, src[6]), 6);
+   return _mm_insert_epi16(v, op_simd_sse2_clut(palette, src[7]), 7);
+}
+
+/* dst = px in the lanes skip leaves zero; skipped lanes keep dst. */
+static SIMD_INLINE
+void op_simd_sse2_blend(uint8_t *dst, __m128i px, __m128i skip)
+{
+   __m128i old = _mm_loadu_si128((const __m128i *)dst);
+   _mm_storeu_si128((__m128i *)dst,
+         _mm_or_si128(_mm_and_si128(skip, old), _mm_andnot_si128(skip, px)));
+}
+
+static SIMD_INLINE
+void op_span16(uint8_t *dst, const uint8_t *src, unsigned count,
+               const uint8_t *palette)
+{
+   (void)palette;
+   for (; count >= 8; count -= 8, dst += 16, src += 16)
+      _mm_storeu_si128((__m128i *)dst,
+            _mm_loadu_si128((const __m128i *)src));
+   op_span16_tail(dst, src, count, false);
+}
+
+static SIMD_INLINE
+void op_span16_trans(uint8_t *dst, const uint8_t *src, unsigned count,
+                     const uint8_t *palette)
+{
+   const __m128i zero = _mm_setzero_si128();
+
+   (void)palette;
+   for (; count >= 8; count -= 8, dst += 16, src += 16)
+   {
+      __m128i px = _mm_loadu_si128((const __m128i *)src);
+      op_simd_sse2_blend(dst, px, _mm_cmpeq_epi16(px, zero));
+   }
+   op_span16_tail(dst, src, count, true);
+}
+
+static SIMD_INLINE
+void op_clut8(uint8_t *dst, const uint8_t *src, unsigned count,
+              const uint8_t *palette)
+{
+   for (; count >= 8; count -= 8, dst += 16, src += 8)
+      _mm_storeu_si128((__m128i *)dst, op_simd_sse2_clut8x8(src, palette));
+   op_clut8_tail(dst, src, count, palette, false);
+}
+
+static SIMD_INLINE
+void op_clut8_trans(uint8_t *dst, const uint8_t *src, unsigned count,
+                    const uint8_t *palette)
+{
+   const __m128i zero = _mm_setzero_si128();
+
+   for (; count >= 8; count -= 8, dst += 16, src += 8)
+   {
+      /* Index 0 is transparent, whatever palette entry 0 holds. */
+      __m128i idx = _mm_unpacklo_epi8(
+            _mm_loadl_epi64((const __m128i *)src), zero);
+      op_simd_sse2_blend(dst, op_simd_sse2_clut8x8(src, palette),
+            _mm_cmpeq_epi16(idx, zero));
+   }
+   op_clut8_tail(dst, src, count, palette, true);
+}
+
+#endif /* OP_SIMD_SSE2_H */
@@ -255,6 +255,7 @@
 
 #include "tom.h"
 
+#include <stdlib.h>
 #include <string.h>								// For memset()
 #include "blitter.h"
 #include "bus_arbiter.h"
@@ -263,13 +264,16 @@
 #include "inputdev.h"
 #include "jaguar.h"
 #include "jerry.h"
+#include "line_simd.h"
 #include "shadowfb.h"
 #include "log.h"
 #include "m68000/m68kinterface.h"
 #include "op.h"
 #include "perf_counters.h"
+#include "perf_timing.h"
 #include "settings.h"
 #include "../core/vjtrace.h"
+#include "../core/vjthread.h"
 
 PERF_COUNTER(timing_gpu_irqs_to_68k);
 PERF_COUNTER(timing_int1_video);
@@ -277,6 +281,9 @@ PERF_COUNTER(timing_int1_gpu);
 PERF_COUNTER(timing_int1_object);
 PERF_COUNTER(timing_int1_timer);
 PERF_COUNTER(timing_int1_jerry);
+PERF_COUNTER(tom_frames_hidden);
+PERF_COUNTER(tom_lines_queued);
+PERF_COUNTER(tom_line_ring_full);
 
 // Red Color Values for CrY<->RGB Color Conversion
 uint8_t redcv[16][16] = {
@@ -428,6 +435,11 @@ static uint16_t tomHCReadPhase;
 static uint32_t tomRowsWrittenCur;
 static uint32_t tomRowsWrittenPrev;
 static uint32_t tomRowsWrittenLast;
+
+/* Whether this frame's pixels will be looked at (TOMSetPresent).  Host-side
+ * only: the OP still fills the line buffer either way, since that buffer is
+ * TOM RAM the GPU can read and the object list writes back to main RAM. */
+static bool tomPresent = true;
 uint16_t tom_jerry_int_pending, tom_timer_int_pending, tom_object_int_pending,
          tom_gpu_int_pending, tom_video_int_pending;
 
@@ -436,15 +448,41 @@ uint16_t tom_jerry_int_pending, tom_timer_int_pending, tom_object_int_pending,
 uint32_t * screenBuffer;
 uint32_t screenPitch;
 
-typedef void (render_xxx_scanline_fn)(uint32_t *);
+/* Everything a scanline renderer reads, so a line can be converted after
+ * TOM has moved on (see "Threaded scanline conversion" below).  On the
+ * synchronous path the pointers are the live arrays; a queued line points
+ * them at its own copies. */
+#define TOM_LINE_BUFFER_BYTES (sizeof(tomRam8) - 0x1800)
+
+typedef struct tom_line_src
+{
+   const uint8_t      *lbuf;     /* tomRam8[0x1800..0x3FFF] */
+   const uint32_t     *sfbTag;   /* true-color shadow line (shadowfb.h) */
+   const uint32_t     *sfbRGB;
+   const uint32_t     *hiresTag; /* Nx shadow line */
+   const shadowfb_sub *hiresSub;
+   uint32_t            border;   /* BORD1/BORD2 as XRGB8888 */
+   uint32_t            leftHC;
+   uint32_t            pitch;    /* screenPitch */
+   uint16_t            vmode;
+   uint16_t            hdb1;
+   uint16_t            width;    /* tomWidth */
+   uint8_t             videoMode;
+   uint8_t             active;   /* inside VDB..VDE; else border fill */
+   int                 sfbActive;
+   int                 hiresActive;
+   int                 hiresN;
+} tom_line_src;
+
+typedef void (render_xxx_scanline_fn)(const tom_line_src *, uint32_t *);
 
 // Private function prototypes
 
-void tom_render_16bpp_cry_scanline(uint32_t * backbuffer);
-void tom_render_24bpp_scanline(uint32_t * backbuffer);
-void tom_render_16bpp_direct_scanline(uint32_t * backbuffer);
-void tom_render_16bpp_rgb_scanline(uint32_t * backbuffer);
-void tom_render_16bpp_cry_rgb_mix_scanline(uint32_t * backbuffer);
+void tom_render_16bpp_cry_scanline(const tom_line_src *src, uint32_t * backbuffer);
+void tom_render_24bpp_scanline(const tom_line_src *src, uint32_t * backbuffer);
+void tom_render_16bpp_direct_scanline(const tom_line_src *src, uint32_t * backbuffer);
+void tom_render_16bpp_rgb_scanline(const tom_line_src *src, uint32_t * backbuffer);
+void tom_render_16bpp_cry_rgb_mix_scanline(const tom_line_src *src, uint32_t * backbuffer);
 uint16_t TOMIRQControlReg(void);
 
 render_xxx_scanline_fn * scanline_render[] =
@@ -462,6 +500,13 @@ render_xxx_scanline_fn * scanline_render[] =
 uint32_t RGB16ToRGB32[0x10000];
 uint32_t CRY16ToRGB32[0x10000];
 uint32_t MIX16ToRGB32[0x10000];
+// Per CRY high byte, for the SIMD converters (see line_simd.h)
+static uint32_t CRYChroma[0x100];
+
+static const line_simd_luts tomLineLuts =
+{
+   CRY16ToRGB32, RGB16ToRGB32, MIX16ToRGB32, CRYChroma
+};
 
 /*
  * Derive visible-window boundaries from TOM display registers (VDB, VDE,
@@ -643,6 +688,11 @@ void TOMFillLookupTables(void)
       CRY16ToRGB32[i] = 0xFF000000 | (r << 16) | (g << 8) | (b << 0);
       MIX16ToRGB32[i] = ((i & 0x01) ? RGB16ToRGB32[i] : CRY16ToRGB32[i]);
    }
+
+   for(i=0; i<0x100; i++)
+      CRYChroma[i] = ((uint32_t)redcv[i >> 4][i & 0x0F] << 16)
+         | ((uint32_t)greencv[i >> 4][i & 0x0F] << 8)
+         | bluecv[i >> 4][i & 0x0F];
 }
 
 
@@ -732,7 +782,7 @@ uint16_t TOMGetMEMCON2(void)
 #define LEFT_BG_FIX
 
 /* Clamp `width` so the per-pixel loop in a tom_render_*_scanline()
- * cannot walk past the end of tomRam8 via current_line_buffer.
+ * cannot walk past the end of the line buffer via current_line_buffer.
  * Catches an ASAN-reported OOB read (#127): when display registers
  * request a width larger than the on-chip line buffer holds
  * (10240 bytes at tomRam8[0x1800..0x3FFF]).
@@ -740,11 +790,11 @@ uint16_t TOMGetMEMCON2(void)
  *   bytes_per_iter: source bytes consumed per loop iter (2 for 16bpp
  *                   variants, 4 for 24bpp).
  *   pwidth_scale:   backbuffer pixels produced per loop iter. */
-static uint16_t tom_clamp_line_buffer_width(
+static uint16_t tom_clamp_line_buffer_width(const tom_line_src *src,
    const uint8_t *current_line_buffer, uint16_t width,
    unsigned bytes_per_iter, uint8_t pwidth_scale)
 {
-   const uint8_t *lb_end = &tomRam8[sizeof(tomRam8)];
+   const uint8_t *lb_end = src->lbuf + TOM_LINE_BUFFER_BYTES;
    unsigned long bytes_left;
    unsigned long safe_width;
    if (current_line_buffer >= lb_end) return 0;
@@ -754,15 +804,14 @@ static uint16_t tom_clamp_line_buffer_width(
 }
 
 // 16 BPP CRY/RGB mixed mode rendering
-void tom_render_16bpp_cry_rgb_mix_scanline(uint32_t * backbuffer)
+void tom_render_16bpp_cry_rgb_mix_scanline(const tom_line_src *src, uint32_t * backbuffer)
 {
    unsigned i;
-   uint8_t s;
-   uint16_t width = tomWidth;
-   uint8_t * current_line_buffer = (uint8_t *)&tomRam8[0x1800];
-   uint8_t pwidth = ((GET16(tomRam8, VMODE) & PWIDTH) >> 9) + 1;
+   uint16_t width = src->width;
+   const uint8_t * current_line_buffer = src->lbuf;
+   uint8_t pwidth = ((src->vmode & PWIDTH) >> 9) + 1;
    uint8_t pwidth_scale = (pwidth >= 8) ? (pwidth / 4) : 1;
-   int16_t startPos = GET16(tomRam8, HDB1) - (int16_t)TOMGetLeftVisibleHC();
+   int16_t startPos = src->hdb1 - (int16_t)src->leftHC;
    uint16_t startPos_disp;
    startPos /= pwidth;
 
@@ -771,8 +820,7 @@ void tom_render_16bpp_cry_rgb_mix_scanline(uint32_t * backbuffer)
    else
 #ifdef LEFT_BG_FIX
    {
-      uint8_t g = tomRam8[BORD1], r = tomRam8[BORD1 + 1], b = tomRam8[BORD2 + 1];
-      uint32_t pixel = 0xFF000000 | (r << 16) | (g << 8) | (b << 0);
+      uint32_t pixel = src->border;
       startPos_disp = (uint16_t)startPos * pwidth_scale;
 
       for(i = 0; i < startPos_disp; i++)
@@ -784,27 +832,21 @@ void tom_render_16bpp_cry_rgb_mix_scanline(uint32_t * backbuffer)
    backbuffer += 2 * startPos, width -= startPos;
 #endif
 
-   width = tom_clamp_line_buffer_width(current_line_buffer, width, 2, pwidth_scale);
-   while (width >= pwidth_scale)
-   {
-      uint16_t color = (*current_line_buffer++) << 8;
-      color |= *current_line_buffer++;
-      for (s = 0; s < pwidth_scale; s++)
-         *backbuffer++ = MIX16ToRGB32[color];
-      width -= pwidth_scale;
-   }
+   width = tom_clamp_line_buffer_width(src, current_line_buffer, width, 2, pwidth_scale);
+   line_simd_mix16(backbuffer, current_line_buffer, width / pwidth_scale,
+      pwidth_scale, &tomLineLuts);
 }
 
 // 16 BPP CRY mode rendering
-void tom_render_16bpp_cry_scanline(uint32_t * backbuffer)
+void tom_render_16bpp_cry_scanline(const tom_line_src *src, uint32_t * backbuffer)
 {
    unsigned i;
    uint8_t s;
-   uint16_t width = tomWidth;
-   uint8_t * current_line_buffer = (uint8_t *)&tomRam8[0x1800];
-   uint8_t pwidth = ((GET16(tomRam8, VMODE) & PWIDTH) >> 9) + 1;
+   uint16_t width = src->width;
+   const uint8_t * current_line_buffer = src->lbuf;
+   uint8_t pwidth = ((src->vmode & PWIDTH) >> 9) + 1;
    uint8_t pwidth_scale = (pwidth >= 8) ? (pwidth / 4) : 1;
-   int16_t startPos = GET16(tomRam8, HDB1) - (int16_t)TOMGetLeftVisibleHC();
+   int16_t startPos = src->hdb1 - (int16_t)src->leftHC;
    uint16_t startPos_disp;
    startPos /= pwidth;
 
@@ -813,8 +855,7 @@ void tom_render_16bpp_cry_scanline(uint32_t * backbuffer)
    else
 #ifdef LEFT_BG_FIX
    {
-      uint8_t g = tomRam8[BORD1], r = tomRam8[BORD1 + 1], b = tomRam8[BORD2 + 1];
-      uint32_t pixel = 0xFF000000 | (r << 16) | (g << 8) | (b << 0);
+      uint32_t pixel = src->border;
       startPos_disp = (uint16_t)startPos * pwidth_scale;
 
       for(i = 0; i < startPos_disp; i++)
@@ -826,7 +867,7 @@ void tom_render_16bpp_cry_scanline(uint32_t * backbuffer)
    backbuffer += 2 * startPos, width -= startPos;
 #endif
 
-   width = tom_clamp_line_buffer_width(current_line_buffer, width, 2, pwidth_scale);
+   width = tom_clamp_line_buffer_width(src, current_line_buffer, width, 2, pwidth_scale);
 
    /* True-color path (see shadowfb.h): substitute the full-precision
     * RGB888 from the shadow line buffer, but only when the entry's tag
@@ -834,9 +875,9 @@ void tom_render_16bpp_cry_scanline(uint32_t * backbuffer)
     * write path (direct TOM writes, RMW blends, missed sites) then
     * falls back to the stock LUT.  With the option off this block is
     * never entered and output is bit-identical to stock. */
-   if (shadowFBActive)
+   if (src->sfbActive)
    {
-      int sfbIdx = (int)((current_line_buffer - &tomRam8[0x1800]) >> 1);
+      int sfbIdx = (int)((current_line_buffer - src->lbuf) >> 1);
       while (width >= pwidth_scale)
       {
          uint32_t out;
@@ -844,8 +885,8 @@ void tom_render_16bpp_cry_scanline(uint32_t * backbuffer)
          color |= *current_line_buffer++;
          out = CRY16ToRGB32[color];
          if (sfbIdx >= 0 && sfbIdx < SHADOWFB_LINE_PIXELS
-               && shadowLineTag[sfbIdx] == ((uint32_t)color | SHADOWFB_TAG_VALID))
-            out = 0xFF000000 | shadowLineRGB[sfbIdx];
+               && src->sfbTag[sfbIdx] == ((uint32_t)color | SHADOWFB_TAG_VALID))
+            out = 0xFF000000 | src->sfbRGB[sfbIdx];
          sfbIdx++;
          for (s = 0; s < pwidth_scale; s++)
             *backbuffer++ = out;
@@ -854,14 +895,8 @@ void tom_render_16bpp_cry_scanline(uint32_t * backbuffer)
       return;
    }
 
-   while (width >= pwidth_scale)
-   {
-      uint16_t color = (*current_line_buffer++) << 8;
-      color |= *current_line_buffer++;
-      for (s = 0; s < pwidth_scale; s++)
-         *backbuffer++ = CRY16ToRGB32[color];
-      width -= pwidth_scale;
-   }
+   line_simd_cry16(backbuffer, current_line_buffer, width / pwidth_scale,
+      pwidth_scale, &tomLineLuts);
 }
 
 /* Hi-res (Nx) CRY renderer -- epic #338 track 1, Stage 1.
@@ -880,32 +915,31 @@ void tom_render_16bpp_cry_scanline(uint32_t * backbuffer)
  * entry, unshadowed page, foreign line-buffer writer) every subpixel
  * falls back to `base`, the exact 1x result including the 1x
  * true-color substitution. */
-static void tom_render_16bpp_cry_scanline_hires(uint32_t * backbuffer)
+static void tom_render_16bpp_cry_scanline_hires(const tom_line_src *src, uint32_t * backbuffer)
 {
    unsigned i;
    uint8_t s;
-   int n = shadowHiresN;
+   int n = src->hiresN;
    int sub, sx;
-   uint16_t width = tomWidth;
-   uint8_t * current_line_buffer = (uint8_t *)&tomRam8[0x1800];
-   uint8_t pwidth = ((GET16(tomRam8, VMODE) & PWIDTH) >> 9) + 1;
+   uint16_t width = src->width;
+   const uint8_t * current_line_buffer = src->lbuf;
+   uint8_t pwidth = ((src->vmode & PWIDTH) >> 9) + 1;
    uint8_t pwidth_scale = (pwidth >= 8) ? (pwidth / 4) : 1;
-   int16_t startPos = GET16(tomRam8, HDB1) - (int16_t)TOMGetLeftVisibleHC();
+   int16_t startPos = src->hdb1 - (int16_t)src->leftHC;
    uint16_t startPos_disp;
    uint32_t *rows[SHADOWFB_HIRES_MAX_N];
    int sfbIdx;
    startPos /= pwidth;
 
    for (sub = 0; sub < n; sub++)
-      rows[sub] = backbuffer + (uint32_t)sub * screenPitch;
+      rows[sub] = backbuffer + (uint32_t)sub * src->pitch;
 
    if (startPos < 0)
       current_line_buffer += 2 * -startPos;
    else
    {
       /* LEFT_BG_FIX border fill, replicated N wide x N sub-rows. */
-      uint8_t g = tomRam8[BORD1], r = tomRam8[BORD1 + 1], b = tomRam8[BORD2 + 1];
-      uint32_t pixel = 0xFF000000 | (r << 16) | (g << 8) | (b << 0);
+      uint32_t pixel = src->border;
       startPos_disp = (uint16_t)startPos * pwidth_scale;
 
       for (sub = 0; sub < n; sub++)
@@ -915,8 +949,8 @@ static void tom_render_16bpp_cry_scanline_hires(uint32_t * backbuffer)
       width -= startPos_disp;
    }
 
-   width = tom_clamp_line_buffer_width(current_line_buffer, width, 2, pwidth_scale);
-   sfbIdx = (int)((current_line_buffer - &tomRam8[0x1800]) >> 1);
+   width = tom_clamp_line_buffer_width(src, current_line_buffer, width, 2, pwidth_scale);
+   sfbIdx = (int)((current_line_buffer - src->lbuf) >> 1);
 
    while (width >= pwidth_scale)
    {
@@ -928,17 +962,17 @@ static void tom_render_16bpp_cry_scanline_hires(uint32_t * backbuffer)
       /* `base` = the exact 1x result for this stock pixel (including
        * the true-color substitution when that option is on). */
       base = CRY16ToRGB32[color];
-      if (shadowFBActive && sfbIdx >= 0 && sfbIdx < SHADOWFB_LINE_PIXELS
-            && shadowLineTag[sfbIdx] == ((uint32_t)color | SHADOWFB_TAG_VALID))
-         base = 0xFF000000 | shadowLineRGB[sfbIdx];
+      if (src->sfbActive && sfbIdx >= 0 && sfbIdx < SHADOWFB_LINE_PIXELS
+            && src->sfbTag[sfbIdx] == ((uint32_t)color | SHADOWFB_TAG_VALID))
+         base = 0xFF000000 | src->sfbRGB[sfbIdx];
 
       for (sub = 0; sub < n; sub++)
       {
          ent = NULL;
          if (sfbIdx >= 0 && sfbIdx < SHADOWFB_LINE_PIXELS
-               && shadowHiresLineTag[sfbIdx] ==
+               && src->hiresTag[sfbIdx] ==
                   ((uint32_t)color | SHADOWFB_TAG_VALID))
-            ent = shadowHiresLineSub
+            ent = src->hiresSub
                 + ((uint32_t)sub * SHADOWFB_LINE_PIXELS + (uint32_t)sfbIdx)
                   * (uint32_t)n;
          for (sx = 0; sx < n; sx++)
@@ -950,7 +984,7 @@ static void tom_render_16bpp_cry_scanline_hires(uint32_t * backbuffer)
              * LUT.  A miss falls back to the exact 1x result. */
             uint32_t out;
             if (ent)
-               out = shadowFBActive
+               out = src->sfbActive
                    ? (0xFF000000
                       | ShadowFBCryRGB(ent[sx].value16, ent[sx].frac16))
                    : CRY16ToRGB32[ent[sx].value16];
@@ -1016,32 +1050,31 @@ static void tom_render_16bpp_cry_scanline_hires(uint32_t * backbuffer)
  * so adding one here at 2x would make the 2x frame differ from the 1x
  * frame by something that is not supersampling, breaking the
  * box-replication identity this renderer must uphold on every miss. */
-static void tom_render_16bpp_rgb_scanline_hires(uint32_t * backbuffer)
+static void tom_render_16bpp_rgb_scanline_hires(const tom_line_src *src, uint32_t * backbuffer)
 {
    unsigned i;
    uint8_t s;
-   int n = shadowHiresN;
+   int n = src->hiresN;
    int sub, sx;
-   uint16_t width = tomWidth;
-   uint8_t * current_line_buffer = (uint8_t *)&tomRam8[0x1800];
-   uint8_t pwidth = ((GET16(tomRam8, VMODE) & PWIDTH) >> 9) + 1;
+   uint16_t width = src->width;
+   const uint8_t * current_line_buffer = src->lbuf;
+   uint8_t pwidth = ((src->vmode & PWIDTH) >> 9) + 1;
    uint8_t pwidth_scale = (pwidth >= 8) ? (pwidth / 4) : 1;
-   int16_t startPos = GET16(tomRam8, HDB1) - (int16_t)TOMGetLeftVisibleHC();
+   int16_t startPos = src->hdb1 - (int16_t)src->leftHC;
    uint16_t startPos_disp;
    uint32_t *rows[SHADOWFB_HIRES_MAX_N];
    int sfbIdx;
    startPos /= pwidth;
 
    for (sub = 0; sub < n; sub++)
-      rows[sub] = backbuffer + (uint32_t)sub * screenPitch;
+      rows[sub] = backbuffer + (uint32_t)sub * src->pitch;
 
    if (startPos < 0)
       current_line_buffer += 2 * -startPos;
    else
    {
       /* LEFT_BG_FIX border fill, replicated N wide x N sub-rows. */
-      uint8_t g = tomRam8[BORD1], r = tomRam8[BORD1 + 1], b = tomRam8[BORD2 + 1];
-      uint32_t pixel = 0xFF000000 | (r << 16) | (g << 8) | (b << 0);
+      uint32_t pixel = src->border;
       startPos_disp = (uint16_t)startPos * pwidth_scale;
 
       for (sub = 0; sub < n; sub++)
@@ -1051,8 +1084,8 @@ static void tom_render_16bpp_rgb_scanline_hires(uint32_t * backbuffer)
       width -= startPos_disp;
    }
 
-   width = tom_clamp_line_buffer_width(current_line_buffer, width, 2, pwidth_scale);
-   sfbIdx = (int)((current_line_buffer - &tomRam8[0x1800]) >> 1);
+   width = tom_clamp_line_buffer_width(src, current_line_buffer, width, 2, pwidth_scale);
+   sfbIdx = (int)((current_line_buffer - src->lbuf) >> 1);
 
    while (width >= pwidth_scale)
    {
@@ -1070,9 +1103,9 @@ static void tom_render_16bpp_rgb_scanline_hires(uint32_t * backbuffer)
       {
          ent = NULL;
          if (sfbIdx >= 0 && sfbIdx < SHADOWFB_LINE_PIXELS
-               && shadowHiresLineTag[sfbIdx] ==
+               && src->hiresTag[sfbIdx] ==
                   ((uint32_t)color | SHADOWFB_TAG_VALID))
-            ent = shadowHiresLineSub
+            ent = src->hiresSub
                 + ((uint32_t)sub * SHADOWFB_LINE_PIXELS + (uint32_t)sfbIdx)
                   * (uint32_t)n;
          for (sx = 0; sx < n; sx++)
@@ -1105,33 +1138,33 @@ static void tom_render_16bpp_rgb_scanline_hires(uint32_t * backbuffer)
  * 1x frame for every mode. */
 static uint32_t tomHiresScratch[1024];
 
-static void tom_render_scanline_hires(uint32_t * backbuffer)
+static void tom_render_scanline_hires(const tom_line_src *src, uint32_t * backbuffer)
 {
-   render_xxx_scanline_fn *fn = scanline_render[TOMGetVideoMode()];
+   render_xxx_scanline_fn *fn = scanline_render[src->videoMode];
    unsigned i, s, r;
-   unsigned n = (unsigned)shadowHiresN;
-   unsigned w = (tomWidth < 1024) ? tomWidth : 1024;
+   unsigned n = (unsigned)src->hiresN;
+   unsigned w = (src->width < 1024) ? src->width : 1024;
    uint32_t *dst;
    uint32_t px;
 
    if (fn == tom_render_16bpp_cry_scanline)
    {
-      tom_render_16bpp_cry_scanline_hires(backbuffer);
+      tom_render_16bpp_cry_scanline_hires(src, backbuffer);
       return;
    }
 
    if (fn == tom_render_16bpp_rgb_scanline)
    {
-      tom_render_16bpp_rgb_scanline_hires(backbuffer);
+      tom_render_16bpp_rgb_scanline_hires(src, backbuffer);
       return;
    }
 
    for (i = 0; i < w; i++)
       tomHiresScratch[i] = backbuffer[i * n];
-   fn(tomHiresScratch);
+   fn(src, tomHiresScratch);
    for (r = 0; r < n; r++)
    {
-      dst = backbuffer + r * screenPitch;
+      dst = backbuffer + r * src->pitch;
       for (i = 0; i < w; i++)
       {
          px = tomHiresScratch[i];
@@ -1142,15 +1175,14 @@ static void tom_render_scanline_hires(uint32_t * backbuffer)
 }
 
 // 24 BPP mode rendering
-void tom_render_24bpp_scanline(uint32_t * backbuffer)
+void tom_render_24bpp_scanline(const tom_line_src *src, uint32_t * backbuffer)
 {
    unsigned i;
-   uint8_t s;
-   uint16_t width = tomWidth;
-   uint8_t * current_line_buffer = (uint8_t *)&tomRam8[0x1800];
-   uint8_t pwidth = ((GET16(tomRam8, VMODE) & PWIDTH) >> 9) + 1;
+   uint16_t width = src->width;
+   const uint8_t * current_line_buffer = src->lbuf;
+   uint8_t pwidth = ((src->vmode & PWIDTH) >> 9) + 1;
    uint8_t pwidth_scale = (pwidth >= 8) ? (pwidth / 4) : 1;
-   int16_t startPos = GET16(tomRam8, HDB1) - (int16_t)TOMGetLeftVisibleHC();
+   int16_t startPos = src->hdb1 - (int16_t)src->leftHC;
    uint16_t startPos_disp;
    startPos /= pwidth;
 
@@ -1159,8 +1191,7 @@ void tom_render_24bpp_scanline(uint32_t * backbuffer)
    else
 #ifdef LEFT_BG_FIX
    {
-      uint8_t g = tomRam8[BORD1], r = tomRam8[BORD1 + 1], b = tomRam8[BORD2 + 1];
-      uint32_t pixel = 0xFF000000 | (r << 16) | (g << 8) | (b << 0);
+      uint32_t pixel = src->border;
       startPos_disp = (uint16_t)startPos * pwidth_scale;
 
       for(i = 0; i < startPos_disp; i++)
@@ -1172,34 +1203,23 @@ void tom_render_24bpp_scanline(uint32_t * backbuffer)
    backbuffer += 2 * startPos, width -= startPos;
 #endif
 
-   width = tom_clamp_line_buffer_width(current_line_buffer, width, 4, pwidth_scale);
-   while (width >= pwidth_scale)
-   {
-      uint32_t b;
-      uint32_t g = *current_line_buffer++;
-      uint32_t r = *current_line_buffer++;
-      uint32_t pixel;
-      current_line_buffer++;
-      b = *current_line_buffer++;
-      pixel = 0xFF000000 | (r << 16) | (g << 8) | (b << 0);
-      for (s = 0; s < pwidth_scale; s++)
-         *backbuffer++ = pixel;
-      width -= pwidth_scale;
-   }
+   width = tom_clamp_line_buffer_width(src, current_line_buffer, width, 4, pwidth_scale);
+   line_simd_rgb24(backbuffer, current_line_buffer, width / pwidth_scale,
+      pwidth_scale, &tomLineLuts);
 }
 
 //Seems to me that this is NOT a valid mode--the JTRM seems to imply that you would need
 //extra hardware outside of the Jaguar console to support this!
 // 16 BPP direct mode rendering
-void tom_render_16bpp_direct_scanline(uint32_t * backbuffer)
+void tom_render_16bpp_direct_scanline(const tom_line_src *src, uint32_t * backbuffer)
 {
    uint8_t s;
-   uint16_t width = tomWidth;
-   uint8_t * current_line_buffer = (uint8_t *)&tomRam8[0x1800];
-   uint8_t pwidth = ((GET16(tomRam8, VMODE) & PWIDTH) >> 9) + 1;
+   uint16_t width = src->width;
+   const uint8_t * current_line_buffer = src->lbuf;
+   uint8_t pwidth = ((src->vmode & PWIDTH) >> 9) + 1;
    uint8_t pwidth_scale = (pwidth >= 8) ? (pwidth / 4) : 1;
 
-   width = tom_clamp_line_buffer_width(current_line_buffer, width, 2, pwidth_scale);
+   width = tom_clamp_line_buffer_width(src, current_line_buffer, width, 2, pwidth_scale);
    while (width >= pwidth_scale)
    {
       uint16_t color = (*current_line_buffer++) << 8;
@@ -1212,15 +1232,14 @@ void tom_render_16bpp_direct_scanline(uint32_t * backbuffer)
 
 
 // 16 BPP RGB mode rendering
-void tom_render_16bpp_rgb_scanline(uint32_t * backbuffer)
+void tom_render_16bpp_rgb_scanline(const tom_line_src *src, uint32_t * backbuffer)
 {
    unsigned i;
-   uint8_t s;
-   uint16_t width = tomWidth;
-   uint8_t * current_line_buffer = (uint8_t *)&tomRam8[0x1800];
-   uint8_t pwidth = ((GET16(tomRam8, VMODE) & PWIDTH) >> 9) + 1;
+   uint16_t width = src->width;
+   const uint8_t * current_line_buffer = src->lbuf;
+   uint8_t pwidth = ((src->vmode & PWIDTH) >> 9) + 1;
    uint8_t pwidth_scale = (pwidth >= 8) ? (pwidth / 4) : 1;
-   int16_t startPos = GET16(tomRam8, HDB1) - (int16_t)TOMGetLeftVisibleHC();
+   int16_t startPos = src->hdb1 - (int16_t)src->leftHC;
    uint16_t startPos_disp;
    startPos /= pwidth;
 
@@ -1229,8 +1248,7 @@ void tom_render_16bpp_rgb_scanline(uint32_t * backbuffer)
    else
 #ifdef LEFT_BG_FIX
    {
-      uint8_t g = tomRam8[BORD1], r = tomRam8[BORD1 + 1], b = tomRam8[BORD2 + 1];
-      uint32_t pixel = 0xFF000000 | (r << 16) | (g << 8) | (b << 0);
+      uint32_t pixel = src->border;
       startPos_disp = (uint16_t)startPos * pwidth_scale;
 
       for(i = 0; i < startPos_disp; i++)
@@ -1242,17 +1260,247 @@ void tom_render_16bpp_rgb_scanline(uint32_t * backbuffer)
    backbuffer += 2 * startPos, width -= startPos;
 #endif
 
-   width = tom_clamp_line_buffer_width(current_line_buffer, width, 2, pwidth_scale);
-   while (width >= pwidth_scale)
+   width = tom_clamp_line_buffer_width(src, current_line_buffer, width, 2, pwidth_scale);
+   line_simd_rgb16(backbuffer, current_line_buffer, width / pwidth_scale,
+      pwidth_scale, &tomLineLuts);
+}
+
+/* ---- Threaded scanline conversion (virtualjaguar_threaded_render) ----
+ *
+ * Turning a finished line buffer into XRGB8888 depends only on the line
+ * buffer, a handful of registers and the shadow lines, so it does not have
+ * to happen on the emulation thread.  With the option on, TOMExecHalfline
+ * copies those inputs into the next slot of a small ring and a worker
+ * converts slots in order while the OP builds the following lines.  The
+ * worker writes nothing but the host framebuffer: the line buffer the GPU
+ * can read, savestates and run-ahead are untouched.
+ *
+ * The copy is bounded by what a renderer will read -- the pixels a
+ * negative startPos skips plus one row, at the widest (24bpp) pixel size
+ * -- and the shadow lines are only copied while their options are on.
+ * Border rows go through the ring too, so rows are always written in the
+ * order TOM addressed them.
+ *
+ * retro_run calls TOMFlushScanlines() right after the frame, before
+ * anything reads the framebuffer, so between frames the worker is always
+ * idle.  Where threads are unavailable (vjthread.h) it never starts and
+ * every line is converted synchronously, as before. */
+#define TOM_LINE_RING  32
+#define TOM_LINE_BATCH 8
+
+typedef struct tom_line_job
+{
+   tom_line_src src;
+   uint32_t    *dst;
+   uint8_t      lbuf[TOM_LINE_BUFFER_BYTES];
+   uint32_t     sfbTag[SHADOWFB_LINE_PIXELS];
+   uint32_t     sfbRGB[SHADOWFB_LINE_PIXELS];
+   uint32_t     hiresTag[SHADOWFB_LINE_PIXELS];
+   shadowfb_sub hiresSub[SHADOWFB_HIRES_MAX_N * SHADOWFB_LINE_PIXELS
+                         * SHADOWFB_HIRES_MAX_N];
+} tom_line_job;
+
+static tom_line_job *tomLineRing;
+static vj_thread    *tomLineWorker;
+static vj_lock      *tomLineLock;
+static unsigned      tomLineHead;      /* next slot to fill (emulation) */
+static unsigned      tomLineTail;      /* next slot to convert (worker) */
+static bool          tomLineQuit;
+
+static void tom_line_src_live(tom_line_src *src, bool active)
+{
+   uint8_t g = tomRam8[BORD1], r = tomRam8[BORD1 + 1], b = tomRam8[BORD2 + 1];
+
+   src->lbuf        = &tomRam8[0x1800];
+   src->sfbTag      = shadowLineTag;
+   src->sfbRGB      = shadowLineRGB;
+   src->hiresTag    = shadowHiresLineTag;
+   src->hiresSub    = shadowHiresLineSub;
+   src->border      = 0xFF000000 | (r << 16) | (g << 8) | (b << 0);
+   src->leftHC      = TOMGetLeftVisibleHC();
+   src->pitch       = screenPitch;
+   src->vmode       = GET16(tomRam8, VMODE);
+   src->hdb1        = GET16(tomRam8, HDB1);
+   src->width       = tomWidth;
+   src->videoMode   = TOMGetVideoMode();
+   src->active      = active;
+   src->sfbActive   = shadowFBActive;
+   src->hiresActive = shadowHiresActive;
+   src->hiresN      = shadowHiresN;
+}
+
+static void tom_render_line(const tom_line_src *src, uint32_t *dst)
+{
+   uint32_t hr, i;
+
+   if (src->active)
    {
-      uint32_t color = (*current_line_buffer++) << 8;
-      color |= *current_line_buffer++;
-      for (s = 0; s < pwidth_scale; s++)
-         *backbuffer++ = RGB16ToRGB32[color];
-      width -= pwidth_scale;
+      if (src->hiresActive)
+         tom_render_scanline_hires(src, dst);
+      else
+         scanline_render[src->videoMode](src, dst);
+      return;
+   }
+
+   // If outside of VDB & VDE, then display the border color
+   // (replicated across the N sub-rows / N-wide pixels at hi-res).
+   for (hr = 0; hr < (uint32_t)src->hiresN; hr++)
+   {
+      uint32_t * currentLineBuffer = dst + hr * src->pitch;
+
+      for (i = 0; i < (uint32_t)src->width * (uint32_t)src->hiresN; i++)
+         *currentLineBuffer++ = src->border;
    }
 }
 
+/* Stock pixels of the line buffer a renderer can read for this line. */
+static uint32_t tom_line_src_span(const tom_line_src *src)
+{
+   int pwidth = ((src->vmode & PWIDTH) >> 9) + 1;
+   int16_t startPos = src->hdb1 - (int16_t)src->leftHC;
+
+   startPos /= pwidth;
+   return (uint32_t)src->width + (startPos < 0 ? (uint32_t)-startPos : 0);
+}
+
+static void tom_line_queue(const tom_line_src *live, uint32_t *dst)
+{
+   tom_line_job *job;
+
+   VJLock(tomLineLock);
+   if (tomLineHead - tomLineTail == TOM_LINE_RING)
+   {
+      PERF_INC(tom_line_ring_full);
+      do
+         VJLockWait(tomLineLock);
+      while (tomLineHead - tomLineTail == TOM_LINE_RING);
+   }
+   VJUnlock(tomLineLock);
+
+   /* Slots in [tail, head) belong to the worker; this one is free. */
+   job      = &tomLineRing[tomLineHead % TOM_LINE_RING];
+   job->src = *live;
+   job->dst = dst;
+   if (live->active)
+   {
+      uint32_t span  = tom_line_src_span(live);
+      uint32_t bytes = span * 4;
+      uint32_t pix   = span;
+      uint32_t n     = (uint32_t)live->hiresN;
+      uint32_t sy;
+
+      if (bytes > TOM_LINE_BUFFER_BYTES)
+         bytes = TOM_LINE_BUFFER_BYTES;
+      if (pix > SHADOWFB_LINE_PIXELS)
+         pix = SHADOWFB_LINE_PIXELS;
+
+      memcpy(job->lbuf, live->lbuf, bytes);
+      job->src.lbuf = job->lbuf;
+      if (live->sfbActive)
+      {
+         memcpy(job->sfbTag, live->sfbTag, pix * sizeof(uint32_t));
+         memcpy(job->sfbRGB, live->sfbRGB, pix * sizeof(uint32_t));
+         job->src.sfbTag = job->sfbTag;
+         job->src.sfbRGB = job->sfbRGB;
+      }
+      if (live->hiresActive && live->hiresSub
+            && n <= SHADOWFB_HIRES_MAX_N)
+      {
+         memcpy(job->hiresTag, live->hiresTag, pix * sizeof(uint32_t));
+         for (sy = 0; sy < n; sy++)
+            memcpy(job->hiresSub + sy * SHADOWFB_LINE_PIXELS * n,
+                   live->hiresSub + sy * SHADOWFB_LINE_PIXELS * n,
+                   pix * n * sizeof(shadowfb_sub));
+         job->src.hiresTag = job->hiresTag;
+         job->src.hiresSub = job->hiresSub;
+      }
+   }
+
+   /* Wake the worker once a batch is waiting rather than per line: each
+    * wakeup is a context switch, and with no spare core that is all
+    * threading costs.  TOMFlushScanlines() wakes it for the remainder. */
+   VJLock(tomLineLock);
+   tomLineHead++;
+   if (tomLineHead - tomLineTail >= TOM_LINE_BATCH)
+      VJLockSignal(tomLineLock);
+   VJUnlock(tomLineLock);
+   PERF_INC(tom_lines_queued);
+}
+
+static void tom_line_worker(void *arg)
+{
+   (void)arg;
+
+   VJLock(tomLineLock);
+   for (;;)
+   {
+      tom_line_job *job;
+
+      while (tomLineTail == tomLineHead && !tomLineQuit)
+         VJLockWait(tomLineLock);
+      if (tomLineTail == tomLineHead)
+         break;
+      job = &tomLineRing[tomLineTail % TOM_LINE_RING];
+      VJUnlock(tomLineLock);
+
+      tom_render_line(&job->src, job->dst);
+
+      VJLock(tomLineLock);
+      tomLineTail++;
+      /* Only an empty ring is worth a wakeup: both a flush and a
+       * producer stalled on a full ring then have room to run on. */
+      if (tomLineTail == tomLineHead)
+         VJLockSignal(tomLineLock);
+   }
+   VJUnlock(tomLineLock);
+}
+
+bool TOMSetThreadedRender(bool enabled)
+{
+   if (enabled && !tomLineWorker)
+   {
+      tomLineRing = (tom_line_job *)malloc(TOM_LINE_RING * sizeof(*tomLineRing));
+      tomLineLock = VJLockNew();
+      tomLineHead = tomLineTail = 0;
+      tomLineQuit = false;
+      if (tomLineRing && tomLineLock)
+         tomLineWorker = VJThreadStart(tom_line_worker, NULL);
+      if (!tomLineWorker)
+      {
+         free(tomLineRing);
+         VJLockFree(tomLineLock);
+         tomLineRing = NULL;
+         tomLineLock = NULL;
+      }
+   }
+   else if (!enabled && tomLineWorker)
+   {
+      /* The worker drains what is queued before it sees the quit. */
+      VJLock(tomLineLock);
+      tomLineQuit = true;
+      VJLockSignal(tomLineLock);
+      VJUnlock(tomLineLock);
+      VJThreadJoin(tomLineWorker);
+      VJLockFree(tomLineLock);
+      free(tomLineRing);
+      tomLineWorker = NULL;
+      tomLineLock   = NULL;
+      tomLineRing   = NULL;
+   }
+   return tomLineWorker != NULL;
+}
+
+void TOMFlushScanlines(void)
+{
+   if (!tomLineWorker)
+      return;
+   VJLock(tomLineLock);
+   VJLockSignal(tomLineLock);
+   while (tomLineTail != tomLineHead)
+      VJLockWait(tomLineLock);
+   VJUnlock(tomLineLock);
+}
+
 // Process a single scanline
 /* ---- light gun: LPH / LPV synthesis (#438) --------------------------
  *
@@ -1426,7 +1674,9 @@ void TOMExecHalfline(uint16_t halfline, bool render)
             for(i=0; i<720; i++)
                *current_line_buffer++ = bgHI, *current_line_buffer++ = bgLO;
 
+         PERF_TIME_ENTER(PERF_T_OP);
          OPProcessList(halfline, render);
+         PERF_TIME_LEAVE();
       }
    }
    else
@@ -1445,6 +1695,7 @@ void TOMExecHalfline(uint16_t halfline, bool render)
        * the Nx pitch.  hiresRowScale is 1 whenever the option is off, so
        * the stock path is unchanged (see shadowfb.h). */
       uint32_t hiresRowScale = (uint32_t)shadowHiresN;
+      tom_line_src src;
 
       // Bit 0 in VP is interlace flag. 0 = interlace, 1 = non-interlaced.
       // (JTRM Rev 8 p.15: half lines per field = VP+1, and an ODD half-line
@@ -1464,29 +1715,18 @@ void TOMExecHalfline(uint16_t halfline, bool render)
       if (writtenRow + 1 > tomRowsWrittenCur)
          tomRowsWrittenCur = writtenRow + 1;
 
-      if (inActiveDisplayArea)
-      {
-         if (shadowHiresActive)
-            tom_render_scanline_hires(TOMCurrentLine);
-         else
-            scanline_render[TOMGetVideoMode()](TOMCurrentLine);
-      }
-      else
-      {
-         // If outside of VDB & VDE, then display the border color
-         // (replicated across the N sub-rows / N-wide pixels at hi-res).
-         uint8_t      g = tomRam8[BORD1], r = tomRam8[BORD1 + 1], b = tomRam8[BORD2 + 1];
-         uint32_t pixel = 0xFF000000 | (r << 16) | (g << 8) | (b << 0);
-         uint32_t hr;
-
-         for (hr = 0; hr < hiresRowScale; hr++)
-         {
-            uint32_t * currentLineBuffer = TOMCurrentLine + hr * screenPitch;
+      /* A frame nobody will see (run-ahead): the line buffer is already
+       * final, only its conversion into the host framebuffer is skipped. */
+      if (!tomPresent)
+         return;
 
-            for(i=0; i<tomWidth * hiresRowScale; i++)
-               *currentLineBuffer++ = pixel;
-         }
-      }
+      PERF_TIME_ENTER(PERF_T_RENDER);
+      tom_line_src_live(&src, inActiveDisplayArea);
+      if (tomLineWorker)
+         tom_line_queue(&src, TOMCurrentLine);
+      else
+         tom_render_line(&src, TOMCurrentLine);
+      PERF_TIME_LEAVE();
    }
 }
 
@@ -1502,6 +1742,7 @@ void TOMInit(void)
 
 void TOMDone(void)
 {
+   TOMSetThreadedRender(false);
    OPDone();
    BlitterDone();
    GPUDone();
@@ -1563,6 +1804,13 @@ uint32_t TOMGetWrittenRowExtent(void)
    return tomRowsWrittenLast;
 }
 
+void TOMSetPresent(bool present)
+{
+   tomPresent = present;
+   if (!present)
+      PERF_INC(tom_frames_hidden);
+}
+
 uint32_t TOMGetVideoModeHeight(void)
 {
    uint16_t vdb = GET16(tomRam8, VDB);
@@ -44,6 +44,14 @@ void TOMExecHalfline(uint16_t halfline, bool render);
 uint32_t TOMGetVideoModeWidth(void);
 uint32_t TOMGetVideoModeHeight(void);
 uint32_t TOMGetWrittenRowExtent(void);
+/* false: run the frame without converting lines into screenBuffer (the
+ * machine state is the same either way).  Set per frame by retro_run. */
+void TOMSetPresent(bool present);
+/* Convert lines into screenBuffer on a worker thread; returns whether the
+ * worker is running (false where threads are unavailable).  Call
+ * TOMFlushScanlines() before reading screenBuffer after a frame. */
+bool TOMSetThreadedRender(bool enabled);
+void TOMFlushScanlines(void);
 uint8_t TOMGetVideoMode(void);
 uint8_t * TOMGetRamPointer(void);
 uint16_t TOMGetHDB(void);
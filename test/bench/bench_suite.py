@@ -0,0 +1,396 @@
+#!/usr/bin/env python3
+"""
+bench_suite.py -- run test_benchmark over a fixed corpus and gate on it.
+
+`make benchmark` times one ROM in one configuration.  This runs every
+entry of a manifest (test/bench/manifest.list) in every configuration of
+a matrix -- blitter engine x blit memo x internal resolution -- repeats
+each one, and writes the samples and their statistics to JSON.  Given a
+baseline JSON from an earlier run it flags the cases that got slower.
+
+  bench_suite.py run [--core SO] [--repeats N] [--frames N] [--warmup N]
+                     [--configs GLOB] [--filter REGEX] [--out FILE]
+                     [--compare BASELINE]
+  bench_suite.py compare BASELINE CURRENT
+
+Samples are interleaved: each repeat runs every (entry, configuration)
+case once before the next repeat starts, so a thermal or background-load
+drift spreads over all cases instead of landing on the last ones.
+
+A case is a regression when BOTH
+  - its median ms/frame is at least --min-slowdown percent (default 2)
+    above the baseline's, and
+  - a one-sided Mann-Whitney U test on the two sample sets gives
+    p < --alpha (default 0.05).
+The first keeps real but negligible shifts from failing the gate; the
+second keeps noise from doing so.  The smallest p the test can reach is
+1 / C(2n, n) for n samples a side -- 0.05 at n = 3, 0.004 at n = 5 --
+so the default alpha needs --repeats 4 or more.
+
+Every run arms the core's host timers (src/core/perf_timing.h), so each
+case also carries a median ms/frame per subsystem, and a regression is
+reported with the subsystem whose time grew the most.  That needs a
+TEST_EXPORTS=1 core; `make bench-suite` builds one.
+
+Exit: 0 clean, 1 regression found (or a run failed), 2 usage error.
+"""
+import argparse
+import fnmatch
+import json
+import math
+import os
+import platform
+import re
+import shlex
+import statistics
+import subprocess
+import sys
+import time
+
+ROOT = os.path.abspath(os.path.join(os.path.dirname(__file__), "..", ".."))
+BENCH = os.path.join(ROOT, "test", "tools", "test_benchmark")
+DEMOS_DIR = os.environ.get("JAGUAR_DEMOS_DIR",
+                           os.path.join(ROOT, "test", "vendor", "JaguarDemos"))
+
+# Matrix axes: (part of the config name, value passed to the core).
+AXES = {
+    "blitter": (("fast", "fast"), ("accurate", "accurate")),
+    "memo": (("nomemo", "disabled"), ("memo", "enabled")),
+    "hires": (("1x", "1x"), ("2x", "2x")),
+}
+
+AVG_RE = re.compile(r"^Time/frame avg:\s+([0-9.]+) ms")
+REGION_RE = re.compile(r"^(\w+)\s+([0-9.]+) ms\s+[0-9.]+%$")
+
+
+def configs():
+    """Every configuration of the matrix, as (name, argv) pairs."""
+    out = []
+    for bname, blitter in AXES["blitter"]:
+        for mname, memo in AXES["memo"]:
+            for hname, hires in AXES["hires"]:
+                out.append(("%s-%s-%s" % (bname, mname, hname),
+                            ["--blitter", blitter,
+                             "--option", "virtualjaguar_blit_memo=" + memo,
+                             "--option",
+                             "virtualjaguar_internal_resolution=" + hires]))
+    return out
+
+
+def resolve(path):
+    if path.startswith("@demos/"):
+        return os.path.join(DEMOS_DIR, path[len("@demos/"):])
+    return path if os.path.isabs(path) else os.path.join(ROOT, path)
+
+
+def read_manifest(path):
+    """Manifest rows: name, ROM, then state=, srm= and opt=key=value."""
+    entries = []
+    with open(path) as fh:
+        for lineno, line in enumerate(fh, 1):
+            line = line.split("#", 1)[0].strip()
+            if not line:
+                continue
+            fields = shlex.split(line)
+            if len(fields) < 2:
+                sys.exit("%s:%d: need a name and a ROM" % (path, lineno))
+            entry = {"name": fields[0], "rom": fields[1], "args": []}
+            for field in fields[2:]:
+                key, _, value = field.partition("=")
+                if key == "state":
+                    entry["args"] += ["--load-state", resolve(value)]
+                    entry["state"] = value
+                elif key == "srm":
+                    entry["args"] += ["--load-srm", resolve(value)]
+                    entry["srm"] = value
+                elif key == "opt":
+                    entry["args"] += ["--option", value]
+                else:
+                    sys.exit("%s:%d: unknown field %r" % (path, lineno, field))
+            entries.append(entry)
+    return entries
+
+
+def missing_inputs(entry):
+    for path in [entry["rom"], entry.get("state"), entry.get("srm")]:
+        if path and not os.path.exists(resolve(path)):
+            return path
+    return None
+
+
+def run_once(core, entry, cfg_args, frames, warmup):
+    cmd = [BENCH, core, resolve(entry["rom"]), str(frames),
+           "--warmup", str(warmup), "--timing"] + cfg_args + entry["args"]
+    proc = subprocess.run(cmd, stdout=subprocess.PIPE, stderr=subprocess.PIPE,
+                          universal_newlines=True)
+    avg = None
+    regions = {}
+    in_regions = False
+    for line in proc.stdout.splitlines():
+        m = AVG_RE.match(line)
+        if m:
+            avg = float(m.group(1))
+        if line.startswith("=== HOST TIME BY SUBSYSTEM"):
+            in_regions = True
+            continue
+        if in_regions:
+            m = REGION_RE.match(line.strip())
+            if m:
+                regions[m.group(1)] = float(m.group(2))
+            elif line.startswith("==="):
+                in_regions = False
+    if proc.returncode != 0 or avg is None:
+        tail = (proc.stderr.strip().splitlines() or ["(no output)"])[-1]
+        raise RuntimeError("%s exited %d: %s" % (" ".join(cmd),
+                                                 proc.returncode, tail))
+    return avg, regions
+
+
+def summarise(samples, region_samples):
+    mean = statistics.mean(samples)
+    var = statistics.variance(samples) if len(samples) > 1 else 0.0
+    return {
+        "samples_ms": samples,
+        "median_ms": statistics.median(samples),
+        "mean_ms": mean,
+        "variance": var,
+        "stdev_ms": var ** 0.5,
+        "cv_pct": 100.0 * var ** 0.5 / mean if mean else 0.0,
+        "min_ms": min(samples),
+        "max_ms": max(samples),
+        "subsystems_ms": {name: statistics.median(vals)
+                          for name, vals in sorted(region_samples.items())},
+    }
+
+
+def cmd_run(args):
+    if not os.access(BENCH, os.X_OK):
+        sys.exit("missing %s -- run `make bench-suite` or build it first"
+                 % os.path.relpath(BENCH, ROOT))
+    pattern = re.compile(args.filter) if args.filter else None
+    cases = []
+    skipped = []
+    for entry in read_manifest(args.manifest):
+        if pattern and not pattern.search(entry["name"]):
+            continue
+        missing = missing_inputs(entry)
+        if missing:
+            skipped.append({"entry": entry["name"], "missing": missing})
+            continue
+        for cname, cargs in configs():
+            if fnmatch.fnmatch(cname, args.configs):
+                cases.append((entry, cname, cargs))
+    if not cases:
+        sys.exit("no runnable cases (manifest %s, filter %r, configs %r)"
+                 % (args.manifest, args.filter, args.configs))
+    for s in skipped:
+        print("skip  %-24s (missing %s)" % (s["entry"], s["missing"]),
+              file=sys.stderr)
+
+    samples = {}
+    regions = {}
+    started = time.time()
+    for rep in range(args.repeats):
+        # Rotate the starting case each repeat as well, so no case is
+        # always the first one after a cold start.
+        shift = rep % len(cases)
+        for entry, cname, cargs in cases[shift:] + cases[:shift]:
+            key = (entry["name"], cname)
+            try:
+                avg, reg = run_once(args.core, entry, cargs,
+                                    args.frames, args.warmup)
+            except RuntimeError as exc:
+                print("FAIL  %s %s: %s" % (key[0], key[1], exc),
+                      file=sys.stderr)
+                return 1
+            samples.setdefault(key, []).append(avg)
+            for name, ms in reg.items():
+                regions.setdefault(key, {}).setdefault(name, []).append(ms)
+            print("[%d/%d] %-24s %-22s %.3f ms/frame"
+                  % (rep + 1, args.repeats, key[0], key[1], avg),
+                  file=sys.stderr)
+
+    result = {
+        "schema": 1,
+        "core": os.path.abspath(args.core),
+        "host": platform.node(),
+        "machine": platform.machine(),
+        "date": time.strftime("%Y-%m-%dT%H:%M:%S"),
+        "frames": args.frames,
+        "warmup": args.warmup,
+        "repeats": args.repeats,
+        "elapsed_s": round(time.time() - started, 1),
+        "skipped": skipped,
+        "cases": [],
+    }
+    for entry, cname, _ in cases:
+        key = (entry["name"], cname)
+        case = {"entry": key[0], "rom": entry["rom"], "config": cname}
+        case.update(summarise(samples[key], regions.get(key, {})))
+        result["cases"].append(case)
+    with open(args.out, "w") as fh:
+        json.dump(result, fh, indent=2, sort_keys=True)
+        fh.write("\n")
+
+    print("\n%-24s %-22s %9s %8s" % ("entry", "config", "median", "cv"))
+    for case in result["cases"]:
+        print("%-24s %-22s %6.3f ms %6.2f%%" % (case["entry"], case["config"],
+                                              case["median_ms"],
+                                              case["cv_pct"]))
+    print("\nwrote %s" % args.out)
+    if args.compare:
+        return compare(load(args.compare), result, args.alpha,
+                       args.min_slowdown)
+    return 0
+
+
+def mann_whitney_greater(base, cur):
+    """One-sided p-value that `cur` tends to be larger than `base`."""
+    pooled = sorted([(v, 0) for v in base] + [(v, 1) for v in cur])
+    ranks = [0.0] * len(pooled)
+    i = 0
+    ties = False
+    while i < len(pooled):
+        j = i
+        while j + 1 < len(pooled) and pooled[j + 1][0] == pooled[i][0]:
+            j += 1
+        if j > i:
+            ties = True
+        for k in range(i, j + 1):
+            ranks[k] = (i + j) / 2.0 + 1.0
+        i = j + 1
+    n1, n2 = len(base), len(cur)
+    r2 = sum(r for r, (_, side) in zip(ranks, pooled) if side == 1)
+    u = r2 - n2 * (n2 + 1) / 2.0
+
+    if not ties and n1 + n2 <= 40:
+        # Exact null distribution of U: the number of ways n2 of the
+        # n1+n2 ranks can sum to each total, by dynamic programming.
+        n = n1 + n2
+        ways = [[0] * (n * (n + 1) // 2 + 1) for _ in range(n2 + 1)]
+        ways[0][0] = 1
+        for rank in range(1, n + 1):
+            for k in range(min(rank, n2), 0, -1):
+                row, prev = ways[k], ways[k - 1]
+                for s in range(len(row) - 1, rank - 1, -1):
+                    row[s] += prev[s - rank]
+        total = sum(ways[n2])
+        at_least = sum(ways[n2][s] for s in range(len(ways[n2]))
+                       if s - n2 * (n2 + 1) / 2.0 >= u)
+        return at_least / float(total)
+
+    # Normal approximation with the tie correction.
+    mu = n1 * n2 / 2.0
+    counts = {}
+    for v, _ in pooled:
+        counts[v] = counts.get(v, 0) + 1
+    n = n1 + n2
+    tie_term = sum(t ** 3 - t for t in counts.values()) / float(n * (n - 1))
+    sigma = (n1 * n2 / 12.0 * ((n + 1) - tie_term)) ** 0.5
+    if sigma == 0:
+        return 1.0
+    z = (u - mu - 0.5) / sigma
+    return 0.5 * math.erfc(z / 2 ** 0.5)
+
+
+def load(path):
+    with open(path) as fh:
+        data = json.load(fh)
+    if data.get("schema") != 1:
+        sys.exit("%s: not a bench_suite result" % path)
+    return data
+
+
+def compare(base, cur, alpha, min_slowdown):
+    if base.get("host") != cur.get("host") or \
+            base.get("machine") != cur.get("machine"):
+        print("warning: baseline is from %s/%s, this run from %s/%s; "
+              "absolute times are not comparable across hosts"
+              % (base.get("host"), base.get("machine"),
+                 cur.get("host"), cur.get("machine")))
+    if base.get("frames") != cur.get("frames"):
+        print("warning: baseline ran %s frames, this run %s"
+              % (base.get("frames"), cur.get("frames")))
+
+    base_cases = {(c["entry"], c["config"]): c for c in base["cases"]}
+    regressions = 0
+    print("\n%-24s %-22s %9s %9s %8s %7s" %
+          ("entry", "config", "base", "now", "delta", "p"))
+    for case in cur["cases"]:
+        key = (case["entry"], case["config"])
+        ref = base_cases.get(key)
+        if ref is None:
+            print("%-24s %-22s %9s %6.3f ms %8s %7s  (new)" %
+                  (key[0], key[1], "-", case["median_ms"], "-", "-"))
+            continue
+        delta = 100.0 * (case["median_ms"] - ref["median_ms"]) / ref["median_ms"]
+        p = mann_whitney_greater(ref["samples_ms"], case["samples_ms"])
+        verdict = ""
+        if delta >= min_slowdown and p < alpha:
+            regressions += 1
+            grew = sorted(((case["subsystems_ms"].get(name, 0.0) - ms, name)
+                           for name, ms in ref.get("subsystems_ms", {}).items()),
+                          reverse=True)
+            verdict = "  SLOWER"
+            if grew and grew[0][0] > 0:
+                verdict += " (%s +%.3f ms)" % (grew[0][1], grew[0][0])
+        elif delta <= -min_slowdown and \
+                mann_whitney_greater(case["samples_ms"], ref["samples_ms"]) < alpha:
+            verdict = "  faster"
+        print("%-24s %-22s %6.3f ms %6.3f ms %+7.2f%% %7.4f%s" %
+              (key[0], key[1], ref["median_ms"], case["median_ms"], delta, p,
+               verdict))
+    for key in sorted(set(base_cases) - set((c["entry"], c["config"])
+                                            for c in cur["cases"])):
+        print("%-24s %-22s  (in baseline, not run)" % key)
+
+    if regressions:
+        print("\n%d case(s) significantly slower than the baseline "
+              "(>= %.1f%%, p < %g)" % (regressions, min_slowdown, alpha))
+        return 1
+    print("\nno significant slowdowns against the baseline")
+    return 0
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    sub = ap.add_subparsers(dest="cmd")
+
+    run = sub.add_parser("run", help="run the suite, write JSON")
+    run.add_argument("--core", default=os.path.join(
+        ROOT, "virtualjaguar_libretro.dylib" if sys.platform == "darwin"
+        else "virtualjaguar_libretro.so"))
+    run.add_argument("--manifest", default=os.path.join(
+        ROOT, "test", "bench", "manifest.list"))
+    run.add_argument("--repeats", type=int, default=5)
+    run.add_argument("--frames", type=int, default=600)
+    run.add_argument("--warmup", type=int, default=60)
+    run.add_argument("--configs", default="*",
+                     help="glob over config names, e.g. 'accurate-*-1x'")
+    run.add_argument("--filter", help="regex over manifest entry names")
+    run.add_argument("--out", default="bench-suite.json")
+    run.add_argument("--compare", metavar="BASELINE")
+    run.add_argument("--alpha", type=float, default=0.05)
+    run.add_argument("--min-slowdown", type=float, default=2.0,
+                     help="percent (default 2)")
+
+    cmp_ = sub.add_parser("compare", help="compare two result files")
+    cmp_.add_argument("baseline")
+    cmp_.add_argument("current")
+    cmp_.add_argument("--alpha", type=float, default=0.05)
+    cmp_.add_argument("--min-slowdown", type=float, default=2.0)
+
+    args = ap.parse_args()
+    if args.cmd == "run":
+        if args.repeats < 1 or args.frames < 1:
+            ap.error("--repeats and --frames must be positive")
+        return cmd_run(args)
+    if args.cmd == "compare":
+        return compare(load(args.baseline), load(args.current), args.alpha,
+                       args.min_slowdown)
+    ap.print_help()
+    return 2
+
+
+if __name__ == "__main__":
+    sys.exit(main())
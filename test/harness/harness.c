@@ -364,6 +364,16 @@ static bool cb_environment(unsigned cmd, void *data)
     case RETRO_ENVIRONMENT_GET_SAVE_DIRECTORY:
         *(const char **)data = "/tmp";
         return true;
+    case RETRO_ENVIRONMENT_GET_AUDIO_VIDEO_ENABLE:
+        if (!active_cfg || !active_cfg->av_hidden)
+            return false;
+        *(int *)data = (int)(3u & ~active_cfg->av_hidden);
+        return true;
+    case RETRO_ENVIRONMENT_GET_SAVESTATE_CONTEXT:
+        if (!active_cfg || !active_cfg->runahead_context)
+            return false;
+        *(int *)data = RETRO_SAVESTATE_CONTEXT_RUNAHEAD_SAME_INSTANCE;
+        return true;
     case RETRO_ENVIRONMENT_GET_VARIABLE: {
         struct retro_variable *var = (struct retro_variable *)data;
         unsigned i;
@@ -252,6 +252,17 @@ typedef struct {
     int           want_fb_hash;
     uint32_t      last_fb_hash;
 
+    /* Run-ahead emulation: the GET_AUDIO_VIDEO_ENABLE bits (1 video,
+     * 2 audio) the frontend will throw away this frame.  0 answers the
+     * query as unsupported, which a core reads as "present everything";
+     * a tool sets it around the harness_step() calls it wants hidden. */
+    unsigned      av_hidden;
+
+    /* Non-zero: answer GET_SAVESTATE_CONTEXT with RUNAHEAD_SAME_INSTANCE,
+     * as a run-ahead frontend does around its own saves and loads.  0
+     * answers the query as unsupported. */
+    int           runahead_context;
+
     /* Runtime state (set by harness) */
     void  *core_handle;
     unsigned current_frame;
@@ -299,6 +310,7 @@ typedef struct {
     .num_mark_specs = 0, \
     .want_fb_hash = 0, \
     .last_fb_hash = 0, \
+    .av_hidden = 0, \
     .core_handle = NULL, \
     .current_frame = 0, \
     .audio = {0}, \
@@ -9,6 +9,8 @@
  *   - Wavetable ROM accessibility and content
  *   - DSP I2S interrupt delivery
  *   - Audio data flow: DSP → LTXD/RTXD → sample buffer
+ *   - Frame-batched resampling: cadence, interpolation, frame seams
+ *   - Selectable output paths: windowed sinc, native I2S rate
  *
  * Build: cc -g -O0 -o test/test_audio_dac test/test_audio_dac.c -ldl
  * Run:   ./test/test_audio_dac
@@ -86,6 +88,35 @@ static void jerry_write(uint32_t addr, uint16_t data)
     core.JERRYWriteWord(addr, data, 0);
 }
 
+/* DAC frame entry points (test export ABI, link-test.T) */
+#define EVENT_JERRY       1
+#define EVENT_TICK_SHIFT  16
+static void (*p_DACReset)(void);
+static void (*p_DACPrepareFrame)(int);
+static void (*p_DACWordStrobe)(void);
+static uint32_t (*p_DACGetI2SResyncCount)(void);
+static void (*p_SoundCallback)(void *, uint16_t *, int);
+static uint64_t (*p_GetEventClock)(int);
+static void (*p_AdvanceEventClock)(uint64_t, int);
+static void (*p_DACSetResampler)(int);
+static double (*p_DACGetI2SRate)(void);
+
+/* dac.h DAC_RESAMPLER_* */
+#define DAC_RESAMPLER_LINEAR  0
+#define DAC_RESAMPLER_SINC    1
+#define DAC_RESAMPLER_NATIVE  2
+
+static int16_t batch_out[4096];
+static size_t batch_pairs;
+
+static size_t capture_audio_batch(const int16_t *d, size_t f)
+{
+    if (batch_pairs + f <= sizeof(batch_out) / sizeof(batch_out[0]) / 2)
+        memcpy(&batch_out[batch_pairs * 2], d, f * 2 * sizeof(int16_t));
+    batch_pairs += f;
+    return f;
+}
+
 /* Clock constants */
 #define RISC_CLOCK_NTSC   26590906
 #define RISC_CLOCK_PAL    26593900
@@ -525,6 +556,154 @@ TEST(audio_48khz_pal_buffer_size)
     ASSERT_EQ(samples_per_frame, 960);
 }
 
+/* The 48 kHz output is rendered in one pass at frame end from the
+ * captured I2S stream.  Feed two frames of a ramp (L rising, R its
+ * negation) at the SCLK=19 word-strobe rate and check what the
+ * frontend gets: a full batch per frame, interpolated between captured
+ * values, never stepping back, and continuous across the frame seam --
+ * the read cursor carries over, so the seam looks like any other pair. */
+/* One NTSC field of a rising ramp at the SCLK=19 word strobe, L = -R,
+ * stepping `*value` by 8 per strobe.  Returns the strobes it took. */
+static int dac_ramp_frame(uint16_t *buf, int16_t *value)
+{
+    const uint64_t strobe = (uint64_t)(32 * 2 * 20) << EVENT_TICK_SHIFT;
+    uint64_t end;
+    int strobes = 0;
+
+    /* One NTSC field is ~16651 us; run past it in strobe steps and
+     * let SoundCallback keep the instants that fell inside. */
+    p_DACPrepareFrame(1600);
+    end = p_GetEventClock(EVENT_JERRY)
+        + ((uint64_t)(16651.0 / 0.03760684198) << EVENT_TICK_SHIFT);
+    while (p_GetEventClock(EVENT_JERRY) + strobe <= end)
+    {
+        p_AdvanceEventClock(strobe, EVENT_JERRY);
+        jerry_write(DAC_LTXD + 2, (uint16_t)*value);
+        jerry_write(DAC_RTXD + 2, (uint16_t)-*value);
+        p_DACWordStrobe();
+        *value += 8;
+        strobes++;
+    }
+    p_AdvanceEventClock(end - p_GetEventClock(EVENT_JERRY), EVENT_JERRY);
+    p_SoundCallback(NULL, buf, 1600);
+    return strobes;
+}
+
+TEST(dac_batch_render_ramp)
+{
+    static uint16_t buf[1600];
+    uint32_t resyncs;
+    int16_t value = 0;
+    int frame;
+    size_t i;
+
+    if (!p_DACReset || !p_DACPrepareFrame || !p_DACWordStrobe
+          || !p_SoundCallback || !p_GetEventClock || !p_AdvanceEventClock
+          || !p_DACGetI2SResyncCount)
+    {
+        ASSERT_TRUE(0 && "DAC frame symbols not exported");
+        return;
+    }
+
+    core.retro_set_audio_sample_batch(capture_audio_batch);
+    jerry_write(DAC_SMODE, SMODE_INTERNAL);
+    jerry_write(DAC_SCLK, 19);
+    jerry_write(DAC_LTXD + 2, 0);
+    jerry_write(DAC_RTXD + 2, 0);
+    p_DACReset();
+    batch_pairs = 0;
+
+    for (frame = 0; frame < 2; frame++)
+    {
+        resyncs = p_DACGetI2SResyncCount();
+        dac_ramp_frame(buf, &value);
+        ASSERT_EQ(p_DACGetI2SResyncCount(), resyncs);
+    }
+    core.retro_set_audio_sample_batch(tf_audio_sample_batch);
+
+    ASSERT_EQ(batch_pairs, 1600);
+    for (i = 1; i < 1600; i++)
+    {
+        int16_t l = batch_out[2 * i], prev = batch_out[2 * i - 2];
+
+        ASSERT_EQ(batch_out[2 * i + 1], -l);
+        /* ~0.43 captures per output pair at 8 per capture */
+        ASSERT_TRUE(l >= prev && l - prev <= 8);
+    }
+    ASSERT_TRUE(batch_out[2 * 1599] > 0 && batch_out[2 * 1599] < value);
+}
+
+/* The other two output paths over the same ramp.  The windowed sinc has
+ * unity DC gain and is linear phase, so a ramp comes out a ramp, only
+ * later; native rate hands over exactly the pairs the strobe latched. */
+TEST(dac_resampler_modes)
+{
+    static uint16_t buf[1600];
+    uint32_t resyncs;
+    int16_t value = 0;
+    int strobes, frame;
+    size_t i;
+
+    if (!p_DACReset || !p_DACPrepareFrame || !p_DACWordStrobe
+          || !p_SoundCallback || !p_GetEventClock || !p_AdvanceEventClock
+          || !p_DACGetI2SResyncCount || !p_DACSetResampler
+          || !p_DACGetI2SRate)
+    {
+        ASSERT_TRUE(0 && "DAC resampler symbols not exported");
+        return;
+    }
+
+    core.retro_set_audio_sample_batch(capture_audio_batch);
+    jerry_write(DAC_SMODE, SMODE_INTERNAL);
+    jerry_write(DAC_SCLK, 19);
+    jerry_write(DAC_LTXD + 2, 0);
+    jerry_write(DAC_RTXD + 2, 0);
+    p_DACReset();
+    p_DACSetResampler(DAC_RESAMPLER_SINC);
+    batch_pairs = 0;
+
+    resyncs = p_DACGetI2SResyncCount();
+    for (frame = 0; frame < 2; frame++)
+        dac_ramp_frame(buf, &value);
+    ASSERT_EQ(p_DACGetI2SResyncCount(), resyncs);
+    ASSERT_EQ(batch_pairs, 1600);
+    /* Past the filter's reach back to the ramp's start. */
+    for (i = 64; i < 1600; i++)
+    {
+        int16_t l = batch_out[2 * i], prev = batch_out[2 * i - 2];
+
+        ASSERT_TRUE(batch_out[2 * i + 1] + l >= -1
+                    && batch_out[2 * i + 1] + l <= 1);
+        ASSERT_TRUE(l >= prev - 1 && l - prev <= 9);
+    }
+    /* Seven ring samples (56 at 8 per sample) behind the linear path,
+     * which trails the newest capture by about two. */
+    ASSERT_TRUE(batch_out[2 * 1599] > value - 8 * 12
+                && batch_out[2 * 1599] < value - 8 * 6);
+
+    /* Native: the frame's captures verbatim, at the I2S rate. */
+    p_DACSetResampler(DAC_RESAMPLER_NATIVE);
+    batch_pairs = 0;
+    strobes = dac_ramp_frame(buf, &value);
+    ASSERT_EQ(batch_pairs, (size_t)strobes);
+    for (i = 0; i < batch_pairs; i++)
+    {
+        int16_t l = (int16_t)(value - 8 * (strobes - (int)i));
+
+        ASSERT_EQ(batch_out[2 * i], l);
+        ASSERT_EQ(batch_out[2 * i + 1], -l);
+    }
+    /* SCLK=19: RISC clock / (64 x 20), ~20.8 kHz NTSC */
+    ASSERT_TRUE(p_DACGetI2SRate() > 20700.0 && p_DACGetI2SRate() < 20850.0);
+
+    /* And back: the cursor was kept parked, so no resync. */
+    p_DACSetResampler(DAC_RESAMPLER_LINEAR);
+    resyncs = p_DACGetI2SResyncCount();
+    dac_ramp_frame(buf, &value);
+    ASSERT_EQ(p_DACGetI2SResyncCount(), resyncs);
+    core.retro_set_audio_sample_batch(tf_audio_sample_batch);
+}
+
 /* ================================================================== */
 /* JERRY Clock Divider Tests                                           */
 /* ================================================================== */
@@ -562,6 +741,15 @@ int main(int argc, char *argv[])
     if (!vj_core_load(&core)) return 1;
     vj_core_init(&core);
     if (core.JERRYInit) core.JERRYInit();
+    p_DACReset = dlsym(core.handle, "DACReset");
+    p_DACPrepareFrame = dlsym(core.handle, "DACPrepareFrame");
+    p_DACWordStrobe = dlsym(core.handle, "DACWordStrobe");
+    p_DACGetI2SResyncCount = dlsym(core.handle, "DACGetI2SResyncCount");
+    p_SoundCallback = dlsym(core.handle, "SoundCallback");
+    p_DACSetResampler = dlsym(core.handle, "DACSetResampler");
+    p_DACGetI2SRate = dlsym(core.handle, "DACGetI2SRate");
+    p_GetEventClock = dlsym(core.handle, "GetEventClock");
+    p_AdvanceEventClock = dlsym(core.handle, "AdvanceEventClock");
 
     /* JERRY PIT timers */
     RUN_TEST(pit1_prescaler_write_read);
@@ -611,6 +799,8 @@ int main(int argc, char *argv[])
     /* Buffer sizes */
     RUN_TEST(audio_48khz_buffer_size);
     RUN_TEST(audio_48khz_pal_buffer_size);
+    RUN_TEST(dac_batch_render_ramp);
+    RUN_TEST(dac_resampler_modes);
 
     /* Clock dividers */
     RUN_TEST(clk1_write);
@@ -10,6 +10,7 @@
 
 #include "test_framework.h"
 #include "mister_ground_truth.h"
+#include "settings.h"
 
 static struct vj_core core;
 
@@ -298,6 +299,268 @@ TEST(blit_zinc_write_read)
     ASSERT_EQ_U32(val, 0x00000001);
 }
 
+/* ================================================================== */
+/* Bulk Phrase Path Tests                                              */
+/* ================================================================== */
+
+/* Whole-phrase fills and copies skip the accurate engine's state machine.
+ * Each case runs twice from the same registers and RAM, once through the
+ * state machine and once through the bulk path, and the destination RAM,
+ * the register readback and the busy window charged to the bus must all
+ * agree.  Out-of-class blits must decline the bulk path. */
+
+#define BULK_RAM_BASE  0x040000
+#define BULK_RAM_SIZE  0x8000
+
+struct bulk_case {
+    uint32_t cmd;
+    uint32_t a1_flags, a1_pixel, a1_step;
+    uint32_t a2_flags, a2_pixel, a2_step;
+    uint32_t a1_base, a2_base;
+    uint32_t count;
+};
+
+struct bulk_result {
+    uint8_t  ram[BULK_RAM_SIZE];
+    uint16_t regs[0xA0 / 2];
+    uint32_t busy;
+};
+
+static void (*p_bulk_enable)(int);
+static void (*p_bulk_stats)(uint32_t *);
+static uint32_t (*p_timing_busy)(void);
+static struct bulk_result bulk_ref, bulk_out;
+
+static void bulk_fill_ram(uint32_t seed)
+{
+    uint8_t *ram = core.GetRamPtr();
+    uint32_t i;
+
+    for (i = 0; i < BULK_RAM_SIZE; i++) {
+        seed = seed * 1103515245u + 12345u;
+        ram[BULK_RAM_BASE + i] = (uint8_t)(seed >> 16);
+    }
+}
+
+static void bulk_run(const struct bulk_case *c, uint32_t seed, int bulk,
+                     struct bulk_result *r)
+{
+    uint8_t *ram = core.GetRamPtr();
+    unsigned i;
+
+    bulk_fill_ram(seed);
+    p_bulk_enable(bulk);
+
+    blit_write32(BLIT_A1_BASE, c->a1_base);
+    blit_write32(BLIT_A1_FLAGS, c->a1_flags);
+    blit_write32(BLIT_A1_CLIP, 0);
+    blit_write32(BLIT_A1_PIXEL, c->a1_pixel);
+    blit_write32(BLIT_A1_STEP, c->a1_step);
+    blit_write32(BLIT_A1_FSTEP, 0);
+    blit_write32(BLIT_A1_FPIXEL, 0);
+    blit_write32(BLIT_A1_INC, 0);
+    blit_write32(BLIT_A1_FINC, 0);
+    blit_write32(BLIT_A2_BASE, c->a2_base);
+    blit_write32(BLIT_A2_FLAGS, c->a2_flags);
+    blit_write32(BLIT_A2_MASK, 0);
+    blit_write32(BLIT_A2_PIXEL, c->a2_pixel);
+    blit_write32(BLIT_A2_STEP, c->a2_step);
+    blit_write32(BLIT_B_PATD, 0x01234567 ^ seed);
+    blit_write32(BLIT_B_PATD + 4, 0x89ABCDEF + seed);
+    blit_write32(BLIT_B_COUNT, c->count);
+    blit_write32(BLIT_B_CMD, c->cmd);
+    /* Read before any other register access consumes the window. */
+    r->busy = p_timing_busy();
+
+    memcpy(r->ram, ram + BULK_RAM_BASE, BULK_RAM_SIZE);
+    for (i = 0; i < 0xA0 / 2; i++)
+        r->regs[i] = blit_read(BLIT_A1_BASE + i * 2);
+    p_bulk_enable(1);
+}
+
+/* Returns the number of blits the bulk path took for this case. */
+static uint32_t bulk_compare(const struct bulk_case *c, uint32_t seed,
+                             int *ram_off, int *reg_off)
+{
+    uint32_t before, after;
+    int i;
+
+    bulk_run(c, seed, 0, &bulk_ref);
+    p_bulk_stats(&before);
+    bulk_run(c, seed, 1, &bulk_out);
+    p_bulk_stats(&after);
+
+    *ram_off = -1;
+    *reg_off = -1;
+    for (i = 0; i < BULK_RAM_SIZE; i++) {
+        if (bulk_ref.ram[i] != bulk_out.ram[i]) {
+            *ram_off = i;
+            break;
+        }
+    }
+    for (i = 0; i < 0xA0 / 2; i++) {
+        if (bulk_ref.regs[i] != bulk_out.regs[i]) {
+            *reg_off = i * 2;
+            break;
+        }
+    }
+    if (bulk_ref.busy != bulk_out.busy)
+        *reg_off = 0x1000;
+    return after - before;
+}
+
+#define BULK_CHECK(c, seed, want_bulk) \
+    do { \
+        int _ram, _reg; \
+        uint32_t _n = bulk_compare(&(c), (seed), &_ram, &_reg); \
+        if (_ram >= 0) \
+            FAIL("cmd %08X: RAM differs at +0x%X", (c).cmd, (unsigned)_ram); \
+        if (_reg == 0x1000) \
+            FAIL("cmd %08X: busy %u vs %u", (c).cmd, bulk_ref.busy, bulk_out.busy); \
+        if (_reg >= 0) \
+            FAIL("cmd %08X: register +0x%02X reads %04X vs %04X", (c).cmd, \
+                 (unsigned)_reg, bulk_ref.regs[_reg / 2], bulk_out.regs[_reg / 2]); \
+        ASSERT_EQ(_n, (want_bulk) ? 1 : 0); \
+    } while (0)
+
+/* Phrase mode (XADDPHR), pitch 1, given pixel size and width code. */
+#define BULK_FLAGS(pixsize, width) (((width) << 9) | ((pixsize) << 3))
+
+TEST(blit_bulk_fill_depths)
+{
+    struct bulk_case c;
+    uint32_t px;
+
+    memset(&c, 0, sizeof(c));
+    c.cmd = BLIT_PATDSEL;
+    c.a1_base = BULK_RAM_BASE;
+    for (px = 3; px <= 5; px++) {
+        c.a1_flags = BULK_FLAGS(px, 24);            /* 64 pixels wide */
+        c.a1_pixel = 0x00020000;                    /* (0,2) */
+        c.count = 0x00010000 | (px == 5 ? 16 : 32);
+        BULK_CHECK(c, px, 1);
+    }
+}
+
+TEST(blit_bulk_fill_multiline)
+{
+    struct bulk_case c;
+
+    memset(&c, 0, sizeof(c));
+    c.cmd = BLIT_PATDSEL | BLIT_UPDA1;
+    c.a1_base = BULK_RAM_BASE;
+    c.a1_flags = BULK_FLAGS(4, 24);
+    c.a1_pixel = 0x00010008;                        /* (8,1) */
+    c.a1_step = 0x0001FFE0;                         /* next line, x -= 32 */
+    c.count = 0x00100020;                           /* 16 lines of 32 */
+    BULK_CHECK(c, 7, 1);
+}
+
+TEST(blit_bulk_copy_depths)
+{
+    struct bulk_case c;
+    uint32_t px;
+
+    memset(&c, 0, sizeof(c));
+    c.a1_base = BULK_RAM_BASE;
+    c.a2_base = BULK_RAM_BASE + 0x4000;
+    for (px = 3; px <= 5; px++) {
+        c.cmd = BLIT_SRCEN | BLIT_UPDA1 | BLIT_UPDA2 | 0x01800000;
+        c.a1_flags = BULK_FLAGS(px, 24);
+        c.a2_flags = BULK_FLAGS(px, 24);
+        c.a1_pixel = 0x00000000;
+        c.a2_pixel = 0x00030000;
+        c.a1_step = 0x0001FFF0;
+        c.a2_step = 0x0001FFF0;
+        c.count = 0x00080010;                       /* 8 lines of 16 */
+        BULK_CHECK(c, 11 + px, 1);
+        c.cmd |= BLIT_SRCENX;
+        BULK_CHECK(c, 17 + px, 1);
+    }
+}
+
+TEST(blit_bulk_copy_overlap)
+{
+    struct bulk_case c;
+
+    /* Destination one phrase ahead of the source in the same window: the
+     * state machine reads each phrase before the write that clobbers it. */
+    memset(&c, 0, sizeof(c));
+    c.cmd = BLIT_SRCEN | 0x01800000;
+    c.a1_base = BULK_RAM_BASE;
+    c.a2_base = BULK_RAM_BASE;
+    c.a1_flags = BULK_FLAGS(4, 24);
+    c.a2_flags = BULK_FLAGS(4, 24);
+    c.a1_pixel = 0x00000004;
+    c.count = 0x00010040;
+    BULK_CHECK(c, 23, 1);
+
+    /* And one phrase behind. */
+    c.a1_pixel = 0x00000000;
+    c.a2_pixel = 0x00000004;
+    BULK_CHECK(c, 29, 1);
+}
+
+TEST(blit_bulk_random)
+{
+    struct bulk_case c;
+    uint32_t seed = 0x5EED;
+    unsigned n;
+
+    for (n = 0; n < 48; n++) {
+        uint32_t px, ppp, lines, phrases;
+
+        seed = seed * 1664525u + 1013904223u;
+        px = 3 + (seed >> 8) % 3;
+        ppp = 64 >> px;
+        lines = 1 + (seed >> 12) % 6;
+        phrases = 1 + (seed >> 16) % 6;
+
+        memset(&c, 0, sizeof(c));
+        c.a1_base = BULK_RAM_BASE;
+        c.a2_base = BULK_RAM_BASE + ((seed >> 20) & 7) * 0x400;
+        c.a1_flags = BULK_FLAGS(px, 24);
+        c.a2_flags = BULK_FLAGS(px, 24);
+        c.a1_pixel = (((seed >> 4) & 3) << 16) | (((seed >> 2) & 3) * ppp);
+        c.a2_pixel = (((seed >> 6) & 3) << 16) | (((seed >> 9) & 3) * ppp);
+        c.a1_step = 0x00010000 | (uint16_t)-(int)(phrases * ppp);
+        c.a2_step = c.a1_step;
+        c.count = (lines << 16) | (phrases * ppp);
+        if (seed & 0x80000000)
+            c.cmd = BLIT_PATDSEL | BLIT_UPDA1;
+        else
+            c.cmd = BLIT_SRCEN | BLIT_UPDA1 | BLIT_UPDA2 | 0x01800000
+                  | ((seed & 0x40000000) ? BLIT_SRCENX : 0);
+        BULK_CHECK(c, seed, 1);
+    }
+}
+
+TEST(blit_bulk_declines)
+{
+    struct bulk_case c;
+
+    memset(&c, 0, sizeof(c));
+    c.cmd = BLIT_PATDSEL;
+    c.a1_base = BULK_RAM_BASE;
+    c.a1_flags = BULK_FLAGS(4, 24);
+    c.count = 0x00010020;
+
+    c.a1_pixel = 0x00000002;                        /* starts mid-phrase */
+    BULK_CHECK(c, 31, 0);
+
+    c.a1_pixel = 0;
+    c.count = 0x0001001E;                           /* ends mid-phrase */
+    BULK_CHECK(c, 37, 0);
+
+    c.count = 0x00010020;
+    c.a1_flags = BULK_FLAGS(4, 24) | 1;              /* pitch 2 */
+    BULK_CHECK(c, 41, 0);
+
+    c.a1_flags = BULK_FLAGS(4, 24);
+    c.cmd = BLIT_PATDSEL | BLIT_DSTEN;              /* reads the destination */
+    BULK_CHECK(c, 43, 0);
+}
+
 /* ================================================================== */
 /* Main                                                                */
 /* ================================================================== */
@@ -341,6 +604,23 @@ int main(int argc, char *argv[])
     RUN_TEST(blit_iinc_write_read);
     RUN_TEST(blit_zinc_write_read);
 
+    /* Bulk phrase path against the state machine */
+    p_bulk_enable = (void (*)(int))dlsym(core.handle, "BlitterBulkEnable");
+    p_bulk_stats = (void (*)(uint32_t *))dlsym(core.handle, "BlitterBulkStats");
+    p_timing_busy = (uint32_t (*)(void))dlsym(core.handle, "BlitterTimingGetBusy");
+    if (p_bulk_enable && p_bulk_stats && p_timing_busy && core.vjs) {
+        ((struct VJSettings *)core.vjs)->useFastBlitter = false;
+        ((struct VJSettings *)core.vjs)->blitterTiming = true;
+        RUN_TEST(blit_bulk_fill_depths);
+        RUN_TEST(blit_bulk_fill_multiline);
+        RUN_TEST(blit_bulk_copy_depths);
+        RUN_TEST(blit_bulk_copy_overlap);
+        RUN_TEST(blit_bulk_random);
+        RUN_TEST(blit_bulk_declines);
+    } else {
+        SKIP_TEST(blit_bulk_fill_depths, "core lacks BlitterBulk exports");
+    }
+
     vj_core_unload(&core);
     return TEST_REPORT();
 }
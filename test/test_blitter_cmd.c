@@ -47,6 +47,10 @@
  * reason the regression survived.  They are worth having on their own
  * merits.
  *
+ * test_specialised_matches_generic() runs two hot command signatures
+ * through their specialised loop instances and again through the generic
+ * loop, and requires identical output.
+ *
  * BOTH BLITTERS
  * =============
  * The output vectors run twice, against blitter_blit() (the fast blitter)
@@ -788,6 +792,95 @@ static void test_cmd_decode_reaches_savestate(void)
       "blitter command");
 }
 
+/* ================================================================
+ * Vector 7 -- specialised instances match the generic loop
+ *
+ * Both blitters dispatch hot command signatures to instances of their
+ * inner loop compiled with the command word and address modes folded in
+ * (BlitterSpecialiseEnable in src/tom/blitter.c).  Each case here is one
+ * of those signatures; it runs specialised, then again from the same
+ * starting RAM with specialisation off, and the destination must match
+ * byte for byte.  The hit counter proves the first run really took an
+ * instance -- a signature that silently drops out of the table would
+ * otherwise pass by comparing the generic loop with itself.  The bulk
+ * phrase path (BlitterBulkEnable) would take both cases on the accurate
+ * engine before the lookup, so it is off for the duration.
+ * ================================================================ */
+
+static void (*p_BlitterSpecialiseEnable)(int);
+static void (*p_BlitterSpecialiseStats)(uint32_t *, uint32_t *);
+static void (*p_BlitterBulkEnable)(int);
+
+static void setup_phrase_copy(void)
+{
+   setup_16bpp_copy(XADD_PHRASE);
+   wreg(PIXLINECOUNTER, (1u << 16) | 16u);
+}
+
+static void setup_pattern_fill(void)
+{
+   blit_regs_reset();
+
+   ram_pattern(DST_ADDR, WINDOW, 0x3C, 0x05);
+
+   wreg(A1_BASE,  DST_ADDR);
+   wreg(A1_FLAGS, FLAG_PIXSIZE(PIXSIZE_16BPP) |
+                  FLAG_WIDTH(WIDTH8_M, WIDTH8_E) |
+                  FLAG_XADD(XADD_PHRASE));
+   wreg(A2_BASE,  SRC_ADDR);
+   wreg(A2_FLAGS, FLAG_PIXSIZE(PIXSIZE_16BPP) |
+                  FLAG_WIDTH(WIDTH8_M, WIDTH8_E) |
+                  FLAG_XADD(XADD_PHRASE));
+   wreg(B_PATD,     0x12345678);
+   wreg(B_PATD + 4, 0x9ABCDEF0);
+   wreg(PIXLINECOUNTER, (2u << 16) | 12u);
+}
+
+static void check_specialised(const char *name, void (*setup)(void),
+                              uint32_t cmd)
+{
+   uint8_t  spec[WINDOW];
+   uint32_t hits0, hits1, misses;
+   char     label[96];
+   char     detail[160];
+
+   snprintf(label, sizeof(label), "%s [%s]", name, blit_mode_name[blit_mode]);
+
+   if (p_BlitterBulkEnable)
+      p_BlitterBulkEnable(0);
+   p_BlitterSpecialiseEnable(1);
+   p_BlitterSpecialiseStats(&hits0, &misses);
+   setup();
+   fire(cmd);
+   p_BlitterSpecialiseStats(&hits1, &misses);
+   memcpy(spec, p_jaguarMainRAM + DST_ADDR, WINDOW);
+
+   p_BlitterSpecialiseEnable(0);
+   setup();
+   fire(cmd);
+   p_BlitterSpecialiseEnable(1);
+   if (p_BlitterBulkEnable)
+      p_BlitterBulkEnable(1);
+
+   snprintf(detail, sizeof(detail),
+            "B_CMD %08X did not reach a specialised instance", (unsigned)cmd);
+   check_true(label, hits1 == hits0 + 1, detail);
+
+   snprintf(label, sizeof(label), "%s_output [%s]", name,
+            blit_mode_name[blit_mode]);
+   check_true(label, memcmp(spec, p_jaguarMainRAM + DST_ADDR, WINDOW) == 0,
+              "the specialised instance wrote different bytes than the "
+              "generic loop");
+}
+
+static void test_specialised_matches_generic(void)
+{
+   check_specialised("spec_phrase_copy", setup_phrase_copy,
+                     C_SRCEN | C_LFU_AN | C_LFU_A);
+   check_specialised("spec_pattern_fill", setup_pattern_fill,
+                     C_PATDSEL | C_UPDA1);
+}
+
 /* ================================================================
  * Synthetic ROM
  *
@@ -871,6 +964,9 @@ int main(int argc, char **argv)
    p_retro_serialize      = harness_dlsym(&cfg, "retro_serialize");
    p_BlitterCompareEnable = harness_dlsym(&cfg, "BlitterCompareEnable");
    p_vjs                  = harness_dlsym(&cfg, "vjs");
+   p_BlitterSpecialiseEnable = harness_dlsym(&cfg, "BlitterSpecialiseEnable");
+   p_BlitterSpecialiseStats  = harness_dlsym(&cfg, "BlitterSpecialiseStats");
+   p_BlitterBulkEnable       = harness_dlsym(&cfg, "BlitterBulkEnable");
 
    /* jaguarMainRAM is `uint8_t *`, so the symbol is the pointer variable
     * itself -- dereference to reach the 2 MB main RAM block. */
@@ -879,7 +975,8 @@ int main(int argc, char **argv)
 
    if (!p_JaguarWriteLong || !p_jaguarMainRAM || !p_vjs ||
        !p_retro_serialize_size || !p_retro_serialize ||
-       !p_BlitterCompareEnable)
+       !p_BlitterCompareEnable || !p_BlitterSpecialiseEnable ||
+       !p_BlitterSpecialiseStats)
    {
       fprintf(stderr,
          "FAIL: required core symbols missing -- build with TEST_EXPORTS=1\n");
@@ -901,6 +998,8 @@ int main(int argc, char **argv)
       test_lfu_ops();
       test_pitch();
       test_gouraud_output();
+      if (!recording)
+         test_specialised_matches_generic();
    }
 
    /* Decode guards: fast path only (see the enum comment up top). */
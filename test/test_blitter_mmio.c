@@ -37,6 +37,9 @@ void TexDumpLaunch(void) {}
 int texReplaceEnabled = 0;               /* texture replacement off */
 int TexReplacePreBlit(void) { return 0; }
 void TexReplacePostBlit(void) {}
+int perf_timing_armed = 0;               /* host timing regions disarmed */
+void perf_timing_enter(int region) { (void)region; }
+void perf_timing_leave(void) {}
 
 /* Blitter bus-time model dependencies (vjs.blitterTiming stays 0 in the
  * stub settings above, so the timing path short-circuits; these only
@@ -66,6 +66,7 @@ typedef struct CDBootStrategy {
     const char *name;
     void *boot;
     void *instruction_hook;
+    void *register_hooks;
     void *reset;
 } CDBootStrategy;
 
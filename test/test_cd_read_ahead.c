@@ -0,0 +1,560 @@
+/*
+ * test_cd_read_ahead.c -- sector read-ahead cache and track lookup in
+ * cdintf.c, pinned against SYNTHETIC disc images.
+ *
+ * CDIntfReadBlock() serves sectors from a cache a worker thread fills
+ * ahead of each read cursor (virtualjaguar_cd_read_ahead), and finds the
+ * sector's track with a binary search over runs built at open time.  Both
+ * must be invisible: every read returns the bytes and pregap flag the
+ * image itself gives.  This test builds its own discs, so it runs
+ * anywhere:
+ *
+ *   multi   four BINs, tracks 40/30 sectors in session 1 and 50/20 in
+ *           session 2, so the 11400-sector inter-session gap sits
+ *           between them (reads there are synthesized silence)
+ *   single  the same four tracks back to back in one BIN
+ *
+ * plus the committed test/roms/synth_jagcd.chd for the CHD reader.  Every
+ * sector byte is derived from (track, sector, offset), so a sector from
+ * the wrong track or the wrong cache slot cannot pass.
+ *
+ * Invariants pinned:
+ *
+ *   1. Track lookup     -- every LBA reports the track the layout puts
+ *                          it in (Q position), gaps report none.
+ *   2. Same bytes       -- sequential, two interleaved cursors (data
+ *                          and audio head), random seeks and re-reads
+ *                          all return what the image holds, with the
+ *                          same pregap flag, read-ahead on or off.
+ *   3. Reads ahead      -- a paced sequential read is served from the
+ *                          cache after the first sector (SKIPs where the
+ *                          core is built without threads).
+ *   4. Teardown         -- closing and reopening while the worker is
+ *                          busy, and toggling it between reads, is safe.
+ *
+ * Build: make test/test_cd_read_ahead     (needs TEST_EXPORTS=1)
+ * Run:   DYLD_LIBRARY_PATH=. test/test_cd_read_ahead
+ */
+
+#define _DEFAULT_SOURCE 1   /* usleep under -std=c99 on glibc */
+
+#include "test_framework.h"
+#include "../libretro-common/include/libretro.h"
+
+#include <unistd.h>
+#include <sys/stat.h>
+
+static struct vj_core C;
+
+/* ------------------------------------------------------------------ */
+/* Core internals resolved by dlsym                                     */
+/* ------------------------------------------------------------------ */
+
+static bool     (*p_open)(const char *);
+static void     (*p_close)(void);
+static bool     (*p_read)(uint32_t, uint8_t *);
+static bool     (*p_last_pregap)(void);
+static bool     (*p_qpos)(uint32_t, uint32_t *, uint32_t *, uint32_t *, bool *);
+static uint32_t (*p_total)(void);
+static void     (*p_set_read_ahead)(bool);
+static void     (*p_prefetch)(uint32_t);
+static void     (*p_stats)(uint64_t *, uint64_t *);
+
+/* ------------------------------------------------------------------ */
+/* Synthetic discs                                                      */
+/* ------------------------------------------------------------------ */
+
+#define SECTOR_BYTES      2352u
+#define NUM_TRACKS        4u
+#define INTER_SESSION_GAP 11400u
+
+static const uint32_t trackSectors[NUM_TRACKS] = { 40, 30, 50, 20 };
+
+/* Disc LBA of each track's first sector, per image (filled by make_*). */
+static uint32_t multiStart[NUM_TRACKS];
+static uint32_t singleStart[NUM_TRACKS];
+
+static uint8_t sector_byte(uint32_t track, uint32_t sector, uint32_t off)
+{
+    return (uint8_t)(track * 37u + sector * 13u + off * 7u + (off >> 8));
+}
+
+static void fill_sector(uint8_t *out, uint32_t track, uint32_t sector)
+{
+    uint32_t i;
+    for (i = 0; i < SECTOR_BYTES; i++)
+        out[i] = sector_byte(track, sector, i);
+}
+
+static bool write_track(FILE *f, uint32_t track)
+{
+    uint8_t sec[SECTOR_BYTES];
+    uint32_t s;
+
+    for (s = 0; s < trackSectors[track]; s++)
+    {
+        fill_sector(sec, track, s);
+        if (fwrite(sec, 1, sizeof(sec), f) != sizeof(sec))
+            return false;
+    }
+    return true;
+}
+
+/* Four BINs, tracks 1-2 in session 1 and 3-4 in session 2. */
+static bool make_multi(const char *dir, char *cueOut, size_t cueOutLen)
+{
+    char path[1024];
+    FILE *f;
+    uint32_t t, lba = 0;
+
+    for (t = 0; t < NUM_TRACKS; t++)
+    {
+        snprintf(path, sizeof(path), "%s/track%02u.bin", dir, t + 1);
+        f = fopen(path, "wb");
+        if (!f || !write_track(f, t))
+        {
+            if (f) fclose(f);
+            return false;
+        }
+        fclose(f);
+        if (t == 2)
+            lba += INTER_SESSION_GAP;
+        multiStart[t] = lba;
+        lba += trackSectors[t];
+    }
+
+    snprintf(cueOut, cueOutLen, "%s/multi.cue", dir);
+    f = fopen(cueOut, "wb");
+    if (!f)
+        return false;
+    fprintf(f,
+            "REM SESSION 01\n"
+            "FILE \"track01.bin\" BINARY\n"
+            "  TRACK 01 AUDIO\n"
+            "    INDEX 01 00:00:00\n"
+            "FILE \"track02.bin\" BINARY\n"
+            "  TRACK 02 AUDIO\n"
+            "    INDEX 01 00:00:00\n"
+            "REM SESSION 02\n"
+            "FILE \"track03.bin\" BINARY\n"
+            "  TRACK 03 AUDIO\n"
+            "    INDEX 01 00:00:00\n"
+            "FILE \"track04.bin\" BINARY\n"
+            "  TRACK 04 AUDIO\n"
+            "    INDEX 01 00:00:00\n");
+    fclose(f);
+    return true;
+}
+
+/* The same four tracks back to back in one BIN, one session. */
+static bool make_single(const char *dir, char *cueOut, size_t cueOutLen)
+{
+    char path[1024];
+    FILE *f;
+    uint32_t t, lba = 0;
+
+    snprintf(path, sizeof(path), "%s/single.bin", dir);
+    f = fopen(path, "wb");
+    if (!f)
+        return false;
+    for (t = 0; t < NUM_TRACKS; t++)
+    {
+        if (!write_track(f, t))
+        {
+            fclose(f);
+            return false;
+        }
+        singleStart[t] = lba;
+        lba += trackSectors[t];
+    }
+    fclose(f);
+
+    snprintf(cueOut, cueOutLen, "%s/single.cue", dir);
+    f = fopen(cueOut, "wb");
+    if (!f)
+        return false;
+    fprintf(f, "FILE \"single.bin\" BINARY\n");
+    for (t = 0; t < NUM_TRACKS; t++)
+        fprintf(f, "  TRACK %02u AUDIO\n    INDEX 01 %02u:%02u:%02u\n",
+                t + 1, singleStart[t] / 4500u, (singleStart[t] / 75u) % 60u,
+                singleStart[t] % 75u);
+    fclose(f);
+    return true;
+}
+
+/* Track (0-based) a layout puts lba in, or -1. */
+static int layout_track(const uint32_t *start, uint32_t lba)
+{
+    uint32_t t;
+    for (t = 0; t < NUM_TRACKS; t++)
+        if (lba >= start[t] && lba < start[t] + trackSectors[t])
+            return (int)t;
+    return -1;
+}
+
+/* ------------------------------------------------------------------ */
+/* Reference reads                                                      */
+/* ------------------------------------------------------------------ */
+
+/* What the image holds at every LBA below `count`, read with the cache
+ * off: the comparison for every pattern below. */
+struct ref_disc {
+    uint32_t count;
+    uint8_t *data;
+    bool *pregap;
+};
+
+static bool ref_capture(struct ref_disc *ref, const char *path, uint32_t count)
+{
+    uint32_t lba;
+
+    p_set_read_ahead(false);
+    if (!p_open(path))
+        return false;
+    ref->count  = count;
+    ref->data   = (uint8_t *)malloc((size_t)count * SECTOR_BYTES);
+    ref->pregap = (bool *)malloc(count * sizeof(bool));
+    if (!ref->data || !ref->pregap)
+        return false;
+    for (lba = 0; lba < count; lba++)
+    {
+        if (!p_read(lba, ref->data + (size_t)lba * SECTOR_BYTES))
+            return false;
+        ref->pregap[lba] = p_last_pregap();
+    }
+    p_close();
+    return true;
+}
+
+static void ref_free(struct ref_disc *ref)
+{
+    free(ref->data);
+    free(ref->pregap);
+    memset(ref, 0, sizeof(*ref));
+}
+
+/* One read through the cache, checked against the reference. */
+static bool read_matches(const struct ref_disc *ref, uint32_t lba)
+{
+    uint8_t sec[SECTOR_BYTES];
+
+    if (!p_read(lba, sec))
+    {
+        fprintf(stderr, "    read of LBA %u failed\n", lba);
+        return false;
+    }
+    if (memcmp(sec, ref->data + (size_t)lba * SECTOR_BYTES, SECTOR_BYTES) != 0)
+    {
+        fprintf(stderr, "    LBA %u: bytes differ from the image\n", lba);
+        return false;
+    }
+    if (p_last_pregap() != ref->pregap[lba])
+    {
+        fprintf(stderr, "    LBA %u: pregap flag %d, image says %d\n",
+                lba, p_last_pregap(), ref->pregap[lba]);
+        return false;
+    }
+    return true;
+}
+
+static uint32_t rng_state = 0x2468ACE1u;
+
+static uint32_t rng(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+/* Sequential, two interleaved cursors, random seeks with short runs and
+ * re-reads, all with the cache on. */
+static bool patterns_match(const struct ref_disc *ref, const char *path)
+{
+    uint32_t i, lba, a, b;
+
+    p_set_read_ahead(true);
+    if (!p_open(path))
+        return false;
+
+    for (lba = 0; lba < ref->count; lba++)
+        if (!read_matches(ref, lba))
+            return false;
+
+    /* cdrom.c's data head and SSI audio head, far apart on the disc. */
+    a = 0;
+    b = ref->count / 2;
+    for (i = 0; i < 400; i++)
+    {
+        if (!read_matches(ref, a % ref->count) ||
+            !read_matches(ref, b % ref->count))
+            return false;
+        a++;
+        b++;
+        if (i % 50 == 49)
+            usleep(200);
+    }
+
+    for (i = 0; i < 300; i++)
+    {
+        uint32_t run = rng() % 12, k;
+
+        lba = rng() % ref->count;
+        if (i % 3 == 0)
+            p_prefetch(lba);
+        for (k = 0; k <= run && lba + k < ref->count; k++)
+            if (!read_matches(ref, lba + k))
+                return false;
+        if (!read_matches(ref, lba))        /* re-read */
+            return false;
+    }
+
+    p_close();
+    return true;
+}
+
+/* ------------------------------------------------------------------ */
+/* Tests                                                                */
+/* ------------------------------------------------------------------ */
+
+static char multiCue[1024];
+static char singleCue[1024];
+
+TEST(track_lookup)
+{
+    uint32_t lba, total, num, idx, rel;
+    bool data;
+    uint8_t sec[SECTOR_BYTES], want[SECTOR_BYTES];
+
+    p_set_read_ahead(false);
+    ASSERT_TRUE(p_open(multiCue));
+    total = multiStart[NUM_TRACKS - 1] + trackSectors[NUM_TRACKS - 1];
+
+    /* Past the last track too: those LBAs belong to no track either. */
+    for (lba = 0; lba < total + 64; lba++)
+    {
+        int t = layout_track(multiStart, lba);
+        bool found = p_qpos(lba, &num, &idx, &rel, &data);
+
+        if (t < 0)
+        {
+            if (found)
+                FAIL("LBA %u is in no track, Q position says track %u", lba, num);
+            ASSERT_TRUE(p_read(lba, sec));
+            ASSERT_TRUE(p_last_pregap());
+            continue;
+        }
+        if (!found || num != (uint32_t)t + 1)
+            FAIL("LBA %u: expected track %d, got %s%u", lba, t + 1,
+                 found ? "" : "none ", found ? num : 0);
+        ASSERT_TRUE(p_read(lba, sec));
+        ASSERT_FALSE(p_last_pregap());
+        fill_sector(want, (uint32_t)t, lba - multiStart[t]);
+        if (memcmp(sec, want, SECTOR_BYTES) != 0)
+            FAIL("LBA %u: not sector %u of track %d", lba,
+                 lba - multiStart[t], t + 1);
+    }
+    p_close();
+}
+
+TEST(reads_match_image)
+{
+    static const char *const chd = "test/roms/synth_jagcd.chd";
+    const char *paths[3];
+    uint32_t counts[3];
+    uint32_t i;
+
+    paths[0]  = multiCue;
+    counts[0] = multiStart[NUM_TRACKS - 1] + trackSectors[NUM_TRACKS - 1] + 40;
+    paths[1]  = singleCue;
+    counts[1] = singleStart[NUM_TRACKS - 1] + trackSectors[NUM_TRACKS - 1] + 40;
+    paths[2]  = chd;
+    counts[2] = 0;
+
+    p_set_read_ahead(false);
+    if (p_open(chd))
+    {
+        counts[2] = p_total() + 40;
+        p_close();
+    }
+
+    for (i = 0; i < 3; i++)
+    {
+        struct ref_disc ref;
+
+        if (counts[i] == 0)
+            FAIL("%s did not open", paths[i]);
+        memset(&ref, 0, sizeof(ref));
+        if (!ref_capture(&ref, paths[i], counts[i]))
+        {
+            ref_free(&ref);
+            FAIL("reference read of %s failed", paths[i]);
+        }
+        if (!patterns_match(&ref, paths[i]))
+        {
+            ref_free(&ref);
+            FAIL("%s: a read through the cache differs from the image", paths[i]);
+        }
+        ref_free(&ref);
+        fprintf(stderr, "    %s: %u sectors match\n", paths[i], counts[i]);
+    }
+}
+
+TEST(reads_ahead_of_sequential_reads)
+{
+    uint64_t h0, m0, h1, m1;
+    uint32_t lba, first = multiStart[2], n = trackSectors[2];
+    uint8_t sec[SECTOR_BYTES];
+
+    p_set_read_ahead(true);
+    ASSERT_TRUE(p_open(multiCue));
+    p_stats(&h0, &m0);
+
+    /* The drive's pace is ~150 sectors/s; 1 ms apart is far faster and
+     * still leaves the worker time to stay ahead. */
+    p_prefetch(first);
+    usleep(5000);
+    for (lba = first; lba < first + n; lba++)
+    {
+        ASSERT_TRUE(p_read(lba, sec));
+        usleep(1000);
+    }
+    p_stats(&h1, &m1);
+    p_close();
+
+    if (h1 + m1 == h0 + m0)
+    {
+        SKIP_TEST(reads_ahead_of_sequential_reads,
+                  "core built without threads: no read-ahead worker");
+        return;
+    }
+    fprintf(stderr, "    %u paced reads: %llu hits, %llu misses\n", n,
+            (unsigned long long)(h1 - h0), (unsigned long long)(m1 - m0));
+    ASSERT_EQ(h1 - h0 + m1 - m0, n);
+    if (m1 - m0 > n / 5)
+        FAIL("read-ahead served only %llu of %u sequential reads",
+             (unsigned long long)(h1 - h0), n);
+}
+
+TEST(teardown_while_busy)
+{
+    struct ref_disc ref;
+    uint32_t i, count = singleStart[NUM_TRACKS - 1] + trackSectors[NUM_TRACKS - 1];
+
+    memset(&ref, 0, sizeof(ref));
+    ASSERT_TRUE(ref_capture(&ref, singleCue, count));
+
+    p_set_read_ahead(true);
+    for (i = 0; i < 50; i++)
+    {
+        if (!p_open(i & 1 ? singleCue : multiCue))
+        {
+            ref_free(&ref);
+            FAIL("open %u failed", i);
+        }
+        p_prefetch(rng() % 100);
+        p_close();
+    }
+
+    if (!p_open(singleCue))
+    {
+        ref_free(&ref);
+        FAIL("reopen failed");
+    }
+    for (i = 0; i < count; i++)
+    {
+        if (i % 16 == 0)
+            p_set_read_ahead(i % 32 == 0);
+        if (!read_matches(&ref, i))
+        {
+            ref_free(&ref);
+            FAIL("read %u after a toggle differs", i);
+        }
+    }
+    p_close();
+    p_set_read_ahead(true);
+    ref_free(&ref);
+}
+
+/* ------------------------------------------------------------------ */
+
+static bool env_cb(unsigned cmd, void *data)
+{
+    if (cmd == RETRO_ENVIRONMENT_GET_SYSTEM_DIRECTORY) {
+        *(const char **)data = ".";
+        return true;
+    }
+    if (cmd == RETRO_ENVIRONMENT_SET_PIXEL_FORMAT) return true;
+    return false;
+}
+
+static void vcb(const void *d, unsigned w, unsigned h, size_t p)
+{ (void)d; (void)w; (void)h; (void)p; }
+static void acb(int16_t l, int16_t r) { (void)l; (void)r; }
+static size_t abcb(const int16_t *d, size_t f) { (void)d; return f; }
+static void ipcb(void) {}
+static int16_t iscb(unsigned p, unsigned d, unsigned i, unsigned id)
+{ (void)p; (void)d; (void)i; (void)id; return 0; }
+
+#define RESOLVE(var, name) \
+    (*(void **)&(var) = dlsym(C.handle, (name)))
+
+int main(int argc, char *argv[])
+{
+    char base[512];
+
+    (void)argc; (void)argv;
+
+    TEST_INIT("CD read-ahead");
+
+    if (!vj_core_load(&C)) {
+        fprintf(stderr, "FATAL: failed to load core\n");
+        return 1;
+    }
+
+    if (!RESOLVE(p_open, "CDIntfOpenImage") ||
+        !RESOLVE(p_close, "CDIntfCloseImage") ||
+        !RESOLVE(p_read, "CDIntfReadBlock") ||
+        !RESOLVE(p_last_pregap, "CDIntfLastReadWasVirtualPregap") ||
+        !RESOLVE(p_qpos, "CDIntfGetQPosition") ||
+        !RESOLVE(p_total, "CDIntfGetDiscTotalSectors") ||
+        !RESOLVE(p_set_read_ahead, "CDIntfSetReadAhead") ||
+        !RESOLVE(p_prefetch, "CDIntfPrefetch") ||
+        !RESOLVE(p_stats, "CDIntfReadAheadStats"))
+    {
+        fprintf(stderr, "FATAL: core lacks the CDIntf test exports "
+                "(build with TEST_EXPORTS=1)\n");
+        return 1;
+    }
+
+    C.retro_set_environment(env_cb);
+    C.retro_set_video_refresh(vcb);
+    C.retro_set_audio_sample(acb);
+    C.retro_set_audio_sample_batch(abcb);
+    C.retro_set_input_poll(ipcb);
+    C.retro_set_input_state(iscb);
+    C.retro_init();
+
+    /* Per-process scratch dir, as test_cd_pregap does. */
+    snprintf(base, sizeof(base), "/tmp/vj_cd_read_ahead_%ld", (long)getpid());
+    mkdir(base, 0755);
+    if (!make_multi(base, multiCue, sizeof(multiCue)) ||
+        !make_single(base, singleCue, sizeof(singleCue)))
+    {
+        fprintf(stderr, "FATAL: could not write the synthetic discs to %s\n", base);
+        return 1;
+    }
+
+    RUN_TEST(track_lookup);
+    RUN_TEST(reads_match_image);
+    RUN_TEST(reads_ahead_of_sequential_reads);
+    RUN_TEST(teardown_while_busy);
+
+    {
+        void (*p)(void) = (void (*)(void))dlsym(C.handle, "retro_deinit");
+        if (p) p();
+    }
+    if (C.handle) dlclose(C.handle);
+
+    return TEST_REPORT();
+}
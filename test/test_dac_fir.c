@@ -0,0 +1,222 @@
+/*
+ * Bit-exactness and performance test for the DAC's polyphase FIR kernel.
+ *
+ * Build (from repo root -- link exactly one SIMD implementation, the
+ * same one test_blitter_simd uses):
+ *   # On x86_64 (SSE2):
+ *   cc -O2 -msse2 -Isrc/core -o test/test_dac_fir \
+ *      test/test_dac_fir.c src/core/simd_ops_sse2.c
+ *
+ *   # On ARM (NEON) / anywhere (scalar): simd_ops_neon.c /
+ *   # simd_ops_scalar.c instead.
+ *
+ * Usage:
+ *   ./test/test_dac_fir           # Run bit-exactness tests
+ *   ./test/test_dac_fir --bench   # Run performance benchmark
+ *
+ * The kernel is run at every block length 0..LEN_MAX against a plain
+ * 32-bit multiply-accumulate, over random taps and coefficient rows
+ * scaled to the absolute-sum bound dac_fir.h promises, plus rows built
+ * to saturate in both directions and taps at the int16 extremes.  The
+ * output is checked one pair past the block for overruns.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+/* The active (possibly SIMD) implementation */
+#include "../src/jerry/dac_fir.h"
+
+#define LEN_MAX 70
+#define ROUNDS  2000
+
+static int16_t coef[DAC_FIR_PHASES][DAC_FIR_TAPS];
+static int16_t taps[(LEN_MAX + 1) * 2 * DAC_FIR_TAPS];
+static uint8_t phase[LEN_MAX + 1];
+static int16_t out_ref[(LEN_MAX + 2) * 2];
+static int16_t out_simd[(LEN_MAX + 2) * 2];
+
+static int total_tests = 0;
+static int total_failures = 0;
+
+static uint32_t rng_state = 0x12345678;
+
+static uint32_t rng_next(void)
+{
+   rng_state ^= rng_state << 13;
+   rng_state ^= rng_state >> 17;
+   rng_state ^= rng_state << 5;
+   return rng_state;
+}
+
+/* --- Reference --- */
+
+static int16_t ref_sat(int64_t acc)
+{
+   acc = (acc + (1 << (DAC_FIR_SHIFT - 1))) >> DAC_FIR_SHIFT;
+   return (int16_t)(acc > 32767 ? 32767 : acc < -32768 ? -32768 : acc);
+}
+
+static void ref_block(int16_t *dst, const int16_t *t, const uint8_t *ph,
+                      unsigned count)
+{
+   unsigned k, j;
+
+   for (k = 0; k < count; k++, t += 2 * DAC_FIR_TAPS)
+   {
+      int64_t l = 0, r = 0;
+
+      for (j = 0; j < DAC_FIR_TAPS; j++)
+      {
+         l += (int64_t)t[j] * coef[ph[k]][j];
+         r += (int64_t)t[DAC_FIR_TAPS + j] * coef[ph[k]][j];
+      }
+      dst[2 * k + 0] = ref_sat(l);
+      dst[2 * k + 1] = ref_sat(r);
+   }
+}
+
+/* Rows: random, each scaled so its absolute sum stays under 1 << 16;
+ * every 16th a unity impulse, and a few that overshoot unity gain so
+ * extreme taps saturate either way. */
+static void build_coef(void)
+{
+   unsigned p, j;
+
+   for (p = 0; p < DAC_FIR_PHASES; p++)
+   {
+      for (j = 0; j < DAC_FIR_TAPS; j++)
+         coef[p][j] = (int16_t)((int32_t)(rng_next() % 8001) - 4000);
+      if (p % 16 == 0)
+      {
+         memset(coef[p], 0, sizeof(coef[p]));
+         coef[p][p / 16] = 1 << DAC_FIR_SHIFT;
+      }
+      else if (p % 16 == 1)
+      {
+         memset(coef[p], 0, sizeof(coef[p]));
+         coef[p][7] = 24000;
+         coef[p][8] = 8000;
+      }
+   }
+}
+
+static void fill_taps(unsigned round)
+{
+   unsigned i;
+
+   for (i = 0; i < sizeof(taps) / sizeof(taps[0]); i++)
+   {
+      switch (round % 4)
+      {
+         case 0:  taps[i] = (int16_t)rng_next(); break;
+         case 1:  taps[i] = (rng_next() & 1) ? 32767 : -32768; break;
+         case 2:  taps[i] = (rng_next() & 1) ? 32767 : 32766; break;
+         default: taps[i] = (int16_t)(rng_next() % 64) - 32; break;
+      }
+   }
+   for (i = 0; i <= LEN_MAX; i++)
+      phase[i] = (uint8_t)rng_next();
+}
+
+static bool check_kernel(void)
+{
+   unsigned round, len, i;
+
+   for (round = 0; round < ROUNDS; round++)
+   {
+      fill_taps(round);
+      for (len = 0; len <= LEN_MAX; len++)
+      {
+         for (i = 0; i < (LEN_MAX + 2) * 2; i++)
+            out_ref[i] = out_simd[i] = (int16_t)0x5A5A;
+         ref_block(out_ref, taps, phase, len);
+         dac_fir_ops.block(out_simd, taps, phase,
+                           (const int16_t (*)[DAC_FIR_TAPS])coef, len);
+         total_tests++;
+
+         if (memcmp(out_ref, out_simd, (len + 1) * 2 * sizeof(int16_t)) != 0)
+         {
+            for (i = 0; i < (len + 1) * 2; i++)
+               if (out_ref[i] != out_simd[i])
+                  break;
+            printf("  FAIL block: round=%u len=%u sample=%u phase=%u "
+                   "ref=%d got=%d\n", round, len, i,
+                   i / 2 < len ? phase[i / 2] : 0, out_ref[i], out_simd[i]);
+            total_failures++;
+            return false;
+         }
+      }
+   }
+
+   printf("  PASS block\n");
+   return true;
+}
+
+/* --- Performance benchmark --- */
+
+#define BENCH_BLOCKS 400000
+
+static double now_sec(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void bench_kernel(void)
+{
+   unsigned b;
+   double t0, t_ref, t_simd;
+   volatile int16_t sink = 0;
+
+   fill_taps(3);
+
+   t0 = now_sec();
+   for (b = 0; b < BENCH_BLOCKS; b++)
+   {
+      ref_block(out_ref, taps, phase, 64);
+      sink += out_ref[b % 128];
+   }
+   t_ref = now_sec() - t0;
+
+   t0 = now_sec();
+   for (b = 0; b < BENCH_BLOCKS; b++)
+   {
+      dac_fir_ops.block(out_simd, taps, phase,
+                        (const int16_t (*)[DAC_FIR_TAPS])coef, 64);
+      sink += out_simd[b % 128];
+   }
+   t_simd = now_sec() - t0;
+
+   printf("  %-10s ref %7.2f ns/pair   active %7.2f ns/pair   %.2fx\n", "block",
+          t_ref * 1e9 / (BENCH_BLOCKS * 64.0),
+          t_simd * 1e9 / (BENCH_BLOCKS * 64.0),
+          t_simd > 0 ? t_ref / t_simd : 0.0);
+   (void)sink;
+}
+
+int main(int argc, char *argv[])
+{
+   bool bench = (argc > 1 && strcmp(argv[1], "--bench") == 0);
+
+   build_coef();
+
+   if (bench)
+   {
+      printf("DAC FIR benchmark (%u x 64-pair blocks, %d taps):\n",
+             BENCH_BLOCKS, DAC_FIR_TAPS);
+      bench_kernel();
+      return 0;
+   }
+
+   printf("DAC FIR kernel bit-exactness:\n");
+   check_kernel();
+
+   printf("\n%d tests, %d failures\n", total_tests, total_failures);
+   return total_failures ? 1 : 0;
+}
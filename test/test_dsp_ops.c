@@ -122,6 +122,12 @@ static void (*p_DSPWriteLong)(uint32_t, uint32_t, uint32_t);
 static uint32_t (*p_DSPReadLong)(uint32_t, uint32_t);
 static void (*p_DSPReset)(void);
 static void (*p_DSPExec)(int32_t);
+static void (*p_DSPSetDecodeCache)(int);
+static void (*p_DSPSetSuperblocks)(int);
+static int (*p_DSPSetJit)(int);
+static void (*p_DSPSetIdleSkip)(int);
+static void (*p_DSPIdleSkipStats)(uint64_t *, uint32_t *);
+static uint32_t *p_dsp_exec_opcode_count;
 
 /* Stubs */
 static void video_refresh(const void *d, unsigned w, unsigned h, size_t p)
@@ -837,6 +843,297 @@ static void test_mtoi(void)
 
 /* ============================================================ */
 
+/* Decode cache coherence: the pre-decoded SRAM stream must follow host
+ * bus stores, the DSP's own STORE (self-modifying code) and writes made
+ * through the raw DSPGetRAM() pointer, and behave identically with the
+ * cache off. */
+static void test_decode_cache_coherence(void)
+{
+   int mode;
+
+   printf("\n--- Decode cache coherence ---\n");
+   for (mode = 1; mode >= 0; mode--)
+   {
+      const char *tag = mode ? "cache on" : "cache off";
+      p_DSPSetDecodeCache(mode);
+
+      /* Host bus rewrite between two runs of the same address. */
+      prep();
+      w16(0x100, OP_MOVEQ(5, 0));
+      run(10);
+      p_DSPWriteLong(0xF1B100, ((uint32_t)OP_MOVEQ(9, 0) << 16) | OP_NOP, 6);
+      run(10);
+      if (REG(0) == 9) PASS("%s: bus rewrite seen (R0=9)", tag);
+      else FAIL("%s: bus rewrite: R0=%u (expected 9)", tag, REG(0));
+
+      /* Raw-pointer rewrite after the stream was already decoded. */
+      w16(0x100, OP_MOVEQ(13, 0));
+      run(10);
+      if (REG(0) == 13) PASS("%s: DSPGetRAM rewrite seen (R0=13)", tag);
+      else FAIL("%s: DSPGetRAM rewrite: R0=%u (expected 13)", tag, REG(0));
+
+      /* DSP STORE patches an instruction ahead of itself. */
+      prep();
+      wmovei(0x100, 0xF1B120, 10);
+      wmovei(0x106, ((uint32_t)OP_MOVEQ(21, 1) << 16) | OP_NOP, 0);
+      w16(0x10C, OP_STORE(10, 0));
+      w16(0x120, OP_MOVEQ(3, 1));
+      run(40);
+      if (REG(1) == 21) PASS("%s: self-modified moveq #21 executed", tag);
+      else FAIL("%s: self-modify: R1=%u (expected 21)", tag, REG(1));
+
+      /* Patched JR delay slot (fetched by the branch handler itself). */
+      prep();
+      w16(0x100, OP_JR(0, 2));
+      w16(0x102, OP_MOVEQ(1, 2));
+      run(20);
+      p_DSPWriteLong(0xF1B100, ((uint32_t)OP_JR(0, 2) << 16) | OP_MOVEQ(11, 2), 6);
+      run(20);
+      if (REG(2) == 11) PASS("%s: patched delay slot (R2=11)", tag);
+      else FAIL("%s: patched delay slot: R2=%u (expected 11)", tag, REG(2));
+   }
+   p_DSPSetDecodeCache(1);
+}
+
+/* Superblocks must stop on exactly the instruction the per-instruction
+ * loop would.  The DIV (9 cycles on the DSP) makes the run's cycle
+ * total uneven, so budgets landing inside it are covered too. */
+static void test_superblock_budget(void)
+{
+   int32_t budget;
+   int bad = 0;
+
+   printf("\n--- Superblock slice budget ---\n");
+   for (budget = 1; budget <= 40; budget++)
+   {
+      uint32_t r0[2], r2[2], pc[2];
+      int sb;
+
+      for (sb = 0; sb < 2; sb++)
+      {
+         int i;
+         p_DSPSetSuperblocks(sb);
+         prep();
+         w16(0x100, OP_MOVEQ(3, 1));
+         w16(0x102, OP_MOVEQ(30, 2));
+         for (i = 0; i < 4; i++)
+            w16(0x104 + i * 2, OP_ADDQ(1, 0));
+         w16(0x10C, OP(21, 1, 2));            /* div r1,r2 */
+         for (i = 0; i < 8; i++)
+            w16(0x10E + i * 2, OP_ADDQ(1, 0));
+         run(budget);
+         r0[sb] = REG(0);
+         r2[sb] = REG(2);
+         pc[sb] = *p_dsp_pc;
+      }
+      if (r0[0] != r0[1] || r2[0] != r2[1] || pc[0] != pc[1])
+      {
+         FAIL("budget %d: R0 %u/%u R2 %u/%u PC %06X/%06X (off/on)", budget,
+               r0[0], r0[1], r2[0], r2[1], pc[0], pc[1]);
+         bad++;
+      }
+   }
+   if (!bad)
+      PASS("budgets 1-40: superblocks stop where single-stepping does");
+   p_DSPSetSuperblocks(1);
+}
+
+/* Differential check of the x86-64 dynarec against the interpreter; see
+ * the GPU version in test_gpu_ops.c.  Uses the DSP's own straight set
+ * (subqmod, sat16s, sat32s, mirror, addqmod, the 40-bit MAC) and its
+ * non-uniform cycle costs. */
+#define JIT_BLOCKS 300
+#define JIT_PASSES 6
+
+static const uint8_t jit_straight_ops[] = {
+    0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15,
+   16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31,
+   32, 33, 34, 35, 36, 37, 42, 48, 51, 55, 56, 57, 63
+};
+
+static uint32_t jit_rng_state = 0x9E3779B9;
+static uint32_t jit_rng(void)
+{
+   jit_rng_state ^= jit_rng_state << 13;
+   jit_rng_state ^= jit_rng_state >> 17;
+   jit_rng_state ^= jit_rng_state << 5;
+   return jit_rng_state;
+}
+
+static uint32_t jit_value(void)
+{
+   static const uint32_t edge[] = { 0, 1, 0x7FFFFFFF, 0x80000000, 0xFFFFFFFF, 0xFFFF, 0x8000 };
+   switch (jit_rng() % 4)
+   {
+   case 0:  return edge[jit_rng() % (sizeof(edge) / sizeof(edge[0]))];
+   case 1:  return jit_rng() & 0x3F;
+   default: return jit_rng();
+   }
+}
+
+typedef struct { uint32_t bank0[32], bank1[32], flags, remain, pc; } jit_state_t;
+
+static void jit_capture(jit_state_t *st)
+{
+   memcpy(st->bank0, p_dsp_reg_bank_0, sizeof(st->bank0));
+   memcpy(st->bank1, p_dsp_reg_bank_1, sizeof(st->bank1));
+   st->flags  = p_DSPReadLong(DSP_FLAGS_ADDR, 6) & 7;
+   st->remain = p_DSPReadLong(0xF1A11C, 6);
+   st->pc     = *p_dsp_pc;
+}
+
+static void jit_run_from(const jit_state_t *init)
+{
+   memcpy(p_dsp_reg_bank_0, init->bank0, sizeof(init->bank0));
+   memcpy(p_dsp_reg_bank_1, init->bank1, sizeof(init->bank1));
+   p_DSPWriteLong(DSP_FLAGS_ADDR, init->flags, 6);
+   run(160);
+}
+
+static void test_jit_differential(void)
+{
+   int b, bad = 0;
+
+   printf("\n--- Dynarec vs interpreter ---\n");
+   if (!p_DSPSetJit(1))
+   {
+      printf("  SKIP: no dynarec on this host\n");
+      return;
+   }
+   p_DSPSetJit(0);
+
+   for (b = 0; b < JIT_BLOCKS && !bad; b++)
+   {
+      jit_state_t init, ref, got;
+      int i, pass, len = 8 + (int)(jit_rng() % 23);
+
+      prep();
+      /* imultn first: the MAC accumulator is not otherwise resettable. */
+      w16(0x100, OP_IMULTN(jit_rng() & 31, jit_rng() & 31));
+      for (i = 1; i < len; i++)
+      {
+         uint8_t opc = jit_straight_ops[jit_rng() % sizeof(jit_straight_ops)];
+         w16(0x100 + i * 2, OP(opc, jit_rng() & 31, jit_rng() & 31));
+      }
+      wmovei(0x100 + len * 2, 0x12345678, 0);    /* ends the run */
+      for (i = 0; i < 32; i++)
+      {
+         init.bank0[i] = jit_value();
+         init.bank1[i] = jit_value();
+      }
+      init.flags = jit_rng() & 7;
+
+      p_DSPSetJit(0);
+      jit_run_from(&init);
+      jit_capture(&ref);
+
+      p_DSPSetJit(1);
+      for (pass = 0; pass < JIT_PASSES; pass++)
+      {
+         jit_run_from(&init);
+         jit_capture(&got);
+         if (memcmp(&ref, &got, sizeof(ref)) != 0)
+         {
+            uint8_t *ram = p_DSPGetRAM();
+            for (i = 0; i < 32; i++)
+               if (ref.bank0[i] != got.bank0[i] || ref.bank1[i] != got.bank1[i])
+                  break;
+            FAIL("block %d pass %d: R%d %08X/%08X alt %08X/%08X flags %X/%X "
+                  "remain %08X/%08X pc %06X/%06X (interp/dynarec)", b, pass, i & 31,
+                  ref.bank0[i & 31], got.bank0[i & 31], ref.bank1[i & 31], got.bank1[i & 31],
+                  ref.flags, got.flags, ref.remain, got.remain, ref.pc, got.pc);
+            for (i = 0; i < len; i++)
+               printf("    $%03X: %02X%02X\n", 0x100 + i * 2,
+                     ram[0x100 + i * 2], ram[0x101 + i * 2]);
+            bad++;
+            break;
+         }
+      }
+      p_DSPSetJit(0);
+   }
+   if (!bad)
+      PASS("%d random blocks: dynarec matches the interpreter", JIT_BLOCKS);
+}
+
+/* Idle-loop skip; see test_idle_skip in test_gpu_ops.c.  The DSP
+ * side adds the bare `jr T,self` an audio engine waits for its I2S
+ * interrupt in. */
+static void idle_load_poll(void)
+{
+   w32(0x800, 0);
+   wmovei(0x100, 0xF1B800, 1);
+   w16(0x106, OP_LOAD(1, 2));
+   w16(0x108, OP_CMPQ(0, 2));
+   w16(0x10A, OP_JR(2, -3));
+   w16(0x10C, OP_NOP);
+   w16(0x10E, OP_MOVEQ(7, 3));
+}
+
+static void idle_load_self(void)
+{
+   w16(0x100, OP_MOVEQ(5, 6));
+   w16(0x102, OP_JR(0, -1));
+   w16(0x104, OP_NOP);
+}
+
+static void test_idle_skip(void)
+{
+   static const struct { const char *name; void (*load)(void); } loops[] = {
+      { "poll", idle_load_poll },
+      { "jr self", idle_load_self },
+   };
+   static const int32_t budgets[] = { 1, 2, 3, 5, 7, 11, 13, 17, 40, 97, 4099, 50000 };
+   unsigned l, b;
+
+   printf("\n--- Idle-loop skip ---\n");
+   for (l = 0; l < sizeof(loops) / sizeof(loops[0]); l++)
+   {
+      uint64_t skipped0, skipped1;
+      int bad = 0;
+
+      for (b = 0; b < sizeof(budgets) / sizeof(budgets[0]); b++)
+      {
+         uint32_t regs[2][32], pc[2], ops[2];
+         int skip;
+
+         for (skip = 0; skip < 2; skip++)
+         {
+            uint32_t before;
+            p_DSPSetIdleSkip(skip);
+            prep();
+            loops[l].load();
+            before = *p_dsp_exec_opcode_count;
+            run(budgets[b]);
+            memcpy(regs[skip], p_dsp_reg_bank_0, sizeof(regs[skip]));
+            pc[skip]  = *p_dsp_pc;
+            ops[skip] = *p_dsp_exec_opcode_count - before;
+         }
+         if (memcmp(regs[0], regs[1], sizeof(regs[0])) != 0
+               || pc[0] != pc[1] || ops[0] != ops[1])
+         {
+            FAIL("%s, budget %d: PC %06X/%06X opcodes %u/%u (off/on)",
+                  loops[l].name, budgets[b], pc[0], pc[1], ops[0], ops[1]);
+            bad++;
+         }
+      }
+      if (!bad)
+         PASS("%s: every budget ends where single-stepping does", loops[l].name);
+
+      p_DSPSetIdleSkip(1);
+      prep();
+      loops[l].load();
+      p_DSPIdleSkipStats(&skipped0, NULL);
+      run(50000);
+      p_DSPIdleSkipStats(&skipped1, NULL);
+      if (skipped1 > skipped0)
+         PASS("%s: %llu cycles of 50000 skipped", loops[l].name,
+               (unsigned long long)(skipped1 - skipped0));
+      else
+         FAIL("%s: nothing skipped", loops[l].name);
+   }
+   p_DSPSetIdleSkip(1);
+}
+
 int main(int argc, char *argv[])
 {
    void *handle;
@@ -870,13 +1167,20 @@ int main(int argc, char *argv[])
    LOAD(DSPGetRAM);
    LOAD(DSPWriteLong);
    LOAD(DSPReadLong);
+   LOAD(DSPSetDecodeCache);
+   LOAD(DSPSetSuperblocks);
+   LOAD(DSPSetJit);
+   LOAD(DSPSetIdleSkip);
+   LOAD(DSPIdleSkipStats);
 
    p_dsp_control    = dlsym(handle, "dsp_control");
    p_dsp_pc         = dlsym(handle, "dsp_pc");
    p_dsp_reg_bank_0 = dlsym(handle, "dsp_reg_bank_0");
    p_dsp_reg_bank_1 = dlsym(handle, "dsp_reg_bank_1");
+   p_dsp_exec_opcode_count = dlsym(handle, "dsp_exec_opcode_count");
 
-   if (!p_dsp_control || !p_dsp_pc || !p_dsp_reg_bank_0 || !p_dsp_reg_bank_1) {
+   if (!p_dsp_control || !p_dsp_pc || !p_dsp_reg_bank_0 || !p_dsp_reg_bank_1
+         || !p_dsp_exec_opcode_count) {
       fprintf(stderr, "Missing DSP internal symbols\n");
       return 1;
    }
@@ -973,6 +1277,12 @@ int main(int argc, char *argv[])
    test_jr();
    test_jump();
 
+   /* Host-side decode cache */
+   test_decode_cache_coherence();
+   test_superblock_budget();
+   test_jit_differential();
+   test_idle_skip();
+
    printf("\n=== Results: %d passed, %d failed ===\n", passes, fails);
 
    p_retro_unload_game();
@@ -1,7 +1,10 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
 
 #include "src/core/event.h"
+#include "src/core/state.h"
 
 static int halfline_calls;
 static int tompit_calls;
@@ -148,6 +151,53 @@ static void test_remove_callback(void)
    assert_int("pit never ran", tompit_calls, 0);
 }
 
+/* A slice is cut at the PIT; the 68K then reprograms PIT1 while the slice
+ * runs (JERRYResetPIT1: remove, reschedule from the slice start -- or not
+ * at all with a zero divider).  The slice end must fire nothing and leave
+ * both clocks there, not run on towards the moved PIT. */
+static void test_slice_end_survives_pit_reprogram(void)
+{
+   uint64_t start;
+   uint64_t sliceEnd;
+
+   InitializeEventList();
+   reset_counts();
+
+   SetCallbackTime(HalflineCallback, 100.0, EVENT_MAIN);
+   SetCallbackTime(JERRYPIT1Callback, 12.0, EVENT_JERRY);
+   start = GetEventClock(EVENT_JERRY);
+   sliceEnd = start + GetTicksToNextEvent(EVENT_JERRY);
+
+   RemoveCallback(JERRYPIT1Callback);
+   SetCallbackTime(JERRYPIT1Callback, 40.0, EVENT_JERRY);
+
+   HandleSliceEnd(sliceEnd);
+   assert_int("moved PIT not fired", jerry_pit1_calls, 0);
+   assert_int("JERRY clock at slice end", GetEventClock(EVENT_JERRY) == sliceEnd, 1);
+   assert_int("MAIN clock at slice end", GetEventClock(EVENT_MAIN) == sliceEnd, 1);
+   assert_int("PIT due 40 us after the slice start",
+              GetEventClock(EVENT_JERRY) + GetTicksToNextEvent(EVENT_JERRY) == start + EventUsecToTicks(40.0), 1);
+
+   /* Next slice: the PIT at its new time. */
+   sliceEnd = GetEventClock(EVENT_JERRY) + GetTicksToNextEvent(EVENT_JERRY);
+   HandleSliceEnd(sliceEnd);
+   assert_int("PIT fired at its new time", jerry_pit1_calls, 1);
+   assert_int("clock at the PIT", GetEventClock(EVENT_JERRY) == sliceEnd, 1);
+
+   /* Zero divider: the PIT is dropped outright. */
+   InitializeEventList();
+   reset_counts();
+   SetCallbackTime(HalflineCallback, 100.0, EVENT_MAIN);
+   SetCallbackTime(JERRYPIT1Callback, 12.0, EVENT_JERRY);
+   sliceEnd = GetEventClock(EVENT_JERRY) + GetTicksToNextEvent(EVENT_JERRY);
+   RemoveCallback(JERRYPIT1Callback);
+
+   HandleSliceEnd(sliceEnd);
+   assert_int("removed PIT: clock at slice end", GetEventClock(EVENT_JERRY) == sliceEnd, 1);
+   assert_int("removed PIT: MAIN clock at slice end", GetEventClock(EVENT_MAIN) == sliceEnd, 1);
+   assert_int("removed PIT: halfline untouched", halfline_calls, 0);
+}
+
 /* AdjustCallbackTime replaces the delay for an already-scheduled callback. */
 static void test_adjust_callback_reschedule(void)
 {
@@ -387,12 +437,157 @@ static void test_dispatch_main_before_jerry_decrements_jerry(void)
    assert_int("MAIN still 1 firing", halfline_calls, 1);
 }
 
+/* Integer slice lengths: cutting every halfline on whole RISC cycles of
+ * the absolute tick clock must add up to the clock itself, with no
+ * per-slice rounding creeping in over a long session. */
+static void test_slice_cycles_sum_to_clock(void)
+{
+   const double period = HORIZ_PERIOD_IN_USEC_NTSC / 2.0;
+   uint64_t total = 0;
+   uint64_t total68k = 0;
+   double expect;
+   int i;
+
+   InitializeEventList();
+   reset_counts();
+
+   SetCallbackTime(HalflineCallback, period, EVENT_MAIN);
+   for (i = 0; i < 200000; i++)
+   {
+      uint64_t from = GetEventClock(EVENT_MAIN);
+      uint64_t ticks = GetTicksToNextEvent(EVENT_MAIN);
+
+      total += EVENT_TICKS_TO_RISC_CYCLES(from, from + ticks);
+      total68k += EVENT_TICKS_TO_M68K_CYCLES(from, from + ticks);
+      HandleNextEvent(EVENT_MAIN);
+      SetCallbackTime(HalflineCallback, period, EVENT_MAIN);
+   }
+
+   assert_int("halflines fired", halfline_calls, 200000);
+   assert_int("RISC cycles == clock", (int)(total - (GetEventClock(EVENT_MAIN) >> EVENT_TICK_SHIFT)), 0);
+   assert_int("68K cycles == clock / 2", (int)(total68k - (GetEventClock(EVENT_MAIN) >> (EVENT_TICK_SHIFT + 1))), 0);
+
+   /* Within a couple of cycles of the real elapsed time after ~3 s. */
+   expect = 200000.0 * period / RISC_CYCLE_IN_USEC;
+   if (total < expect - 2.0 || total > expect + 2.0)
+   {
+      fprintf(stderr, "elapsed cycles: expected %.1f, got %llu\n", expect, (unsigned long long)total);
+      exit(1);
+   }
+}
+
+/* A full list of 32 events must drain in due-time order, each firing at
+ * its own due time; the 33rd is dropped.  Ties are pinned below. */
+static uint64_t fired_at[32];
+static int fired_count;
+static void ClockedCallback(void) { fired_at[fired_count++] = GetEventClock(EVENT_JERRY); }
+
+static void test_full_list_dispatch_order(void)
+{
+   static const int due[32] = {
+      9, 3, 7, 3, 1, 8, 3, 5, 2, 9, 6, 4, 1, 7, 0, 5,
+      8, 2, 6, 0, 4, 9, 1, 3, 7, 2, 5, 8, 6, 4, 0, 9 };
+   int count[10];
+   int i, t;
+
+   InitializeEventList();
+   reset_counts();
+   fired_count = 0;
+   memset(count, 0, sizeof(count));
+
+   for (i = 0; i < 32; i++)
+   {
+      SetCallbackTime(ClockedCallback, (double)due[i], EVENT_JERRY);
+      count[due[i]]++;
+   }
+   SetCallbackTime(JERRYPIT1Callback, 0.0, EVENT_JERRY);
+
+   for (i = 0; i < 32; i++)
+   {
+      (void)GetTimeToNextEvent(EVENT_JERRY);
+      HandleNextEvent(EVENT_JERRY);
+   }
+   assert_int("all 32 fired", fired_count, 32);
+   assert_int("33rd dropped", jerry_pit1_calls, 0);
+   assert_double("queue empty", GetTimeToNextEvent(EVENT_JERRY), 1e30);
+
+   for (i = 0, t = 0; t < 10; t++)
+   {
+      int k;
+      for (k = 0; k < count[t]; k++, i++)
+         assert_int("fired at due time",
+               (int)(fired_at[i] / EVENT_TICKS_PER_RISC_CYCLE),
+               (int)((uint64_t)((double)t / RISC_CYCLE_IN_USEC * EVENT_TICKS_PER_RISC_CYCLE + 0.5) / EVENT_TICKS_PER_RISC_CYCLE));
+   }
+
+   /* Free slots 0-2 and refill one: the new event lands in slot 0 and so
+    * wins a tie against the older events left in slots 4 and 5. */
+   InitializeEventList();
+   reset_counts();
+   for (i = 0; i < 6; i++)
+      SetCallbackTime(JERRYPIT2Callback, 50.0, EVENT_MAIN);
+   RemoveCallback(JERRYPIT2Callback);     /* slot 0 */
+   RemoveCallback(JERRYPIT2Callback);     /* slot 1 */
+   RemoveCallback(JERRYPIT2Callback);     /* slot 2 */
+   SetCallbackTime(HalflineCallback, 50.0, EVENT_MAIN);   /* slot 0 */
+   AdjustCallbackTime(JERRYPIT2Callback, 10.0);           /* slot 3 */
+   (void)GetTimeToNextEvent(EVENT_MAIN);
+   HandleNextEvent(EVENT_MAIN);
+   assert_int("adjusted slot 3 first", jerry_pit2_calls, 1);
+   HandleNextEvent(EVENT_MAIN);
+   assert_int("slot 0 wins the 50.0 tie", halfline_calls, 1);
+   assert_int("slots 4/5 still pending", jerry_pit2_calls, 1);
+}
+
+/* Savestate round trip: the event chunk (legacy slot layout, delays in
+ * µs) plus the clock chunk restore both clocks, including the sub-cycle
+ * phase, and every pending delay to the tick. */
+static void test_state_roundtrip(void)
+{
+   static uint8_t buf[4096];
+   uint64_t mainNow, jerryNow, mainNext, jerryNext;
+   size_t n;
+
+   InitializeEventList();
+   reset_counts();
+
+   SetCallbackTime(HalflineCallback, 31.77, EVENT_MAIN);
+   SetCallbackTime(TOMPITCallback, 1000.0, EVENT_MAIN);
+   SetCallbackTime(JERRYI2SCallback, 20.8, EVENT_JERRY);
+   AdvanceEventClock(12345, EVENT_MAIN);
+   AdvanceEventClock(777777, EVENT_JERRY);
+   (void)GetTimeToNextEvent(EVENT_MAIN);
+   HandleNextEvent(EVENT_MAIN);
+
+   mainNow = GetEventClock(EVENT_MAIN);
+   jerryNow = GetEventClock(EVENT_JERRY);
+   mainNext = GetTicksToNextEvent(EVENT_MAIN);
+   jerryNext = GetTicksToNextEvent(EVENT_JERRY);
+
+   n = EventStateSave(buf);
+   n += EventClockStateSave(buf + n);
+
+   InitializeEventList();
+   SetCallbackTime(GPUCPUINTCallback, 1.0, EVENT_MAIN);
+   AdvanceEventClock(99, EVENT_MAIN);
+
+   assert_int("load size", (int)(EventStateLoad(buf) + EventClockStateLoad(buf + EventStateLoad(buf))), (int)n);
+   assert_int("MAIN clock restored", GetEventClock(EVENT_MAIN) == mainNow, 1);
+   assert_int("JERRY clock restored", GetEventClock(EVENT_JERRY) == jerryNow, 1);
+   assert_int("MAIN delay restored", GetTicksToNextEvent(EVENT_MAIN) == mainNext, 1);
+   assert_int("JERRY delay restored", GetTicksToNextEvent(EVENT_JERRY) == jerryNext, 1);
+
+   HandleNextEvent(EVENT_MAIN);
+   assert_int("restored MAIN event is the PIT", tompit_calls, 1);
+}
+
 int main(void)
 {
    test_main_queue_due_now_clamp();
    test_jerry_queue_due_now_clamp();
    test_schedule_negative_as_due_now();
    test_remove_callback();
+   test_slice_end_survives_pit_reprogram();
    test_adjust_callback_reschedule();
    test_main_tie_break_lower_index();
    test_main_tie_break_order_matters();
@@ -402,6 +597,9 @@ int main(void)
    test_adjust_jerry_only_touches_jerry();
    test_dispatch_tie_goes_to_main();
    test_dispatch_main_before_jerry_decrements_jerry();
+   test_slice_cycles_sum_to_clock();
+   test_full_list_dispatch_order();
+   test_state_roundtrip();
 
    printf("event queue tests passed\n");
    return 0;
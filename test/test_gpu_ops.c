@@ -106,6 +106,12 @@ static void (*p_GPUExec)(int32_t);
 static void (*p_GPUWriteLong)(uint32_t, uint32_t, uint32_t);
 static void (*p_GPUWriteWord)(uint32_t, uint16_t, uint32_t);
 static uint32_t (*p_GPUReadLong)(uint32_t, uint32_t);
+static void (*p_GPUSetDecodeCache)(int);
+static void (*p_GPUSetSuperblocks)(int);
+static int (*p_GPUSetJit)(int);
+static void (*p_GPUSetIdleSkip)(int);
+static void (*p_GPUIdleSkipStats)(uint64_t *, uint32_t *);
+static uint32_t *p_gpu_exec_opcode_count;
 
 /* Stubs */
 static void video_refresh(const void *d, unsigned w, unsigned h, size_t p)
@@ -734,6 +740,314 @@ static void test_normi(void)
 
 /* ============================================================ */
 
+/* Decode cache coherence: the pre-decoded local-RAM stream must follow
+ * every store, whether it comes from the host bus or from the GPU's own
+ * STORE (self-modifying code), and behave identically with it off. */
+static void test_decode_cache_coherence(void)
+{
+   int mode;
+
+   printf("\n--- Decode cache coherence ---\n");
+   for (mode = 1; mode >= 0; mode--)
+   {
+      const char *tag = mode ? "cache on" : "cache off";
+      p_GPUSetDecodeCache(mode);
+
+      /* Host rewrite between two runs of the same address. */
+      prep();
+      gw16(0x100, OP_MOVEQ(5, 0));
+      run(10);
+      gw16(0x100, OP_MOVEQ(9, 0));
+      run(10);
+      if (REG(0) == 9) PASS("%s: host rewrite seen (R0=9)", tag);
+      else FAIL("%s: host rewrite: R0=%u (expected 9)", tag, REG(0));
+
+      /* GPU STORE patches an instruction ahead of itself. */
+      prep();
+      gwmovei(0x100, GPU_RAM_BASE + 0x120, 10);
+      gwmovei(0x106, ((uint32_t)OP_MOVEQ(21, 1) << 16) | OP_NOP, 0);
+      gw16(0x10C, OP_STORE(10, 0));
+      gw16(0x120, OP_MOVEQ(3, 1));
+      run(40);
+      if (REG(1) == 21) PASS("%s: self-modified moveq #21 executed", tag);
+      else FAIL("%s: self-modify: R1=%u (expected 21)", tag, REG(1));
+
+      /* Patched JR delay slot (fetched by the branch handler itself). */
+      prep();
+      gw16(0x100, OP_JR(0, 2));
+      gw16(0x102, OP_MOVEQ(1, 2));
+      gw16(0x106, OP_NOP);
+      run(20);
+      gw16(0x102, OP_MOVEQ(11, 2));
+      run(20);
+      if (REG(2) == 11) PASS("%s: patched delay slot (R2=11)", tag);
+      else FAIL("%s: patched delay slot: R2=%u (expected 11)", tag, REG(2));
+   }
+   p_GPUSetDecodeCache(1);
+}
+
+/* Superblocks must stop on exactly the instruction the per-instruction
+ * loop would: for every slice budget, a straight run cut short by the
+ * budget leaves the same registers and PC with superblocks on and off. */
+static void test_superblock_budget(void)
+{
+   int32_t budget;
+   int bad = 0;
+
+   printf("\n--- Superblock slice budget ---\n");
+   for (budget = 1; budget <= 24; budget++)
+   {
+      uint32_t r0[2], pc[2];
+      int sb;
+
+      for (sb = 0; sb < 2; sb++)
+      {
+         int i;
+         p_GPUSetSuperblocks(sb);
+         prep();
+         for (i = 0; i < 10; i++)
+            gw16(0x100 + i * 2, OP_ADDQ(1, 0));
+         gwmovei(0x114, 0x1000, 1);          /* movei ends the run */
+         for (i = 0; i < 6; i++)
+            gw16(0x11A + i * 2, OP_ADDQ(2, 0));
+         run(budget);
+         r0[sb] = REG(0);
+         pc[sb] = *p_gpu_pc;
+      }
+      if (r0[0] != r0[1] || pc[0] != pc[1])
+      {
+         FAIL("budget %d: R0 %u/%u PC %06X/%06X (off/on)", budget,
+               r0[0], r0[1], pc[0], pc[1]);
+         bad++;
+      }
+   }
+   if (!bad)
+      PASS("budgets 1-24: superblocks stop where single-stepping does");
+   p_GPUSetSuperblocks(1);
+}
+
+/* Differential check of the x86-64 dynarec against the interpreter:
+ * random straight-line blocks (every opcode the superblock path takes,
+ * inline-translated or handler-called) from random register/flag state.
+ * Each block runs once interpreted, then repeatedly with the dynarec on
+ * -- the first entries interpret while the run heats up, the rest run
+ * the translation -- and both register banks, flags, G_REMAIN and PC
+ * must match after every pass. */
+#define JIT_BLOCKS 300
+#define JIT_PASSES 6
+
+static const uint8_t jit_straight_ops[] = {
+    0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15,
+   16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31,
+   32, 33, 34, 35, 36, 37, 51, 55, 56, 57, 62, 63
+};
+
+static uint32_t jit_rng_state = 0x2545F491;
+static uint32_t jit_rng(void)
+{
+   jit_rng_state ^= jit_rng_state << 13;
+   jit_rng_state ^= jit_rng_state >> 17;
+   jit_rng_state ^= jit_rng_state << 5;
+   return jit_rng_state;
+}
+
+static uint32_t jit_value(void)
+{
+   static const uint32_t edge[] = { 0, 1, 0x7FFFFFFF, 0x80000000, 0xFFFFFFFF, 0xFFFF, 0x8000 };
+   switch (jit_rng() % 4)
+   {
+   case 0:  return edge[jit_rng() % (sizeof(edge) / sizeof(edge[0]))];
+   case 1:  return jit_rng() & 0x3F;
+   default: return jit_rng();
+   }
+}
+
+typedef struct { uint32_t bank0[32], bank1[32], flags, remain, pc; } jit_state_t;
+
+static void jit_capture(jit_state_t *st)
+{
+   memcpy(st->bank0, p_gpu_reg_bank_0, sizeof(st->bank0));
+   memcpy(st->bank1, p_gpu_reg_bank_1, sizeof(st->bank1));
+   st->flags  = p_GPUReadLong(GPU_FLAGS_ADDR, 1) & 7;
+   st->remain = p_GPUReadLong(0xF0211C, 1);
+   st->pc     = *p_gpu_pc;
+}
+
+static void jit_run_from(const jit_state_t *init)
+{
+   memcpy(p_gpu_reg_bank_0, init->bank0, sizeof(init->bank0));
+   memcpy(p_gpu_reg_bank_1, init->bank1, sizeof(init->bank1));
+   p_GPUWriteLong(GPU_FLAGS_ADDR, init->flags, 1);
+   run(64);
+}
+
+static void test_jit_differential(void)
+{
+   int b, bad = 0;
+
+   printf("\n--- Dynarec vs interpreter ---\n");
+   if (!p_GPUSetJit(1))
+   {
+      printf("  SKIP: no dynarec on this host\n");
+      return;
+   }
+   p_GPUSetJit(0);
+
+   for (b = 0; b < JIT_BLOCKS && !bad; b++)
+   {
+      jit_state_t init, ref, got;
+      int i, pass, len = 8 + (int)(jit_rng() % 23);
+
+      prep();
+      /* imultn first: the MAC accumulator is not otherwise resettable. */
+      gw16(0x100, OP_IMULTN(jit_rng() & 31, jit_rng() & 31));
+      for (i = 1; i < len; i++)
+      {
+         uint8_t opc = jit_straight_ops[jit_rng() % sizeof(jit_straight_ops)];
+         gw16(0x100 + i * 2, OP(opc, jit_rng() & 31, jit_rng() & 31));
+      }
+      gwmovei(0x100 + len * 2, 0x12345678, 0);   /* ends the run */
+      for (i = 0; i < 32; i++)
+      {
+         init.bank0[i] = jit_value();
+         init.bank1[i] = jit_value();
+      }
+      init.flags = jit_rng() & 7;
+
+      p_GPUSetJit(0);
+      jit_run_from(&init);
+      jit_capture(&ref);
+
+      p_GPUSetJit(1);
+      for (pass = 0; pass < JIT_PASSES; pass++)
+      {
+         jit_run_from(&init);
+         jit_capture(&got);
+         if (memcmp(&ref, &got, sizeof(ref)) != 0)
+         {
+            for (i = 0; i < 32; i++)
+               if (ref.bank0[i] != got.bank0[i] || ref.bank1[i] != got.bank1[i])
+                  break;
+            FAIL("block %d pass %d: R%d %08X/%08X alt %08X/%08X flags %X/%X "
+                  "remain %08X/%08X pc %06X/%06X (interp/dynarec)", b, pass, i & 31,
+                  ref.bank0[i & 31], got.bank0[i & 31], ref.bank1[i & 31], got.bank1[i & 31],
+                  ref.flags, got.flags, ref.remain, got.remain, ref.pc, got.pc);
+            for (i = 0; i < len; i++)
+               printf("    $%03X: %04X\n", 0x100 + i * 2,
+                     (unsigned)(p_GPUReadLong(GPU_RAM_BASE + ((0x100 + i * 2) & ~3), 1)
+                        >> (((0x100 + i * 2) & 2) ? 0 : 16)) & 0xFFFF);
+            bad++;
+            break;
+         }
+      }
+      p_GPUSetJit(0);
+   }
+   if (!bad)
+      PASS("%d random blocks: dynarec matches the interpreter", JIT_BLOCKS);
+}
+
+/* Idle-loop skip (src/core/risc_idle.h): a poll loop that never sees
+ * its mailbox change must end every slice exactly where running each
+ * iteration does -- registers, PC and liveness count -- for budgets
+ * that cut the last iteration anywhere.  Loops the watch must not skip
+ * (state that moves, an I/O register read) are run too and must not
+ * move the skipped-cycle counter. */
+typedef struct { uint32_t bank0[32], pc, opcodes; } idle_result_t;
+
+static void idle_run(int skip, int32_t budget, void (*load)(void), idle_result_t *res)
+{
+   uint32_t before;
+
+   p_GPUSetIdleSkip(skip);
+   prep();
+   load();
+   before = *p_gpu_exec_opcode_count;
+   run(budget);
+   memcpy(res->bank0, p_gpu_reg_bank_0, sizeof(res->bank0));
+   res->pc      = *p_gpu_pc;
+   res->opcodes = *p_gpu_exec_opcode_count - before;
+}
+
+/* movei #mailbox,r1 / poll: load (r1),r2 / cmpq #0,r2 / jr EQ,poll / nop */
+static void idle_load_poll(void)
+{
+   gw32(0x800, 0);
+   gwmovei(0x100, GPU_RAM_BASE + 0x800, 1);
+   gw16(0x106, OP_LOAD(1, 2));
+   gw16(0x108, OP_CMPQ(0, 2));
+   gw16(0x10A, OP_JR(2, -3));
+   gw16(0x10C, OP_NOP);
+   gw16(0x10E, OP_MOVEQ(7, 3));
+}
+
+/* Counting loop: subq #1,r4 / jr NE,-2 / nop, with r4 large. */
+static void idle_load_count(void)
+{
+   gwmovei(0x100, 0x100000, 4);
+   gw16(0x106, OP_SUBQ(1, 4));
+   gw16(0x108, OP_JR(1, -2));
+   gw16(0x10A, OP_NOP);
+}
+
+/* Poll G_FLAGS: a register read is never taken as replayable. */
+static void idle_load_io(void)
+{
+   gwmovei(0x100, GPU_FLAGS_ADDR, 1);
+   gw16(0x106, OP_LOAD(1, 2));
+   gw16(0x108, OP_CMPQ(0, 2));
+   gw16(0x10A, OP_JR(1, -3));
+   gw16(0x10C, OP_NOP);
+}
+
+static void test_idle_skip(void)
+{
+   static const struct { const char *name; void (*load)(void); int idle; } loops[] = {
+      { "poll",    idle_load_poll,  1 },
+      { "count",   idle_load_count, 0 },
+      { "g_flags", idle_load_io,    0 },
+   };
+   static const int32_t budgets[] = { 1, 2, 3, 5, 7, 11, 13, 17, 23, 40, 97, 1000, 4099, 50000 };
+   unsigned l, b;
+
+   printf("\n--- Idle-loop skip ---\n");
+   for (l = 0; l < sizeof(loops) / sizeof(loops[0]); l++)
+   {
+      uint64_t skipped0, skipped1;
+      int bad = 0;
+
+      for (b = 0; b < sizeof(budgets) / sizeof(budgets[0]); b++)
+      {
+         idle_result_t ref, got;
+
+         idle_run(0, budgets[b], loops[l].load, &ref);
+         idle_run(1, budgets[b], loops[l].load, &got);
+         if (memcmp(&ref, &got, sizeof(ref)) != 0)
+         {
+            FAIL("%s, budget %d: PC %06X/%06X opcodes %u/%u R2 %08X/%08X R4 %08X/%08X (off/on)",
+                  loops[l].name, budgets[b], ref.pc, got.pc, ref.opcodes, got.opcodes,
+                  ref.bank0[2], got.bank0[2], ref.bank0[4], got.bank0[4]);
+            bad++;
+         }
+      }
+      /* GPUReset() zeroes the counter, so read it before the last prep(). */
+      p_GPUSetIdleSkip(1);
+      prep();
+      loops[l].load();
+      p_GPUIdleSkipStats(&skipped0, NULL);
+      run(50000);
+      p_GPUIdleSkipStats(&skipped1, NULL);
+      if (!bad)
+         PASS("%s: every budget ends where single-stepping does", loops[l].name);
+      if (loops[l].idle ? skipped1 > skipped0 : skipped1 == skipped0)
+         PASS("%s: %llu cycles of 50000 skipped", loops[l].name,
+               (unsigned long long)(skipped1 - skipped0));
+      else
+         FAIL("%s: %llu cycles of 50000 skipped (expected %s)", loops[l].name,
+               (unsigned long long)(skipped1 - skipped0), loops[l].idle ? "some" : "none");
+   }
+   p_GPUSetIdleSkip(1);
+}
+
 int main(int argc, char *argv[])
 {
    void *handle;
@@ -767,12 +1081,19 @@ int main(int argc, char *argv[])
    LOAD(GPUWriteLong);
    LOAD(GPUWriteWord);
    LOAD(GPUReadLong);
+   LOAD(GPUSetDecodeCache);
+   LOAD(GPUSetSuperblocks);
+   LOAD(GPUSetJit);
+   LOAD(GPUSetIdleSkip);
+   LOAD(GPUIdleSkipStats);
 
    p_gpu_pc         = dlsym(handle, "gpu_pc");
    p_gpu_reg_bank_0 = dlsym(handle, "gpu_reg_bank_0");
    p_gpu_reg_bank_1 = dlsym(handle, "gpu_reg_bank_1");
+   p_gpu_exec_opcode_count = dlsym(handle, "gpu_exec_opcode_count");
 
-   if (!p_gpu_pc || !p_gpu_reg_bank_0 || !p_gpu_reg_bank_1) {
+   if (!p_gpu_pc || !p_gpu_reg_bank_0 || !p_gpu_reg_bank_1
+         || !p_gpu_exec_opcode_count) {
       fprintf(stderr, "Missing GPU internal symbols\n");
       return 1;
    }
@@ -858,6 +1179,12 @@ int main(int argc, char *argv[])
    test_pack();
    test_normi();
 
+   /* Host-side decode cache */
+   test_decode_cache_coherence();
+   test_superblock_budget();
+   test_jit_differential();
+   test_idle_skip();
+
    printf("\n=== Results: %d passed, %d failed ===\n", passes, fails);
 
    p_retro_unload_game();
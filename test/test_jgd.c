@@ -716,6 +716,12 @@ int main(int argc, char **argv)
               "jgdPage after retro_reset = {%u,%u,%u,%u,%u,%u}",
               page_ptr[0], page_ptr[1], page_ptr[2],
               page_ptr[3], page_ptr[4], page_ptr[5]);
+        /* The bus sees it too: the cart pages of the memory map are
+         * rebuilt on every bank change, not cached from the last one. */
+        check(jag_read_long(0xA00010, 0) == 0xC0DE0002u,
+              "reset_banked_read",
+              "JaguarReadLong($A00010) after reset = $%08X (expect $C0DE0002)",
+              jag_read_long(0xA00010, 0));
 
         /* ...and the state load restores the remap. */
         check(unser(state, ssize) != 0, "v8_unserialize", "state loads back");
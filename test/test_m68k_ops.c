@@ -7,7 +7,9 @@
  *
  * Tests: MOVEQ, MOVE.L, ADD, ADDI, ADDQ, SUB, SUBQ, NEG, AND, OR, EOR, NOT,
  *        CLR, SWAP, EXT, MULU, MULS, DIVU, DIVS, LSL, LSR, ASR, ROL, ROR,
- *        BTST, BSET, BCLR, CMP, TST, BRA, BEQ, BNE, BSR/RTS, NOP, LEA
+ *        BTST, BSET, BCLR, CMP, TST, BRA, BEQ, BNE, BSR/RTS, NOP, LEA,
+ *        instruction fetch across page ends and over rewritten code,
+ *        PC hook dispatch and the PC history ring
  */
 
 #include <stdio.h>
@@ -174,6 +176,9 @@ static int (*p_m68k_execute)(int);
 static void (*p_m68k_set_reg)(int, unsigned int);
 static unsigned int (*p_m68k_get_reg)(void *, int);
 static uint8_t **p_jaguarMainRAM;
+static bool *p_jaguarMemTrackInserted;
+static uint32_t *p_pcQueue;
+static uint32_t *p_pcQPtr;
 
 /* Stubs */
 static void video_refresh(const void *d, unsigned w, unsigned h, size_t p)
@@ -275,13 +280,15 @@ static void prep(void) {
       p_m68k_set_reg(i, 0);
 }
 
-static void run(int cycles) {
-   p_m68k_set_reg(M68K_REG_PC, CODE_BASE);
+static void run_at(uint32_t pc, int cycles) {
+   p_m68k_set_reg(M68K_REG_PC, pc);
    p_m68k_set_reg(M68K_REG_SR, 0x2700);
    p_m68k_set_reg(M68K_REG_SP, STACK_TOP);
    p_m68k_execute(cycles);
 }
 
+static void run(int cycles) { run_at(CODE_BASE, cycles); }
+
 static uint32_t D(int n) { return p_m68k_get_reg(NULL, M68K_REG_D0 + n); }
 static uint32_t A(int n) { return p_m68k_get_reg(NULL, M68K_REG_A0 + n); }
 static uint32_t PC(void) { return p_m68k_get_reg(NULL, M68K_REG_PC); }
@@ -770,6 +777,87 @@ static void test_nop(void)
    else FAIL("NOP: D0=%u", D(0));
 }
 
+/* Instruction fetch reads through a window over one 64K page: extension
+ * words past the page end, and code the program has just rewritten, must
+ * still come from memory. */
+static void test_fetch_window(void)
+{
+   printf("\n--- Instruction fetch window ---\n");
+   prep();
+   wmoveil(0xFFFC, 0x12345678, 0);            /* imm spans $FFFE-$10001 */
+   w16(0x10002, M68K_MOVEQ(7, 1));
+   w16(0x10004, 0x60FE);                      /* bra.s * */
+   run_at(0xFFFC, 40);
+   if (D(0) == 0x12345678 && D(1) == 7)
+      PASS("move.l #imm across a page end, then the next page");
+   else FAIL("page crossing: D0=%08X D1=%u", D(0), D(1));
+
+   prep();
+   w16(0x1FFFE, 0x343C);                      /* move.w #$ABCD, D2 */
+   w16(0x20000, 0xABCD);
+   w16(0x20002, 0x60FE);
+   run_at(0x1FFFE, 30);
+   if ((D(2) & 0xFFFF) == 0xABCD)
+      PASS("opcode in a page's last word, extension in the next");
+   else FAIL("last-word opcode: D2=%08X", D(2));
+
+   prep();
+   w16(CODE_BASE,      0x31FC);               /* move.w #$7005, $4008.w */
+   w16(CODE_BASE + 2,  M68K_MOVEQ(5, 0));
+   w16(CODE_BASE + 4,  CODE_BASE + 8);
+   w16(CODE_BASE + 8,  M68K_MOVEQ(1, 0));     /* overwritten before it runs */
+   w16(CODE_BASE + 10, 0x60FE);
+   run(60);
+   if (D(0) == 5) PASS("self-modified code is fetched fresh");
+   else FAIL("self-modifying code: D0=%u (stale fetch gives 1)", D(0));
+}
+
+static void test_instruction_hooks(void)
+{
+   unsigned i, q;
+   bool ordered = false;
+   uint32_t d0;
+
+   printf("\n--- Instruction hooks ---\n");
+   if (!p_jaguarMemTrackInserted || !p_pcQueue || !p_pcQPtr)
+   {
+      FAIL("missing jaguarMemTrackInserted/pcQueue/pcQPtr exports");
+      return;
+   }
+
+   /* The NVM BIOS registers $2404 with the hook map for every boot
+    * strategy; its hook answers only while the cookie is in place. */
+   prep();
+   *p_jaguarMemTrackInserted = true;
+   w32(0x2400, 0x5F4E564D);                   /* '_NVM' */
+   w16(0x2404, 0x4E75);                       /* rts */
+   w16(CODE_BASE,     0x3F3C);                /* move.w #99, -(sp) */
+   w16(CODE_BASE + 2, 99);
+   w16(CODE_BASE + 4, 0x4EB8);                /* jsr $2404.w */
+   w16(CODE_BASE + 6, 0x2404);
+   w16(CODE_BASE + 8, 0x60FE);
+   run(80);
+   *p_jaguarMemTrackInserted = false;
+   d0 = D(0);
+   /* ENOINIT or EINVFN, depending on whether a module is open. */
+   if (d0 == 0xFFFFFFFFu || d0 == 0xFFFFFFFCu)
+      PASS("registered PC $2404 dispatches to the NVM BIOS");
+   else FAIL("NVM dispatch: D0=%08X (0 = hook never ran)", d0);
+
+   /* Every instruction's start PC lands in the history ring, hooked or
+    * not: jsr, then the trapped rts at $2404, then the return. */
+   q = *p_pcQPtr;
+   for (i = 1; i < 0x3FF; i++)
+      if (p_pcQueue[(q - i) & 0x3FF] == 0x2404)
+      {
+         ordered = p_pcQueue[(q - i - 1) & 0x3FF] == CODE_BASE + 4
+                && p_pcQueue[(q - i + 1) & 0x3FF] == CODE_BASE + 8;
+         break;
+      }
+   if (ordered) PASS("PC history records jsr, rts at $2404, return");
+   else FAIL("PC history around $2404 not in order");
+}
+
 /* ============================================================ */
 
 int main(int argc, char *argv[])
@@ -809,6 +897,10 @@ int main(int argc, char *argv[])
       return 1;
    }
 
+   p_jaguarMemTrackInserted = dlsym(handle, "jaguarMemTrackInserted");
+   p_pcQueue = dlsym(handle, "pcQueue");
+   p_pcQPtr = dlsym(handle, "pcQPtr");
+
    p_retro_set_environment(environment);
    p_retro_set_video_refresh(video_refresh);
    p_retro_set_audio_sample(audio_sample);
@@ -890,6 +982,12 @@ int main(int argc, char *argv[])
    /* Memory indirect */
    test_load_store_indirect();
 
+   /* Instruction fetch */
+   test_fetch_window();
+
+   /* PC hooks and history */
+   test_instruction_hooks();
+
    printf("\n=== Results: %d passed, %d failed ===\n", passes, fails);
 
    p_retro_unload_game();
@@ -30,6 +30,7 @@ unsigned int m68k_read_memory_16(unsigned int a) { (void)a; return 0; }
 unsigned int m68k_read_memory_32(unsigned int a) { (void)a; return 0; }
 void m68k_write_memory_8(unsigned int a, unsigned int v) { (void)a; (void)v; }
 void m68k_write_memory_32(unsigned int a, unsigned int v) { (void)a; (void)v; }
+void M68KHookRegister(uint32_t pc) { (void)pc; }
 
 static int failures, checks;
 
@@ -157,6 +157,9 @@ int main(int argc, char **argv)
    LOADSYM_OPT(handle, DSPIsRunning);
    LOADSYM_OPT(handle, DSPReadLong);
 
+   /* The A6/D0 columns of the traceback dump are opt-in in the core. */
+   setenv("VJ_M68K_TRACEBACK", "1", 1);
+
    p_retro_set_environment(environment);
    p_retro_set_video_refresh(video_refresh);
    p_retro_set_audio_sample(audio_sample);
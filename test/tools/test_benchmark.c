@@ -3,7 +3,15 @@
 
    Usage: test_benchmark <core.dylib> <rom_file> [num_frames]
           [--blitter fast|accurate] [--warmup N] [--load-srm file]
+          [--option key=value ...] [--timing] [--timing-csv file]
 */
+
+/* clock_gettime()/CLOCK_MONOTONIC are POSIX and hidden from a -std=c99
+ * translation unit by glibc; same guard as test/harness/harness.c. */
+#if !defined(__APPLE__) && !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -36,14 +44,34 @@ static void *(*pretro_get_memory_data)(unsigned);
 static size_t (*pretro_get_memory_size)(unsigned);
 static size_t (*pretro_serialize_size)(void);
 static bool (*pretro_unserialize)(const void *, size_t);
+static bool (*pretro_serialize)(void *, size_t);
+static size_t (*pStateDeltaLastBytes)(void);
 /* Optional: only present when the core was built with BENCH_PROFILE=1. */
 static void (*pperf_counters_dump)(FILE *);
 static unsigned long long *(*pperf_counters_find)(const char *);
+/* Host time by subsystem (src/core/perf_timing.h); test-export builds. */
+static void (*pperf_timing_arm)(int);
+static const char *(*pperf_timing_name)(unsigned);
+static unsigned long long *(*pperf_timing_find)(const char *);
 
 /* Options state */
 static int bios_option_set = 0;
 static const char *blitter_value = "enabled"; /* default: fast blitter */
 
+/* Arbitrary core options from --option key=value, for A/B runs of a
+ * single toggle without rebuilding the core.  Checked before the
+ * built-in defaults above so they can override those too. */
+#define MAX_EXTRA_OPTIONS 32
+static char extra_option_buf[MAX_EXTRA_OPTIONS][128];
+static const char *extra_option_key[MAX_EXTRA_OPTIONS];
+static const char *extra_option_value[MAX_EXTRA_OPTIONS];
+static int num_extra_options = 0;
+static int serialize_each_frame = 0;
+static int hidden_frames = 0;
+static int timing_regions = 0;
+#define MAX_TIMING_REGIONS 16
+static const char *timing_csv_path = NULL;
+
 /* High-resolution timer helpers */
 #ifdef __APPLE__
 static mach_timebase_info_data_t timebase_info;
@@ -107,6 +135,15 @@ static bool environment_cb(unsigned cmd, void *data)
       case RETRO_ENVIRONMENT_GET_VARIABLE:
       {
          struct retro_variable *var = (struct retro_variable *)data;
+         int k;
+         for (k = 0; k < num_extra_options; k++)
+         {
+            if (strcmp(var->key, extra_option_key[k]) == 0)
+            {
+               var->value = extra_option_value[k];
+               return true;
+            }
+         }
          if (strcmp(var->key, "virtualjaguar_bios") == 0)
          {
             var->value = "enabled";
@@ -153,6 +190,18 @@ static bool environment_cb(unsigned cmd, void *data)
       case RETRO_ENVIRONMENT_GET_SAVE_DIRECTORY:
          *(const char **)data = "/tmp";
          return true;
+      case RETRO_ENVIRONMENT_GET_AUDIO_VIDEO_ENABLE:
+         /* --hidden models run-ahead's discarded frames. */
+         if (!hidden_frames)
+            return false;
+         *(int *)data = 0;
+         return true;
+      case RETRO_ENVIRONMENT_GET_SAVESTATE_CONTEXT:
+         /* --serialize models run-ahead: one buffer, same process. */
+         if (!serialize_each_frame)
+            return false;
+         *(int *)data = RETRO_SAVESTATE_CONTEXT_RUNAHEAD_SAME_INSTANCE;
+         return true;
       default:
          return false;
    }
@@ -186,7 +235,8 @@ static void print_usage(const char *progname)
    fprintf(stderr,
       "Usage: %s <core.dylib> <rom_file> [num_frames]\n"
       "       [--blitter fast|accurate] [--warmup N] [--load-srm file]\n"
-      "       [--load-state file]\n"
+      "       [--load-state file] [--option key=value ...] [--serialize]\n"
+      "       [--hidden] [--timing] [--timing-csv file]\n"
       "\n"
       "Options:\n"
       "  num_frames           Number of frames to benchmark (default: 300)\n"
@@ -196,7 +246,21 @@ static void print_usage(const char *progname)
       "  --load-srm file      Load EEPROM save data from file\n"
       "  --load-state file    Load a save state into the core after retro_load_game.\n"
       "                       Accepts raw retro_serialize() payloads or RetroArch\n"
-      "                       RASTATE container files (the MEM chunk is extracted).\n",
+      "                       RASTATE container files (the MEM chunk is extracted).\n"
+      "  --option key=value   Answer core option 'key' with 'value' (repeatable),\n"
+      "                       e.g. --option virtualjaguar_risc_decode_cache=disabled\n"
+      "  --serialize          After every timed frame, retro_serialize() into one\n"
+      "                       reused buffer (as run-ahead does) and report the\n"
+      "                       save cost and how much of main RAM changed per frame.\n"
+      "                       Pair with --option virtualjaguar_state_delta=enabled.\n"
+      "  --hidden             Report video and audio disabled on every frame\n"
+      "                       (GET_AUDIO_VIDEO_ENABLE = 0), as run-ahead does for\n"
+      "                       the frames it discards.\n"
+      "  --timing             Arm the core's per-subsystem host timers and report\n"
+      "                       time per frame by subsystem (needs TEST_EXPORTS=1).\n"
+      "  --timing-csv file    As --timing, and write one CSV row per timed frame:\n"
+      "                       frame, frame_ns, one column per subsystem in ns,\n"
+      "                       other_ns (the part of the frame no region covers).\n",
       progname);
 }
 
@@ -247,6 +311,36 @@ int main(int argc, char **argv)
          srm_load_path = argv[++i];
       else if (strcmp(argv[i], "--load-state") == 0 && i + 1 < argc)
          state_load_path = argv[++i];
+      else if (strcmp(argv[i], "--option") == 0 && i + 1 < argc)
+      {
+         char *buf;
+         char *eq;
+         if (num_extra_options >= MAX_EXTRA_OPTIONS
+               || strlen(argv[i + 1]) >= sizeof(extra_option_buf[0])
+               || !strchr(argv[i + 1], '='))
+         {
+            fprintf(stderr, "Bad or too many --option arguments: %s\n", argv[i + 1]);
+            return 1;
+         }
+         buf = extra_option_buf[num_extra_options];
+         strcpy(buf, argv[++i]);
+         eq  = strchr(buf, '=');
+         *eq = '\0';
+         extra_option_key[num_extra_options]   = buf;
+         extra_option_value[num_extra_options] = eq + 1;
+         num_extra_options++;
+      }
+      else if (strcmp(argv[i], "--serialize") == 0)
+         serialize_each_frame = 1;
+      else if (strcmp(argv[i], "--hidden") == 0)
+         hidden_frames = 1;
+      else if (strcmp(argv[i], "--timing") == 0)
+         timing_regions = 1;
+      else if (strcmp(argv[i], "--timing-csv") == 0 && i + 1 < argc)
+      {
+         timing_regions = 1;
+         timing_csv_path = argv[++i];
+      }
       else if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0)
       {
          print_usage(argv[0]);
@@ -323,10 +417,22 @@ int main(int argc, char **argv)
    LOAD_SYM(retro_get_memory_size);
    LOAD_SYM(retro_serialize_size);
    LOAD_SYM(retro_unserialize);
+   LOAD_SYM(retro_serialize);
 
    /* Optional perf-counter access; absent unless built with BENCH_PROFILE=1. */
    pperf_counters_dump = dlsym(handle, "perf_counters_dump");
    pperf_counters_find = dlsym(handle, "perf_counters_find");
+   /* Test-export builds only. */
+   pStateDeltaLastBytes = dlsym(handle, "StateDeltaLastBytes");
+   pperf_timing_arm  = dlsym(handle, "perf_timing_arm");
+   pperf_timing_name = dlsym(handle, "perf_timing_name");
+   pperf_timing_find = dlsym(handle, "perf_timing_find");
+   if (timing_regions && (!pperf_timing_arm || !pperf_timing_name || !pperf_timing_find))
+   {
+      fprintf(stderr, "ERROR: --timing needs perf_timing_* exports -- build the core with TEST_EXPORTS=1\n");
+      dlclose(handle);
+      return 1;
+   }
 
    pretro_set_environment(environment_cb);
    pretro_set_video_refresh(video_refresh);
@@ -345,6 +451,8 @@ int main(int argc, char **argv)
    fprintf(stderr, "  BIOS:    %s\n", bios_option_set ? "enabled" : "enabled (pending)");
    fprintf(stderr, "  Warmup:  %d frames\n", warmup_frames);
    fprintf(stderr, "  Measure: %d frames\n", num_frames);
+   for (i = 0; i < num_extra_options; i++)
+      fprintf(stderr, "  Option:  %s=%s\n", extra_option_key[i], extra_option_value[i]);
    fprintf(stderr, "---\n");
 
    if (!pretro_load_game(&info))
@@ -520,6 +628,36 @@ state_fail:
       unsigned long long *blit_inner_ctr = pperf_counters_find ? pperf_counters_find("blitter_inner") : NULL;
       unsigned long long blit_calls_prev = blit_calls_ctr ? *blit_calls_ctr : 0;
       unsigned long long blit_inner_prev = blit_inner_ctr ? *blit_inner_ctr : 0;
+      /* --serialize: the state buffer, the previous frame's main RAM
+       * image (header is 16 bytes) to diff against, and running totals. */
+      size_t state_size = pretro_serialize_size();
+      uint8_t *state_buf = NULL, *state_prev = NULL;
+      double ser_total_ms = 0.0, ser_max_ms = 0.0;
+      unsigned long long ser_changed = 0, ser_written = 0;
+      int ser_failed = 0;
+      /* --timing: each region's running total, its value at the start of
+       * the frame, and its sum over the timed frames, all in ns. */
+      unsigned long long *tr_ctr[MAX_TIMING_REGIONS];
+      unsigned long long tr_prev[MAX_TIMING_REGIONS];
+      unsigned long long tr_sum[MAX_TIMING_REGIONS];
+      const char *tr_name[MAX_TIMING_REGIONS];
+      unsigned tr_n = 0;
+      double tr_frame_ns = 0.0;
+      FILE *timing_csv = NULL;
+
+      if (serialize_each_frame)
+      {
+         state_buf  = (uint8_t *)calloc(1, state_size);
+         state_prev = (uint8_t *)calloc(1, 0x200000);
+         if (!state_buf || !state_prev)
+         {
+            fprintf(stderr, "ERROR: malloc failed for --serialize buffers\n");
+            return 1;
+         }
+         /* Untimed first save so frame 0 is measured like the rest. */
+         if (pretro_serialize(state_buf, state_size))
+            memcpy(state_prev, state_buf + 16, 0x200000);
+      }
 
       if (!frame_ms || !blit_calls_at_frame || !blit_inner_at_frame)
       {
@@ -529,6 +667,36 @@ state_fail:
          return 1;
       }
 
+      if (timing_regions)
+      {
+         unsigned r;
+         const char *name;
+
+         for (r = 0; r < MAX_TIMING_REGIONS && (name = pperf_timing_name(r)) != NULL; r++)
+         {
+            tr_name[r] = name;
+            tr_ctr[r] = pperf_timing_find(name);
+            tr_sum[r] = 0;
+         }
+         tr_n = r;
+         if (timing_csv_path)
+         {
+            timing_csv = fopen(timing_csv_path, "w");
+            if (!timing_csv)
+            {
+               fprintf(stderr, "ERROR: cannot write %s\n", timing_csv_path);
+               return 1;
+            }
+            fprintf(timing_csv, "frame,frame_ns");
+            for (r = 0; r < tr_n; r++)
+               fprintf(timing_csv, ",%s_ns", tr_name[r]);
+            fprintf(timing_csv, ",other_ns\n");
+         }
+         pperf_timing_arm(1);
+         for (r = 0; r < tr_n; r++)
+            tr_prev[r] = *tr_ctr[r];
+      }
+
       fprintf(stderr, "--- Benchmarking %d frames ---\n", num_frames);
       t_start = timer_now();
 
@@ -539,6 +707,28 @@ state_fail:
          pretro_run();
          f1 = timer_now();
          frame_ms[i] = timer_elapsed_sec(f0, f1) * 1000.0;
+         if (serialize_each_frame)
+         {
+            uint64_t s0 = timer_now();
+            double s_ms;
+            size_t off;
+            if (!pretro_serialize(state_buf, state_size))
+               ser_failed++;
+            s_ms = timer_elapsed_sec(s0, timer_now()) * 1000.0;
+            ser_total_ms += s_ms;
+            if (s_ms > ser_max_ms)
+               ser_max_ms = s_ms;
+            if (pStateDeltaLastBytes)
+               ser_written += pStateDeltaLastBytes();
+            for (off = 0; off < 0x200000; off += 4096)
+            {
+               if (memcmp(state_buf + 16 + off, state_prev + off, 4096) != 0)
+               {
+                  ser_changed += 4096;
+                  memcpy(state_prev + off, state_buf + 16 + off, 4096);
+               }
+            }
+         }
          if (blit_calls_ctr) {
             blit_calls_at_frame[i] = *blit_calls_ctr - blit_calls_prev;
             blit_calls_prev = *blit_calls_ctr;
@@ -547,9 +737,36 @@ state_fail:
             blit_inner_at_frame[i] = *blit_inner_ctr - blit_inner_prev;
             blit_inner_prev = *blit_inner_ctr;
          } else blit_inner_at_frame[i] = 0;
+         if (timing_regions)
+         {
+            /* The frame includes the --serialize save, which the
+             * savestate region also covers. */
+            double fns = timer_elapsed_sec(f0, timer_now()) * 1e9;
+            double other = fns;
+            unsigned r;
+
+            tr_frame_ns += fns;
+            if (timing_csv)
+               fprintf(timing_csv, "%d,%.0f", i, fns);
+            for (r = 0; r < tr_n; r++)
+            {
+               unsigned long long d = *tr_ctr[r] - tr_prev[r];
+               tr_prev[r] = *tr_ctr[r];
+               tr_sum[r] += d;
+               other -= (double)d;
+               if (timing_csv)
+                  fprintf(timing_csv, ",%llu", d);
+            }
+            if (timing_csv)
+               fprintf(timing_csv, ",%.0f\n", other > 0.0 ? other : 0.0);
+         }
       }
 
       t_end = timer_now();
+      if (timing_regions)
+         pperf_timing_arm(0);
+      if (timing_csv)
+         fclose(timing_csv);
 
       elapsed = timer_elapsed_sec(t_start, t_end);
       fps = (double)num_frames / elapsed;
@@ -598,6 +815,45 @@ state_fail:
              over_budget, num_frames, 100.0 * over_budget / num_frames);
       printf("=========================\n");
 
+      if (serialize_each_frame)
+      {
+         printf("\n=== SERIALIZE (per frame, %zu-byte state) ===\n", state_size);
+         printf("Serialize avg:   %.3f ms\n", ser_total_ms / num_frames);
+         printf("Serialize max:   %.3f ms\n", ser_max_ms);
+         printf("RAM changed avg: %.1f KB (4 KB pages differing from previous frame)\n",
+                (double)ser_changed / num_frames / 1024.0);
+         if (pStateDeltaLastBytes)
+            printf("Bytes written:   %.1f KB avg\n",
+                   (double)ser_written / num_frames / 1024.0);
+         if (ser_failed)
+            printf("FAILED saves:    %d\n", ser_failed);
+         printf("=========================\n");
+      }
+      free(state_buf);
+      free(state_prev);
+
+      if (timing_regions)
+      {
+         double other = tr_frame_ns;
+         unsigned r;
+
+         printf("\n=== HOST TIME BY SUBSYSTEM (per frame) ===\n");
+         for (r = 0; r < tr_n; r++)
+         {
+            other -= (double)tr_sum[r];
+            printf("%-17s %8.3f ms  %5.1f%%\n", tr_name[r],
+                   (double)tr_sum[r] / 1e6 / num_frames,
+                   tr_frame_ns > 0.0 ? 100.0 * (double)tr_sum[r] / tr_frame_ns : 0.0);
+         }
+         if (other < 0.0)
+            other = 0.0;
+         printf("%-17s %8.3f ms  %5.1f%%\n", "other", other / 1e6 / num_frames,
+                tr_frame_ns > 0.0 ? 100.0 * other / tr_frame_ns : 0.0);
+         if (timing_csv_path)
+            printf("Per-frame CSV:   %s\n", timing_csv_path);
+         printf("=========================\n");
+      }
+
       /* If we have per-frame blitter counters, dump the slowest frames
        * so we can correlate blit volume with frame-time spikes. */
       if (over_budget > 0 && blit_calls_ctr) {
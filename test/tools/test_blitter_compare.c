@@ -2,6 +2,12 @@
    reports which blit operations produce different results between the fast
    (old) blitter and the accurate (Midsummer2) blitter.
 
+   With --specialised it instead diffs one engine's specialised command
+   loops against its generic loop, registers included (the accurate engine,
+   or the fast one with --fast-engine).  Those must never differ.
+   --bulk does the same for the accurate engine's bulk phrase path
+   against its state machine.
+
    Usage: test_blitter_compare <core.dylib> <rom_file> [num_frames]
 */
 #include <stdio.h>
@@ -41,8 +47,12 @@ static void (*pBlitterCompareSetFrame)(uint32_t);
 static void (*pBlitterCompareSetFrameWindow)(uint32_t, uint32_t);
 static void (*pBlitterCompareSetCmdMask)(uint32_t, uint32_t);
 static void (*pBlitterCompareSetVerbose)(int);
+static void (*pBlitterCompareSetPair)(int);
+static void (*pBlitterSpecialiseStats)(uint32_t *, uint32_t *);
+static void (*pBlitterBulkStats)(uint32_t *);
 
 static int bios_option_set = 0;
+static int fast_engine = 0;
 
 static void log_printf(enum retro_log_level level, const char *fmt, ...)
 {
@@ -87,10 +97,11 @@ static bool environment_cb(unsigned cmd, void *data)
             var->value = "disabled";
             return true;
          }
-         /* Do NOT set usefastblitter - comparison mode handles both */
+         /* Engine comparison runs both regardless; --fast-engine picks
+          * the one the specialised comparison runs. */
          if (strcmp(var->key, "virtualjaguar_usefastblitter") == 0)
          {
-            var->value = "disabled";
+            var->value = fast_engine ? "enabled" : "disabled";
             return true;
          }
          var->value = NULL;
@@ -211,6 +222,9 @@ int main(int argc, char **argv)
    uint32_t cmd_mask = 0;
    uint32_t cmd_value = 0;
    int verbose_dump = 0;
+   int specialised = 0;
+   int bulk = 0;
+   uint32_t spec_hits = 0, spec_misses = 0, bulk_blits = 0;
 
    if (argc < 3)
    {
@@ -218,12 +232,16 @@ int main(int argc, char **argv)
          "Usage: %s <core.dylib> <rom_file> [num_frames] "
          "[--load-state file] [--save-state file] [--load-srm file] "
          "[--warmup N] [--frame-window FIRST LAST] "
-         "[--cmd-filter MASK VAL] [--verbose-dump]\n",
+         "[--cmd-filter MASK VAL] [--verbose-dump] "
+         "[--specialised [--fast-engine] | --bulk]\n",
          argv[0]);
       fprintf(stderr,
          "  --frame-window FIRST LAST  inclusive frame range to compare\n"
          "  --cmd-filter MASK VAL      compare only when (cmd & MASK) == VAL\n"
-         "  --verbose-dump             dump pre-blit regs + dst hex on diff\n");
+         "  --verbose-dump             dump pre-blit regs + dst hex on diff\n"
+         "  --specialised              diff specialised vs generic loops\n"
+         "  --fast-engine              ... of the fast engine, not the accurate one\n"
+         "  --bulk                     diff the bulk phrase path vs the state machine\n");
       return 1;
    }
 
@@ -276,6 +294,12 @@ int main(int argc, char **argv)
       }
       else if (strcmp(argv[i], "--verbose-dump") == 0)
          verbose_dump = 1;
+      else if (strcmp(argv[i], "--specialised") == 0)
+         specialised = 1;
+      else if (strcmp(argv[i], "--fast-engine") == 0)
+         fast_engine = 1;
+      else if (strcmp(argv[i], "--bulk") == 0)
+         bulk = 1;
       else if (argv[i][0] == '-')
       {
          fprintf(stderr, "%s: unknown option '%s'\n", argv[0], argv[i]);
@@ -343,6 +367,9 @@ int main(int argc, char **argv)
    LOAD_SYM_OPT(BlitterCompareSetFrameWindow);
    LOAD_SYM_OPT(BlitterCompareSetCmdMask);
    LOAD_SYM_OPT(BlitterCompareSetVerbose);
+   LOAD_SYM_OPT(BlitterCompareSetPair);
+   LOAD_SYM_OPT(BlitterSpecialiseStats);
+   LOAD_SYM_OPT(BlitterBulkStats);
 
    if (!pBlitterCompareEnable || !pBlitterCompareGetStats)
    {
@@ -351,6 +378,27 @@ int main(int argc, char **argv)
       dlclose(handle);
       return 1;
    }
+   if (specialised && (!pBlitterCompareSetPair || !pBlitterSpecialiseStats))
+   {
+      fprintf(stderr, "Core has no command specialisation. Rebuild core.\n");
+      free((void*)info.data);
+      dlclose(handle);
+      return 1;
+   }
+   if (bulk && (specialised || fast_engine))
+   {
+      fprintf(stderr, "--bulk is an accurate-engine pair; drop --specialised/--fast-engine.\n");
+      free((void*)info.data);
+      dlclose(handle);
+      return 1;
+   }
+   if (bulk && (!pBlitterCompareSetPair || !pBlitterBulkStats))
+   {
+      fprintf(stderr, "Core has no bulk phrase path. Rebuild core.\n");
+      free((void*)info.data);
+      dlclose(handle);
+      return 1;
+   }
 
    pretro_set_environment(environment_cb);
    pretro_set_video_refresh(video_refresh);
@@ -491,8 +539,22 @@ int main(int argc, char **argv)
    }
 
    /* Enable blitter comparison mode */
+   if (specialised)
+   {
+      pBlitterCompareSetPair(1);   /* BLIT_CMP_PAIR_SPECIALISED */
+      pBlitterSpecialiseStats(&spec_hits, &spec_misses);
+   }
+   else if (bulk)
+   {
+      pBlitterCompareSetPair(2);   /* BLIT_CMP_PAIR_BULK */
+      pBlitterBulkStats(&bulk_blits);
+   }
    pBlitterCompareEnable(1);
-   fprintf(stderr, "--- Blitter comparison enabled ---\n");
+   fprintf(stderr, "--- Blitter comparison enabled (%s) ---\n",
+           bulk ? "accurate engine, bulk phrase path vs state machine"
+           : !specialised ? "fast vs accurate engine"
+           : fast_engine ? "fast engine, specialised vs generic"
+           : "accurate engine, specialised vs generic");
 
    /* Apply filters.  Setters are optional symbols so older cores still
     * link; warn if the user passed a filter flag but the core lacks it. */
@@ -550,6 +612,21 @@ int main(int argc, char **argv)
    if (total > 0)
       fprintf(stderr, "Difference rate:       %.2f%%\n",
               100.0 * diffs / total);
+   if (specialised)
+   {
+      uint32_t hits, misses;
+      pBlitterSpecialiseStats(&hits, &misses);
+      /* Only the specialised pass counts: the generic pass runs with
+       * specialisation switched off. */
+      fprintf(stderr, "Specialised blits:     %u (%u took the generic loop)\n",
+              (unsigned)(hits - spec_hits), (unsigned)(misses - spec_misses));
+   }
+   if (bulk)
+   {
+      uint32_t blits;
+      pBlitterBulkStats(&blits);
+      fprintf(stderr, "Bulk phrase blits:     %u\n", (unsigned)(blits - bulk_blits));
+   }
    fprintf(stderr, "Result: %s\n",
            diffs > 0 ? "DIFFERENCES FOUND" : "IDENTICAL");
 
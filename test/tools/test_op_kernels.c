@@ -0,0 +1,382 @@
+/* test_op_kernels.c -- The bitmap kernels must not change a pixel.
+ *
+ * OPProcessFixedBitmap and OPProcessScaledBitmap run a specialised copy
+ * of their loop per depth/RMW/TRANS combination, and the unreflected
+ * non-RMW 16bpp and 8bpp fixed copies write whole runs through the
+ * op_simd.h spans (op.c, "Bitmap kernels").  OPSetBitmapKernels(false)
+ * sends every object through the generic loops, which stay the
+ * reference.  Checks:
+ *
+ *   - objects_match_reference  random fixed and scaled objects -- every
+ *                              depth and flag, clipped both edges,
+ *                              firstPix, pitch 0..7, hscale, data in
+ *                              RAM, ROM and across a page boundary --
+ *                              leave the same TOM RAM (line buffer and
+ *                              all) and charge the bus arbiter the same
+ *                              OP clocks with the kernels on as off
+ *   - kernels_serve_objects    the on arm ran every object through a
+ *                              kernel; the off arm none
+ *   - frames_identical         a ROM window from one state hashes the
+ *                              same frame by frame both ways
+ *   - state_untouched          and ends in the same savestate
+ *
+ * Run the ROM window at 2x true color too (see the Makefile line): the
+ * 16bpp span path then has to make the same shadow resolves.
+ *
+ * Usage: ./test/tools/test_op_kernels <core> <rom> [--frames N]
+ *                                     [--warmup N] [--objects N] [--json]
+ *                                     [--option K=V ...]
+ *
+ * Exit:  0 PASS, 1 FAIL, 2 SKIP (ROM missing)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <unistd.h>
+
+#include "../harness/harness.h"
+#include "bus_arbiter.h"
+
+#define DEFAULT_WARMUP  120
+#define DEFAULT_FRAMES  120
+#define DEFAULT_OBJECTS 20000
+#define RESERVED_OFF    12
+
+#define TOM_RAM_SIZE    0x4000
+#define SCRATCH         0x100000u  /* 64 KB of main RAM the fuzz owns */
+#define SCRATCH_SIZE    0x10000u
+
+static void (*p_fixed)(uint64_t, uint64_t, bool);
+static void (*p_scaled)(uint64_t, uint64_t, uint64_t, bool);
+static void (*p_set_kernels)(bool);
+static void (*p_stats)(uint64_t *, uint64_t *);
+static size_t (*p_serialize_size)(void);
+static bool   (*p_serialize)(void *, size_t);
+static bool   (*p_unserialize)(const void *, size_t);
+static uint8_t *tom;
+static uint8_t *ram;
+static struct BusArbiter *arb;
+
+static size_t state_size;
+static uint32_t rng_state = 0x0B1EC7u;
+
+static uint32_t rng(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+/* First differing offset of two images, skipping the reserved word, or -1. */
+static long image_diff(const uint8_t *a, const uint8_t *b)
+{
+    size_t i;
+
+    for (i = 0; i < state_size; i++) {
+        if (i >= RESERVED_OFF && i < RESERVED_OFF + 4)
+            continue;
+        if (a[i] != b[i])
+            return (long)i;
+    }
+    return -1;
+}
+
+/* Pixel data: mostly the fuzz's own RAM (with runs of zero words for
+ * TRANS), sometimes the cart ROM or the BIOS, sometimes the last few
+ * phrases of a page so the span path has to fall back. */
+static uint32_t random_data(void)
+{
+    switch (rng() % 8) {
+    case 0:  return 0x800000u + (rng() % 0x100000u);
+    case 1:  return 0xE00000u + (rng() % 0x20000u);
+    case 2:  return SCRATCH + SCRATCH_SIZE - 8 * (1 + rng() % 16);
+    default: return SCRATCH + (rng() % SCRATCH_SIZE);
+    }
+}
+
+static void fill_inputs(void)
+{
+    unsigned i;
+
+    for (i = 0; i < SCRATCH_SIZE; i += 2) {
+        uint32_t r = rng();
+        ram[SCRATCH + i]     = (r & 3) ? (uint8_t)(r >> 8) : 0;
+        ram[SCRATCH + i + 1] = (r & 3) ? (uint8_t)(r >> 16) : 0;
+    }
+    /* CLUT, a few zero entries at non-zero indices */
+    for (i = 0; i < 512; i++)
+        tom[0x400 + i] = (i % 14 == 6) ? 0 : (uint8_t)rng();
+}
+
+/* Objects stay narrower than the line buffer: one that overhangs both
+ * edges makes the stock phrase clip keep only the last edge's count and
+ * write far outside TOM RAM, kernels or not. */
+static void random_object(uint64_t *p0, uint64_t *p1, uint64_t *p2)
+{
+    static const uint32_t phrasePixels[6] = { 64, 32, 16, 8, 4, 2 };
+    uint32_t r = rng();
+    int32_t  xpos = (int32_t)(rng() % 1600) - 400;
+    uint32_t depth = rng() % 6;
+    uint32_t iwidth = (r & 0x0F) == 0 ? rng() % 0x400 : rng() % 48;
+    uint32_t hscale;
+
+    switch ((r >> 4) % 4) {
+    case 0:  hscale = 0x20; break;
+    case 1:  hscale = 0x10 + (rng() % 0x30); break;
+    default: hscale = rng() % 0x100; break;
+    }
+    while (iwidth * phrasePixels[depth] * (hscale > 0x20 ? hscale : 0x20) / 0x20 > 640)
+        iwidth >>= 1;
+
+    *p0 = (uint64_t)(random_data() & 0xFFFFF8) << 40;
+    *p1 = ((uint64_t)((uint32_t)xpos & 0xFFF))
+        | ((uint64_t)depth << 12)                 /* 1..24 bpp */
+        | ((uint64_t)(rng() % 8) << 15)          /* pitch */
+        | ((uint64_t)(rng() & 0x3FF) << 18)      /* dwidth */
+        | ((uint64_t)iwidth << 28)
+        | ((uint64_t)(rng() & 0x7F) << 38)       /* index */
+        | ((uint64_t)(rng() % 8) << 45)          /* REFLECT/RMW/TRANS */
+        | ((uint64_t)(rng() & 0x3F) << 49);      /* firstPix */
+    *p2 = hscale;
+}
+
+/* One object through one arm from the same TOM RAM; returns the OP
+ * clocks it charged and leaves TOM RAM in out. */
+static uint32_t run_arm(bool kernels, bool scaled, uint64_t p0, uint64_t p1,
+                        uint64_t p2, const uint8_t *before, uint8_t *out)
+{
+    memcpy(tom, before, TOM_RAM_SIZE);
+    arb->op_clk_accum = 0;
+    p_set_kernels(kernels);
+    if (scaled)
+        p_scaled(p0, p1, p2, true);
+    else
+        p_fixed(p0, p1, true);
+    memcpy(out, tom, TOM_RAM_SIZE);
+    return arb->op_clk_accum;
+}
+
+int main(int argc, char **argv)
+{
+    harness_config cfg = HARNESS_CONFIG_DEFAULT;
+    harness_result results[4];
+    unsigned       nres = 0;
+    unsigned       warmup = DEFAULT_WARMUP;
+    unsigned       objects = DEFAULT_OBJECTS;
+    unsigned       i;
+    uint32_t      *ref = NULL;
+    uint8_t       *start = NULL, *after_off = NULL, *after_on = NULL;
+    static uint8_t saved_tom[TOM_RAM_SIZE], saved_ram[SCRATCH_SIZE];
+    static uint8_t before[TOM_RAM_SIZE], out_off[TOM_RAM_SIZE], out_on[TOM_RAM_SIZE];
+    uint64_t       h0, h1, h2, m0, m1, m2;
+    uint32_t       saved_accum;
+    uint8_t        saved_enabled;
+    int            object_bad = -1;
+    int            frame_bad = -1;
+    long           state_off = -1;
+    bool           served;
+    char           d_obj[200], d_serve[160], d_frames[160], d_state[160];
+    int            failed = 0;
+
+    for (i = 1; i < (unsigned)argc; i++) {
+        if (!strcmp(argv[i], "--warmup") && i + 1 < (unsigned)argc)
+            warmup = (unsigned)atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--objects") && i + 1 < (unsigned)argc)
+            objects = (unsigned)atoi(argv[++i]);
+    }
+
+    cfg.frames = DEFAULT_FRAMES;
+    if (!harness_init_from_args(&cfg, argc, argv)) {
+        fprintf(stderr, "usage: %s <core> <rom> [--frames N] [--warmup N] "
+                "[--objects N] [--json]\n", argv[0]);
+        return 1;
+    }
+    cfg.want_fb_hash = 1;
+
+    if (!cfg.rom_path || access(cfg.rom_path, R_OK) != 0) {
+        printf("SKIP: ROM not available (%s)\n",
+               cfg.rom_path ? cfg.rom_path : "(none)");
+        return 2;
+    }
+
+    if (!harness_load_core(&cfg))
+        return 1;
+    if (!harness_load_rom(&cfg)) {
+        harness_shutdown(&cfg);
+        return 1;
+    }
+
+    p_fixed          = harness_dlsym(&cfg, "OPProcessFixedBitmap");
+    p_scaled         = harness_dlsym(&cfg, "OPProcessScaledBitmap");
+    p_set_kernels    = harness_dlsym(&cfg, "OPSetBitmapKernels");
+    p_stats          = harness_dlsym(&cfg, "OPBitmapKernelStats");
+    p_serialize_size = harness_dlsym(&cfg, "retro_serialize_size");
+    p_serialize      = harness_dlsym(&cfg, "retro_serialize");
+    p_unserialize    = harness_dlsym(&cfg, "retro_unserialize");
+    tom              = harness_dlsym(&cfg, "tomRam8");
+    arb              = harness_dlsym(&cfg, "busArbiter");
+    {
+        uint8_t **ramp = harness_dlsym(&cfg, "jaguarMainRAM");
+        ram = ramp ? *ramp : NULL;
+    }
+    if (!p_fixed || !p_scaled || !p_set_kernels || !p_stats || !p_serialize_size
+            || !p_serialize || !p_unserialize || !tom || !arb || !ram) {
+        fprintf(stderr, "FAIL: needs a TEST_EXPORTS=1 core\n");
+        harness_shutdown(&cfg);
+        return 1;
+    }
+
+    state_size = p_serialize_size();
+    ref        = (uint32_t *)calloc(cfg.frames, sizeof(*ref));
+    start      = (uint8_t *)malloc(state_size);
+    after_off  = (uint8_t *)malloc(state_size);
+    after_on   = (uint8_t *)malloc(state_size);
+    if (!ref || !start || !after_off || !after_on) {
+        fprintf(stderr, "FAIL: out of memory\n");
+        harness_shutdown(&cfg);
+        return 1;
+    }
+
+    for (i = 0; i < warmup; i++)
+        harness_step(&cfg);
+    p_serialize(start, state_size);
+
+    /* ---------- synthetic objects, between frames ---------- */
+
+    memcpy(saved_tom, tom, TOM_RAM_SIZE);
+    memcpy(saved_ram, ram + SCRATCH, SCRATCH_SIZE);
+    saved_accum   = arb->op_clk_accum;
+    saved_enabled = arb->enabled;
+    arb->enabled  = 1;
+    fill_inputs();
+
+    p_stats(&h0, &m0);
+    for (i = 0; i < objects && object_bad < 0; i++) {
+        uint64_t p0, p1, p2;
+        bool     scaled = (i & 1) != 0;
+        uint32_t clk_off, clk_on;
+        unsigned k;
+
+        random_object(&p0, &p1, &p2);
+        memcpy(before, tom, TOM_RAM_SIZE);
+        for (k = 0x1800; k < TOM_RAM_SIZE; k++)
+            before[k] = (uint8_t)rng();
+
+        clk_off = run_arm(false, scaled, p0, p1, p2, before, out_off);
+        if (i == 0)
+            p_stats(&h1, &m1);
+        clk_on  = run_arm(true, scaled, p0, p1, p2, before, out_on);
+
+        if (clk_off != clk_on || memcmp(out_off, out_on, TOM_RAM_SIZE) != 0) {
+            for (k = 0; k < TOM_RAM_SIZE; k++)
+                if (out_off[k] != out_on[k])
+                    break;
+            object_bad = (int)i;
+            if (k < TOM_RAM_SIZE)
+                snprintf(d_obj, sizeof(d_obj),
+                         "%s object %u (p0=%016llX p1=%016llX p2=%02X): "
+                         "TOM RAM $%04X ref %02X got %02X",
+                         scaled ? "scaled" : "fixed", i,
+                         (unsigned long long)p0, (unsigned long long)p1,
+                         (unsigned)p2, k, out_off[k], out_on[k]);
+            else
+                snprintf(d_obj, sizeof(d_obj),
+                         "%s object %u (p0=%016llX p1=%016llX p2=%02X): "
+                         "OP clocks ref %u got %u",
+                         scaled ? "scaled" : "fixed", i,
+                         (unsigned long long)p0, (unsigned long long)p1,
+                         (unsigned)p2, clk_off, clk_on);
+        }
+    }
+    p_stats(&h2, &m2);
+
+    /* The off arm of object 0 took no kernel; every on arm did. */
+    served = h1 == h0 && m1 == m0 && h2 - h1 == (uint64_t)i && m2 == m1;
+    snprintf(d_serve, sizeof(d_serve),
+             "%llu objects through a kernel, %llu through the generic loop "
+             "while enabled",
+             (unsigned long long)(h2 - h1), (unsigned long long)(m2 - m1));
+
+    memcpy(tom, saved_tom, TOM_RAM_SIZE);
+    memcpy(ram + SCRATCH, saved_ram, SCRATCH_SIZE);
+    arb->op_clk_accum = saved_accum;
+    arb->enabled      = saved_enabled;
+
+    if (object_bad < 0)
+        snprintf(d_obj, sizeof(d_obj),
+                 "%u random objects identical with the kernels on and off", i);
+
+    /* ---------- ROM window, both ways from one state ---------- */
+
+    p_unserialize(start, state_size);
+    p_set_kernels(false);
+    for (i = 0; i < cfg.frames; i++) {
+        harness_step(&cfg);
+        ref[i] = cfg.last_fb_hash;
+    }
+    p_serialize(after_off, state_size);
+
+    p_unserialize(start, state_size);
+    p_set_kernels(true);
+    for (i = 0; i < cfg.frames; i++) {
+        harness_step(&cfg);
+        if (cfg.last_fb_hash != ref[i] && frame_bad < 0)
+            frame_bad = (int)i;
+    }
+    p_serialize(after_on, state_size);
+    state_off = image_diff(after_off, after_on);
+
+    /* ---------- report ---------- */
+
+    results[nres].status = (object_bad < 0) ? "PASS" : "FAIL";
+    results[nres].name   = "objects_match_reference";
+    results[nres].detail = d_obj;
+    if (object_bad >= 0) failed = 1;
+    nres++;
+
+    results[nres].status = served ? "PASS" : "FAIL";
+    results[nres].name   = "kernels_serve_objects";
+    results[nres].detail = d_serve;
+    if (!served) failed = 1;
+    nres++;
+
+    if (frame_bad < 0)
+        snprintf(d_frames, sizeof(d_frames),
+                 "%u frames hash identical with the kernels on and off",
+                 cfg.frames);
+    else
+        snprintf(d_frames, sizeof(d_frames),
+                 "frame %d of the window differs from the generic pass",
+                 frame_bad);
+    results[nres].status = (frame_bad < 0) ? "PASS" : "FAIL";
+    results[nres].name   = "frames_identical";
+    results[nres].detail = d_frames;
+    if (frame_bad >= 0) failed = 1;
+    nres++;
+
+    if (state_off < 0)
+        snprintf(d_state, sizeof(d_state),
+                 "savestate after the window is byte-identical");
+    else
+        snprintf(d_state, sizeof(d_state),
+                 "savestates differ at offset %ld", state_off);
+    results[nres].status = (state_off < 0) ? "PASS" : "FAIL";
+    results[nres].name   = "state_untouched";
+    results[nres].detail = d_state;
+    if (state_off >= 0) failed = 1;
+    nres++;
+
+    harness_report(&cfg, results, nres);
+
+    free(ref);
+    free(start);
+    free(after_off);
+    free(after_on);
+    harness_shutdown(&cfg);
+
+    return failed;
+}
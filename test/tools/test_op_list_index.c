@@ -0,0 +1,241 @@
+/*
+ * test_op_list_index.c — Object Processor object-list index.
+ *
+ * OPProcessList remembers each object's first phrase for the rest of the
+ * field (op.c, "Object-list index") and re-reads it only when something
+ * writes into the list's RAM pages.  Contract checked here:
+ *
+ *   1. index_matches_reference — a walk over several halflines leaves
+ *      the same line buffer per halfline and the same list bytes in RAM
+ *      (height/data write-backs) with the index on as with it off.  The
+ *      rendered object's height runs out mid-walk, so the write-back has
+ *      to be carried in the index for the next halfline to reject it.
+ *   2. index_serves_hits — the on arm actually decided objects from the
+ *      index; the off arm never did.
+ *   3. bus_write_invalidates — rewriting the object's header through the
+ *      bus mid-field (what a 68K/GPU list update does) is seen on the
+ *      very next halfline.
+ *   4. field_start_rereads — a host-side poke (bypasses every write hook,
+ *      like a frontend cheat) is seen once a new field starts.
+ *
+ * Build: make TEST_EXPORTS=1 test/tools/test_op_list_index
+ * Run:   ./test/tools/test_op_list_index ./virtualjaguar_libretro.so \
+ *            test/roms/yarc.j64
+ */
+
+#include "../harness/harness.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dlfcn.h>
+
+#define LIST_BASE   0x10000u   /* phrase-aligned scratch in main RAM */
+#define SKIP_OBJ    (LIST_BASE + 0x00)  /* double-phrase aligned */
+#define BMP_OBJ     (LIST_BASE + 0x10)
+#define STOP_OBJ    (LIST_BASE + 0x20)
+#define PIX_DATA    (LIST_BASE + 0x800)
+#define LIST_BYTES  0x28
+
+#define FIRST_HALFLINE 100
+#define WALK_LINES     4          /* 100, 102, 104, 106 */
+#define BMP_HEIGHT     2
+#define BMP_XPOS       8
+
+#define WHO_GPU 3                 /* vjag_memory.h: UNKNOWN, JAGUAR, DSP, GPU */
+
+static uint8_t *g_tom;
+static uint8_t *g_ram;
+static void (*g_opproc)(int halfline, bool render);
+static void (*g_setindex)(bool enabled);
+static void (*g_stats)(uint64_t *hits, uint64_t *misses);
+static void (*g_jwl)(uint32_t addr, uint32_t data, uint32_t who);
+
+static void put_phrase(uint32_t addr, uint64_t v)
+{
+    int i;
+    for (i = 7; i >= 0; i--) {
+        g_ram[addr + i] = (uint8_t)(v & 0xFF);
+        v >>= 8;
+    }
+}
+
+static void set_olp(uint32_t addr)
+{
+    /* OLP is LO word at $20, HI word at $22, each stored big-endian */
+    g_tom[0x20] = (uint8_t)((addr >> 8) & 0xFF);
+    g_tom[0x21] = (uint8_t)(addr & 0xFF);
+    g_tom[0x22] = (uint8_t)((addr >> 24) & 0xFF);
+    g_tom[0x23] = (uint8_t)((addr >> 16) & 0xFF);
+}
+
+static uint64_t bitmap_p0(unsigned ypos, unsigned height, uint32_t link)
+{
+    uint64_t p0 = 0;                              /* type 0 = BITMAP */
+    p0 |= (uint64_t)(ypos & 0x7FF) << 3;
+    p0 |= (uint64_t)(height & 0x3FF) << 14;
+    p0 |= (uint64_t)(link & 0x3FFFF8) << 21;
+    p0 |= (uint64_t)(PIX_DATA & 0xFFFFF8) << 40;
+    return p0;
+}
+
+static uint64_t bitmap_p1(void)
+{
+    uint64_t p1 = 0;
+    p1 |= (uint64_t)(BMP_XPOS & 0xFFF);           /* xpos */
+    p1 |= (uint64_t)4 << 12;                      /* depth = 16bpp */
+    p1 |= (uint64_t)1 << 15;                      /* pitch = 1 phrase */
+    p1 |= (uint64_t)1 << 18;                      /* dwidth = 1 */
+    p1 |= (uint64_t)1 << 28;                      /* iwidth = 1 */
+    return p1;
+}
+
+/* [SKIP: ypos 400, rejected on every walked line][BMP: ypos 100,
+ * height 2][STOP].  Pixel data is a ramp so each write-back's data
+ * advance shows up as different pixels on the next line. */
+static void build_list(void)
+{
+    unsigned i;
+
+    put_phrase(SKIP_OBJ, bitmap_p0(400, 8, BMP_OBJ));
+    put_phrase(SKIP_OBJ + 8, bitmap_p1());
+    put_phrase(BMP_OBJ, bitmap_p0(FIRST_HALFLINE, BMP_HEIGHT, STOP_OBJ));
+    put_phrase(BMP_OBJ + 8, bitmap_p1());
+    put_phrase(STOP_OBJ, 0x04ull);                /* STOP, no IRQ */
+
+    for (i = 0; i < 64; i++)
+        g_ram[PIX_DATA + i] = (uint8_t)(0x11 * (i + 1));
+
+    set_olp(SKIP_OBJ);
+}
+
+static void clear_linebuffer(void)
+{
+    memset(&g_tom[0x1800], 0, 1440);
+}
+
+/* 16bpp render writes pixels at lbuf 0x1800 + xpos*2 */
+static int linebuffer_has_pixels(void)
+{
+    static const uint8_t zero[8];
+    return memcmp(&g_tom[0x1800 + BMP_XPOS * 2], zero, 8) != 0;
+}
+
+/* One arm: walk WALK_LINES halflines from a fresh field, keeping each
+ * line's rendered pixels and the list bytes afterwards. */
+static void walk(bool indexed, uint8_t lines[WALK_LINES][8],
+                 uint8_t list[LIST_BYTES])
+{
+    unsigned i;
+
+    g_setindex(indexed);
+    build_list();
+    g_opproc(0, 0);                               /* new field */
+    for (i = 0; i < WALK_LINES; i++) {
+        clear_linebuffer();
+        g_opproc(FIRST_HALFLINE + 2 * i, 1);
+        memcpy(lines[i], &g_tom[0x1800 + BMP_XPOS * 2], 8);
+    }
+    memcpy(list, &g_ram[LIST_BASE], LIST_BYTES);
+}
+
+int main(int argc, char **argv)
+{
+    harness_config cfg = HARNESS_CONFIG_DEFAULT;
+    harness_result results[4];
+    unsigned nres = 0;
+    uint8_t lines_on[WALK_LINES][8], lines_off[WALK_LINES][8];
+    uint8_t list_on[LIST_BYTES], list_off[LIST_BYTES];
+    uint64_t hits0, hits1, hits2, misses;
+    uint64_t p0;
+    int pass_match, pass_hits, pass_bus, pass_field;
+    int rendered, expect;
+    unsigned i;
+
+    cfg.frames = 2;
+    if (!harness_init_from_args(&cfg, argc, argv)) return 1;
+    if (!cfg.rom_path) cfg.rom_path = "test/roms/yarc.j64";
+    if (!harness_load_rom(&cfg)) return 1;
+    harness_run(&cfg);
+
+    g_tom = (uint8_t *)dlsym(cfg.core_handle, "tomRam8");
+    {
+        uint8_t **ramp = (uint8_t **)dlsym(cfg.core_handle, "jaguarMainRAM");
+        g_ram = ramp ? *ramp : NULL;
+    }
+    g_opproc = (void (*)(int, bool))dlsym(cfg.core_handle, "OPProcessList");
+    g_setindex = (void (*)(bool))dlsym(cfg.core_handle, "OPSetListIndex");
+    g_stats = (void (*)(uint64_t *, uint64_t *))
+        dlsym(cfg.core_handle, "OPListIndexStats");
+    g_jwl = (void (*)(uint32_t, uint32_t, uint32_t))
+        dlsym(cfg.core_handle, "JaguarWriteLong");
+    if (!g_tom || !g_ram || !g_opproc || !g_setindex || !g_stats || !g_jwl) {
+        fprintf(stderr, "test_op_list_index: needs TEST_EXPORTS=1 core\n");
+        return 1;
+    }
+
+    /* 1 + 2. Same walk with the index off, then on. */
+    g_stats(&hits0, NULL);
+    walk(false, lines_off, list_off);
+    g_stats(&hits1, NULL);
+    walk(true, lines_on, list_on);
+    g_stats(&hits2, &misses);
+
+    pass_match = memcmp(lines_on, lines_off, sizeof(lines_on)) == 0
+              && memcmp(list_on, list_off, sizeof(list_on)) == 0;
+    for (i = 0; i < WALK_LINES; i++) {
+        static const uint8_t zero[8];
+        rendered = memcmp(lines_on[i], zero, 8) != 0;
+        expect = i < BMP_HEIGHT;
+        if (rendered != expect)
+            pass_match = 0;
+    }
+    results[nres].status = pass_match ? "PASS" : "FAIL";
+    results[nres].name   = "index_matches_reference";
+    results[nres].detail = pass_match
+        ? "line buffer and list write-backs identical with the index on/off"
+        : "indexed walk diverged from the reference walk";
+    nres++;
+
+    pass_hits = hits1 == hits0 && hits2 > hits1;
+    results[nres].status = pass_hits ? "PASS" : "FAIL";
+    results[nres].name   = "index_serves_hits";
+    results[nres].detail = pass_hits
+        ? "later halflines decided from the index; none with it off"
+        : "index hit counts wrong";
+    nres++;
+    printf("index: %llu hits, %llu misses\n",
+           (unsigned long long)(hits2 - hits1), (unsigned long long)misses);
+
+    /* 3. Mid-field header rewrite through the bus: height back to 1.
+     *    The walk above ended at halfline 106 with the height spent. */
+    p0 = bitmap_p0(FIRST_HALFLINE, 1, STOP_OBJ);
+    g_jwl(BMP_OBJ, (uint32_t)(p0 >> 32), WHO_GPU);
+    g_jwl(BMP_OBJ + 4, (uint32_t)p0, WHO_GPU);
+    clear_linebuffer();
+    g_opproc(FIRST_HALFLINE + 2 * WALK_LINES, 1);
+    pass_bus = linebuffer_has_pixels();
+    results[nres].status = pass_bus ? "PASS" : "FAIL";
+    results[nres].name   = "bus_write_invalidates";
+    results[nres].detail = pass_bus
+        ? "bus write into the list re-read on the next halfline"
+        : "stale header served after a bus write";
+    nres++;
+
+    /* 4. Host-side poke, no write hook: seen from the next field on. */
+    put_phrase(BMP_OBJ, bitmap_p0(FIRST_HALFLINE, 1, STOP_OBJ));
+    clear_linebuffer();
+    g_opproc(FIRST_HALFLINE, 1);
+    pass_field = linebuffer_has_pixels();
+    results[nres].status = pass_field ? "PASS" : "FAIL";
+    results[nres].name   = "field_start_rereads";
+    results[nres].detail = pass_field
+        ? "new field re-read the list from RAM"
+        : "index survived a field start";
+    nres++;
+
+    g_setindex(true);
+    harness_report(&cfg, results, nres);
+    harness_shutdown(&cfg);
+    return (pass_match && pass_hits && pass_bus && pass_field) ? 0 : 1;
+}
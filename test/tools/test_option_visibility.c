@@ -273,6 +273,7 @@ int main(int argc, char **argv)
    expect("(cart)", "virtualjaguar_cd_boot_mode",  false);
    expect("(cart)", "virtualjaguar_cd_bios_type",  false);
    expect("(cart)", "virtualjaguar_cd_read_speed", false);
+   expect("(cart)", "virtualjaguar_cd_read_ahead", false);
    expect("(cart)", "virtualjaguar_cd_trace",      false);
    expect("(cart)", "virtualjaguar_bios",          true);
    expect("(cart)", "virtualjaguar_bios_type",     true);
@@ -367,6 +368,7 @@ int main(int argc, char **argv)
          expect("(cd)", "virtualjaguar_cd_boot_mode",  true);
          expect("(cd)", "virtualjaguar_cd_bios_type",  true);
          expect("(cd)", "virtualjaguar_cd_read_speed", true);
+         expect("(cd)", "virtualjaguar_cd_read_ahead", true);
          expect("(cd)", "virtualjaguar_cd_trace",      true);
          expect("(cd)", "virtualjaguar_bios",          false);
          expect("(cd)", "virtualjaguar_bios_type",     false);
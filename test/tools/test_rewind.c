@@ -0,0 +1,366 @@
+/* test_rewind.c -- In-core rewind must land exactly on earlier states.
+ *
+ * With virtualjaguar_rewind set, retro_run() captures a state every
+ * `interval` frames into a ring of compressed XOR deltas
+ * (src/core/rewind.h) and, while the rewind button is held, steps back
+ * through it.  A delta that is dropped, mis-packed or applied to the
+ * wrong head does not crash anything -- it resumes play from a machine
+ * that never existed.  This test records a full savestate after every
+ * frame of a run, then holds the button and checks every frame:
+ *
+ *   - steps_exact          after each rewind frame the machine equals the
+ *                          recorded state one capture back plus the frame
+ *                          it ran (byte-identical savestates)
+ *   - depth_tracks         the reachable depth drops by one per step
+ *   - resume_captures      on release, captures resume
+ *   - player_load_clears   a frontend state load forgets the history
+ *   - runahead_real_only   under run-ahead only the real frame of each
+ *                          load/run/save/look-ahead cycle captures, while
+ *                          frontend rewind (a save before every frame)
+ *                          still captures every frame
+ *   - eviction_exact       a ring too small for the history evicts the
+ *                          oldest deltas and the rest still step back to
+ *                          exact copies (RewindConfigure driven directly)
+ *
+ * Usage: ./test/tools/test_rewind <core> <rom> [--frames N] [--warmup N]
+ *                                 [--json]
+ *
+ * Exit:  0 PASS, 1 FAIL, 2 SKIP (ROM missing)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <unistd.h>
+
+#include "../harness/harness.h"
+
+#define DEFAULT_WARMUP 120
+#define DEFAULT_FRAMES 48
+#define REWIND_STEPS   24
+#define RESERVED_OFF   12
+#define RETROPAD_SELECT 2       /* RETRO_DEVICE_ID_JOYPAD_SELECT */
+#define EVICT_STATES   12
+#define RUNAHEAD_CYCLES 8
+
+static size_t (*p_serialize_size)(void);
+static bool   (*p_serialize)(void *, size_t);
+static bool   (*p_unserialize)(const void *, size_t);
+static unsigned (*p_depth)(void);
+static bool   (*p_configure)(size_t, size_t);
+static uint8_t *(*p_capture)(void);
+static void   (*p_commit)(void);
+static const uint8_t *(*p_step_back)(void);
+
+static size_t state_size;
+static bool   hold_rewind;
+
+static int16_t rewind_input(void *userdata, unsigned port, unsigned device,
+                            unsigned index, unsigned id)
+{
+    (void)userdata;
+    (void)index;
+    return (hold_rewind && port == 0 && device == 1 /* RETRO_DEVICE_JOYPAD */
+            && id == RETROPAD_SELECT) ? 1 : 0;
+}
+
+/* First differing offset of two images, skipping the reserved word, or -1. */
+static long image_diff(const uint8_t *a, const uint8_t *b)
+{
+    size_t i;
+
+    for (i = 0; i < state_size; i++) {
+        if (i >= RESERVED_OFF && i < RESERVED_OFF + 4)
+            continue;
+        if (a[i] != b[i])
+            return (long)i;
+    }
+    return -1;
+}
+
+/* Synthetic state n: noise seeded by n, so every delta is a full,
+ * incompressible state and only a few fit the ring. */
+static void make_state(uint8_t *dst, unsigned n)
+{
+    size_t i;
+    uint32_t x = 0x12345678u ^ (n * 0x9E3779B9u);
+
+    for (i = 0; i < state_size; i++) {
+        x = x * 1664525u + 1013904223u;
+        dst[i] = (uint8_t)(x >> 24);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    harness_config cfg = HARNESS_CONFIG_DEFAULT;
+    harness_result results[6];
+    unsigned       nres = 0;
+    unsigned       warmup = DEFAULT_WARMUP;
+    unsigned       i;
+    uint8_t      **hist = NULL;
+    uint8_t       *now = NULL;
+    int            step_bad = -1, depth_bad = -1;
+    long           step_off = -1;
+    unsigned       depth_before = 0, depth_after_resume = 0, depth_after_load = 0;
+    unsigned       depth_runahead = 0, depth_frontend = 0;
+    unsigned       evict_depth = 0;
+    int            evict_bad = -1;
+    bool           evict_config = false;
+    char           d_step[160], d_depth[160], d_res[160], d_load[160], d_ra[160];
+    char           d_ev[160];
+    int            failed = 0;
+
+    for (i = 1; i < (unsigned)argc; i++) {
+        if (!strcmp(argv[i], "--warmup") && i + 1 < (unsigned)argc)
+            warmup = (unsigned)atoi(argv[++i]);
+    }
+
+    cfg.frames = DEFAULT_FRAMES;
+    harness_set_option(&cfg, "virtualjaguar_rewind", "select");
+    harness_set_option(&cfg, "virtualjaguar_rewind_interval", "1");
+    harness_set_option(&cfg, "virtualjaguar_rewind_budget", "32");
+    if (!harness_init_from_args(&cfg, argc, argv)) {
+        fprintf(stderr, "usage: %s <core> <rom> [--frames N] [--warmup N] [--json]\n",
+                argv[0]);
+        return 1;
+    }
+    if (cfg.frames <= REWIND_STEPS + 1)
+        cfg.frames = REWIND_STEPS + 2;
+    cfg.input_callback = rewind_input;
+
+    if (!cfg.rom_path || access(cfg.rom_path, R_OK) != 0) {
+        printf("SKIP: ROM not available (%s)\n",
+               cfg.rom_path ? cfg.rom_path : "(none)");
+        return 2;
+    }
+
+    if (!harness_load_core(&cfg))
+        return 1;
+    if (!harness_load_rom(&cfg)) {
+        harness_shutdown(&cfg);
+        return 1;
+    }
+
+    p_serialize_size = harness_dlsym(&cfg, "retro_serialize_size");
+    p_serialize      = harness_dlsym(&cfg, "retro_serialize");
+    p_unserialize    = harness_dlsym(&cfg, "retro_unserialize");
+    p_depth          = harness_dlsym(&cfg, "RewindDepth");
+    p_configure      = harness_dlsym(&cfg, "RewindConfigure");
+    p_capture        = harness_dlsym(&cfg, "RewindCaptureBuffer");
+    p_commit         = harness_dlsym(&cfg, "RewindCommit");
+    p_step_back      = harness_dlsym(&cfg, "RewindStepBack");
+    if (!p_serialize_size || !p_serialize || !p_unserialize || !p_depth
+            || !p_configure || !p_capture || !p_commit || !p_step_back) {
+        fprintf(stderr, "FAIL: core lacks serialize or Rewind test exports\n");
+        harness_shutdown(&cfg);
+        return 1;
+    }
+
+    state_size = p_serialize_size();
+    hist = (uint8_t **)calloc(cfg.frames, sizeof(*hist));
+    now  = (uint8_t *)malloc(state_size);
+    if (!hist || !now) {
+        fprintf(stderr, "FAIL: out of memory\n");
+        harness_shutdown(&cfg);
+        return 1;
+    }
+    for (i = 0; i < cfg.frames; i++) {
+        hist[i] = (uint8_t *)malloc(state_size);
+        if (!hist[i]) {
+            fprintf(stderr, "FAIL: out of memory\n");
+            harness_shutdown(&cfg);
+            return 1;
+        }
+    }
+
+    for (i = 0; i < warmup; i++)
+        harness_step(&cfg);
+
+    /* hist[i]: the machine after recorded frame i, which is also what the
+     * core captured at the end of that frame. */
+    for (i = 0; i < cfg.frames; i++) {
+        harness_step(&cfg);
+        p_serialize(hist[i], state_size);
+    }
+    depth_before = p_depth();
+
+    /* Rewind frame j steps back to capture (last - j) and runs one idle
+     * frame from there, landing on recorded frame (last - j + 1). */
+    hold_rewind = true;
+    for (i = 1; i <= REWIND_STEPS; i++) {
+        unsigned expect = cfg.frames - i;
+        long d;
+
+        harness_step(&cfg);
+        p_serialize(now, state_size);
+        d = image_diff(now, hist[expect]);
+        if (d >= 0 && step_bad < 0) {
+            step_bad = (int)i;
+            step_off = d;
+        }
+        if (p_depth() != depth_before - i && depth_bad < 0)
+            depth_bad = (int)i;
+    }
+    hold_rewind = false;
+
+    for (i = 0; i < 4; i++)
+        harness_step(&cfg);
+    depth_after_resume = p_depth();
+
+    p_unserialize(hist[0], state_size);
+    depth_after_load = p_depth();
+
+    /* Run-ahead by two: load, the real frame, save, then two look-ahead
+     * frames -- hidden, then presented -- that the next load discards. */
+    cfg.runahead_context = 1;
+    p_serialize(now, state_size);
+    for (i = 0; i < RUNAHEAD_CYCLES; i++) {
+        p_unserialize(now, state_size);
+        cfg.av_hidden = 3;
+        harness_step(&cfg);
+        p_serialize(now, state_size);
+        harness_step(&cfg);
+        cfg.av_hidden = 0;
+        harness_step(&cfg);
+    }
+    depth_runahead = p_depth();
+    /* Frontend rewind: the same save context before every frame, and
+     * no loads. */
+    for (i = 0; i < RUNAHEAD_CYCLES; i++) {
+        p_serialize(now, state_size);
+        harness_step(&cfg);
+    }
+    depth_frontend = p_depth() - depth_runahead;
+    cfg.runahead_context = 0;
+
+    /* Eviction: a budget with room for only a handful of deltas. */
+    if (p_configure(state_size, 20u << 20)) {
+        uint8_t **syn = (uint8_t **)calloc(EVICT_STATES, sizeof(*syn));
+        unsigned n;
+
+        evict_config = true;
+        for (n = 0; syn && n < EVICT_STATES; n++) {
+            syn[n] = (uint8_t *)malloc(state_size);
+            if (!syn[n])
+                break;
+            make_state(syn[n], n);
+            memcpy(p_capture(), syn[n], state_size);
+            p_commit();
+        }
+        evict_depth = p_depth();
+        if (n < EVICT_STATES || evict_depth == 0 || evict_depth >= EVICT_STATES - 1)
+            evict_bad = 0;
+        for (i = 1; evict_bad < 0 && i <= evict_depth; i++) {
+            const uint8_t *s = p_step_back();
+            if (!s || memcmp(s, syn[EVICT_STATES - 1 - i], state_size) != 0)
+                evict_bad = (int)i;
+        }
+        if (evict_bad < 0 && p_step_back() != NULL)
+            evict_bad = (int)evict_depth + 1;
+        for (n = 0; syn && n < EVICT_STATES; n++)
+            free(syn[n]);
+        free(syn);
+    }
+
+    /* ---------- report ---------- */
+
+    if (step_bad < 0)
+        snprintf(d_step, sizeof(d_step),
+                 "%u rewind frames each landed on the recorded state",
+                 REWIND_STEPS);
+    else
+        snprintf(d_step, sizeof(d_step),
+                 "rewind frame %d differs from the recorded state at offset %ld",
+                 step_bad, step_off);
+    results[nres].status = (step_bad < 0) ? "PASS" : "FAIL";
+    results[nres].name   = "steps_exact";
+    results[nres].detail = d_step;
+    if (step_bad >= 0) failed = 1;
+    nres++;
+
+    {
+        int ok = depth_bad < 0 && depth_before >= cfg.frames;
+
+        if (depth_bad < 0)
+            snprintf(d_depth, sizeof(d_depth),
+                     "depth %u before rewinding, one less per step",
+                     depth_before);
+        else
+            snprintf(d_depth, sizeof(d_depth),
+                     "depth wrong after step %d (started at %u)",
+                     depth_bad, depth_before);
+        results[nres].status = ok ? "PASS" : "FAIL";
+        results[nres].name   = "depth_tracks";
+        results[nres].detail = d_depth;
+        if (!ok) failed = 1;
+        nres++;
+    }
+
+    {
+        unsigned expect = depth_before - REWIND_STEPS + 4;
+        int ok = depth_after_resume == expect;
+
+        snprintf(d_res, sizeof(d_res),
+                 "4 frames after release depth is %u (expected %u)",
+                 depth_after_resume, expect);
+        results[nres].status = ok ? "PASS" : "FAIL";
+        results[nres].name   = "resume_captures";
+        results[nres].detail = d_res;
+        if (!ok) failed = 1;
+        nres++;
+    }
+
+    snprintf(d_load, sizeof(d_load),
+             "depth %u after retro_unserialize from the frontend",
+             depth_after_load);
+    results[nres].status = (depth_after_load == 0) ? "PASS" : "FAIL";
+    results[nres].name   = "player_load_clears";
+    results[nres].detail = d_load;
+    if (depth_after_load != 0) failed = 1;
+    nres++;
+
+    {
+        /* After the load the first capture is the head, not a step. */
+        int ok = depth_runahead == RUNAHEAD_CYCLES - 1
+              && depth_frontend == RUNAHEAD_CYCLES;
+
+        snprintf(d_ra, sizeof(d_ra),
+                 "%u run-ahead cycles captured %u, %u saved frames captured %u",
+                 RUNAHEAD_CYCLES, depth_runahead + 1,
+                 RUNAHEAD_CYCLES, depth_frontend);
+        results[nres].status = ok ? "PASS" : "FAIL";
+        results[nres].name   = "runahead_real_only";
+        results[nres].detail = d_ra;
+        if (!ok) failed = 1;
+        nres++;
+    }
+
+    if (!evict_config)
+        snprintf(d_ev, sizeof(d_ev), "RewindConfigure refused a 20 MB budget");
+    else if (evict_bad < 0)
+        snprintf(d_ev, sizeof(d_ev),
+                 "%u states into a 20 MB ring kept %u, each stepped back exactly",
+                 EVICT_STATES, evict_depth);
+    else
+        snprintf(d_ev, sizeof(d_ev),
+                 "%u states into a 20 MB ring kept %u, step %d wrong",
+                 EVICT_STATES, evict_depth, evict_bad);
+    results[nres].status = (evict_config && evict_bad < 0) ? "PASS" : "FAIL";
+    results[nres].name   = "eviction_exact";
+    results[nres].detail = d_ev;
+    if (!evict_config || evict_bad >= 0) failed = 1;
+    nres++;
+
+    harness_report(&cfg, results, nres);
+
+    for (i = 0; i < cfg.frames; i++)
+        free(hist[i]);
+    free(hist);
+    free(now);
+    harness_shutdown(&cfg);
+
+    return failed;
+}
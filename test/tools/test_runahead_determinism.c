@@ -30,6 +30,13 @@
  *   - audio_replay_identical    pass 1 == pass 2, per-frame audio digests
  *   - state_reconverges         state C == state B, byte for byte
  *   - repeated_rollback_agrees  pass 2 == pass 3, video and audio
+ *   - hidden_frames_identical   pass 4: roll back again and run the
+ *                               window with video and audio reported
+ *                               disabled (GET_AUDIO_VIDEO_ENABLE, as
+ *                               run-ahead does for frames it discards)
+ *                               except the last; the state after it
+ *                               equals state B and the presented frame
+ *                               equals pass 1's last frame
  *
  * A state that round-trips but silently drops a field usually passes a
  * naive "save, load, does it still run?" check and fails here, because
@@ -316,7 +323,7 @@ static void run_window(harness_config *cfg, unsigned n)
 int main(int argc, char **argv)
 {
     harness_config cfg = HARNESS_CONFIG_DEFAULT;
-    harness_result results[4];
+    harness_result results[5];
     unsigned       nres = 0;
     unsigned       warmup = DEFAULT_WARMUP;
     unsigned       i;
@@ -332,6 +339,7 @@ int main(int argc, char **argv)
     int            first_repeat_diff = -1;
     unsigned       repeat_diff_count = 0;
     unsigned       pass1_count;
+    unsigned       pass3_count;
     unsigned       pass1_audio_entries = 0;
     unsigned       pass2_audio_entries = 0;
     int            audio_measurable;
@@ -339,6 +347,11 @@ int main(int argc, char **argv)
     char           state_a[64];
     char           state_b[64];
     char           state_c[64];
+    char           state_d[64];
+    uint8_t       *blob_d = NULL;
+    size_t         len_d = 0;
+    int            hidden_state_ok = 0, hidden_frame_ok = 0;
+    char           detail_h[256];
     uint8_t       *blob_b = NULL, *blob_c = NULL;
     size_t         len_b = 0, len_c = 0;
     int            state_stable = 0;
@@ -356,6 +369,8 @@ int main(int argc, char **argv)
              (long)getpid());
     snprintf(state_c, sizeof(state_c), "/tmp/vj_runahead_c_%ld.state",
              (long)getpid());
+    snprintf(state_d, sizeof(state_d), "/tmp/vj_runahead_d_%ld.state",
+             (long)getpid());
 
     for (i = 1; i < (unsigned)argc; i++) {
         if (!strcmp(argv[i], "--warmup") && i + 1 < (unsigned)argc)
@@ -468,10 +483,34 @@ int main(int argc, char **argv)
             repeat_diff_count++;
         }
     }
-    /* Compare pass 1 against pass 3's digests below; cap now holds pass 3,
+
+    pass3_count = cap.count;
+
+    /* 9. Pass 4 -- run-ahead's hidden frames.  Everything but the last
+     * frame runs with video and audio reported disabled, which skips the
+     * scanline conversion and output resampling; the machine must end
+     * up exactly where pass 1 did, and the one presented frame must look
+     * and sound the same. */
+    if (!harness_load_state(&cfg, state_a)) {
+        fprintf(stderr, "FAIL: retro_unserialize failed on third rollback\n");
+        harness_shutdown(&cfg);
+        return 1;
+    }
+    cfg.av_hidden = 3;
+    for (i = 0; i + 1 < window_frames; i++)
+        harness_step(&cfg);
+    cfg.av_hidden = 0;
+    run_window(&cfg, 1);
+    hidden_frame_ok = (pass1_count == window_frames && cap.count == 1
+                       && cap.video[0] == pass1_video[pass1_count - 1]
+                       && cap.audio[0] == pass1_audio[pass1_count - 1]);
+    harness_save_state(&cfg, state_d);
+
+    /* Compare pass 1 against pass 3's digests below; cap now holds pass 4,
      * and pass 2 and pass 3 are asserted equal separately. */
     memcpy(cap.video, pass2_video, sizeof(pass2_video));
     memcpy(cap.audio, pass2_audio, sizeof(pass2_audio));
+    cap.count = pass3_count;
 
     /* ---------- compare ---------- */
 
@@ -492,6 +531,9 @@ int main(int argc, char **argv)
     blob_c = read_file(state_c, &len_c);
     state_stable = (blob_b && blob_c && len_b == len_c &&
                     memcmp(blob_b, blob_c, len_b) == 0);
+    blob_d = read_file(state_d, &len_d);
+    hidden_state_ok = (blob_b && blob_d && len_b == len_d &&
+                       memcmp(blob_b, blob_d, len_b) == 0);
 
     if (first_video_diff < 0)
         snprintf(detail_v, sizeof(detail_v),
@@ -585,13 +627,31 @@ int main(int argc, char **argv)
     if (first_repeat_diff >= 0) failed = 1;
     nres++;
 
+    if (hidden_state_ok && hidden_frame_ok)
+        snprintf(detail_h, sizeof(detail_h),
+                 "%u hidden frames then one presented: state and presented "
+                 "frame identical to pass 1", window_frames - 1);
+    else
+        snprintf(detail_h, sizeof(detail_h),
+                 "after %u hidden frames the %s differs from pass 1",
+                 window_frames - 1,
+                 !hidden_state_ok ? "state" : "presented frame");
+
+    results[nres].status = (hidden_state_ok && hidden_frame_ok) ? "PASS" : "FAIL";
+    results[nres].name   = "hidden_frames_identical";
+    results[nres].detail = detail_h;
+    if (!(hidden_state_ok && hidden_frame_ok)) failed = 1;
+    nres++;
+
     harness_report(&cfg, results, nres);
 
     free(blob_b);
     free(blob_c);
+    free(blob_d);
     remove(state_a);
     remove(state_b);
     remove(state_c);
+    remove(state_d);
     harness_shutdown(&cfg);
 
     return failed;
@@ -0,0 +1,323 @@
+/* test_state_delta.c -- Incremental savestates must equal full ones.
+ *
+ * With virtualjaguar_state_delta enabled, retro_serialize() into the
+ * buffer it wrote last time rewrites only the main-RAM pages marked dirty
+ * since then (src/core/state_delta.h).  A main-RAM store path that
+ * forgets to mark its page leaves a stale page in the buffer, and the
+ * next rollback silently restores old memory.  This test drives the
+ * run-ahead loop and checks every image it produces:
+ *
+ *   - ram_matches_live     after each save into the reused buffer, its
+ *                          2 MB RAM chunk equals live RAM
+ *                          (retro_get_memory_data), every frame
+ *   - delta_equals_full    periodically, a reused-buffer save and a fresh
+ *                          full save of the same machine state are
+ *                          byte-identical apart from the reserved word
+ *   - delta_engaged        reused saves really wrote less than a full
+ *                          state (otherwise the checks above are vacuous)
+ *   - rollback_tracked     unserialize the tracked buffer itself, run on
+ *   - rollback_foreign     unserialize an older copy, run on
+ *   - tampered_nonce       a buffer whose reserved word was changed
+ *                          behind the core's back gets a full copy
+ *
+ * Pages written by a rollback are the interesting case: the tracked
+ * buffer is trusted again only when the state just loaded IS that
+ * buffer; any other load must mark every page.
+ *
+ * Usage: ./test/tools/test_state_delta <core> <rom> [--frames N]
+ *                                      [--warmup N] [--json]
+ *
+ * Exit:  0 PASS, 1 FAIL, 2 SKIP (ROM missing)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <unistd.h>
+
+#include "../harness/harness.h"
+
+#define DEFAULT_WARMUP 120
+#define DEFAULT_FRAMES 240
+#define RAM_OFFSET     16          /* state header: magic, version, flags, reserved */
+#define RAM_SIZE       0x200000
+#define RESERVED_OFF   12
+#define FULL_EVERY     30
+
+static size_t (*p_serialize_size)(void);
+static bool   (*p_serialize)(void *, size_t);
+static bool   (*p_unserialize)(const void *, size_t);
+static void  *(*p_get_memory_data)(unsigned);
+static size_t (*p_last_bytes)(void);
+
+static size_t state_size;
+
+/* Compare two state images, skipping the reserved (nonce) word.  Returns
+ * the first differing offset or -1. */
+static long image_diff(const uint8_t *a, const uint8_t *b)
+{
+    size_t i;
+
+    for (i = 0; i < state_size; i++) {
+        if (i >= RESERVED_OFF && i < RESERVED_OFF + 4)
+            continue;
+        if (a[i] != b[i])
+            return (long)i;
+    }
+    return -1;
+}
+
+/* First differing byte between the image's RAM chunk and live RAM. */
+static long ram_diff(const uint8_t *img)
+{
+    const uint8_t *ram = (const uint8_t *)p_get_memory_data(2 /* RETRO_MEMORY_SYSTEM_RAM */);
+    size_t i;
+
+    if (memcmp(img + RAM_OFFSET, ram, RAM_SIZE) == 0)
+        return -1;
+    for (i = 0; i < RAM_SIZE; i++)
+        if (img[RAM_OFFSET + i] != ram[i])
+            return (long)i;
+    return -1;
+}
+
+int main(int argc, char **argv)
+{
+    harness_config cfg = HARNESS_CONFIG_DEFAULT;
+    harness_result results[6];
+    unsigned       nres = 0;
+    unsigned       warmup = DEFAULT_WARMUP;
+    unsigned       i;
+    uint8_t       *tracked = NULL, *full = NULL, *older = NULL;
+    long           first_ram_diff = -1, first_full_diff = -1;
+    int            ram_bad_frame = -1, full_bad_frame = -1;
+    unsigned       full_checks = 0;
+    unsigned long long delta_bytes = 0;
+    unsigned       delta_saves = 0;
+    long           rb_tracked = -1, rb_foreign = -1;
+    size_t         tamper_bytes = 0;
+    long           tamper_diff = -1;
+    char           d_ram[160], d_full[160], d_eng[160], d_rbt[160], d_rbf[160], d_tam[160];
+    int            failed = 0;
+
+    for (i = 1; i < (unsigned)argc; i++) {
+        if (!strcmp(argv[i], "--warmup") && i + 1 < (unsigned)argc)
+            warmup = (unsigned)atoi(argv[++i]);
+    }
+
+    cfg.frames = DEFAULT_FRAMES;
+    harness_set_option(&cfg, "virtualjaguar_state_delta", "enabled");
+    if (!harness_init_from_args(&cfg, argc, argv)) {
+        fprintf(stderr, "usage: %s <core> <rom> [--frames N] [--warmup N] [--json]\n",
+                argv[0]);
+        return 1;
+    }
+
+    if (!cfg.rom_path || access(cfg.rom_path, R_OK) != 0) {
+        printf("SKIP: ROM not available (%s)\n",
+               cfg.rom_path ? cfg.rom_path : "(none)");
+        return 2;
+    }
+
+    if (!harness_load_core(&cfg))
+        return 1;
+    if (!harness_load_rom(&cfg)) {
+        harness_shutdown(&cfg);
+        return 1;
+    }
+
+    p_serialize_size  = harness_dlsym(&cfg, "retro_serialize_size");
+    p_serialize       = harness_dlsym(&cfg, "retro_serialize");
+    p_unserialize     = harness_dlsym(&cfg, "retro_unserialize");
+    p_get_memory_data = harness_dlsym(&cfg, "retro_get_memory_data");
+    p_last_bytes      = harness_dlsym(&cfg, "StateDeltaLastBytes");
+    if (!p_serialize_size || !p_serialize || !p_unserialize
+            || !p_get_memory_data || !p_last_bytes) {
+        fprintf(stderr, "FAIL: core lacks serialize or StateDelta test exports\n");
+        harness_shutdown(&cfg);
+        return 1;
+    }
+
+    state_size = p_serialize_size();
+    tracked = (uint8_t *)calloc(1, state_size);
+    full    = (uint8_t *)calloc(1, state_size);
+    older   = (uint8_t *)calloc(1, state_size);
+    if (!tracked || !full || !older) {
+        fprintf(stderr, "FAIL: out of memory\n");
+        harness_shutdown(&cfg);
+        return 1;
+    }
+
+    for (i = 0; i < warmup; i++)
+        harness_step(&cfg);
+
+    /* Run-ahead loop: one buffer, a save every frame. */
+    for (i = 0; i < cfg.frames; i++) {
+        long d;
+
+        harness_step(&cfg);
+        if (!p_serialize(tracked, state_size)) {
+            fprintf(stderr, "FAIL: retro_serialize failed at frame %u\n", i);
+            failed = 1;
+            break;
+        }
+        if (i > 0 && i % FULL_EVERY != 1) {
+            delta_bytes += p_last_bytes();
+            delta_saves++;
+        }
+
+        d = ram_diff(tracked);
+        if (d >= 0 && ram_bad_frame < 0) {
+            ram_bad_frame  = (int)i;
+            first_ram_diff = d;
+        }
+
+        /* Same machine state into a buffer the core has never seen: a full
+         * copy.  (This moves tracking to `full`, so the next save into
+         * `tracked` is itself full; the frames in between are deltas.) */
+        if (i % FULL_EVERY == 0) {
+            if (i == FULL_EVERY)
+                memcpy(older, tracked, state_size);
+            if (!p_serialize(full, state_size)) {
+                failed = 1;
+                break;
+            }
+            d = image_diff(tracked, full);
+            if (d >= 0 && full_bad_frame < 0) {
+                full_bad_frame  = (int)i;
+                first_full_diff = d;
+            }
+            full_checks++;
+        }
+    }
+
+    /* Rollback to the tracked buffer itself -- save, run ahead, load, as
+     * run-ahead does -- then keep saving into it. */
+    p_serialize(tracked, state_size);
+    for (i = 0; i < 5; i++)
+        harness_step(&cfg);
+    if (p_unserialize(tracked, state_size)) {
+        for (i = 0; i < 30; i++) {
+            harness_step(&cfg);
+            p_serialize(tracked, state_size);
+            if (ram_diff(tracked) >= 0) {
+                rb_tracked = (long)i;
+                break;
+            }
+        }
+    } else
+        rb_tracked = 0;
+
+    /* Rollback to an older copy the core did not just write. */
+    if (p_unserialize(older, state_size)) {
+        for (i = 0; i < 30; i++) {
+            harness_step(&cfg);
+            p_serialize(tracked, state_size);
+            if (ram_diff(tracked) >= 0) {
+                rb_foreign = (long)i;
+                break;
+            }
+        }
+    } else
+        rb_foreign = 0;
+
+    /* Someone rewrote the reserved word: no longer our image. */
+    harness_step(&cfg);
+    p_serialize(tracked, state_size);
+    tracked[RESERVED_OFF] ^= 0x5A;
+    p_serialize(tracked, state_size);
+    tamper_bytes = p_last_bytes();
+    tamper_diff  = ram_diff(tracked);
+
+    /* ---------- report ---------- */
+
+    if (ram_bad_frame < 0)
+        snprintf(d_ram, sizeof(d_ram),
+                 "%u saves into one buffer, RAM chunk equal to live RAM each time",
+                 cfg.frames);
+    else
+        snprintf(d_ram, sizeof(d_ram),
+                 "stale RAM in saved image at frame %d, RAM offset $%06lX",
+                 ram_bad_frame, first_ram_diff);
+    results[nres].status = (ram_bad_frame < 0) ? "PASS" : "FAIL";
+    results[nres].name   = "ram_matches_live";
+    results[nres].detail = d_ram;
+    if (ram_bad_frame >= 0) failed = 1;
+    nres++;
+
+    if (full_bad_frame < 0)
+        snprintf(d_full, sizeof(d_full),
+                 "%u incremental images byte-identical to full saves", full_checks);
+    else
+        snprintf(d_full, sizeof(d_full),
+                 "incremental image differs from full save at frame %d, offset %ld",
+                 full_bad_frame, first_full_diff);
+    results[nres].status = (full_bad_frame < 0 && full_checks > 0) ? "PASS" : "FAIL";
+    results[nres].name   = "delta_equals_full";
+    results[nres].detail = d_full;
+    if (full_bad_frame >= 0 || full_checks == 0) failed = 1;
+    nres++;
+
+    {
+        double avg = delta_saves ? (double)delta_bytes / delta_saves : 0.0;
+        int ok = delta_saves > 0 && avg < (double)state_size / 2;
+
+        snprintf(d_eng, sizeof(d_eng),
+                 "%u reused-buffer saves wrote %.0f KB on average (full state %lu KB)",
+                 delta_saves, avg / 1024.0, (unsigned long)(state_size / 1024));
+        results[nres].status = ok ? "PASS" : "FAIL";
+        results[nres].name   = "delta_engaged";
+        results[nres].detail = d_eng;
+        if (!ok) failed = 1;
+        nres++;
+    }
+
+    if (rb_tracked < 0)
+        snprintf(d_rbt, sizeof(d_rbt),
+                 "load of the tracked buffer, then 30 incremental saves: all match");
+    else
+        snprintf(d_rbt, sizeof(d_rbt),
+                 "after loading the tracked buffer, stale RAM at save %ld", rb_tracked);
+    results[nres].status = (rb_tracked < 0) ? "PASS" : "FAIL";
+    results[nres].name   = "rollback_tracked";
+    results[nres].detail = d_rbt;
+    if (rb_tracked >= 0) failed = 1;
+    nres++;
+
+    if (rb_foreign < 0)
+        snprintf(d_rbf, sizeof(d_rbf),
+                 "load of an older copy, then 30 saves into the tracked buffer: all match");
+    else
+        snprintf(d_rbf, sizeof(d_rbf),
+                 "after loading an older copy, stale RAM at save %ld", rb_foreign);
+    results[nres].status = (rb_foreign < 0) ? "PASS" : "FAIL";
+    results[nres].name   = "rollback_foreign";
+    results[nres].detail = d_rbf;
+    if (rb_foreign >= 0) failed = 1;
+    nres++;
+
+    {
+        int ok = tamper_bytes >= RAM_SIZE && tamper_diff < 0;
+
+        snprintf(d_tam, sizeof(d_tam),
+                 "save after the reserved word changed wrote %lu bytes%s",
+                 (unsigned long)tamper_bytes,
+                 tamper_diff < 0 ? "" : " and left stale RAM");
+        results[nres].status = ok ? "PASS" : "FAIL";
+        results[nres].name   = "tampered_nonce";
+        results[nres].detail = d_tam;
+        if (!ok) failed = 1;
+        nres++;
+    }
+
+    harness_report(&cfg, results, nres);
+
+    free(tracked);
+    free(full);
+    free(older);
+    harness_shutdown(&cfg);
+
+    return failed;
+}
@@ -0,0 +1,237 @@
+/* test_threaded_dsp.c -- The DSP worker must not change a bit.
+ *
+ * With virtualjaguar_threaded_dsp on, each scheduler slice hands the
+ * DSP's share to a worker thread that runs it while the 68000 and GPU
+ * run theirs.  The worker parks at the DSP's first access outside its
+ * own RAM and registers, and a 68000/GPU/blitter access to the DSP
+ * mid-slice rolls it back to the start of the slice (see the comment in
+ * src/jerry/dsp.c).  A state the snapshot misses, an undo-log gap, an
+ * external access that slips past the park, or a claim that comes too
+ * late all show up as a frame or a savestate that differs from the
+ * serial scheduler.  This test runs the same window both ways from one
+ * state:
+ *
+ *   - worker_started      DSPSetThreaded(true) brought the worker up
+ *   - worker_used         slices were handed to it (parks and rollbacks
+ *                         are reported alongside)
+ *   - frames_identical    every frame hashes the same as the serial pass
+ *   - state_untouched     the savestate after the threaded pass equals
+ *                         the one after the serial pass
+ *   - worker_stops        DSPSetThreaded(false) returns to the serial
+ *                         path and the next frame still matches
+ *
+ * Usage: ./test/tools/test_threaded_dsp <core> <rom> [--frames N]
+ *                                       [--warmup N] [--json]
+ *                                       [--option K=V ...]
+ *
+ * Exit:  0 PASS, 1 FAIL, 2 SKIP (ROM missing, or no threads in this
+ *        build)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <unistd.h>
+
+#include "../harness/harness.h"
+
+#define DEFAULT_WARMUP 120
+#define DEFAULT_FRAMES 120
+#define RESERVED_OFF   12
+
+static size_t (*p_serialize_size)(void);
+static bool   (*p_serialize)(void *, size_t);
+static bool   (*p_unserialize)(const void *, size_t);
+static bool   (*p_set_threaded)(bool);
+static void   (*p_stats)(uint32_t *, uint32_t *, uint32_t *);
+
+static size_t state_size;
+
+/* First differing offset of two images, skipping the reserved word, or -1. */
+static long image_diff(const uint8_t *a, const uint8_t *b)
+{
+    size_t i;
+
+    for (i = 0; i < state_size; i++) {
+        if (i >= RESERVED_OFF && i < RESERVED_OFF + 4)
+            continue;
+        if (a[i] != b[i])
+            return (long)i;
+    }
+    return -1;
+}
+
+int main(int argc, char **argv)
+{
+    harness_config cfg = HARNESS_CONFIG_DEFAULT;
+    harness_result results[5];
+    unsigned       nres = 0;
+    unsigned       warmup = DEFAULT_WARMUP;
+    unsigned       i;
+    uint32_t      *ref = NULL;
+    uint8_t       *start = NULL, *after_serial = NULL, *after_thr = NULL;
+    bool           started = false, stopped = false;
+    int            frame_bad = -1;
+    long           state_off = -1;
+    uint32_t       tail_ref = 0, tail_serial = 0;
+    uint32_t       slices0, parks0, rollbacks0, slices, parks, rollbacks;
+    char           d_start[160], d_used[160], d_frames[160], d_state[160],
+                   d_stop[160];
+    int            failed = 0;
+
+    for (i = 1; i < (unsigned)argc; i++) {
+        if (!strcmp(argv[i], "--warmup") && i + 1 < (unsigned)argc)
+            warmup = (unsigned)atoi(argv[++i]);
+    }
+
+    cfg.frames = DEFAULT_FRAMES;
+    if (!harness_init_from_args(&cfg, argc, argv)) {
+        fprintf(stderr, "usage: %s <core> <rom> [--frames N] [--warmup N] [--json]\n",
+                argv[0]);
+        return 1;
+    }
+    cfg.want_fb_hash = 1;
+
+    if (!cfg.rom_path || access(cfg.rom_path, R_OK) != 0) {
+        printf("SKIP: ROM not available (%s)\n",
+               cfg.rom_path ? cfg.rom_path : "(none)");
+        return 2;
+    }
+
+    if (!harness_load_core(&cfg))
+        return 1;
+    if (!harness_load_rom(&cfg)) {
+        harness_shutdown(&cfg);
+        return 1;
+    }
+
+    p_serialize_size = harness_dlsym(&cfg, "retro_serialize_size");
+    p_serialize      = harness_dlsym(&cfg, "retro_serialize");
+    p_unserialize    = harness_dlsym(&cfg, "retro_unserialize");
+    p_set_threaded   = harness_dlsym(&cfg, "DSPSetThreaded");
+    p_stats          = harness_dlsym(&cfg, "DSPThreadStats");
+    if (!p_serialize_size || !p_serialize || !p_unserialize || !p_set_threaded
+        || !p_stats) {
+        fprintf(stderr, "FAIL: core lacks serialize or DSPSetThreaded/DSPThreadStats export\n");
+        harness_shutdown(&cfg);
+        return 1;
+    }
+
+    state_size   = p_serialize_size();
+    ref          = (uint32_t *)calloc(cfg.frames, sizeof(*ref));
+    start        = (uint8_t *)malloc(state_size);
+    after_serial = (uint8_t *)malloc(state_size);
+    after_thr    = (uint8_t *)malloc(state_size);
+    if (!ref || !start || !after_serial || !after_thr) {
+        fprintf(stderr, "FAIL: out of memory\n");
+        harness_shutdown(&cfg);
+        return 1;
+    }
+
+    for (i = 0; i < warmup; i++)
+        harness_step(&cfg);
+    p_serialize(start, state_size);
+
+    /* Pass 1: the serial scheduler. */
+    p_unserialize(start, state_size);
+    for (i = 0; i < cfg.frames; i++) {
+        harness_step(&cfg);
+        ref[i] = cfg.last_fb_hash;
+    }
+    p_serialize(after_serial, state_size);
+    harness_step(&cfg);
+    tail_ref = cfg.last_fb_hash;
+
+    /* Pass 2: the same window with the DSP on the worker. */
+    p_unserialize(start, state_size);
+    started = p_set_threaded(true);
+    if (!started) {
+        printf("SKIP: no DSP worker in this build\n");
+        free(ref); free(start); free(after_serial); free(after_thr);
+        harness_shutdown(&cfg);
+        return 2;
+    }
+    p_stats(&slices0, &parks0, &rollbacks0);
+    for (i = 0; i < cfg.frames; i++) {
+        harness_step(&cfg);
+        if (cfg.last_fb_hash != ref[i] && frame_bad < 0)
+            frame_bad = (int)i;
+    }
+    p_stats(&slices, &parks, &rollbacks);
+    slices -= slices0;
+    parks -= parks0;
+    rollbacks -= rollbacks0;
+    p_serialize(after_thr, state_size);
+    state_off = image_diff(after_serial, after_thr);
+
+    /* Back to serial mid-session for the frame after the window. */
+    stopped = !p_set_threaded(false);
+    harness_step(&cfg);
+    tail_serial = cfg.last_fb_hash;
+
+    /* ---------- report ---------- */
+
+    snprintf(d_start, sizeof(d_start), "DSP worker %s",
+             started ? "running" : "did not start");
+    results[nres].status = started ? "PASS" : "FAIL";
+    results[nres].name   = "worker_started";
+    results[nres].detail = d_start;
+    nres++;
+
+    snprintf(d_used, sizeof(d_used),
+             "%u slices handed out, %u parked on an external access, %u rolled back",
+             slices, parks, rollbacks);
+    results[nres].status = slices ? "PASS" : "FAIL";
+    results[nres].name   = "worker_used";
+    results[nres].detail = d_used;
+    if (!slices) failed = 1;
+    nres++;
+
+    if (frame_bad < 0)
+        snprintf(d_frames, sizeof(d_frames),
+                 "%u threaded frames hash identical to the serial pass",
+                 cfg.frames);
+    else
+        snprintf(d_frames, sizeof(d_frames),
+                 "frame %d of the window differs from the serial pass",
+                 frame_bad);
+    results[nres].status = (frame_bad < 0) ? "PASS" : "FAIL";
+    results[nres].name   = "frames_identical";
+    results[nres].detail = d_frames;
+    if (frame_bad >= 0) failed = 1;
+    nres++;
+
+    if (state_off < 0)
+        snprintf(d_state, sizeof(d_state),
+                 "savestate after the window is byte-identical");
+    else
+        snprintf(d_state, sizeof(d_state),
+                 "savestates differ at offset %ld", state_off);
+    results[nres].status = (state_off < 0) ? "PASS" : "FAIL";
+    results[nres].name   = "state_untouched";
+    results[nres].detail = d_state;
+    if (state_off >= 0) failed = 1;
+    nres++;
+
+    snprintf(d_stop, sizeof(d_stop),
+             "worker %s, next serial frame %s",
+             stopped ? "stopped" : "still running",
+             tail_serial == tail_ref ? "matches" : "differs");
+    results[nres].status = (stopped && tail_serial == tail_ref) ? "PASS" : "FAIL";
+    results[nres].name   = "worker_stops";
+    results[nres].detail = d_stop;
+    if (!stopped || tail_serial != tail_ref) failed = 1;
+    nres++;
+
+    harness_report(&cfg, results, nres);
+
+    free(ref);
+    free(start);
+    free(after_serial);
+    free(after_thr);
+    harness_shutdown(&cfg);
+
+    return failed;
+}